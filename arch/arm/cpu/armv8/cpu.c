@@ -14,6 +14,8 @@
 #include <command.h>
 #include <cpu_func.h>
 #include <irq_func.h>
+#include <vsprintf.h>
+#include <worker.h>
 #include <asm/cache.h>
 #include <asm/system.h>
 #include <asm/secure.h>
@@ -44,6 +46,10 @@ int cleanup_before_linux(void)
 	 * disable interrupt and turn off caches etc ...
 	 */
 
+	/* The OS starts the secondary cores itself */
+	if (worker_stop())
+		panic("Secondary cores are still running U-Boot\n");
+
 	board_cleanup_before_linux();
 
 	disable_interrupts();
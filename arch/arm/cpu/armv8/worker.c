@@ -0,0 +1,207 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Starting secondary cores with PSCI to run worker jobs
+ *
+ * The cores are found in the /cpus node of the control devicetree. Each one
+ * is started with PSCI CPU_ON, sets up its MMU the same way as the boot CPU
+ * and then runs jobs until it is told to stop, when it turns itself off with
+ * PSCI CPU_OFF so that the OS can start it again.
+ */
+
+#define LOG_CATEGORY LOGC_BOOT
+
+#include <common.h>
+#include <hang.h>
+#include <cpu_func.h>
+#include <dm.h>
+#include <log.h>
+#include <malloc.h>
+#include <time.h>
+#include <worker.h>
+#include <asm/global_data.h>
+#include <asm/system.h>
+#include <asm/armv8/worker.h>
+#include <linux/psci.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/* Affinity fields of MPIDR_EL1, as passed to PSCI */
+#define MPIDR_HWID_MASK		0xff00ffffffUL
+
+/* Time allowed for a core to turn off */
+#define WORKER_OFF_TIMEOUT_MS	100
+
+static struct worker_boot *worker_boots;
+static uint worker_boot_count;
+static void (*worker_entry_func)(uint id);
+
+void worker_secondary_start(struct worker_boot *boot)
+{
+	worker_entry_func(boot->id);
+}
+
+/* Read the MMU settings of the boot CPU, for the secondary cores to copy */
+static void worker_get_mmu(struct worker_boot *boot)
+{
+	u64 tcr, mair, ttbr, vbar;
+
+	if (current_el() == 2) {
+		asm volatile("mrs %0, tcr_el2" : "=r" (tcr));
+		asm volatile("mrs %0, mair_el2" : "=r" (mair));
+		asm volatile("mrs %0, ttbr0_el2" : "=r" (ttbr));
+		asm volatile("mrs %0, vbar_el2" : "=r" (vbar));
+	} else {
+		asm volatile("mrs %0, tcr_el1" : "=r" (tcr));
+		asm volatile("mrs %0, mair_el1" : "=r" (mair));
+		asm volatile("mrs %0, ttbr0_el1" : "=r" (ttbr));
+		asm volatile("mrs %0, vbar_el1" : "=r" (vbar));
+	}
+	boot->sctlr = get_sctlr();
+	boot->tcr = tcr;
+	boot->mair = mair;
+	boot->ttbr = ttbr;
+	boot->vbar = vbar;
+	boot->gd = (ulong)gd;
+}
+
+/* Get the affinity value of a CPU node, or -ENOENT if it is not a CPU */
+static int worker_get_mpidr(ofnode node, u64 *mpidrp)
+{
+	const char *type;
+	const fdt32_t *reg;
+	int len;
+
+	type = ofnode_read_string(node, "device_type");
+	if (!type || strcmp(type, "cpu") || !ofnode_is_available(node))
+		return -ENOENT;
+	reg = ofnode_read_prop(node, "reg", &len);
+	if (!reg)
+		return -EINVAL;
+	if (len == sizeof(u64))
+		*mpidrp = fdt64_to_cpu(*(fdt64_t *)reg);
+	else if (len == sizeof(u32))
+		*mpidrp = fdt32_to_cpu(*reg);
+	else
+		return -EINVAL;
+
+	return 0;
+}
+
+int arch_worker_start(uint max, void (*entry)(uint id))
+{
+	u64 self = read_mpidr() & MPIDR_HWID_MASK;
+	struct worker_boot *boot;
+	struct udevice *dev;
+	ofnode node;
+	ulong size;
+	u64 mpidr;
+	int ret;
+
+	BUILD_BUG_ON(offsetof(struct worker_boot, sp) != WORKER_BOOT_SP);
+	BUILD_BUG_ON(offsetof(struct worker_boot, gd) != WORKER_BOOT_GD);
+
+	/* This also sets up the method for calling PSCI */
+	ret = uclass_get_device_by_driver(UCLASS_FIRMWARE,
+					  DM_GET_DRIVER(psci), &dev);
+	if (ret)
+		return log_msg_ret("psci", ret);
+
+	size = roundup(sizeof(*boot) * max, ARCH_DMA_MINALIGN);
+	worker_boots = memalign(ARCH_DMA_MINALIGN, size);
+	if (!worker_boots)
+		return log_msg_ret("boot", -ENOMEM);
+	memset(worker_boots, '\0', size);
+	worker_entry_func = entry;
+
+	worker_boot_count = 0;
+	ofnode_for_each_subnode(node, ofnode_path("/cpus")) {
+		if (worker_boot_count == max)
+			break;
+		if (worker_get_mpidr(node, &mpidr) || mpidr == self)
+			continue;
+
+		boot = &worker_boots[worker_boot_count];
+		boot->stack = memalign(16, CONFIG_WORKER_STACK_SIZE);
+		if (!boot->stack)
+			break;
+		worker_get_mmu(boot);
+		boot->sp = (ulong)boot->stack + CONFIG_WORKER_STACK_SIZE;
+		boot->id = worker_boot_count + 1;
+		boot->mpidr = mpidr;
+
+		/* The core reads this with its caches off */
+		flush_dcache_range((ulong)worker_boots,
+				   (ulong)worker_boots + size);
+		ret = invoke_psci_fn(PSCI_0_2_FN64_CPU_ON, mpidr,
+				     (ulong)worker_entry, (ulong)boot);
+		if (ret) {
+			log_debug("%s: CPU_ON failed (err=%d)\n",
+				  ofnode_get_name(node), ret);
+			free(boot->stack);
+			boot->stack = NULL;
+			continue;
+		}
+		worker_boot_count++;
+	}
+	if (!worker_boot_count) {
+		free(worker_boots);
+		worker_boots = NULL;
+	}
+
+	return worker_boot_count;
+}
+
+uint arch_worker_self(void)
+{
+	u64 mpidr = read_mpidr() & MPIDR_HWID_MASK;
+	uint i;
+
+	for (i = 0; i < worker_boot_count; i++) {
+		if (worker_boots[i].mpidr == mpidr)
+			return worker_boots[i].id;
+	}
+
+	return 0;
+}
+
+void arch_worker_idle(void)
+{
+	asm volatile("wfe" : : : "memory");
+}
+
+void arch_worker_kick(void)
+{
+	/* Make the queued job visible before waking the cores */
+	asm volatile("dsb ishst\n\tsev" : : : "memory");
+}
+
+void arch_worker_exit(void)
+{
+	invoke_psci_fn(PSCI_0_2_FN_CPU_OFF, 0, 0, 0);
+	hang();
+}
+
+void arch_worker_stop(void)
+{
+	struct worker_boot *boot;
+	ulong start;
+	uint i;
+
+	/* Make sure that the OS can start the cores again */
+	for (i = 0; i < worker_boot_count; i++) {
+		boot = &worker_boots[i];
+		start = get_timer(0);
+		while (invoke_psci_fn(PSCI_0_2_FN64_AFFINITY_INFO, boot->mpidr,
+				      0, 0) != PSCI_0_2_AFFINITY_LEVEL_OFF) {
+			if (get_timer(start) > WORKER_OFF_TIMEOUT_MS) {
+				log_warning("CPU %llx did not turn off\n",
+					    boot->mpidr);
+				break;
+			}
+		}
+		free(boot->stack);
+	}
+	free(worker_boots);
+	worker_boots = NULL;
+	worker_boot_count = 0;
+}
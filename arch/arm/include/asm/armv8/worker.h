@@ -0,0 +1,67 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Starting secondary cores to run worker jobs
+ */
+
+#ifndef __ASM_ARMV8_WORKER_H
+#define __ASM_ARMV8_WORKER_H
+
+/* Offsets into struct worker_boot, for worker_entry */
+#define WORKER_BOOT_SCTLR	0
+#define WORKER_BOOT_TCR		8
+#define WORKER_BOOT_MAIR	16
+#define WORKER_BOOT_TTBR	24
+#define WORKER_BOOT_VBAR	32
+#define WORKER_BOOT_SP		40
+#define WORKER_BOOT_GD		48
+
+#ifndef __ASSEMBLY__
+/**
+ * struct worker_boot - Information needed by a secondary core to start
+ *
+ * This is read by worker_entry before the MMU is on, so must be flushed from
+ * the cache before the core is started. The MMU settings are copied from the
+ * boot CPU, so all cores share the same page tables.
+ *
+ * @sctlr: System control register
+ * @tcr: Translation control register
+ * @mair: Memory attribute indirection register
+ * @ttbr: Translation table base register
+ * @vbar: Exception vector base address
+ * @sp: Initial stack pointer
+ * @gd: Global data pointer, for x18
+ * @id: Worker number
+ * @mpidr: Affinity of the core, as used by PSCI
+ * @stack: Stack allocated for the core
+ */
+struct worker_boot {
+	u64 sctlr;
+	u64 tcr;
+	u64 mair;
+	u64 ttbr;
+	u64 vbar;
+	u64 sp;
+	u64 gd;
+	u64 id;
+	u64 mpidr;
+	void *stack;
+};
+
+/**
+ * worker_entry() - Entry point for a secondary core started by PSCI
+ *
+ * This is called with the MMU and caches off and x0 pointing to the core's
+ * struct worker_boot. It sets up the MMU and stack, then calls
+ * worker_secondary_start().
+ */
+void worker_entry(void);
+
+/**
+ * worker_secondary_start() - Start running worker jobs
+ *
+ * @boot: Information for this core
+ */
+void worker_secondary_start(struct worker_boot *boot);
+#endif
+
+#endif
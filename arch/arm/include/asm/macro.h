@@ -75,6 +75,21 @@ lr	.req	x30
 	b.lt	\el1_label
 .endm
 
+/*
+ * Branch if the MMU is off at the current exception level. All data
+ * accesses are then to Device memory, where unaligned accesses and
+ * DC ZVA fault.
+ */
+.macro	branch_if_mmu_off, xreg, label
+	switch_el \xreg, 13f, 12f, 11f
+13:	mrs	\xreg, sctlr_el3
+	b	10f
+12:	mrs	\xreg, sctlr_el2
+	b	10f
+11:	mrs	\xreg, sctlr_el1
+10:	tbz	\xreg, #0, \label		/* SCTLR_ELx.M */
+.endm
+
 /*
  * Branch if we are not in the highest exception level
  */
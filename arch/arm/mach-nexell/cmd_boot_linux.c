@@ -64,6 +64,8 @@ static void boot_start_lmb(bootm_headers_t *images)
 	ulong		mem_start;
 	phys_size_t	mem_size;
 
+	/* Free region storage left over from an earlier bootl */
+	lmb_release(&images->lmb);
 	lmb_init(&images->lmb);
 
 	mem_start = getenv_bootm_low();
@@ -4,9 +4,13 @@
  */
 
 #include <dirent.h>
+#include <elf.h>
 #include <errno.h>
+#include <execinfo.h>
 #include <fcntl.h>
 #include <getopt.h>
+#include <link.h>
+#include <pthread.h>
 #include <setjmp.h>
 #include <signal.h>
 #include <stdio.h>
@@ -828,3 +832,290 @@ void os_relaunch(char *argv[])
 	execv(argv[0], argv);
 	os_exit(1);
 }
+
+/* Number of frames added by os_profile_handler() and the signal trampoline */
+#define OS_PROFILE_SKIP		2
+#define OS_PROFILE_MAX_FRAMES	(32 + OS_PROFILE_SKIP)
+
+static void (*os_profile_func)(void *const *frames, int count);
+
+static void os_profile_handler(int sig)
+{
+	void *frames[OS_PROFILE_MAX_FRAMES];
+	int err = errno;
+	int count;
+
+	count = backtrace(frames, OS_PROFILE_MAX_FRAMES);
+	if (count > OS_PROFILE_SKIP)
+		os_profile_func(frames + OS_PROFILE_SKIP,
+				count - OS_PROFILE_SKIP);
+	errno = err;
+}
+
+int os_profile_start(unsigned int period_us,
+		     void (*func)(void *const *frames, int count))
+{
+	struct itimerval timer;
+	struct sigaction act;
+	void *frame;
+
+	if (os_profile_func)
+		return -EBUSY;
+
+	/* The first call may load libgcc, which is not safe in the handler */
+	backtrace(&frame, 1);
+
+	os_profile_func = func;
+	memset(&act, '\0', sizeof(act));
+	act.sa_handler = os_profile_handler;
+	act.sa_flags = SA_RESTART;
+	sigemptyset(&act.sa_mask);
+	if (sigaction(SIGPROF, &act, NULL))
+		goto err;
+
+	timer.it_interval.tv_sec = period_us / 1000000;
+	timer.it_interval.tv_usec = period_us % 1000000;
+	timer.it_value = timer.it_interval;
+	if (setitimer(ITIMER_PROF, &timer, NULL))
+		goto err;
+
+	return 0;
+err:
+	signal(SIGPROF, SIG_DFL);
+	os_profile_func = NULL;
+
+	return -EIO;
+}
+
+void os_profile_stop(void)
+{
+	struct itimerval timer;
+
+	if (!os_profile_func)
+		return;
+	memset(&timer, '\0', sizeof(timer));
+	setitimer(ITIMER_PROF, &timer, NULL);
+	signal(SIGPROF, SIG_IGN);
+	os_profile_func = NULL;
+}
+
+struct os_symbol {
+	unsigned long addr;
+	unsigned long size;
+	const char *name;
+};
+
+static struct os_symbol *os_symbols;
+static int os_symbol_count;
+static bool os_symbols_read;
+
+static int os_symbol_cmp(const void *a, const void *b)
+{
+	const struct os_symbol *sym1 = a, *sym2 = b;
+
+	if (sym1->addr == sym2->addr)
+		return 0;
+
+	return sym1->addr > sym2->addr ? 1 : -1;
+}
+
+/*
+ * Read the function symbols from our own executable. The executable stays
+ * mapped so that the names can be used directly from its string table.
+ */
+static void os_read_symbols(void)
+{
+	const ElfW(Shdr) *shdr, *symtab = NULL;
+	const ElfW(Ehdr) *ehdr;
+	const ElfW(Sym) *sym;
+	unsigned long base = 0;
+	const char *strtab;
+	struct stat st;
+	void *buf;
+	int count;
+	int fd;
+	int i;
+
+	os_symbols_read = true;
+	fd = open("/proc/self/exe", O_RDONLY);
+	if (fd == -1)
+		return;
+	if (fstat(fd, &st)) {
+		close(fd);
+		return;
+	}
+	buf = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (buf == MAP_FAILED)
+		return;
+
+	ehdr = buf;
+	if (memcmp(ehdr->e_ident, ELFMAG, SELFMAG) ||
+	    ehdr->e_shoff + ehdr->e_shnum * sizeof(*shdr) > st.st_size)
+		goto err;
+	shdr = buf + ehdr->e_shoff;
+	for (i = 0; i < ehdr->e_shnum; i++) {
+		if (shdr[i].sh_type == SHT_SYMTAB) {
+			symtab = &shdr[i];
+			break;
+		}
+	}
+	if (!symtab || symtab->sh_link >= ehdr->e_shnum)
+		goto err;
+
+	sym = buf + symtab->sh_offset;
+	count = symtab->sh_size / sizeof(*sym);
+	strtab = buf + shdr[symtab->sh_link].sh_offset;
+	os_symbols = os_malloc(count * sizeof(*os_symbols));
+	if (!os_symbols)
+		goto err;
+	for (i = 0; i < count; i++, sym++) {
+		const char *name = strtab + sym->st_name;
+
+		if (ELF64_ST_TYPE(sym->st_info) != STT_FUNC || !sym->st_value ||
+		    !sym->st_size)
+			continue;
+		/* Work out where a position-independent executable was loaded */
+		if (!strcmp(name, "os_find_symbol"))
+			base = (unsigned long)os_find_symbol - sym->st_value;
+		os_symbols[os_symbol_count].addr = sym->st_value;
+		os_symbols[os_symbol_count].size = sym->st_size;
+		os_symbols[os_symbol_count++].name = name;
+	}
+	if (ehdr->e_type == ET_EXEC)
+		base = 0;
+	for (i = 0; i < os_symbol_count; i++)
+		os_symbols[i].addr += base;
+	qsort(os_symbols, os_symbol_count, sizeof(*os_symbols), os_symbol_cmp);
+
+	return;
+err:
+	munmap(buf, st.st_size);
+}
+
+const char *os_find_symbol(unsigned long addr, unsigned long *offsetp)
+{
+	const struct os_symbol *sym;
+	int low, high, mid;
+
+	if (!os_symbols_read)
+		os_read_symbols();
+
+	/* Find the last symbol at or below addr */
+	low = 0;
+	high = os_symbol_count;
+	while (low < high) {
+		mid = (low + high) / 2;
+		if (os_symbols[mid].addr <= addr)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	if (!low)
+		return NULL;
+	sym = &os_symbols[low - 1];
+	if (addr - sym->addr >= sym->size)
+		return NULL;
+	*offsetp = addr - sym->addr;
+
+	return sym->name;
+}
+
+/* Number of threads which can be starting at the same time */
+#define OS_THREAD_SLOTS		16
+
+/**
+ * struct os_thread - Thread being started
+ *
+ * These are not allocated, since malloc() is U-Boot's allocator, which must
+ * not be used from the new thread.
+ *
+ * @func: Function for the thread to run
+ * @arg: Argument for @func
+ * @busy: true while the slot is in use
+ */
+struct os_thread {
+	void (*func)(void *arg);
+	void *arg;
+	bool busy;
+};
+
+static struct os_thread os_threads[OS_THREAD_SLOTS];
+
+static void *os_thread_start(void *ptr)
+{
+	struct os_thread *slot = ptr;
+	struct os_thread thread = *slot;
+
+	__atomic_store_n(&slot->busy, false, __ATOMIC_RELEASE);
+	thread.func(thread.arg);
+
+	return NULL;
+}
+
+int os_thread_create(void (*func)(void *arg), void *arg)
+{
+	struct os_thread *thread;
+	pthread_attr_t attr;
+	sigset_t all, old;
+	pthread_t id;
+	bool idle;
+	int ret;
+
+	for (thread = os_threads; thread < os_threads + OS_THREAD_SLOTS;
+	     thread++) {
+		idle = false;
+		if (__atomic_compare_exchange_n(&thread->busy, &idle, true,
+						false, __ATOMIC_ACQUIRE,
+						__ATOMIC_RELAXED))
+			break;
+	}
+	if (thread == os_threads + OS_THREAD_SLOTS)
+		return -EAGAIN;
+	thread->func = func;
+	thread->arg = arg;
+
+	/* The new thread inherits the signal mask */
+	sigfillset(&all);
+	pthread_sigmask(SIG_SETMASK, &all, &old);
+	pthread_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+	ret = pthread_create(&id, &attr, os_thread_start, thread);
+	pthread_attr_destroy(&attr);
+	pthread_sigmask(SIG_SETMASK, &old, NULL);
+	if (ret) {
+		__atomic_store_n(&thread->busy, false, __ATOMIC_RELEASE);
+		return -ret;
+	}
+
+	return 0;
+}
+
+void os_thread_exit(void)
+{
+	pthread_exit(NULL);
+}
+
+static pthread_mutex_t os_event_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t os_event_cond = PTHREAD_COND_INITIALIZER;
+static unsigned long os_event_count;
+
+/* Value of os_event_count when this thread last returned from a wait */
+static __thread unsigned long os_event_seen;
+
+void os_event_wait(void)
+{
+	pthread_mutex_lock(&os_event_lock);
+	while (os_event_seen == os_event_count)
+		pthread_cond_wait(&os_event_cond, &os_event_lock);
+	os_event_seen = os_event_count;
+	pthread_mutex_unlock(&os_event_lock);
+}
+
+void os_event_signal(void)
+{
+	pthread_mutex_lock(&os_event_lock);
+	os_event_count++;
+	pthread_cond_broadcast(&os_event_cond);
+	pthread_mutex_unlock(&os_event_lock);
+}
@@ -0,0 +1,300 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Sampling profiler for sandbox
+ *
+ * The host's SIGPROF timer interrupts sandbox at regular intervals of CPU
+ * time. Each time, the call stack is recorded in a ring buffer. Addresses are
+ * only converted to function names when the samples are reported, using the
+ * symbol table of the sandbox executable.
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <os.h>
+#include <sort.h>
+#include <asm/profile.h>
+#include <linux/kernel.h>
+
+struct profile_sample {
+	ulong pc[PROFILE_MAX_DEPTH];	/* innermost first */
+	int depth;
+};
+
+/* Total number of samples for a function */
+struct profile_func {
+	ulong addr;
+	uint self;		/* samples where this function was running */
+	uint total;		/* samples where it was on the stack */
+};
+
+static struct {
+	struct profile_sample *samples;
+	uint count;		/* number of valid samples in the buffer */
+	uint head;		/* next sample to write */
+	ulong total;		/* number of samples taken */
+	bool running;
+} prof;
+
+/* Called from the SIGPROF handler, so must not allocate or print */
+static void profile_record(void *const *frames, int count)
+{
+	struct profile_sample *sample = &prof.samples[prof.head];
+	int i;
+
+	count = min(count, PROFILE_MAX_DEPTH);
+	for (i = 0; i < count; i++)
+		sample->pc[i] = (ulong)frames[i];
+	sample->depth = count;
+
+	if (++prof.head == CONFIG_SANDBOX_PROFILE_SAMPLES)
+		prof.head = 0;
+	if (prof.count < CONFIG_SANDBOX_PROFILE_SAMPLES)
+		prof.count++;
+	prof.total++;
+}
+
+int profile_start(uint rate)
+{
+	int ret;
+
+	if (!rate || rate > 1000000)
+		return -EINVAL;
+	if (prof.running)
+		return -EBUSY;
+	if (!prof.samples) {
+		prof.samples = malloc(CONFIG_SANDBOX_PROFILE_SAMPLES *
+				      sizeof(struct profile_sample));
+		if (!prof.samples)
+			return -ENOMEM;
+	}
+	prof.count = 0;
+	prof.head = 0;
+	prof.total = 0;
+
+	ret = os_profile_start(1000000 / rate, profile_record);
+	if (ret)
+		return ret;
+	prof.running = true;
+
+	return 0;
+}
+
+int profile_stop(void)
+{
+	if (!prof.running)
+		return -EALREADY;
+	os_profile_stop();
+	prof.running = false;
+
+	return 0;
+}
+
+ulong profile_get_total(void)
+{
+	return prof.total;
+}
+
+/* Get the start address of the function containing an address */
+static ulong profile_func_addr(ulong pc)
+{
+	ulong offset;
+
+	if (!os_find_symbol(pc, &offset))
+		return pc;
+
+	return pc - offset;
+}
+
+static const char *profile_func_name(ulong addr, char *buf, int size)
+{
+	const char *name;
+	ulong offset;
+
+	name = os_find_symbol(addr, &offset);
+	if (name)
+		return name;
+	snprintf(buf, size, "0x%lx", addr);
+
+	return buf;
+}
+
+static int h_cmp_sample(const void *v1, const void *v2)
+{
+	const struct profile_sample *s1 = v1, *s2 = v2;
+	int i;
+
+	if (s1->depth != s2->depth)
+		return s1->depth - s2->depth;
+	for (i = 0; i < s1->depth; i++) {
+		if (s1->pc[i] != s2->pc[i])
+			return s1->pc[i] > s2->pc[i] ? 1 : -1;
+	}
+
+	return 0;
+}
+
+/**
+ * profile_get_stacks() - Get a sorted copy of the samples
+ *
+ * Each address is replaced with the start of its function, so that identical
+ * call stacks sort together.
+ *
+ * @return pointer to prof.count samples (to be freed by the caller), or NULL
+ *	if out of memory
+ */
+static struct profile_sample *profile_get_stacks(void)
+{
+	struct profile_sample *stacks;
+	int i, j;
+
+	if (prof.running)
+		profile_stop();
+	stacks = malloc(max(prof.count, 1U) * sizeof(*stacks));
+	if (!stacks)
+		return NULL;
+	memcpy(stacks, prof.samples, prof.count * sizeof(*stacks));
+	for (i = 0; i < prof.count; i++) {
+		for (j = 0; j < stacks[i].depth; j++)
+			stacks[i].pc[j] = profile_func_addr(stacks[i].pc[j]);
+	}
+	qsort(stacks, prof.count, sizeof(*stacks), h_cmp_sample);
+
+	return stacks;
+}
+
+static int h_cmp_func_addr(const void *v1, const void *v2)
+{
+	const struct profile_func *f1 = v1, *f2 = v2;
+
+	if (f1->addr == f2->addr)
+		return 0;
+
+	return f1->addr > f2->addr ? 1 : -1;
+}
+
+static int h_cmp_func_self(const void *v1, const void *v2)
+{
+	const struct profile_func *f1 = v1, *f2 = v2;
+
+	if (f1->self != f2->self)
+		return f1->self < f2->self ? 1 : -1;
+
+	return f1->total < f2->total ? 1 : f1->total > f2->total ? -1 : 0;
+}
+
+int profile_report(int max_funcs)
+{
+	struct profile_sample *stacks, *sample;
+	struct profile_func *funcs;
+	int count, i, j, k;
+	char buf[20];
+
+	if (!prof.count) {
+		printf("No samples\n");
+		return 0;
+	}
+	stacks = profile_get_stacks();
+	if (!stacks)
+		return -ENOMEM;
+	funcs = malloc(prof.count * PROFILE_MAX_DEPTH * sizeof(*funcs));
+	if (!funcs) {
+		free(stacks);
+		return -ENOMEM;
+	}
+
+	/* Add one entry for each function on each stack, ignoring recursion */
+	for (i = 0, count = 0, sample = stacks; i < prof.count; i++, sample++) {
+		for (j = 0; j < sample->depth; j++) {
+			for (k = 0; k < j; k++) {
+				if (sample->pc[k] == sample->pc[j])
+					break;
+			}
+			if (k < j)
+				continue;
+			funcs[count].addr = sample->pc[j];
+			funcs[count].self = !j;
+			funcs[count++].total = 1;
+		}
+	}
+	free(stacks);
+
+	/* Merge the entries for each function */
+	qsort(funcs, count, sizeof(*funcs), h_cmp_func_addr);
+	for (i = 0, j = 0; i < count; i++) {
+		if (j && funcs[j - 1].addr == funcs[i].addr) {
+			funcs[j - 1].self += funcs[i].self;
+			funcs[j - 1].total += funcs[i].total;
+		} else {
+			funcs[j++] = funcs[i];
+		}
+	}
+	count = j;
+	qsort(funcs, count, sizeof(*funcs), h_cmp_func_self);
+
+	printf("%lu samples", prof.total);
+	if (prof.total > prof.count)
+		printf(", last %u shown", prof.count);
+	printf("\n%8s %8s %8s  %s\n", "Self", "Total", "Samples", "Function");
+	for (i = 0; i < min(count, max_funcs); i++) {
+		struct profile_func *func = &funcs[i];
+
+		printf("%7u%% %7u%% %8u  %s\n", func->self * 100 / prof.count,
+		       func->total * 100 / prof.count, func->self,
+		       profile_func_name(func->addr, buf, sizeof(buf)));
+	}
+	free(funcs);
+
+	return 0;
+}
+
+/**
+ * Append a string to a buffer
+ *
+ * Write the string if there is space. Whether there is space or not, the
+ * buffer pointer is incremented.
+ *
+ * @ptrp: Pointer to buffer, updated by this function
+ * @end: Pointer to end of buffer
+ * @str: String to write
+ */
+static void profile_append(char **ptrp, char *end, const char *str)
+{
+	int len = strlen(str);
+	char *ptr = *ptrp;
+
+	*ptrp += len;
+	if (*ptrp <= end)
+		memcpy(ptr, str, len);
+}
+
+int profile_folded(char *buf, int size)
+{
+	struct profile_sample *stacks, *sample;
+	char *ptr = buf, *end = buf + size;
+	char name[20];
+	int i, j, run;
+
+	stacks = profile_get_stacks();
+	if (!stacks)
+		return -ENOMEM;
+	for (i = 0; i < prof.count; i += run) {
+		sample = &stacks[i];
+		for (run = 1; i + run < prof.count; run++) {
+			if (h_cmp_sample(sample, &stacks[i + run]))
+				break;
+		}
+		for (j = sample->depth - 1; j >= 0; j--) {
+			profile_append(&ptr, end,
+				       profile_func_name(sample->pc[j], name,
+							 sizeof(name)));
+			profile_append(&ptr, end, j ? ";" : " ");
+		}
+		snprintf(name, sizeof(name), "%d\n", run);
+		profile_append(&ptr, end, name);
+	}
+	free(stacks);
+	if (++ptr <= end)
+		ptr[-1] = '\0';
+
+	return ptr - buf;
+}
@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Worker cores for sandbox, using host threads
+ */
+
+#include <common.h>
+#include <log.h>
+#include <os.h>
+#include <worker.h>
+
+/* Worker number of this thread, 0 for the main thread */
+static __thread uint worker_id;
+
+static void (*worker_entry)(uint id);
+
+static void sandbox_worker_thread(void *arg)
+{
+	worker_id = (ulong)arg;
+	worker_entry(worker_id);
+}
+
+int arch_worker_start(uint max, void (*entry)(uint id))
+{
+	uint i;
+	int ret;
+
+	worker_entry = entry;
+	for (i = 0; i < max; i++) {
+		ret = os_thread_create(sandbox_worker_thread,
+				       (void *)(ulong)(i + 1));
+		if (ret) {
+			log_warning("Cannot start thread (err=%d)\n", ret);
+			break;
+		}
+	}
+
+	return i;
+}
+
+uint arch_worker_self(void)
+{
+	return worker_id;
+}
+
+void arch_worker_idle(void)
+{
+	os_event_wait();
+}
+
+void arch_worker_kick(void)
+{
+	os_event_signal();
+}
+
+void arch_worker_exit(void)
+{
+	os_thread_exit();
+}
@@ -0,0 +1,71 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Sampling profiler for sandbox
+ */
+
+#ifndef __ASM_PROFILE_H
+#define __ASM_PROFILE_H
+
+/* Maximum number of stack frames recorded for each sample */
+#define PROFILE_MAX_DEPTH	16
+
+/**
+ * profile_start() - Start sampling
+ *
+ * This discards any existing samples and starts taking samples at the given
+ * rate. The rate is in terms of CPU time used by sandbox, so no samples are
+ * taken while it is waiting for input.
+ *
+ * @rate: Number of samples to take per second of CPU time
+ * @return 0 if OK, -EINVAL if the rate is not valid, -EBUSY if already
+ *	started, -ENOMEM if the sample buffer could not be allocated, -EIO if
+ *	the host timer could not be set up
+ */
+int profile_start(uint rate);
+
+/**
+ * profile_stop() - Stop sampling
+ *
+ * The samples taken so far are kept until the next profile_start().
+ *
+ * @return 0 if OK, -EALREADY if sampling was not started
+ */
+int profile_stop(void);
+
+/**
+ * profile_get_total() - Get the number of samples taken
+ *
+ * @return total number of samples taken since profile_start(), including any
+ *	which have since been overwritten in the sample buffer
+ */
+ulong profile_get_total(void);
+
+/**
+ * profile_report() - Show a flat profile
+ *
+ * This shows the functions with the most samples, along with the proportion of
+ * samples in which they were executing (self) or on the call stack (total).
+ * Sampling is stopped first if needed.
+ *
+ * @max_funcs: Maximum number of functions to show
+ * @return 0 if OK, -ENOMEM if out of memory
+ */
+int profile_report(int max_funcs);
+
+/**
+ * profile_folded() - Write the samples as folded stacks
+ *
+ * This produces one line for each distinct call stack, with the functions
+ * separated by semicolons, outermost first, followed by the number of
+ * samples. This is the format used by flamegraph.pl. The output is
+ * nul-terminated. Sampling is stopped first if needed.
+ *
+ * @buf: Buffer to write to (may be NULL if @size is 0)
+ * @size: Size of buffer in bytes
+ * @return number of bytes needed for the output including the terminator, or
+ *	-ENOMEM if out of memory. If this is larger than @size, the output was
+ *	truncated.
+ */
+int profile_folded(char *buf, int size);
+
+#endif
@@ -244,4 +244,11 @@ uint sandbox_pci_read_bar(u32 barval, int type, uint size);
  */
 void sandbox_set_enable_memio(bool enable);
 
+/**
+ * sandbox_serial_written() - Get the number of bytes written to the console
+ *
+ * @return number of bytes written by the sandbox serial driver so far
+ */
+size_t sandbox_serial_written(void);
+
 #endif
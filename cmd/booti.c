@@ -6,7 +6,9 @@
 
 #include <common.h>
 #include <bootm.h>
+#include <bootstage.h>
 #include <command.h>
+#include <dma.h>
 #include <image.h>
 #include <irq_func.h>
 #include <lmb.h>
@@ -16,6 +18,18 @@
 #include <linux/sizes.h>
 
 DECLARE_GLOBAL_DATA_PTR;
+
+/* Move the Image, accounting for the time and bytes it takes */
+static void booti_move(bootm_headers_t *images, ulong to, ulong from,
+		       ulong size)
+{
+	bootstage_start(BOOTSTAGE_ID_ACCUM_BOOTM_COPY, "bootm_copy");
+	if (dma_memcpy_try((void *)to, (void *)from, size))
+		memmove((void *)to, (void *)from, size);
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_BOOTM_COPY);
+	images->copied += size;
+}
+
 /*
  * Image booting support
  */
@@ -68,8 +82,22 @@ static int booti_start(struct cmd_tbl *cmdtp, int flag, int argc,
 				 decomp_len, &dest_end);
 		if (ret)
 			return ret;
-		/* dest_end contains the uncompressed Image size */
-		memmove((void *) ld, (void *)dest, dest_end);
+
+		/*
+		 * Boot the Image from the decompression buffer if it can run
+		 * there and nothing else is using that memory, rather than
+		 * copying it back to the load address
+		 */
+		ret = booti_setup(dest, &relocated_addr, &image_size, false);
+		if (ret != 0)
+			return 1;
+		if (relocated_addr == dest &&
+		    lmb_reserve(&images->lmb, dest, image_size) >= 0) {
+			ld = dest;
+		} else {
+			/* dest_end contains the uncompressed Image size */
+			booti_move(images, ld, dest, dest_end);
+		}
 	}
 	unmap_sysmem((void *)ld);
 
@@ -81,7 +109,7 @@ static int booti_start(struct cmd_tbl *cmdtp, int flag, int argc,
 	if (relocated_addr != ld) {
 		printf("Moving Image from 0x%lx to 0x%lx, end=%lx\n", ld,
 		       relocated_addr, relocated_addr + image_size);
-		memmove((void *)relocated_addr, (void *)ld, image_size);
+		booti_move(images, relocated_addr, ld, image_size);
 	}
 
 	images->ep = relocated_addr;
@@ -6,6 +6,10 @@
 #include <common.h>
 #include <bootstage.h>
 #include <command.h>
+#include <env.h>
+#include <fs.h>
+#include <malloc.h>
+#include <mapmem.h>
 
 static int do_bootstage_report(struct cmd_tbl *cmdtp, int flag, int argc,
 			       char *const argv[])
@@ -59,10 +63,62 @@ static int do_bootstage_stash(struct cmd_tbl *cmdtp, int flag, int argc,
 	return 0;
 }
 
+static int do_bootstage_export(struct cmd_tbl *cmdtp, int flag, int argc,
+			       char *const argv[])
+{
+	loff_t actwrite;
+	ulong base, size;
+	char *buf;
+	int len, ret;
+
+	if (argc == 2 || argc == 3) {
+		if (get_base_size(argc, argv, &base, &size))
+			return CMD_RET_USAGE;
+		buf = map_sysmem(base, size);
+		len = bootstage_export_json(buf, size);
+		unmap_sysmem(buf);
+		if ((ulong)len > size) {
+			printf("Need %#x bytes for export\n", len);
+			return CMD_RET_FAILURE;
+		}
+		env_set_hex("filesize", len - 1);
+
+		return 0;
+	}
+	if (argc != 1 && argc != 4)
+		return CMD_RET_USAGE;
+
+	len = bootstage_export_json(NULL, 0);
+	buf = malloc(len);
+	if (!buf) {
+		printf("Out of memory\n");
+		return CMD_RET_FAILURE;
+	}
+	bootstage_export_json(buf, len);
+	if (argc == 1) {
+		puts(buf);
+		free(buf);
+		return 0;
+	}
+
+	ret = fs_set_blk_dev(argv[1], argv[2], FS_TYPE_ANY);
+	if (!ret)
+		ret = fs_write(argv[3], map_to_sysmem(buf), 0, len - 1,
+			       &actwrite);
+	free(buf);
+	if (ret) {
+		printf("Cannot write to '%s'\n", argv[3]);
+		return CMD_RET_FAILURE;
+	}
+
+	return 0;
+}
+
 static struct cmd_tbl cmd_bootstage_sub[] = {
 	U_BOOT_CMD_MKENT(report, 2, 1, do_bootstage_report, "", ""),
 	U_BOOT_CMD_MKENT(stash, 4, 0, do_bootstage_stash, "", ""),
 	U_BOOT_CMD_MKENT(unstash, 4, 0, do_bootstage_stash, "", ""),
+	U_BOOT_CMD_MKENT(export, 5, 0, do_bootstage_export, "", ""),
 };
 
 /*
@@ -87,10 +143,14 @@ static int do_boostage(struct cmd_tbl *cmdtp, int flag, int argc,
 }
 
 
-U_BOOT_CMD(bootstage, 4, 1, do_boostage,
+U_BOOT_CMD(bootstage, 5, 1, do_boostage,
 	"Boot stage command",
 	" - check boot progress and timing\n"
 	"report                      - Print a report\n"
 	"stash [<start> [<size>]]    - Stash data into memory\n"
-	"unstash [<start> [<size>]]  - Unstash data from memory"
+	"unstash [<start> [<size>]]  - Unstash data from memory\n"
+	"export                      - Print a Chrome trace (JSON)\n"
+	"export <start> [<size>]     - Write a Chrome trace to memory\n"
+	"export <interface> <dev[:part]> <filename>\n"
+	"                            - Write a Chrome trace to a file"
 );
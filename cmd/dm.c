@@ -40,6 +40,14 @@ static int do_dm_dump_devres(struct cmd_tbl *cmdtp, int flag, int argc,
 	return 0;
 }
 
+static int do_dm_dump_stats(struct cmd_tbl *cmdtp, int flag, int argc,
+			    char *const argv[])
+{
+	dm_dump_stats();
+
+	return 0;
+}
+
 static int do_dm_dump_drivers(struct cmd_tbl *cmdtp, int flag, int argc,
 			      char *const argv[])
 {
@@ -68,6 +76,7 @@ static struct cmd_tbl test_commands[] = {
 	U_BOOT_CMD_MKENT(tree, 0, 1, do_dm_dump_all, "", ""),
 	U_BOOT_CMD_MKENT(uclass, 1, 1, do_dm_dump_uclass, "", ""),
 	U_BOOT_CMD_MKENT(devres, 1, 1, do_dm_dump_devres, "", ""),
+	U_BOOT_CMD_MKENT(stats, 1, 1, do_dm_dump_stats, "", ""),
 	U_BOOT_CMD_MKENT(drivers, 1, 1, do_dm_dump_drivers, "", ""),
 	U_BOOT_CMD_MKENT(compat, 1, 1, do_dm_dump_driver_compat, "", ""),
 	U_BOOT_CMD_MKENT(static, 1, 1, do_dm_dump_static_driver_info, "", ""),
@@ -112,6 +121,7 @@ U_BOOT_CMD(
 	"tree          Dump driver model tree ('*' = activated)\n"
 	"dm uclass        Dump list of instances for each uclass\n"
 	"dm devres        Dump list of device resources for each device\n"
+	"dm stats         Dump uclass device lookup statistics\n"
 	"dm drivers       Dump list of drivers with uclass and instances\n"
 	"dm compat        Dump list of drivers with compatibility strings\n"
 	"dm static        Dump list of drivers with static platform data"
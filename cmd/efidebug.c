@@ -458,12 +458,15 @@ static void print_memory_attributes(u64 attributes)
  * Return:	CMD_RET_SUCCESS on success, CMD_RET_RET_FAILURE on failure
  *
  * Implement efidebug "memmap" sub-command.
- * Show UEFI memory map.
+ * Show UEFI memory map, followed by the total size of each memory type and
+ * statistics on memory map updates.
  */
 static int do_efi_show_memmap(struct cmd_tbl *cmdtp, int flag,
 			      int argc, char *const argv[])
 {
 	struct efi_mem_desc *memmap = NULL, *map;
+	u64 pages[ARRAY_SIZE(efi_mem_type_string)] = { 0 };
+	struct efi_mem_stats stats;
 	efi_uintn_t map_size = 0;
 	const char *type;
 	int i;
@@ -493,10 +496,12 @@ static int do_efi_show_memmap(struct cmd_tbl *cmdtp, int flag,
 	 * populated by allocate_pool() above.
 	 */
 	for (i = 0, map = memmap; i < map_size / sizeof(*map); map++, i++) {
-		if (map->type < ARRAY_SIZE(efi_mem_type_string))
+		if (map->type < ARRAY_SIZE(efi_mem_type_string)) {
 			type = efi_mem_type_string[map->type];
-		else
+			pages[map->type] += map->num_pages;
+		} else {
 			type = "(unknown)";
+		}
 
 		printf("%-16s %.*llx-%.*llx", type,
 		       EFI_PHYS_ADDR_WIDTH,
@@ -513,6 +518,16 @@ static int do_efi_show_memmap(struct cmd_tbl *cmdtp, int flag,
 
 	efi_free_pool(memmap);
 
+	putc('\n');
+	for (i = 0; i < ARRAY_SIZE(pages); i++) {
+		if (pages[i])
+			printf("%-16s %8llu KiB\n", efi_mem_type_string[i],
+			       pages[i] << (EFI_PAGE_SHIFT - 10));
+	}
+	efi_get_memory_stats(&stats);
+	printf("\n%d entries (space for %d), %lu updates taking %lu us\n",
+	       stats.entries, stats.capacity, stats.updates, stats.update_us);
+
 	return CMD_RET_SUCCESS;
 }
 
@@ -0,0 +1,26 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Command-line access to heap usage
+ */
+
+#include <common.h>
+#include <command.h>
+#include <malloc_stats.h>
+
+static int do_malloc_stats(struct cmd_tbl *cmdtp, int flag, int argc,
+			   char *const argv[])
+{
+	int max_sites = 10;
+
+	if (argc > 1)
+		max_sites = simple_strtoul(argv[1], NULL, 10);
+	malloc_stats_show(max_sites);
+
+	return 0;
+}
+
+static char malloc_help_text[] =
+	"stats [n]  - show heap usage and the n callers using most (default 10)";
+
+U_BOOT_CMD_WITH_SUBCMDS(malloc, "Heap usage", malloc_help_text,
+	U_BOOT_SUBCMD_MKENT(stats, 2, 1, do_malloc_stats));
@@ -16,6 +16,7 @@
 #include <cli.h>
 #include <command.h>
 #include <console.h>
+#include <dma.h>
 #include <flash.h>
 #include <hash.h>
 #include <log.h>
@@ -357,7 +358,8 @@ static int do_mem_cp(struct cmd_tbl *cmdtp, int flag, int argc,
 	}
 #endif
 
-	memcpy(dst, src, count * size);
+	if (dma_memcpy_try(dst, src, count * size))
+		memcpy(dst, src, count * size);
 
 	unmap_sysmem(src);
 	unmap_sysmem(dst);
@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Command for the sandbox sampling profiler
+ */
+
+#include <common.h>
+#include <command.h>
+#include <malloc.h>
+#include <os.h>
+#include <asm/profile.h>
+
+static int do_profile_start(struct cmd_tbl *cmdtp, int flag, int argc,
+			    char *const argv[])
+{
+	uint rate = 1000;
+	int ret;
+
+	if (argc > 1)
+		rate = simple_strtoul(argv[1], NULL, 10);
+	ret = profile_start(rate);
+	if (ret) {
+		printf("Cannot start profiling (err=%d)\n", ret);
+		return CMD_RET_FAILURE;
+	}
+
+	return 0;
+}
+
+static int do_profile_stop(struct cmd_tbl *cmdtp, int flag, int argc,
+			   char *const argv[])
+{
+	if (profile_stop()) {
+		printf("Profiling is not running\n");
+		return CMD_RET_FAILURE;
+	}
+	printf("%lu samples\n", profile_get_total());
+
+	return 0;
+}
+
+static int do_profile_report(struct cmd_tbl *cmdtp, int flag, int argc,
+			     char *const argv[])
+{
+	int max_funcs = 20;
+
+	if (argc > 1)
+		max_funcs = simple_strtoul(argv[1], NULL, 10);
+	if (profile_report(max_funcs))
+		return CMD_RET_FAILURE;
+
+	return 0;
+}
+
+static int do_profile_folded(struct cmd_tbl *cmdtp, int flag, int argc,
+			     char *const argv[])
+{
+	char *buf;
+	int size;
+	int ret;
+
+	size = profile_folded(NULL, 0);
+	if (size < 0)
+		return CMD_RET_FAILURE;
+	buf = malloc(size);
+	if (!buf) {
+		printf("Out of memory\n");
+		return CMD_RET_FAILURE;
+	}
+	profile_folded(buf, size);
+	ret = 0;
+	if (argc > 1) {
+		if (os_write_file(argv[1], buf, size - 1)) {
+			printf("Cannot write to '%s'\n", argv[1]);
+			ret = CMD_RET_FAILURE;
+		}
+	} else {
+		puts(buf);
+	}
+	free(buf);
+
+	return ret;
+}
+
+static struct cmd_tbl cmd_profile_sub[] = {
+	U_BOOT_CMD_MKENT(start, 2, 0, do_profile_start, "", ""),
+	U_BOOT_CMD_MKENT(stop, 1, 0, do_profile_stop, "", ""),
+	U_BOOT_CMD_MKENT(report, 2, 0, do_profile_report, "", ""),
+	U_BOOT_CMD_MKENT(folded, 2, 0, do_profile_folded, "", ""),
+};
+
+static int do_profile(struct cmd_tbl *cmdtp, int flag, int argc,
+		      char *const argv[])
+{
+	struct cmd_tbl *c;
+
+	/* Strip off leading 'profile' command argument */
+	argc--;
+	argv++;
+
+	c = find_cmd_tbl(argv[0], cmd_profile_sub,
+			 ARRAY_SIZE(cmd_profile_sub));
+	if (c)
+		return c->cmd(cmdtp, flag, argc, argv);
+	else
+		return CMD_RET_USAGE;
+}
+
+U_BOOT_CMD(profile, 3, 0, do_profile,
+	"Sampling profiler",
+	"start [<rate>]   - Start sampling <rate> times per second of CPU time\n"
+	"profile stop             - Stop sampling\n"
+	"profile report [<count>] - Show the <count> busiest functions\n"
+	"profile folded [<file>]  - Show folded stacks, or write them to a host\n"
+	"                           file, for use with flamegraph.pl"
+);
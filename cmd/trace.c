@@ -76,6 +76,37 @@ static int create_call_list(int argc, char *const argv[])
 	return 0;
 }
 
+static int trace_top(int argc, char *const argv[])
+{
+	static const char *const sort_names[] = {
+		[TRACE_SORT_SELF]	= "self",
+		[TRACE_SORT_TOTAL]	= "total",
+		[TRACE_SORT_CALLS]	= "calls",
+		[TRACE_SORT_MAX]	= "max",
+	};
+	enum trace_sort sort = TRACE_SORT_SELF;
+	int count = 20;
+	int ret;
+
+	if (argc > 2)
+		count = simple_strtoul(argv[2], NULL, 10);
+	if (argc > 3) {
+		for (sort = 0; sort < ARRAY_SIZE(sort_names); sort++) {
+			if (!strcmp(argv[3], sort_names[sort]))
+				break;
+		}
+		if (sort == ARRAY_SIZE(sort_names)) {
+			printf("Unknown sort order '%s'\n", argv[3]);
+			return -EINVAL;
+		}
+	}
+	ret = trace_print_top(count, sort);
+	if (ret == -ENOSYS)
+		printf("Function statistics are not enabled\n");
+
+	return ret;
+}
+
 int do_trace(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
 {
 	const char *cmd = argc < 2 ? NULL : argv[1];
@@ -100,6 +131,10 @@ int do_trace(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
 	case 's':
 		trace_print_stats();
 		break;
+	case 't':
+		if (trace_top(argc, argv))
+			return CMD_RET_FAILURE;
+		break;
 	default:
 		return CMD_RET_USAGE;
 	}
@@ -115,5 +150,9 @@ U_BOOT_CMD(
 	"trace resume                       - resume tracing\n"
 	"trace funclist [<addr> <size>]     - dump function list into buffer\n"
 	"trace calls  [<addr> <size>]       "
-		"- dump function call trace into buffer"
+		"- dump function call trace into buffer\n"
+	"trace top [<count> [<sort>]]       "
+		"- show the functions taking most time,\n"
+	"                                     "
+		"sorted by self, total, calls or max"
 );
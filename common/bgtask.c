@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Cooperative background tasks
+ */
+
+#include <common.h>
+#include <bgtask.h>
+#include <log.h>
+#include <time.h>
+#include <asm/global_data.h>
+#include <linux/errno.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+static LIST_HEAD(bgtask_list);
+
+/* Task whose step is running, or NULL if none */
+static struct bgtask *bgtask_cur;
+
+/* Set when a task is removed from within a step, so the list may be changed */
+static bool bgtask_changed;
+
+int bgtask_start(struct bgtask *task, const char *name, bgtask_func func,
+		 void *ctx)
+{
+	if (!(gd->flags & GD_FLG_RELOC))
+		return log_msg_ret("rel", -EPERM);
+	task->name = name;
+	task->func = func;
+	task->ctx = ctx;
+	task->ret = -EAGAIN;
+	list_add_tail(&task->sibling, &bgtask_list);
+	log_debug("start %s\n", name);
+
+	return 0;
+}
+
+/* Run one step of a task, removing it from the list if it is finished */
+static void bgtask_step(struct bgtask *task)
+{
+	struct bgtask *prev = bgtask_cur;
+	int ret;
+
+	bgtask_cur = task;
+	ret = task->func(task->ctx);
+	bgtask_cur = prev;
+	if (ret != -EAGAIN) {
+		log_debug("%s finished, ret=%d\n", task->name, ret);
+		list_del_init(&task->sibling);
+		task->ret = ret;
+		if (prev)
+			bgtask_changed = true;
+	}
+}
+
+void bgtask_poll(void)
+{
+	struct bgtask *task, *next;
+
+	if (bgtask_cur || !(gd->flags & GD_FLG_RELOC))
+		return;
+	bgtask_changed = false;
+	list_for_each_entry_safe(task, next, &bgtask_list, sibling) {
+		bgtask_step(task);
+
+		/* @next may have gone; the rest can wait for the next poll */
+		if (bgtask_changed)
+			break;
+	}
+}
+
+int bgtask_wait(struct bgtask *task, ulong timeout_ms)
+{
+	ulong start = get_timer(0);
+
+	while (task->ret == -EAGAIN) {
+		if (get_timer(start) >= timeout_ms)
+			return log_msg_ret("wait", -ETIMEDOUT);
+		if (!bgtask_cur)
+			bgtask_poll();
+		else if (task != bgtask_cur)
+			bgtask_step(task);
+		else
+			return log_msg_ret("self", -EDEADLK);
+	}
+
+	return task->ret;
+}
+
+void bgtask_cancel(struct bgtask *task)
+{
+	if (task->ret != -EAGAIN)
+		return;
+	log_debug("cancel %s\n", task->name);
+	list_del_init(&task->sibling);
+	task->ret = -ECANCELED;
+	if (bgtask_cur)
+		bgtask_changed = true;
+}
+
+bool bgtask_pending(void)
+{
+	if (!(gd->flags & GD_FLG_RELOC))
+		return false;
+
+	return !list_empty(&bgtask_list);
+}
+
+void bgtask_show(void)
+{
+	struct bgtask *task;
+
+	list_for_each_entry(task, &bgtask_list, sibling)
+		printf("%s\n", task->name);
+}
@@ -33,6 +33,7 @@ static const char *const tag_name[] = {
 	[BLOBLISTT_SPL_HANDOFF]		= "SPL hand-off",
 	[BLOBLISTT_VBOOT_CTX]		= "Chrome OS vboot context",
 	[BLOBLISTT_VBOOT_HANDOFF]	= "Chrome OS vboot hand-off",
+	[BLOBLISTT_MALLOC_STATS]	= "malloc() statistics",
 };
 
 const char *bloblist_tag_name(enum bloblist_tag_t tag)
@@ -208,6 +209,33 @@ int bloblist_ensure_size_ret(uint tag, int *sizep, void **blobp)
 	return 0;
 }
 
+int bloblist_load(uint tag, void *buf, int size, u32 magic)
+{
+	void *blob;
+
+	blob = bloblist_find(tag, size);
+	if (!blob || *(u32 *)blob != magic)
+		return -ENOENT;
+	memcpy(buf, blob, size);
+
+	return 0;
+}
+
+int bloblist_save(uint tag, const void *buf, int size)
+{
+	void *blob;
+	int ret;
+
+	if (!gd->bloblist)
+		return -ENOENT;
+	ret = bloblist_ensure_size(tag, size, 0, &blob);
+	if (ret)
+		return ret;
+	memcpy(blob, buf, size);
+
+	return 0;
+}
+
 static u32 bloblist_calc_chksum(struct bloblist_hdr *hdr)
 {
 	struct bloblist_rec *rec;
@@ -702,7 +702,12 @@ static int setup_reloc(void)
 #ifdef CONFIG_OF_BOARD_FIXUP
 static int fix_fdt(void)
 {
-	return board_fix_fdt((void *)gd->fdt_blob);
+	int ret;
+
+	ret = board_fix_fdt((void *)gd->fdt_blob);
+	fdtdec_phandle_index_invalidate(gd->fdt_blob);
+
+	return ret;
 }
 #endif
 
@@ -635,6 +635,13 @@ static int initr_net(void)
 }
 #endif
 
+#if CONFIG_IS_ENABLED(DM_ASYNC_PROBE)
+static int initr_dm_async_probe(void)
+{
+	return dm_probe_async(CONFIG_DM_ASYNC_PROBE_UCLASSES);
+}
+#endif
+
 #ifdef CONFIG_POST
 static int initr_post(void)
 {
@@ -894,6 +901,9 @@ static init_fnc_t init_sequence_r[] = {
 #endif
 #ifdef CONFIG_EFI_SETUP_EARLY
 	(init_fnc_t)efi_init_obj_list,
+#endif
+#if CONFIG_IS_ENABLED(DM_ASYNC_PROBE)
+	initr_dm_async_probe,
 #endif
 	run_main_loop,
 };
@@ -62,6 +62,7 @@ static void boot_start_lmb(bootm_headers_t *images)
 
 	lmb_init_and_reserve_range(&images->lmb, (phys_addr_t)mem_start,
 				   mem_size, NULL);
+	images->lmb.owner = LMB_OWNER_BOOTM;
 }
 #else
 #define lmb_reserve(lmb, base, size)
@@ -71,6 +72,9 @@ static inline void boot_start_lmb(bootm_headers_t *images) { }
 static int bootm_start(struct cmd_tbl *cmdtp, int flag, int argc,
 		       char *const argv[])
 {
+	/* Free region storage left over from an earlier bootm */
+	if (IS_ENABLED(CONFIG_LMB))
+		lmb_release(&images.lmb);
 	memset((void *)&images, 0, sizeof(images));
 	images.verify = env_get_yesno("verify");
 
@@ -378,15 +382,23 @@ static int bootm_load_os(bootm_headers_t *images, int boot_progress)
 	ulong image_start = os.image_start;
 	ulong image_len = os.image_len;
 	ulong flush_start = ALIGN_DOWN(load, ARCH_DMA_MINALIGN);
-	bool no_overlap;
+	bool no_overlap, copy;
 	void *load_buf, *image_buf;
 	int err;
 
 	load_buf = map_sysmem(load, 0);
 	image_buf = map_sysmem(os.image_start, image_len);
+	copy = os.comp == IH_COMP_NONE && load != image_start;
+	if (copy)
+		bootstage_start(BOOTSTAGE_ID_ACCUM_BOOTM_COPY, "bootm_copy");
 	err = image_decomp(os.comp, load, os.image_start, os.type,
 			   load_buf, image_buf, image_len,
 			   CONFIG_SYS_BOOTM_LEN, &load_end);
+	if (copy) {
+		bootstage_accum(BOOTSTAGE_ID_ACCUM_BOOTM_COPY);
+		if (!err)
+			images->copied += image_len;
+	}
 	if (err) {
 		err = handle_decomp_error(os.comp, load_end - load, err);
 		bootstage_error(BOOTSTAGE_ID_DECOMP_IMAGE);
@@ -576,6 +588,11 @@ int do_bootm_states(struct cmd_tbl *cmdtp, int flag, int argc,
 	if (!ret && (states & BOOTM_STATE_FINDOTHER))
 		ret = bootm_find_other(cmdtp, flag, argc, argv);
 
+#if IMAGE_ENABLE_FIT
+	/* Any hashes which have not been used by now are stale */
+	fit_prehash_done();
+#endif
+
 	/* Load the OS */
 	if (!ret && (states & BOOTM_STATE_LOADOS)) {
 		iflag = bootm_disable_interrupts();
@@ -602,8 +619,7 @@ int do_bootm_states(struct cmd_tbl *cmdtp, int flag, int argc,
 #if IMAGE_ENABLE_OF_LIBFDT && defined(CONFIG_LMB)
 	if (!ret && (states & BOOTM_STATE_FDT)) {
 		boot_fdt_add_mem_rsv_regions(&images->lmb, images->ft_addr);
-		ret = boot_relocate_fdt(&images->lmb, &images->ft_addr,
-					&images->ft_len);
+		ret = boot_place_fdt(images, &images->ft_len);
 	}
 #endif
 
@@ -656,9 +672,13 @@ int do_bootm_states(struct cmd_tbl *cmdtp, int flag, int argc,
 	}
 
 	/* Now run the OS! We hope this doesn't return */
-	if (!ret && (states & BOOTM_STATE_OS_GO))
+	if (!ret && (states & BOOTM_STATE_OS_GO)) {
+		if (images->copied)
+			printf("   Moved %lu bytes while placing images\n",
+			       images->copied);
 		ret = boot_selected_os(argc, argv, BOOTM_STATE_OS_GO,
 				images, boot_fn);
+	}
 
 	/* Deal with any fallout */
 err:
@@ -25,6 +25,10 @@ enum {
 	RECORD_COUNT = CONFIG_VAL(BOOTSTAGE_RECORD_COUNT),
 };
 
+/*
+ * For a span (BOOTSTAGEF_SPAN), time_us holds the start time and start_us
+ * holds the duration
+ */
 struct bootstage_record {
 	ulong time_us;
 	uint32_t start_us;
@@ -217,6 +221,46 @@ uint32_t bootstage_accum(enum bootstage_id id)
 	return duration;
 }
 
+#ifdef ENABLE_BOOTSTAGE_SPANS
+ulong bootstage_span(ulong start_us, const char *fmt, ...)
+{
+	struct bootstage_data *data = gd->bootstage;
+	ulong duration = timer_get_boot_us() - start_us;
+	char buf[60];
+	va_list args;
+	char *name;
+	uint count;
+
+	if (!data || duration < CONFIG_BOOTSTAGE_SPAN_MIN_US ||
+	    data->rec_count >= RECORD_COUNT)
+		return duration;
+
+	/*
+	 * Once reserve_bootstage() has worked out the space needed for the
+	 * relocated records, more names would not fit there
+	 */
+	if (gd->new_bootstage && gd->bootstage != gd->new_bootstage)
+		return duration;
+
+	va_start(args, fmt);
+	vsnprintf(buf, sizeof(buf), fmt, args);
+	va_end(args);
+	name = strdup(buf);
+	if (!name)
+		return duration;
+	count = data->rec_count;
+	bootstage_add_record(0, name, BOOTSTAGEF_ALLOC | BOOTSTAGEF_SPAN,
+			     start_us);
+	if (data->rec_count == count) {
+		free(name);
+		return duration;
+	}
+	data->record[count].start_us = duration;
+
+	return duration;
+}
+#endif
+
 /**
  * Get a record name as a printable string
  *
@@ -297,6 +341,8 @@ static int add_bootstages_devicetree(struct fdt_header *blob)
 
 		if (rec->id != BOOTSTAGE_ID_AWAKE && rec->time_us == 0)
 			continue;
+		if (rec->flags & BOOTSTAGEF_SPAN)
+			continue;
 
 		node = fdt_add_subnode(blob, bootstage, simple_itoa(i));
 		if (node < 0)
@@ -343,7 +389,7 @@ void bootstage_report(void)
 	qsort(data->record, data->rec_count, sizeof(*rec), h_compare_record);
 
 	for (i = 1, rec++; i < data->rec_count; i++, rec++) {
-		if (rec->id && !rec->start_us)
+		if (rec->id && !rec->start_us && !(rec->flags & BOOTSTAGEF_SPAN))
 			prev = print_time_record(rec, prev);
 	}
 	if (data->rec_count > RECORD_COUNT)
@@ -353,9 +399,20 @@ void bootstage_report(void)
 
 	puts("\nAccumulated time:\n");
 	for (i = 0, rec = data->record; i < data->rec_count; i++, rec++) {
-		if (rec->start_us)
+		if (rec->start_us && !(rec->flags & BOOTSTAGEF_SPAN))
 			prev = print_time_record(rec, -1);
 	}
+
+	if (!CONFIG_IS_ENABLED(BOOTSTAGE_SPANS))
+		return;
+	printf("\nSpans:\n%11s%11s  %s\n", "Start", "Duration", "Activity");
+	for (i = 0, rec = data->record; i < data->rec_count; i++, rec++) {
+		if (rec->flags & BOOTSTAGEF_SPAN) {
+			print_grouped_ull(rec->time_us, BOOTSTAGE_DIGITS);
+			print_grouped_ull(rec->start_us, BOOTSTAGE_DIGITS);
+			printf("  %s\n", rec->name);
+		}
+	}
 }
 
 /**
@@ -380,6 +437,95 @@ static void append_data(char **ptrp, char *end, const void *data, int size)
 	memcpy(ptr, data, size);
 }
 
+/**
+ * Append a string to a memory buffer, without its terminator
+ *
+ * @param ptrp	Pointer to buffer, updated by this function
+ * @param end	Pointer to end of buffer
+ * @param str	String to write
+ */
+static void append_str(char **ptrp, char *end, const char *str)
+{
+	append_data(ptrp, end, str, strlen(str));
+}
+
+/**
+ * Append a string to a memory buffer as a JSON string
+ *
+ * This adds quotes and escapes any characters which JSON does not allow to
+ * appear in a string.
+ *
+ * @param ptrp	Pointer to buffer, updated by this function
+ * @param end	Pointer to end of buffer
+ * @param str	String to write
+ */
+static void append_json_str(char **ptrp, char *end, const char *str)
+{
+	char esc[7];
+
+	append_str(ptrp, end, "\"");
+	for (; *str; str++) {
+		if (*str == '"' || *str == '\\') {
+			esc[0] = '\\';
+			esc[1] = *str;
+			append_data(ptrp, end, esc, 2);
+		} else if ((unsigned char)*str < ' ') {
+			snprintf(esc, sizeof(esc), "\\u%04x", *str);
+			append_data(ptrp, end, esc, 6);
+		} else {
+			append_data(ptrp, end, str, 1);
+		}
+	}
+	append_str(ptrp, end, "\"");
+}
+
+int bootstage_export_json(char *buf, int size)
+{
+	const struct bootstage_data *data = gd->bootstage;
+	const struct bootstage_record *rec;
+	char *ptr = buf, *end = buf + size;
+	char name[20], num[80];
+	const char *sep = "";
+	int i;
+
+	append_str(&ptr, end, "{\"traceEvents\":[");
+	for (rec = data->record, i = 0; i < data->rec_count; i++, rec++) {
+		if (rec->start_us && !(rec->flags & BOOTSTAGEF_SPAN))
+			continue;
+		append_str(&ptr, end, sep);
+		append_str(&ptr, end, "\n{\"name\":");
+		append_json_str(&ptr, end,
+				get_record_name(name, sizeof(name), rec));
+		if (rec->flags & BOOTSTAGEF_SPAN)
+			snprintf(num, sizeof(num),
+				 ",\"ph\":\"X\",\"ts\":%lu,\"dur\":%u",
+				 rec->time_us, rec->start_us);
+		else
+			snprintf(num, sizeof(num),
+				 ",\"ph\":\"i\",\"s\":\"g\",\"ts\":%lu",
+				 rec->time_us);
+		append_str(&ptr, end, num);
+		append_str(&ptr, end, ",\"pid\":1,\"tid\":1}");
+		sep = ",";
+	}
+	append_str(&ptr, end, "],\n\"otherData\":{");
+	sep = "";
+	for (rec = data->record, i = 0; i < data->rec_count; i++, rec++) {
+		if (!rec->start_us || (rec->flags & BOOTSTAGEF_SPAN))
+			continue;
+		append_str(&ptr, end, sep);
+		append_json_str(&ptr, end,
+				get_record_name(name, sizeof(name), rec));
+		snprintf(num, sizeof(num), ":%lu", rec->time_us);
+		append_str(&ptr, end, num);
+		sep = ",";
+	}
+	append_str(&ptr, end, "}}\n");
+	append_data(&ptr, end, "", 1);
+
+	return ptr - buf;
+}
+
 int bootstage_stash(void *base, int size)
 {
 	const struct bootstage_data *data = gd->bootstage;
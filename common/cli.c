@@ -43,8 +43,10 @@ int run_command(const char *cmd, int flag)
 #else
 	int hush_flags = FLAG_PARSE_SEMICOLON | FLAG_EXIT_FROM_LOOP;
 
+	/* scripts from the environment are often run many times */
 	if (flag & CMD_FLAG_ENV)
-		hush_flags |= FLAG_CONT_ON_NEWLINE;
+		return parse_string_cached(cmd,
+					   hush_flags | FLAG_CONT_ON_NEWLINE);
 	return parse_string_outer(cmd, hush_flags);
 #endif
 }
@@ -105,7 +107,7 @@ int run_command_list(const char *cmd, int len, int flag)
 		buff[len] = '\0';
 	}
 #ifdef CONFIG_HUSH_PARSER
-	rcode = parse_string_outer(buff, FLAG_PARSE_SEMICOLON);
+	rcode = parse_string_cached(buff, FLAG_PARSE_SEMICOLON);
 #else
 	/*
 	 * This function will overwrite any \n it sees with a \0, which
@@ -307,6 +307,7 @@ struct variables *top_vars = &shell_ver;
 #else
 static int flag_repeat = 0;
 static int do_repeat = 0;
+static int syntax_quiet;	/* don't report syntax errors */
 static struct variables *top_vars = NULL ;
 #endif /*__U_BOOT__ */
 
@@ -377,7 +378,8 @@ static inline void debug_printf(const char *format, ...) { }
 
 #ifdef __U_BOOT__
 static void syntax_err(void) {
-	 printf("syntax error\n");
+	if (!syntax_quiet)
+		printf("syntax error\n");
 }
 #else
 static void __syntax(char *file, int line) {
@@ -1553,6 +1555,7 @@ static int run_pipe_real(struct pipe *pi)
 	int flag = do_repeat ? CMD_FLAG_REPEAT : 0;
 	struct child_prog *child;
 	char *p;
+	int sp;
 # if __GNUC__
 	/* Avoid longjmp clobbering */
 	(void) &i;
@@ -1619,6 +1622,8 @@ static int run_pipe_real(struct pipe *pi)
 			}
 			return EXIT_SUCCESS;   /* don't worry about errors in set_local_var() yet */
 		}
+		/* don't change the pipe, since it may be run again */
+		sp = child->sp;
 		for (i = 0; is_assignment(child->argv[i]); i++) {
 			p = insert_var_value(child->argv[i]);
 #ifndef __U_BOOT__
@@ -1627,11 +1632,11 @@ static int run_pipe_real(struct pipe *pi)
 			set_local_var(p, 0);
 #endif
 			if (p != child->argv[i]) {
-				child->sp--;
+				sp--;
 				free(p);
 			}
 		}
-		if (child->sp) {
+		if (sp) {
 			char * str = NULL;
 
 			str = make_string(child->argv + i,
@@ -1764,6 +1769,7 @@ static int run_list_real(struct pipe *pi)
 	char *save_name = NULL;
 	char **list = NULL;
 	char **save_list = NULL;
+	struct pipe *for_pi = NULL;
 	struct pipe *rpipe;
 	int flag_rep = 0;
 #ifndef __U_BOOT__
@@ -1803,7 +1809,8 @@ static int run_list_real(struct pipe *pi)
 				/* check Ctrl-C */
 				ctrlc();
 				if ((had_ctrlc())) {
-					return 1;
+					rcode = 1;
+					goto out;
 				}
 #endif
 				flag_restore = 0;
@@ -1832,6 +1839,7 @@ static int run_list_real(struct pipe *pi)
 				list = make_list_in(pi->next->progs->argv,
 					pi->progs->argv[0]);
 				save_list = list;
+				for_pi = pi;
 				save_name = pi->progs->argv[0];
 				pi->progs->argv[0] = NULL;
 				flag_rep = 1;
@@ -1902,7 +1910,8 @@ static int run_list_real(struct pipe *pi)
 #else
 		if (rcode < -1) {
 			last_return_code = -rcode - 2;
-			return -2;	/* exit */
+			rcode = -2;	/* exit */
+			goto out;
 		}
 		last_return_code=(rcode == 0) ? 0 : 1;
 #endif
@@ -1920,6 +1929,18 @@ static int run_list_real(struct pipe *pi)
 			skip_more_in_this_rmode=rmode;
 #ifndef __U_BOOT__
 		checkjobs(NULL);
+#endif
+	}
+out:
+	if (list) {
+		/* left a 'for' loop early: put back the loop variable */
+		free(for_pi->progs->argv[0]);
+		while (*list)
+			free(*list++);
+		free(save_list);
+		for_pi->progs->argv[0] = save_name;
+#ifndef __U_BOOT__
+		for_pi->progs->glob_result.gl_pathv[0] = save_name;
 #endif
 	}
 	return rcode;
@@ -3275,6 +3296,168 @@ int parse_string_outer(const char *s, int flag)
 #endif
 }
 
+#ifdef CONFIG_HUSH_SCRIPT_CACHE
+/*
+ * Scripts run from environment variables or with 'source' are parsed once and
+ * the parse tree is kept, so running them again only needs the tree to be
+ * walked. Variables are only expanded when the tree is run, so an entry stays
+ * valid as long as the text of the script does not change. Entries are found
+ * by the text itself, so changing the variable holding a script simply means
+ * that the new text misses in the cache, and the old entry is eventually
+ * evicted.
+ */
+struct script_cache {
+	char *text;		/* script text, with '\n' added as needed */
+	int len;		/* length of text */
+	uint hash;		/* hash of text */
+	int flag;		/* FLAG_... used to parse it */
+	struct pipe **lists;	/* one list of pipes for each statement */
+	int count;		/* number of statements */
+	ulong last_used;	/* for finding the least-recently-used entry */
+	bool busy;		/* being run, so it cannot be used again */
+};
+
+static struct script_cache script_cache[CONFIG_HUSH_SCRIPT_CACHE_SIZE];
+static ulong script_cache_seq;
+
+static uint script_hash(const char *s, int len)
+{
+	uint hash = 2166136261U;
+
+	while (len--)
+		hash = (hash ^ (uchar)*s++) * 16777619;
+
+	return hash;
+}
+
+static void script_cache_free(struct script_cache *ent)
+{
+	int i;
+
+	for (i = 0; i < ent->count; i++)
+		free_pipe_list(ent->lists[i], 0);
+	free(ent->lists);
+	free(ent->text);
+	memset(ent, '\0', sizeof(*ent));
+}
+
+/*
+ * Parse a script without running it, in the same way as parse_stream_outer()
+ * does when it runs it. Returns 0 if OK, or -1 on a syntax error, in which
+ * case the script must be run uncached so that the error is reported at the
+ * right point.
+ */
+static int script_compile(struct script_cache *ent, int flag)
+{
+	struct in_str input;
+	struct p_context ctx;
+	o_string temp = NULL_O_STRING;
+	int rcode;
+
+	setup_string_in_str(&input, ent->text);
+	syntax_quiet = 1;
+	do {
+		ctx.type = flag;
+		initialize_context(&ctx);
+		update_ifs_map();
+		if (!(flag & FLAG_PARSE_SEMICOLON))
+			mapset((uchar *)";$&|", 0);
+		input.promptmode = 1;
+		rcode = parse_stream(&temp, &ctx, &input,
+				     flag & FLAG_CONT_ON_NEWLINE ? -1 : '\n');
+		if (rcode == 1 || ctx.old_flag != 0) {
+			if (ctx.old_flag != 0)
+				free(ctx.stack);
+			b_free(&temp);
+			free_pipe_list(ctx.list_head, 0);
+			syntax_quiet = 0;
+			return -1;
+		}
+		done_word(&temp, &ctx);
+		done_pipe(&ctx, PIPE_SEQ);
+		b_free(&temp);
+		ent->lists = xrealloc(ent->lists,
+				      sizeof(*ent->lists) * (ent->count + 1));
+		ent->lists[ent->count++] = ctx.list_head;
+	} while (rcode != -1 && !(flag & FLAG_EXIT_FROM_LOOP) &&
+		 b_peek(&input));
+	syntax_quiet = 0;
+
+	return 0;
+}
+
+/* Run a parsed script, with the same result as parse_stream_outer() */
+static int script_run(struct script_cache *ent)
+{
+	int code = 1;
+	int i;
+
+	ent->busy = true;
+	for (i = 0; i < ent->count; i++) {
+		code = run_list_real(ent->lists[i]);
+		if (code == -2) {	/* exit */
+			code = 0;
+			break;
+		}
+		if (code == -1)
+			flag_repeat = 0;
+	}
+	ent->busy = false;
+
+	return (code != 0) ? 1 : 0;
+}
+
+int parse_string_cached(const char *s, int flag)
+{
+	struct script_cache *ent, *victim = NULL;
+	const char *p;
+	uint hash;
+	int len;
+
+	if (!s)
+		return 1;
+	if (!*s)
+		return 0;
+	/* add a '\n' in the same cases as parse_string_outer() */
+	p = strchr(s, '\n');
+	len = strlen(s) + (!p || p[1]);
+	hash = script_hash(s, len - 1);
+	for (ent = script_cache; ent < script_cache + ARRAY_SIZE(script_cache);
+	     ent++) {
+		if (ent->text && ent->hash == hash && ent->len == len &&
+		    ent->flag == flag && !memcmp(ent->text, s, len - 1)) {
+			/* a script which runs itself must be parsed again */
+			if (ent->busy)
+				return parse_string_outer(s, flag);
+			ent->last_used = ++script_cache_seq;
+			return script_run(ent);
+		}
+		if (ent->busy)
+			continue;
+		if (!victim || !ent->text ||
+		    (victim->text && ent->last_used < victim->last_used))
+			victim = ent;
+	}
+	if (!victim)
+		return parse_string_outer(s, flag);
+
+	script_cache_free(victim);
+	victim->text = xmalloc(len + 1);
+	memcpy(victim->text, s, len - 1);
+	strcpy(victim->text + len - 1, "\n");
+	victim->len = len;
+	victim->hash = hash;
+	victim->flag = flag;
+	victim->last_used = ++script_cache_seq;
+	if (script_compile(victim, flag)) {
+		script_cache_free(victim);
+		return parse_string_outer(s, flag);
+	}
+
+	return script_run(victim);
+}
+#endif /* CONFIG_HUSH_SCRIPT_CACHE */
+
 #ifndef __U_BOOT__
 static int parse_file_outer(FILE *f)
 #else
@@ -9,6 +9,7 @@
  */
 
 #include <common.h>
+#include <bgtask.h>
 #include <bootretry.h>
 #include <cli.h>
 #include <command.h>
@@ -269,6 +270,7 @@ static int cread_line(const char *const prompt, char *buf, unsigned int *len,
 				if (get_ticks() >= etime)
 					return -2;	/* timed out */
 				WATCHDOG_RESET();
+				bgtask_poll();
 			}
 			first = 0;
 		}
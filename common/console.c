@@ -5,6 +5,7 @@
  */
 
 #include <common.h>
+#include <bgtask.h>
 #include <console.h>
 #include <debug_uart.h>
 #include <dm.h>
@@ -338,6 +339,7 @@ int fgetc(int file)
 		 */
 		for (;;) {
 			WATCHDOG_RESET();
+			bgtask_poll();
 #if CONFIG_IS_ENABLED(CONSOLE_MUX)
 			/*
 			 * Upper layer may have already called tstc() so
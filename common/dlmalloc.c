@@ -6,6 +6,7 @@
 #endif
 
 #include <malloc.h>
+#include <malloc_stats.h>
 #include <asm/io.h>
 
 #ifdef DEBUG
@@ -620,6 +621,7 @@ void mem_malloc_init(ulong start, ulong size)
 	memset((void *)mem_malloc_start, 0x0, size);
 #endif
 	malloc_bin_reloc();
+	malloc_stats_init();
 }
 
 /* field-extraction macros */
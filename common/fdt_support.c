@@ -1803,6 +1803,8 @@ int fdt_overlay_apply_verbose(void *fdt, void *fdto)
 	has_symbols = err >= 0;
 
 	err = fdt_overlay_apply(fdt, fdto);
+	/* The base tree is changed even if applying the overlay fails */
+	fdtdec_phandle_index_invalidate(fdt);
 	if (err < 0) {
 		printf("failed on fdt_overlay_apply(): %s\n",
 				fdt_strerror(err));
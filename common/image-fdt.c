@@ -9,6 +9,7 @@
  */
 
 #include <common.h>
+#include <bootstage.h>
 #include <fdt_support.h>
 #include <fdtdec.h>
 #include <env.h>
@@ -105,10 +106,14 @@ void boot_fdt_add_mem_rsv_regions(struct lmb *lmb, void *fdt_blob)
 	int i, total, ret;
 	int nodeoffset, subnode;
 	struct fdt_resource res;
+	enum lmb_owner owner;
 
 	if (fdt_check_header(fdt_blob) != 0)
 		return;
 
+	owner = lmb->owner;
+	lmb->owner = LMB_OWNER_FDT;
+
 	/* process memreserve sections */
 	total = fdt_num_mem_rsv(fdt_blob);
 	for (i = 0; i < total; i++) {
@@ -134,6 +139,8 @@ void boot_fdt_add_mem_rsv_regions(struct lmb *lmb, void *fdt_blob)
 			subnode = fdt_next_subnode(fdt_blob, subnode);
 		}
 	}
+
+	lmb->owner = owner;
 }
 
 /**
@@ -224,7 +231,9 @@ int boot_relocate_fdt(struct lmb *lmb, char **of_flat_tree, ulong *of_size)
 		printf("   Loading Device Tree to %p, end %p ... ",
 		       of_start, of_start + of_len - 1);
 
+		bootstage_start(BOOTSTAGE_ID_ACCUM_BOOTM_COPY, "bootm_copy");
 		err = fdt_open_into(fdt_blob, of_start, of_len);
+		bootstage_accum(BOOTSTAGE_ID_ACCUM_BOOTM_COPY);
 		if (err != 0) {
 			fdt_error("fdt move failed");
 			goto error;
@@ -243,6 +252,94 @@ error:
 	return 1;
 }
 
+#ifdef CONFIG_LMB
+/**
+ * boot_fdt_in_place() - use the flat device tree at its current address
+ * @lmb: pointer to lmb handle, will be used for memory mgmt
+ * @of_flat_tree: pointer to the fdt start address
+ * @of_size: pointer to a ulong variable, will hold fdt length
+ *
+ * This avoids copying the fdt when it already sits in free, suitably aligned
+ * memory within the bootmap, with room for CONFIG_SYS_FDT_PAD bytes of
+ * padding after it. It is not used if 'fdt_high' is set, since that selects
+ * the relocation address explicitly.
+ *
+ * returns:
+ *      0 - success, the fdt is reserved and padded in place
+ *      -ve - the fdt must be relocated
+ */
+static int boot_fdt_in_place(struct lmb *lmb, char **of_flat_tree,
+			     ulong *of_size)
+{
+	ulong of_start = map_to_sysmem(*of_flat_tree);
+	ulong of_len = *of_size + CONFIG_SYS_FDT_PAD;
+	ulong bootmap_base = env_get_bootm_low();
+	ulong bootmap_end = bootmap_base + env_get_bootm_mapsize();
+	int err;
+
+	if (env_get("fdt_high"))
+		return -EPERM;
+	if (!IS_ALIGNED(of_start, 8) || of_start < bootmap_base ||
+	    of_start + of_len > bootmap_end)
+		return -EINVAL;
+	if (fdt_check_header(*of_flat_tree))
+		return -EINVAL;
+	if (lmb_alloc_addr(lmb, of_start, of_len) != of_start)
+		return -ENOSPC;
+
+	/* Grow the blob into the padding, as boot_relocate_fdt() would */
+	err = fdt_open_into(*of_flat_tree, *of_flat_tree, of_len);
+	if (err) {
+		debug("%s: cannot expand FDT: %s\n", __func__,
+		      fdt_strerror(err));
+		lmb_free(lmb, of_start, of_len);
+		return -EINVAL;
+	}
+	printf("   Using Device Tree in place at %p, end %p\n",
+	       *of_flat_tree, *of_flat_tree + of_len - 1);
+
+	*of_size = of_len;
+	if (CONFIG_IS_ENABLED(CMD_FDT))
+		set_working_fdt_addr(of_start);
+
+	return 0;
+}
+
+/**
+ * boot_place_fdt() - place the flat device tree for the OS
+ * @images: pointer to the bootm images structure
+ * @of_size: pointer to a ulong variable, will hold fdt length
+ *
+ * The fdt is used in place where possible (see CONFIG_BOOTM_FDT_IN_PLACE),
+ * otherwise it is relocated by boot_relocate_fdt(). images->ft_addr is
+ * updated to the final address and any bytes copied are added to
+ * images->copied.
+ *
+ * returns:
+ *      0 - success
+ *      1 - failure
+ */
+int boot_place_fdt(bootm_headers_t *images, ulong *of_size)
+{
+	char *fdt_blob = images->ft_addr;
+	ulong fdt_size = *of_size;
+	int ret;
+
+	if (!fdt_size)
+		return 0;
+
+	if (IS_ENABLED(CONFIG_BOOTM_FDT_IN_PLACE) && !images->ft_embedded &&
+	    !boot_fdt_in_place(&images->lmb, &images->ft_addr, of_size))
+		return 0;
+
+	ret = boot_relocate_fdt(&images->lmb, &images->ft_addr, of_size);
+	if (!ret && images->ft_addr != fdt_blob)
+		images->copied += fdt_size;
+
+	return ret;
+}
+#endif /* CONFIG_LMB */
+
 /**
  * boot_get_fdt - main fdt handling routine
  * @argc: command argument count
@@ -372,6 +469,7 @@ int boot_get_fdt(int flag, int argc, char *const argv[], uint8_t arch,
 
 			if (load == image_start ||
 			    load == image_data) {
+				images->ft_embedded = true;
 				fdt_addr = load;
 				break;
 			}
@@ -410,6 +508,9 @@ int boot_get_fdt(int flag, int argc, char *const argv[], uint8_t arch,
 				images->fit_hdr_fdt = map_sysmem(fdt_addr, 0);
 				images->fit_uname_fdt = fit_uname_fdt;
 				images->fit_noffset_fdt = fdt_noffset;
+				/* An fdt without a load address stays in the FIT */
+				images->ft_embedded = load >= fdt_addr &&
+					load < fdt_addr + fdt_totalsize(buf);
 				fdt_addr = load;
 
 				break;
@@ -447,6 +548,7 @@ int boot_get_fdt(int flag, int argc, char *const argv[], uint8_t arch,
 				   &fdt_len);
 		if (fdt_len) {
 			fdt_blob = (char *)fdt_data;
+			images->ft_embedded = true;
 			printf("   Booting using the fdt at 0x%p\n", fdt_blob);
 
 			if (fdt_check_header(fdt_blob) != 0) {
@@ -476,6 +578,7 @@ int boot_get_fdt(int flag, int argc, char *const argv[], uint8_t arch,
 			if (fdt_check_header(fdt_blob))
 				goto no_fdt;
 
+			images->ft_embedded = true;
 			debug("## Using FDT in Android image dtb area with idx %u\n", dtb_idx);
 		} else if (!android_image_get_second(hdr, &fdt_data, &fdt_len) &&
 			!fdt_check_header((char *)fdt_data)) {
@@ -483,6 +586,8 @@ int boot_get_fdt(int flag, int argc, char *const argv[], uint8_t arch,
 			if (fdt_totalsize(fdt_blob) != fdt_len)
 				goto error;
 
+			images->ft_embedded = true;
+
 			debug("## Using FDT in Android image second area\n");
 		} else {
 			fdt_addr = env_get_hex("fdtaddr", 0);
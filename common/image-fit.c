@@ -21,6 +21,7 @@
 #include <mapmem.h>
 #include <asm/io.h>
 #include <malloc.h>
+#include <worker.h>
 DECLARE_GLOBAL_DATA_PTR;
 #endif /* !USE_HOSTCC*/
 
@@ -1226,6 +1227,199 @@ int calculate_hash(const void *data, int data_len, const char *algo,
 	return 0;
 }
 
+#if IMAGE_ENABLE_PREHASH
+/* Number of image hashes which can be calculated ahead of time */
+#define FIT_PREHASH_COUNT	8
+
+/**
+ * struct fit_prehash - A hash being calculated on another core
+ *
+ * @job: Job calculating the hash
+ * @fit: FIT containing the hash node, or NULL if this entry is unused
+ * @image_noffset: Offset of the image node
+ * @noffset: Offset of the hash node
+ * @data: Image data being hashed
+ * @size: Size of the image data
+ * @algo: Hash algorithm
+ * @value: Hash value, once the job is done
+ * @value_len: Length of @value
+ */
+struct fit_prehash {
+	struct worker_job job;
+	const void *fit;
+	int image_noffset;
+	int noffset;
+	const void *data;
+	size_t size;
+	char *algo;
+	uint8_t value[FIT_MAX_HASH_LEN];
+	int value_len;
+};
+
+static struct fit_prehash fit_prehashes[FIT_PREHASH_COUNT];
+
+static int fit_prehash_run(void *ctx)
+{
+	struct fit_prehash *ph = ctx;
+
+	return calculate_hash(ph->data, ph->size, ph->algo, ph->value,
+			      &ph->value_len);
+}
+
+static struct fit_prehash *fit_prehash_find(const void *fit, int noffset,
+					    const void *data, size_t size)
+{
+	struct fit_prehash *ph;
+
+	for (ph = fit_prehashes; ph < fit_prehashes + FIT_PREHASH_COUNT; ph++) {
+		if (ph->fit == fit && ph->noffset == noffset &&
+		    ph->data == data && ph->size == size)
+			return ph;
+	}
+
+	return NULL;
+}
+
+static void fit_prehash_free(struct fit_prehash *ph)
+{
+	worker_wait(&ph->job);
+	ph->fit = NULL;
+}
+
+/* Get a hash calculated in advance, or return -ENOENT if there is none */
+static int fit_prehash_get(const void *fit, int noffset, const void *data,
+			   size_t size, uint8_t *value, int *value_lenp)
+{
+	struct fit_prehash *ph;
+	int ret;
+
+	ph = fit_prehash_find(fit, noffset, data, size);
+	if (!ph)
+		return -ENOENT;
+	ret = worker_wait(&ph->job);
+	memcpy(value, ph->value, ph->value_len);
+	*value_lenp = ph->value_len;
+	fit_prehash_free(ph);
+
+	return ret;
+}
+
+/* Start calculating the hashes of an image on other cores */
+static void fit_image_prehash(const void *fit, int image_noffset,
+			      const void *data, size_t size)
+{
+	struct fit_prehash *ph;
+	int noffset, ignore;
+	char *algo;
+
+	/* Without other cores, hash each image only when it is verified */
+	if (!worker_init())
+		return;
+
+	fdt_for_each_subnode(noffset, fit, image_noffset) {
+		const char *name = fit_get_name(fit, noffset, NULL);
+
+		if (strncmp(name, FIT_HASH_NODENAME,
+			    strlen(FIT_HASH_NODENAME)) ||
+		    fit_image_hash_get_algo(fit, noffset, &algo) ||
+		    fit_prehash_find(fit, noffset, data, size))
+			continue;
+		if (IMAGE_ENABLE_IGNORE &&
+		    !fit_image_hash_get_ignore(fit, noffset, &ignore) && ignore)
+			continue;
+
+		ph = fit_prehash_find(NULL, 0, NULL, 0);
+		if (!ph)
+			return;
+		ph->fit = fit;
+		ph->image_noffset = image_noffset;
+		ph->noffset = noffset;
+		ph->data = data;
+		ph->size = size;
+		ph->algo = algo;
+		worker_submit(&ph->job, fit_prehash_run, ph);
+	}
+}
+
+/* Drop the hashes of an image once it has been verified */
+static void fit_image_prehash_drop(const void *fit, int image_noffset)
+{
+	struct fit_prehash *ph;
+
+	for (ph = fit_prehashes; ph < fit_prehashes + FIT_PREHASH_COUNT; ph++) {
+		if (ph->fit == fit && ph->image_noffset == image_noffset)
+			fit_prehash_free(ph);
+	}
+}
+
+/* Drop the hashes of data which is about to be overwritten */
+static void fit_prehash_drop_range(const void *start, ulong len)
+{
+	struct fit_prehash *ph;
+
+	for (ph = fit_prehashes; ph < fit_prehashes + FIT_PREHASH_COUNT; ph++) {
+		if (ph->fit && ph->data < start + len &&
+		    ph->data + ph->size > start)
+			fit_prehash_free(ph);
+	}
+}
+
+void fit_conf_prehash(const void *fit, int cfg_noffset)
+{
+	static const char *const props[] = {
+		FIT_KERNEL_PROP, FIT_RAMDISK_PROP, FIT_FDT_PROP,
+		FIT_LOADABLE_PROP, FIT_FPGA_PROP, FIT_FIRMWARE_PROP,
+	};
+	const void *data;
+	size_t size;
+	int i, j, count, noffset;
+
+	for (i = 0; i < ARRAY_SIZE(props); i++) {
+		count = fit_conf_get_prop_node_count(fit, cfg_noffset,
+						     props[i]);
+		for (j = 0; j < count; j++) {
+			noffset = fit_conf_get_prop_node_index(fit,
+					cfg_noffset, props[i], j);
+			if (noffset < 0 ||
+			    fit_image_get_data_and_size(fit, noffset, &data,
+							&size))
+				continue;
+			fit_image_prehash(fit, noffset, data, size);
+		}
+	}
+}
+
+void fit_prehash_done(void)
+{
+	struct fit_prehash *ph;
+
+	for (ph = fit_prehashes; ph < fit_prehashes + FIT_PREHASH_COUNT; ph++) {
+		if (ph->fit)
+			fit_prehash_free(ph);
+	}
+}
+#else
+static inline int fit_prehash_get(const void *fit, int noffset,
+				  const void *data, size_t size,
+				  uint8_t *value, int *value_lenp)
+{
+	return -ENOENT;
+}
+
+static inline void fit_image_prehash(const void *fit, int image_noffset,
+				     const void *data, size_t size)
+{
+}
+
+static inline void fit_image_prehash_drop(const void *fit, int image_noffset)
+{
+}
+
+static inline void fit_prehash_drop_range(const void *start, ulong len)
+{
+}
+#endif
+
 static int fit_image_check_hash(const void *fit, int noffset, const void *data,
 				size_t size, char **err_msgp)
 {
@@ -1235,6 +1429,7 @@ static int fit_image_check_hash(const void *fit, int noffset, const void *data,
 	uint8_t *fit_value;
 	int fit_value_len;
 	int ignore;
+	int ret;
 
 	*err_msgp = NULL;
 
@@ -1258,7 +1453,10 @@ static int fit_image_check_hash(const void *fit, int noffset, const void *data,
 		return -1;
 	}
 
-	if (calculate_hash(data, size, algo, value, &value_len)) {
+	ret = fit_prehash_get(fit, noffset, data, size, value, &value_len);
+	if (ret == -ENOENT)
+		ret = calculate_hash(data, size, algo, value, &value_len);
+	if (ret) {
 		*err_msgp = "Unsupported hash algorithm";
 		return -1;
 	}
@@ -1282,6 +1480,9 @@ int fit_image_verify_with_data(const void *fit, int image_noffset,
 	int verify_all = 1;
 	int ret;
 
+	/* Work out the hashes on other cores while checking signatures */
+	fit_image_prehash(fit, image_noffset, data, size);
+
 	/* Verify all required signatures */
 	if (FIT_IMAGE_ENABLE_VERIFY &&
 	    fit_image_verify_required_sigs(fit, image_noffset, data, size,
@@ -1328,10 +1529,12 @@ int fit_image_verify_with_data(const void *fit, int image_noffset,
 		err_msg = "Corrupted or truncated tree";
 		goto error;
 	}
+	fit_image_prehash_drop(fit, image_noffset);
 
 	return 1;
 
 error:
+	fit_image_prehash_drop(fit, image_noffset);
 	printf(" error!\n%s for '%s' hash node in '%s' image node\n",
 	       err_msg, fit_get_name(fit, noffset, NULL),
 	       fit_get_name(fit, image_noffset, NULL));
@@ -1396,6 +1599,15 @@ int fit_all_image_verify(const void *fit)
 		return 0;
 	}
 
+	/* Start hashing all the images at once, if there are other cores */
+	fdt_for_each_subnode(noffset, fit, images_noffset) {
+		const void *data;
+		size_t size;
+
+		if (!fit_image_get_data_and_size(fit, noffset, &data, &size))
+			fit_image_prehash(fit, noffset, data, size);
+	}
+
 	/* Process all image subnodes, check hashes for each */
 	printf("## Checking hash(es) for FIT Image at %08lx ...\n",
 	       (ulong)fit);
@@ -1412,8 +1624,10 @@ int fit_all_image_verify(const void *fit)
 			       fit_get_name(fit, noffset, NULL));
 			count++;
 
-			if (!fit_image_verify(fit, noffset))
+			if (!fit_image_verify(fit, noffset)) {
+				fit_prehash_done();
 				return 0;
+			}
 			printf("\n");
 		}
 	}
@@ -1946,9 +2160,14 @@ int fit_image_load(bootm_headers_t *images, ulong addr,
 		fit_base_uname_config = fdt_get_name(fit, cfg_noffset, NULL);
 		printf("   Using '%s' configuration\n", fit_base_uname_config);
 		/* Remember this config */
-		if (image_type == IH_TYPE_KERNEL)
+		if (image_type == IH_TYPE_KERNEL) {
 			images->fit_uname_cfg = fit_base_uname_config;
 
+			/* Hash the other images while this one is handled */
+			if (images->verify)
+				fit_conf_prehash(fit, cfg_noffset);
+		}
+
 		if (FIT_IMAGE_ENABLE_VERIFY && images->verify) {
 			puts("   Verifying Hash Integrity ... ");
 			if (fit_config_verify(fit, cfg_noffset)) {
@@ -2099,6 +2318,7 @@ int fit_image_load(bootm_headers_t *images, ulong addr,
 			load = map_to_sysmem(loadbuf);
 		} else {
 			loadbuf = map_sysmem(load, max_decomp_len);
+			fit_prehash_drop_range(loadbuf, max_decomp_len);
 		}
 		if (image_decomp(comp, load, data, image_type,
 				loadbuf, buf, len, max_decomp_len, &load_end)) {
@@ -2109,6 +2329,7 @@ int fit_image_load(bootm_headers_t *images, ulong addr,
 		len = load_end - load;
 	} else if (load != data) {
 		loadbuf = map_sysmem(load, len);
+		fit_prehash_drop_range(loadbuf, len);
 		memcpy(loadbuf, buf, len);
 	}
 
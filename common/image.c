@@ -10,6 +10,7 @@
 #include <common.h>
 #include <bootstage.h>
 #include <cpu_func.h>
+#include <dma.h>
 #include <env.h>
 #include <lmb.h>
 #include <log.h>
@@ -455,10 +456,14 @@ int image_decomp(int comp, ulong load, ulong image_start, int type,
 	case IH_COMP_NONE:
 		if (load == image_start)
 			break;
-		if (image_len <= unc_len)
-			memmove_wd(load_buf, image_buf, image_len, CHUNKSZ);
-		else
+		if (image_len > unc_len)
 			ret = -ENOSPC;
+#ifndef USE_HOSTCC
+		else if (!dma_memcpy_try(load_buf, image_buf, image_len))
+			break;
+#endif
+		else
+			memmove_wd(load_buf, image_buf, image_len, CHUNKSZ);
 		break;
 #ifdef CONFIG_GZIP
 	case IH_COMP_GZIP: {
@@ -1722,7 +1727,7 @@ int image_setup_linux(bootm_headers_t *images)
 	}
 
 	if (IMAGE_ENABLE_OF_LIBFDT) {
-		ret = boot_relocate_fdt(lmb, of_flat_tree, &of_size);
+		ret = boot_place_fdt(images, &of_size);
 		if (ret)
 			return ret;
 	}
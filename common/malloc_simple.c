@@ -10,6 +10,7 @@
 #include <common.h>
 #include <log.h>
 #include <malloc.h>
+#include <malloc_stats.h>
 #include <mapmem.h>
 #include <asm/io.h>
 
@@ -44,6 +45,9 @@ void *malloc_simple(size_t bytes)
 		return ptr;
 
 	log_debug("%lx\n", (ulong)ptr);
+	if (CONFIG_IS_ENABLED(SYS_MALLOC_SIMPLE))
+		malloc_stats_alloc(ptr, bytes,
+				   (ulong)__builtin_return_address(0));
 
 	return ptr;
 }
@@ -56,20 +60,31 @@ void *memalign_simple(size_t align, size_t bytes)
 	if (!ptr)
 		return ptr;
 	log_debug("aligned to %lx\n", (ulong)ptr);
+	if (CONFIG_IS_ENABLED(SYS_MALLOC_SIMPLE))
+		malloc_stats_alloc(ptr, bytes,
+				   (ulong)__builtin_return_address(0));
 
 	return ptr;
 }
 
+#if CONFIG_IS_ENABLED(MALLOC_STATS)
+void *malloc_simple_untracked(size_t bytes)
+{
+	return alloc_simple(bytes, sizeof(ulong));
+}
+#endif
+
 #if CONFIG_IS_ENABLED(SYS_MALLOC_SIMPLE)
 void *calloc(size_t nmemb, size_t elem_size)
 {
 	size_t size = nmemb * elem_size;
 	void *ptr;
 
-	ptr = malloc(size);
+	ptr = alloc_simple(size, 1);
 	if (!ptr)
 		return ptr;
 	memset(ptr, '\0', size);
+	malloc_stats_alloc(ptr, size, (ulong)__builtin_return_address(0));
 
 	return ptr;
 }
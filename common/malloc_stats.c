@@ -0,0 +1,447 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Heap usage statistics for each caller of malloc()
+ *
+ * Each allocation is charged to the return address of the call. Before
+ * relocation nothing is ever freed, so only the totals for each caller are
+ * kept, in a table allocated from the pre-relocation heap itself. Once the main
+ * heap is set up, each live block is also recorded so that it can be charged
+ * back to its caller when freed.
+ */
+
+#define LOG_CATEGORY LOGC_ALLOC
+
+#include <common.h>
+#include <bloblist.h>
+#include <log.h>
+#include <malloc.h>
+#include <malloc_stats.h>
+#include <asm/global_data.h>
+#include <linux/kernel.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+#define NO_SITE		(~0U)
+
+/**
+ * struct malloc_live - A block allocated from the main heap
+ *
+ * @ptr: Pointer to the block, or NULL if the entry is unused
+ * @size: Number of bytes requested
+ * @site: Index of the caller in the main heap's sites, or NO_SITE if none
+ */
+struct malloc_live {
+	void *ptr;
+	ulong size;
+	uint site;
+};
+
+/* Statistics for the pre-relocation heap, copied here when it is replaced */
+static struct malloc_usage early_stats;
+static struct malloc_site early_sites[CONFIG_MALLOC_STATS_F_SITES];
+
+static struct malloc_usage main_stats;
+static struct malloc_site main_sites[CONFIG_MALLOC_STATS_SITES];
+
+/* Hash table of live blocks in the main heap, kept at most 3/4 full */
+static struct malloc_live live[CONFIG_MALLOC_STATS_LIVE];
+static uint num_live;
+
+static bool malloc_stats_is_early(void)
+{
+	if (CONFIG_IS_ENABLED(SYS_MALLOC_SIMPLE))
+		return true;
+#if CONFIG_VAL(SYS_MALLOC_F_LEN)
+	return !(gd->flags & GD_FLG_FULL_MALLOC_INIT);
+#else
+	return false;
+#endif
+}
+
+/* Get the table for the pre-relocation heap, allocating it if needed */
+static struct malloc_usage *malloc_stats_early(void)
+{
+#if CONFIG_VAL(SYS_MALLOC_F_LEN)
+	struct malloc_usage *stats = gd->malloc_usage;
+
+	if (!stats) {
+		stats = malloc_simple_untracked(sizeof(*stats) +
+						sizeof(early_sites));
+		if (stats) {
+			memset(stats, '\0', sizeof(*stats) + sizeof(early_sites));
+			stats->max_sites = CONFIG_MALLOC_STATS_F_SITES;
+			stats->sites = (struct malloc_site *)(stats + 1);
+		}
+		gd->malloc_usage = stats;
+	}
+
+	return stats;
+#else
+	return NULL;
+#endif
+}
+
+static uint malloc_stats_hash(ulong val, uint size)
+{
+	return (u32)(val >> 2) * 2654435761U % size;
+}
+
+/* Find the entry for a caller, adding it if needed */
+static uint malloc_stats_site(struct malloc_usage *stats, ulong caller)
+{
+	uint start, i;
+
+	if (!stats->max_sites)
+		return NO_SITE;
+	start = malloc_stats_hash(caller, stats->max_sites);
+	i = start;
+	do {
+		struct malloc_site *site = &stats->sites[i];
+
+		if (site->caller == caller)
+			return i;
+		if (!site->caller) {
+			site->caller = caller;
+			stats->num_sites++;
+			return i;
+		}
+		i = (i + 1) % stats->max_sites;
+	} while (i != start);
+
+	return NO_SITE;
+}
+
+static void malloc_stats_charge(struct malloc_usage *stats, uint idx,
+				ulong size)
+{
+	struct malloc_site *site;
+
+	stats->cur += size;
+	stats->peak = max(stats->peak, stats->cur);
+	if (idx != NO_SITE) {
+		site = &stats->sites[idx];
+		site->count++;
+		site->bytes += size;
+		site->peak = max(site->peak, site->bytes);
+	}
+}
+
+static bool malloc_stats_add_live(void *ptr, ulong size, uint idx)
+{
+	uint i;
+
+	if (num_live >= CONFIG_MALLOC_STATS_LIVE * 3 / 4)
+		return false;
+	i = malloc_stats_hash((ulong)ptr, CONFIG_MALLOC_STATS_LIVE);
+	while (live[i].ptr)
+		i = (i + 1) % CONFIG_MALLOC_STATS_LIVE;
+	live[i].ptr = ptr;
+	live[i].size = size;
+	live[i].site = idx;
+	num_live++;
+
+	return true;
+}
+
+static int malloc_stats_find_live(void *ptr)
+{
+	uint i;
+
+	i = malloc_stats_hash((ulong)ptr, CONFIG_MALLOC_STATS_LIVE);
+	for (; live[i].ptr; i = (i + 1) % CONFIG_MALLOC_STATS_LIVE) {
+		if (live[i].ptr == ptr)
+			return i;
+	}
+
+	return -ENOENT;
+}
+
+/*
+ * Remove an entry, moving back any later entries in the same run which would
+ * otherwise no longer be found
+ */
+static void malloc_stats_remove_live(uint i)
+{
+	uint j = i, home;
+
+	while (1) {
+		j = (j + 1) % CONFIG_MALLOC_STATS_LIVE;
+		if (!live[j].ptr)
+			break;
+		home = malloc_stats_hash((ulong)live[j].ptr,
+					 CONFIG_MALLOC_STATS_LIVE);
+		/* Leave it if its home is cyclically within (i, j] */
+		if (i <= j ? i < home && home <= j : i < home || home <= j)
+			continue;
+		live[i] = live[j];
+		i = j;
+	}
+	live[i].ptr = NULL;
+	num_live--;
+}
+
+void malloc_stats_alloc(void *ptr, size_t size, ulong caller)
+{
+	struct malloc_usage *stats;
+	uint idx;
+
+	if (!ptr)
+		return;
+	stats = malloc_stats_is_early() ? malloc_stats_early() : &main_stats;
+	if (!stats)
+		return;
+	stats->count++;
+	idx = malloc_stats_site(stats, caller);
+	if (idx == NO_SITE)
+		stats->dropped++;
+	if (!malloc_stats_is_early() &&
+	    !malloc_stats_add_live(ptr, size, idx)) {
+		stats->untracked++;
+		return;
+	}
+	malloc_stats_charge(stats, idx, size);
+}
+
+void malloc_stats_free(void *ptr)
+{
+	struct malloc_live *blk;
+	int i;
+
+	if (!ptr || malloc_stats_is_early())
+		return;
+	i = malloc_stats_find_live(ptr);
+	if (i < 0)
+		return;
+	blk = &live[i];
+	main_stats.cur -= blk->size;
+	if (blk->site != NO_SITE)
+		main_stats.sites[blk->site].bytes -= blk->size;
+	malloc_stats_remove_live(i);
+}
+
+void malloc_stats_new_f_pool(void)
+{
+#if CONFIG_VAL(SYS_MALLOC_F_LEN)
+	ulong used = gd->malloc_ptr;
+	struct malloc_usage *stats;
+
+	stats = malloc_stats_early();
+	if (stats && !stats->f_size) {
+		stats->f_used = used;
+		stats->f_size = gd->malloc_limit;
+	}
+#endif
+}
+
+void malloc_stats_init(void)
+{
+#if CONFIG_VAL(SYS_MALLOC_F_LEN)
+	struct malloc_usage *stats = gd->malloc_usage;
+
+	if (stats && stats != &early_stats) {
+		early_stats = *stats;
+		memcpy(early_sites, stats->sites, sizeof(early_sites));
+	}
+	early_stats.max_sites = CONFIG_MALLOC_STATS_F_SITES;
+	early_stats.sites = early_sites;
+	if (!early_stats.f_size) {
+		early_stats.f_used = gd->malloc_ptr;
+		early_stats.f_size = gd->malloc_limit;
+	}
+	gd->malloc_usage = &early_stats;
+#endif
+	memset(&main_stats, '\0', sizeof(main_stats));
+	memset(main_sites, '\0', sizeof(main_sites));
+	main_stats.max_sites = CONFIG_MALLOC_STATS_SITES;
+	main_stats.sites = main_sites;
+	memset(live, '\0', sizeof(live));
+	num_live = 0;
+}
+
+struct malloc_usage *malloc_stats_get(bool early)
+{
+	if (early) {
+#if CONFIG_VAL(SYS_MALLOC_F_LEN)
+		return gd->malloc_usage;
+#else
+		return NULL;
+#endif
+	}
+
+	return CONFIG_IS_ENABLED(SYS_MALLOC_SIMPLE) ? NULL : &main_stats;
+}
+
+int malloc_stats_write_handoff(void)
+{
+	struct malloc_handoff *ho;
+	struct malloc_usage *early;
+
+	if (!CONFIG_IS_ENABLED(BLOBLIST))
+		return 0;
+	ho = bloblist_ensure(BLOBLISTT_MALLOC_STATS, sizeof(*ho));
+	if (!ho)
+		return -ENOSPC;
+	memset(ho, '\0', sizeof(*ho));
+#if CONFIG_VAL(SYS_MALLOC_F_LEN)
+	ho->f_used = gd->malloc_ptr;
+	ho->f_size = gd->malloc_limit;
+#endif
+	early = malloc_stats_get(true);
+	if (early && early->f_size) {
+		/* A new simple heap was set up, so report both */
+		ho->peak = ho->f_used;
+		ho->size = ho->f_size;
+		ho->f_used = early->f_used;
+		ho->f_size = early->f_size;
+	}
+	if (!malloc_stats_is_early()) {
+		ho->peak = main_stats.peak;
+		ho->size = mem_malloc_end - mem_malloc_start;
+	}
+
+	return 0;
+}
+
+/* Check if site @i should be shown before site @j: highest peak first */
+static bool malloc_stats_before(struct malloc_usage *stats, int i, int j)
+{
+	struct malloc_site *s1 = &stats->sites[i], *s2 = &stats->sites[j];
+
+	if (s1->peak != s2->peak)
+		return s1->peak > s2->peak;
+	if (s1->count != s2->count)
+		return s1->count > s2->count;
+
+	return i < j;
+}
+
+/*
+ * Show a heap's totals and its callers with the highest peak usage
+ *
+ * The callers are picked one at a time rather than sorted, so that nothing is
+ * allocated (and recorded) while showing them.
+ */
+static void malloc_stats_show_heap(struct malloc_usage *stats, ulong offset,
+				   int max_sites)
+{
+	int i, n, best, prev = -1;
+
+	printf("   %lu bytes in use, peak %lu, %u allocations\n", stats->cur,
+	       stats->peak, stats->count);
+	if (stats->dropped)
+		printf("   %u allocations from callers not shown (table full)\n",
+		       stats->dropped);
+	if (stats->untracked)
+		printf("   %u allocations not tracked (increase MALLOC_STATS_LIVE)\n",
+		       stats->untracked);
+
+	printf("   %-*s %8s %10s %10s\n", (int)sizeof(ulong) * 2, "Caller",
+	       "Count", "Bytes", "Peak");
+	for (n = 0; n < max_sites; n++) {
+		struct malloc_site *site;
+
+		for (i = 0, best = -1; i < stats->max_sites; i++) {
+			if (!stats->sites[i].caller)
+				continue;
+			if (prev != -1 && !malloc_stats_before(stats, prev, i))
+				continue;
+			if (best == -1 || malloc_stats_before(stats, i, best))
+				best = i;
+		}
+		if (best == -1)
+			break;
+		site = &stats->sites[best];
+		printf("   %0*lx %8u %10lu %10lu\n", (int)sizeof(ulong) * 2,
+		       site->caller - offset, site->count, site->bytes,
+		       site->peak);
+		prev = best;
+	}
+}
+
+void malloc_stats_show(int max_sites)
+{
+	struct malloc_handoff *ho;
+	struct malloc_usage *stats;
+
+	if (CONFIG_IS_ENABLED(BLOBLIST) && !IS_ENABLED(CONFIG_SPL_BUILD)) {
+		ho = bloblist_find(BLOBLISTT_MALLOC_STATS, sizeof(*ho));
+		if (ho) {
+			printf("SPL pre-relocation heap: %#x of %#x bytes used\n",
+			       ho->f_used, ho->f_size);
+			if (ho->size)
+				printf("SPL heap: peak %#x of %#x bytes\n",
+				       ho->peak, ho->size);
+		}
+	}
+
+	stats = malloc_stats_get(true);
+	if (stats) {
+#if CONFIG_VAL(SYS_MALLOC_F_LEN)
+		if (stats->f_size)
+			printf("Pre-relocation heap: %#lx of %#lx bytes used\n",
+			       stats->f_used, stats->f_size);
+		else
+			printf("Pre-relocation heap: %#lx of %#lx bytes used\n",
+			       gd->malloc_ptr, gd->malloc_limit);
+#endif
+		malloc_stats_show_heap(stats, 0, max_sites);
+	}
+
+	stats = malloc_stats_get(false);
+	if (stats && !malloc_stats_is_early()) {
+		printf("Heap: %#lx bytes\n", mem_malloc_end - mem_malloc_start);
+		malloc_stats_show_heap(stats, gd->reloc_off, max_sites);
+	}
+}
+
+#if !CONFIG_IS_ENABLED(SYS_MALLOC_SIMPLE)
+/*
+ * These are the public allocation functions. The allocator provides the
+ * underlying ones under other names (see malloc.h).
+ */
+void *malloc(size_t bytes)
+{
+	void *ptr = mALLOc(bytes);
+
+	malloc_stats_alloc(ptr, bytes, (ulong)__builtin_return_address(0));
+
+	return ptr;
+}
+
+void free(void *ptr)
+{
+	malloc_stats_free(ptr);
+	fREe(ptr);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+	void *ptr = cALLOc(nmemb, size);
+
+	malloc_stats_alloc(ptr, nmemb * size,
+			   (ulong)__builtin_return_address(0));
+
+	return ptr;
+}
+
+void *realloc(void *oldmem, size_t bytes)
+{
+	void *ptr = rEALLOc(oldmem, bytes);
+
+	/* On failure the old block is left alone, unless it was freed */
+	if (ptr || !bytes)
+		malloc_stats_free(oldmem);
+	malloc_stats_alloc(ptr, bytes, (ulong)__builtin_return_address(0));
+
+	return ptr;
+}
+
+void *memalign(size_t alignment, size_t bytes)
+{
+	void *ptr = mEMALIGn(alignment, bytes);
+
+	malloc_stats_alloc(ptr, bytes, (ulong)__builtin_return_address(0));
+
+	return ptr;
+}
+#endif
@@ -0,0 +1,189 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * malloc() implementation using the TLSF allocator
+ *
+ * This provides the same functions as dlmalloc.c, so either can be used. Before
+ * relocation the simple allocator in malloc_simple.c is used as with dlmalloc,
+ * since those allocations are never freed.
+ */
+
+#define LOG_CATEGORY LOGC_ALLOC
+
+#include <common.h>
+#include <log.h>
+#include <malloc.h>
+#include <malloc_stats.h>
+#include <tlsf.h>
+#include <asm/global_data.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+ulong mem_malloc_start;
+ulong mem_malloc_end;
+ulong mem_malloc_brk;
+
+static struct tlsf *pool;
+
+void mem_malloc_init(ulong start, ulong size)
+{
+	mem_malloc_start = start;
+	mem_malloc_end = start + size;
+
+	/* The whole region belongs to the pool from the start */
+	mem_malloc_brk = mem_malloc_end;
+
+	debug("using memory %#lx-%#lx for malloc()\n", mem_malloc_start,
+	      mem_malloc_end);
+#ifdef CONFIG_SYS_MALLOC_CLEAR_ON_INIT
+	memset((void *)mem_malloc_start, 0x0, size);
+#endif
+	pool = tlsf_create((void *)start, size);
+	if (!pool)
+		log_err("malloc() region too small\n");
+	malloc_stats_init();
+}
+
+Void_t *mALLOc(size_t bytes)
+{
+#if CONFIG_VAL(SYS_MALLOC_F_LEN)
+	if (!(gd->flags & GD_FLG_FULL_MALLOC_INIT))
+		return malloc_simple(bytes);
+#endif
+	if (!pool)
+		return NULL;
+
+	return tlsf_malloc(pool, bytes);
+}
+
+void fREe(Void_t *mem)
+{
+#if CONFIG_VAL(SYS_MALLOC_F_LEN)
+	/* free() is a no-op - all the memory will be freed on relocation */
+	if (!(gd->flags & GD_FLG_FULL_MALLOC_INIT))
+		return;
+#endif
+	/* Ignore memory which came from the pre-relocation pool */
+	if (!mem || !pool || !tlsf_contains(pool, mem))
+		return;
+
+	tlsf_free(pool, mem);
+}
+
+Void_t *rEALLOc(Void_t *oldmem, size_t bytes)
+{
+	if (!oldmem)
+		return mALLOc(bytes);
+#if CONFIG_VAL(SYS_MALLOC_F_LEN)
+	if (!(gd->flags & GD_FLG_FULL_MALLOC_INIT)) {
+		/* This is harder to support and should not be needed */
+		panic("pre-reloc realloc() is not supported");
+	}
+#endif
+	if (!pool)
+		return NULL;
+
+	return tlsf_realloc(pool, oldmem, bytes);
+}
+
+Void_t *mEMALIGn(size_t alignment, size_t bytes)
+{
+#if CONFIG_VAL(SYS_MALLOC_F_LEN)
+	if (!(gd->flags & GD_FLG_FULL_MALLOC_INIT))
+		return memalign_simple(alignment, bytes);
+#endif
+	if (!pool)
+		return NULL;
+
+	return tlsf_memalign(pool, alignment, bytes);
+}
+
+Void_t *vALLOc(size_t bytes)
+{
+	return mEMALIGn(malloc_getpagesize, bytes);
+}
+
+Void_t *pvALLOc(size_t bytes)
+{
+	return mEMALIGn(malloc_getpagesize, ALIGN(bytes, malloc_getpagesize));
+}
+
+Void_t *cALLOc(size_t n, size_t elem_size)
+{
+	size_t size;
+	void *mem;
+
+	if (__builtin_mul_overflow(n, elem_size, &size))
+		return NULL;
+	mem = mALLOc(size);
+	if (mem)
+		memset(mem, '\0', size);
+
+	return mem;
+}
+
+void cfree(Void_t *mem)
+{
+	fREe(mem);
+}
+
+int malloc_trim(size_t pad)
+{
+	/* All the memory belongs to the pool, so there is nothing to give back */
+	return 0;
+}
+
+size_t malloc_usable_size(Void_t *mem)
+{
+	if (!mem || !pool || !tlsf_contains(pool, mem))
+		return 0;
+
+	return tlsf_usable_size(mem);
+}
+
+void malloc_stats(void)
+{
+	struct tlsf_info info;
+
+	if (!pool)
+		return;
+	tlsf_get_info(pool, &info);
+	printf("max system bytes = %10lu\n", (ulong)info.max_used);
+	printf("system bytes     = %10lu\n", (ulong)info.total);
+	printf("in use bytes     = %10lu\n", (ulong)info.used);
+	printf("free blocks      = %10u\n", info.free_blocks);
+	printf("largest free     = %10lu\n", (ulong)info.largest_free);
+}
+
+struct mallinfo mALLINFo(void)
+{
+	struct mallinfo mi = {};
+	struct tlsf_info info;
+
+	if (!pool)
+		return mi;
+	tlsf_get_info(pool, &info);
+	mi.arena = info.total;
+	mi.ordblks = info.free_blocks;
+	mi.usmblks = info.max_used;
+	mi.uordblks = info.used;
+	mi.fordblks = info.total - info.used;
+
+	return mi;
+}
+
+int mALLOPt(int param_number, int value)
+{
+	/* There are no tunable parameters */
+	return 0;
+}
+
+int initf_malloc(void)
+{
+#if CONFIG_VAL(SYS_MALLOC_F_LEN)
+	assert(gd->malloc_base);	/* Set up by crt0.S */
+	gd->malloc_limit = CONFIG_VAL(SYS_MALLOC_F_LEN);
+	gd->malloc_ptr = 0;
+#endif
+
+	return 0;
+}
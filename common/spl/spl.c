@@ -25,6 +25,7 @@
 #include <version.h>
 #include <image.h>
 #include <malloc.h>
+#include <malloc_stats.h>
 #include <mapmem.h>
 #include <dm/root.h>
 #include <linux/compiler.h>
@@ -393,6 +394,9 @@ static int spl_common_init(bool setup_malloc)
 #endif
 		gd->malloc_limit = CONFIG_VAL(SYS_MALLOC_F_LEN);
 		gd->malloc_ptr = 0;
+#if CONFIG_IS_ENABLED(MALLOC_STATS)
+		gd->malloc_usage = NULL;
+#endif
 	}
 #endif
 	ret = bootstage_init(u_boot_first_phase());
@@ -671,6 +675,13 @@ void board_init_r(gd_t *dummy1, ulong dummy2)
 			printf(SPL_TPL_PROMPT
 			       "SPL hand-off write failed (err=%d)\n", ret);
 	}
+	if (CONFIG_IS_ENABLED(MALLOC_STATS)) {
+		ret = malloc_stats_write_handoff();
+		if (ret)
+			printf(SPL_TPL_PROMPT
+			       "Cannot write malloc() statistics (err=%d)\n",
+			       ret);
+	}
 	if (CONFIG_IS_ENABLED(BLOBLIST)) {
 		ret = bloblist_finish();
 		if (ret)
@@ -811,6 +822,7 @@ ulong spl_relocate_stack_gd(void)
 	if (CONFIG_SPL_STACK_R_MALLOC_SIMPLE_LEN) {
 		debug("SPL malloc() before relocation used 0x%lx bytes (%ld KB)\n",
 		      gd->malloc_ptr, gd->malloc_ptr / 1024);
+		malloc_stats_new_f_pool();
 		ptr -= CONFIG_SPL_STACK_R_MALLOC_SIMPLE_LEN;
 		gd->malloc_base = ptr;
 		gd->malloc_limit = CONFIG_SPL_STACK_R_MALLOC_SIMPLE_LEN;
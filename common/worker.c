@@ -0,0 +1,210 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Running jobs on secondary CPU cores
+ *
+ * Jobs are put in a small fixed-size queue. Each slot holds a pointer to a job
+ * and a core claims a job by swapping the pointer for NULL, so no lock is
+ * needed. Idle cores wait with arch_worker_idle() and are woken by
+ * arch_worker_kick() when a job is queued.
+ */
+
+#define LOG_CATEGORY LOGC_BOOT
+
+#include <common.h>
+#include <hang.h>
+#include <log.h>
+#include <time.h>
+#include <watchdog.h>
+#include <worker.h>
+#include <asm/global_data.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/* Number of jobs which can be queued before worker_submit() runs them */
+#define WORKER_QUEUE_LEN	32
+
+/* Time allowed for the workers to finish their jobs and stop */
+#define WORKER_STOP_TIMEOUT_MS	1000
+
+static struct worker_job *worker_queue[WORKER_QUEUE_LEN];
+
+/* Number of workers started, 0 if jobs run on the boot CPU */
+static uint worker_num;
+
+/* Number of workers which have not yet stopped */
+static uint worker_active;
+
+/* Set to tell the workers to stop, left set if they do not */
+static bool worker_stopping;
+
+/* Set once the workers have been started (or could not be), or stopped */
+static bool worker_inited;
+
+/* Take the next job from the queue, or return NULL if there is none */
+static struct worker_job *worker_take(void)
+{
+	struct worker_job *job;
+	int i;
+
+	for (i = 0; i < WORKER_QUEUE_LEN; i++) {
+		job = __atomic_load_n(&worker_queue[i], __ATOMIC_ACQUIRE);
+		if (job && __atomic_compare_exchange_n(&worker_queue[i], &job,
+						       NULL, false,
+						       __ATOMIC_ACQ_REL,
+						       __ATOMIC_RELAXED))
+			return job;
+	}
+
+	return NULL;
+}
+
+static void worker_run(struct worker_job *job, uint cpu)
+{
+	job->ret = job->func(job->ctx);
+	job->cpu = cpu;
+	__atomic_store_n(&job->done, true, __ATOMIC_RELEASE);
+}
+
+/* Main loop of each secondary core */
+static void worker_main(uint id)
+{
+	struct worker_job *job;
+
+	while (!__atomic_load_n(&worker_stopping, __ATOMIC_ACQUIRE)) {
+		job = worker_take();
+		if (job)
+			worker_run(job, id);
+		else
+			arch_worker_idle();
+	}
+	__atomic_sub_fetch(&worker_active, 1, __ATOMIC_RELEASE);
+	arch_worker_exit();
+}
+
+int worker_init(void)
+{
+	int ret;
+
+	/* The workers would be left running the old copy of U-Boot */
+	if (worker_num || worker_stopping || !(gd->flags & GD_FLG_RELOC))
+		return worker_num;
+	worker_inited = true;
+
+	ret = arch_worker_start(CONFIG_WORKER_MAX, worker_main);
+	if (ret < 0) {
+		log_warning("Cannot start workers (err=%d)\n", ret);
+		return 0;
+	}
+	worker_num = ret;
+	__atomic_store_n(&worker_active, worker_num, __ATOMIC_RELEASE);
+	log_debug("%u workers\n", worker_num);
+
+	return worker_num;
+}
+
+int worker_stop(void)
+{
+	struct worker_job *job;
+	ulong start;
+
+	if (worker_num) {
+		__atomic_store_n(&worker_stopping, true, __ATOMIC_RELEASE);
+		arch_worker_kick();
+		start = get_timer(0);
+		while (__atomic_load_n(&worker_active, __ATOMIC_ACQUIRE)) {
+			if (get_timer(start) > WORKER_STOP_TIMEOUT_MS) {
+				log_err("%u workers did not stop\n",
+					worker_active);
+				return -ETIMEDOUT;
+			}
+			WATCHDOG_RESET();
+		}
+		arch_worker_stop();
+		worker_num = 0;
+		worker_stopping = false;
+	}
+
+	/* Nothing can be left running once the OS is started */
+	while ((job = worker_take()))
+		worker_run(job, 0);
+
+	return 0;
+}
+
+uint worker_count(void)
+{
+	return worker_num;
+}
+
+uint worker_self(void)
+{
+	return worker_num ? arch_worker_self() : 0;
+}
+
+void worker_submit(struct worker_job *job, worker_func func, void *ctx)
+{
+	struct worker_job *empty;
+	int i;
+
+	job->func = func;
+	job->ctx = ctx;
+	job->ret = 0;
+	job->cpu = 0;
+	job->done = false;
+	if (!worker_inited)
+		worker_init();
+
+	for (i = 0; worker_num && i < WORKER_QUEUE_LEN; i++) {
+		empty = NULL;
+		if (__atomic_compare_exchange_n(&worker_queue[i], &empty, job,
+						false, __ATOMIC_RELEASE,
+						__ATOMIC_RELAXED)) {
+			arch_worker_kick();
+			return;
+		}
+	}
+
+	worker_run(job, 0);
+}
+
+int worker_wait(struct worker_job *job)
+{
+	struct worker_job *other;
+
+	while (!__atomic_load_n(&job->done, __ATOMIC_ACQUIRE)) {
+		other = worker_take();
+		if (other)
+			worker_run(other, worker_self());
+		else
+			WATCHDOG_RESET();
+	}
+
+	return job->ret;
+}
+
+__weak int arch_worker_start(uint max, void (*entry)(uint id))
+{
+	return 0;
+}
+
+__weak uint arch_worker_self(void)
+{
+	return 0;
+}
+
+__weak void arch_worker_idle(void)
+{
+}
+
+__weak void arch_worker_kick(void)
+{
+}
+
+__weak void arch_worker_exit(void)
+{
+	hang();
+}
+
+__weak void arch_worker_stop(void)
+{
+}
@@ -239,6 +239,7 @@ void part_init(struct blk_desc *dev_desc)
 	struct part_driver *entry;
 
 	blkcache_invalidate(dev_desc->if_type, dev_desc->devnum);
+	part_cache_drop(dev_desc);
 
 	dev_desc->part_type = PART_TYPE_UNKNOWN;
 	for (entry = drv; entry != drv + n_ents; entry++) {
@@ -253,6 +254,54 @@ void part_init(struct blk_desc *dev_desc)
 	}
 }
 
+#if CONFIG_IS_ENABLED(PARTITION_CACHE)
+struct part_cache *part_cache_get(struct blk_desc *desc, int part_type)
+{
+	struct part_cache *cache = desc->part_cache;
+
+	if (!cache || cache->part_type != part_type ||
+	    cache->hwpart != desc->hwpart)
+		return NULL;
+
+	return cache;
+}
+
+struct part_cache *part_cache_new(struct blk_desc *desc, int part_type,
+				  lbaint_t first_lba, lbaint_t last_lba,
+				  size_t size)
+{
+	struct part_cache *cache;
+
+	part_cache_drop(desc);
+	cache = malloc(sizeof(*cache) + size);
+	if (!cache)
+		return NULL;
+	cache->part_type = part_type;
+	cache->hwpart = desc->hwpart;
+	cache->first_lba = first_lba;
+	cache->last_lba = last_lba;
+	cache->size = size;
+	desc->part_cache = cache;
+
+	return cache;
+}
+
+void part_cache_drop(struct blk_desc *desc)
+{
+	free(desc->part_cache);
+	desc->part_cache = NULL;
+}
+
+void part_cache_write(struct blk_desc *desc, lbaint_t start, lbaint_t blkcnt)
+{
+	struct part_cache *cache = desc->part_cache;
+
+	if (cache && (start < cache->first_lba ||
+		      start + blkcnt - 1 > cache->last_lba))
+		part_cache_drop(desc);
+}
+#endif
+
 static void print_part_header(const char *type, struct blk_desc *dev_desc)
 {
 #if CONFIG_IS_ENABLED(MAC_PARTITION) || \
@@ -993,8 +993,22 @@ static int is_gpt_valid(struct blk_desc *dev_desc, u64 lba,
 static int find_valid_gpt(struct blk_desc *dev_desc, gpt_header *gpt_head,
 			  gpt_entry **pgpt_pte)
 {
+	struct part_cache *cache;
+	size_t count;
 	int r;
 
+	cache = part_cache_get(dev_desc, PART_TYPE_EFI);
+	if (cache) {
+		count = cache->size - sizeof(gpt_header);
+		*pgpt_pte = malloc(count);
+		if (*pgpt_pte) {
+			memcpy(gpt_head, cache->data, sizeof(gpt_header));
+			memcpy(*pgpt_pte, cache->data + sizeof(gpt_header),
+			       count);
+			return 1;
+		}
+	}
+
 	r = is_gpt_valid(dev_desc, GPT_PRIMARY_PARTITION_TABLE_LBA, gpt_head,
 			 pgpt_pte);
 
@@ -1012,6 +1026,19 @@ static int find_valid_gpt(struct blk_desc *dev_desc, gpt_header *gpt_head,
 			printf("%s: ***        Using Backup GPT ***\n",
 			       __func__);
 	}
+
+	/* Keep the table so that it need not be read for each partition */
+	count = le32_to_cpu(gpt_head->num_partition_entries) *
+		le32_to_cpu(gpt_head->sizeof_partition_entry);
+	cache = part_cache_new(dev_desc, PART_TYPE_EFI,
+			       le64_to_cpu(gpt_head->first_usable_lba),
+			       le64_to_cpu(gpt_head->last_usable_lba),
+			       sizeof(gpt_header) + count);
+	if (cache) {
+		memcpy(cache->data, gpt_head, sizeof(gpt_header));
+		memcpy(cache->data + sizeof(gpt_header), *pgpt_pte, count);
+	}
+
 	return 1;
 }
 
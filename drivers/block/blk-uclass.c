@@ -463,6 +463,7 @@ unsigned long blk_dwrite(struct blk_desc *block_dev, lbaint_t start,
 		return -ENOSYS;
 
 	blkcache_invalidate(block_dev->if_type, block_dev->devnum);
+	part_cache_write(block_dev, start, blkcnt);
 	return ops->write(dev, start, blkcnt, buffer);
 }
 
@@ -476,6 +477,7 @@ unsigned long blk_derase(struct blk_desc *block_dev, lbaint_t start,
 		return -ENOSYS;
 
 	blkcache_invalidate(block_dev->if_type, block_dev->devnum);
+	part_cache_write(block_dev, start, blkcnt);
 	return ops->erase(dev, start, blkcnt);
 }
 
@@ -656,9 +658,19 @@ static int blk_post_probe(struct udevice *dev)
 	return 0;
 }
 
+static int blk_pre_unbind(struct udevice *dev)
+{
+	struct blk_desc *desc = dev_get_uclass_platdata(dev);
+
+	part_cache_drop(desc);
+
+	return 0;
+}
+
 UCLASS_DRIVER(blk) = {
 	.id		= UCLASS_BLK,
 	.name		= "blk",
 	.post_probe	= blk_post_probe,
+	.pre_unbind	= blk_pre_unbind,
 	.per_device_platdata_auto_alloc_size = sizeof(struct blk_desc),
 };
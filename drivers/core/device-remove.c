@@ -14,6 +14,7 @@
 #include <malloc.h>
 #include <dm/device.h>
 #include <dm/device-internal.h>
+#include <dm/lists.h>
 #include <dm/uclass.h>
 #include <dm/uclass-internal.h>
 #include <dm/util.h>
@@ -26,6 +27,7 @@ int device_chld_unbind(struct udevice *dev, struct driver *drv)
 
 	assert(dev);
 
+	dm_lazy_forget(dev, drv);
 	list_for_each_entry_safe(pos, n, &dev->child_head, sibling_node) {
 		if (drv && (pos->driver != drv))
 			continue;
@@ -172,9 +174,13 @@ int device_remove(struct udevice *dev, uint flags)
 	drv = dev->driver;
 	assert(drv);
 
-	ret = uclass_pre_remove_device(dev);
-	if (ret)
-		return ret;
+	/* If the probe has not finished, post_probe() has not been called */
+	if (!(dev->flags & DM_FLAG_PROBE_PENDING)) {
+		ret = uclass_pre_remove_device(dev);
+		if (ret)
+			return ret;
+	}
+	device_probe_cancel(dev);
 
 	ret = device_chld_remove(dev, NULL, flags);
 	if (ret)
@@ -208,6 +214,7 @@ int device_remove(struct udevice *dev, uint flags)
 		device_free(dev);
 
 		dev->seq = -1;
+		uclass_index_update(dev);
 		dev->flags &= ~DM_FLAG_ACTIVATED;
 	}
 
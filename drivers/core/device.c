@@ -9,6 +9,7 @@
  */
 
 #include <common.h>
+#include <bootstage.h>
 #include <cpu_func.h>
 #include <log.h>
 #include <asm/io.h>
@@ -40,6 +41,7 @@ static int device_bind_common(struct udevice *parent, const struct driver *drv,
 {
 	struct udevice *dev;
 	struct uclass *uc;
+	ulong start_us = 0;
 	int size, ret = 0;
 
 	if (devp)
@@ -47,7 +49,11 @@ static int device_bind_common(struct udevice *parent, const struct driver *drv,
 	if (!name)
 		return -EINVAL;
 
-	ret = uclass_get(drv->id, &uc);
+	/* Reading the time may need a timer device, so timers are not timed */
+	if (drv->id != UCLASS_TIMER)
+		start_us = bootstage_span_start();
+
+	ret = uclass_find_or_add(drv->id, &uc);
 	if (ret) {
 		debug("Missing uclass for driver %s\n", drv->name);
 		return ret;
@@ -177,6 +183,8 @@ static int device_bind_common(struct udevice *parent, const struct driver *drv,
 		*devp = dev;
 
 	dev->flags |= DM_FLAG_BOUND;
+	if (drv->id != UCLASS_TIMER)
+		bootstage_span(start_us, "bind %s", dev->name);
 
 	return 0;
 
@@ -251,26 +259,37 @@ int device_bind_ofnode(struct udevice *parent, const struct driver *drv,
 int device_bind_by_name(struct udevice *parent, bool pre_reloc_only,
 			const struct driver_info *info, struct udevice **devp)
 {
-	struct driver *drv;
+	const struct driver *drv = NULL;
 	uint platdata_size = 0;
+	struct udevice *dev;
 	int ret;
 
-	drv = lists_driver_lookup_name(info->name);
+#if CONFIG_IS_ENABLED(OF_PLATDATA)
+	drv = info->drv;
+	platdata_size = info->platdata_size;
+#endif
+	if (!drv)
+		drv = lists_driver_lookup_name(info->name);
 	if (!drv)
 		return -ENOENT;
 	if (pre_reloc_only && !(drv->flags & DM_FLAG_PRE_RELOC))
 		return -EPERM;
 
-#if CONFIG_IS_ENABLED(OF_PLATDATA)
-	platdata_size = info->platdata_size;
-#endif
 	ret = device_bind_common(parent, drv, info->name,
 				 (void *)info->platdata, 0, ofnode_null(),
-				 platdata_size, devp);
+				 platdata_size, &dev);
 	if (ret)
 		return ret;
 
-	return ret;
+	/* Use the sequence number which dtoc found in the aliases */
+	if (CONFIG_IS_ENABLED(DM_SEQ_ALIAS) &&
+	    driver_info_req_seq(info) != -1 &&
+	    (dev->uclass->uc_drv->flags & DM_UC_FLAG_SEQ_ALIAS))
+		dev->req_seq = driver_info_req_seq(info);
+	if (devp)
+		*devp = dev;
+
+	return 0;
 }
 
 int device_reparent(struct udevice *dev, struct udevice *new_parent)
@@ -421,17 +440,30 @@ fail:
 	return ret;
 }
 
-int device_probe(struct udevice *dev)
+/**
+ * device_do_probe() - Probe a device
+ *
+ * @dev: Device to probe
+ * @nowait: true to return while a probe deferred by the driver (see
+ *	device_probe_defer()) is still finishing in the background, false to
+ *	wait for it
+ * @return 0 if OK, -ve on error
+ */
+static int device_do_probe(struct udevice *dev, bool nowait)
 {
 	const struct driver *drv;
+	ulong start_us = 0;
 	int ret;
 	int seq;
 
 	if (!dev)
 		return -EINVAL;
 
-	if (dev->flags & DM_FLAG_ACTIVATED)
+	if (dev->flags & DM_FLAG_ACTIVATED) {
+		if (!nowait && (dev->flags & DM_FLAG_PROBE_PENDING))
+			return device_probe_wait(dev);
 		return 0;
+	}
 
 	drv = dev->driver;
 	assert(drv);
@@ -453,7 +485,7 @@ int device_probe(struct udevice *dev)
 		 * so that we don't mess up the device.
 		 */
 		if (dev->flags & DM_FLAG_ACTIVATED)
-			return 0;
+			return device_do_probe(dev, nowait);
 	}
 
 	seq = uclass_resolve_seq(dev);
@@ -462,8 +494,11 @@ int device_probe(struct udevice *dev)
 		goto fail;
 	}
 	dev->seq = seq;
+	uclass_index_update(dev);
 
 	dev->flags |= DM_FLAG_ACTIVATED;
+	if (drv->id != UCLASS_TIMER)
+		start_us = bootstage_span_start();
 
 	/*
 	 * Process pinctrl for everything except the root device, and
@@ -509,12 +544,19 @@ int device_probe(struct udevice *dev)
 			goto fail;
 	}
 
+	/* The rest is done when the probe finishes, see device_probe_defer() */
+	if (CONFIG_IS_ENABLED(DM_ASYNC_PROBE) &&
+	    (dev->flags & DM_FLAG_PROBE_PENDING))
+		return nowait ? 0 : device_probe_wait(dev);
+
 	ret = uclass_post_probe_device(dev);
 	if (ret)
 		goto fail_uclass;
 
 	if (dev->parent && device_get_uclass_id(dev) == UCLASS_PINCTRL)
 		pinctrl_select_state(dev, "default");
+	if (drv->id != UCLASS_TIMER)
+		bootstage_span(start_us, "probe %s", dev->name);
 
 	return 0;
 fail_uclass:
@@ -526,11 +568,24 @@ fail:
 	dev->flags &= ~DM_FLAG_ACTIVATED;
 
 	dev->seq = -1;
+	uclass_index_update(dev);
 	device_free(dev);
 
 	return ret;
 }
 
+int device_probe(struct udevice *dev)
+{
+	return device_do_probe(dev, false);
+}
+
+#if CONFIG_IS_ENABLED(DM_ASYNC_PROBE)
+int device_probe_nowait(struct udevice *dev)
+{
+	return device_do_probe(dev, true);
+}
+#endif
+
 void *dev_get_platdata(const struct udevice *dev)
 {
 	if (!dev) {
@@ -640,6 +695,7 @@ int device_get_child(const struct udevice *parent, int index,
 {
 	struct udevice *dev;
 
+	dm_lazy_bind_children(parent);
 	list_for_each_entry(dev, &parent->child_head, sibling_node) {
 		if (!index--)
 			return device_get_device_tail(dev, 0, devp);
@@ -653,6 +709,7 @@ int device_get_child_count(const struct udevice *parent)
 	struct udevice *dev;
 	int count = 0;
 
+	dm_lazy_bind_children(parent);
 	list_for_each_entry(dev, &parent->child_head, sibling_node)
 		count++;
 
@@ -667,6 +724,7 @@ int device_find_child_by_seq(const struct udevice *parent, int seq_or_req_seq,
 	*devp = NULL;
 	if (seq_or_req_seq == -1)
 		return -ENODEV;
+	dm_lazy_bind_children(parent);
 
 	list_for_each_entry(dev, &parent->child_head, sibling_node) {
 		if ((find_req_seq ? dev->req_seq : dev->seq) ==
@@ -704,6 +762,7 @@ int device_find_child_by_of_offset(const struct udevice *parent, int of_offset,
 
 	*devp = NULL;
 
+	dm_lazy_bind_children(parent);
 	list_for_each_entry(dev, &parent->child_head, sibling_node) {
 		if (dev_of_offset(dev) == of_offset) {
 			*devp = dev;
@@ -733,6 +792,7 @@ static struct udevice *_device_find_global_by_ofnode(struct udevice *parent,
 	if (ofnode_equal(dev_ofnode(parent), ofnode))
 		return parent;
 
+	dm_lazy_bind_children(parent);
 	list_for_each_entry(dev, &parent->child_head, sibling_node) {
 		found = _device_find_global_by_ofnode(dev, ofnode);
 		if (found)
@@ -787,6 +847,7 @@ int device_get_by_driver_info_idx(uint idx, struct udevice **devp)
 
 int device_find_first_child(const struct udevice *parent, struct udevice **devp)
 {
+	dm_lazy_bind_children(parent);
 	if (list_empty(&parent->child_head)) {
 		*devp = NULL;
 	} else {
@@ -819,8 +880,9 @@ int device_find_first_inactive_child(const struct udevice *parent,
 	struct udevice *dev;
 
 	*devp = NULL;
+	dm_lazy_bind_children(parent);
 	list_for_each_entry(dev, &parent->child_head, sibling_node) {
-		if (!device_active(dev) &&
+		if (!(dev->flags & DM_FLAG_ACTIVATED) &&
 		    device_get_uclass_id(dev) == uclass_id) {
 			*devp = dev;
 			return 0;
@@ -837,6 +899,7 @@ int device_find_first_child_by_uclass(const struct udevice *parent,
 	struct udevice *dev;
 
 	*devp = NULL;
+	dm_lazy_bind_children(parent);
 	list_for_each_entry(dev, &parent->child_head, sibling_node) {
 		if (device_get_uclass_id(dev) == uclass_id) {
 			*devp = dev;
@@ -854,6 +917,7 @@ int device_find_child_by_name(const struct udevice *parent, const char *name,
 
 	*devp = NULL;
 
+	dm_lazy_bind_children(parent);
 	list_for_each_entry(dev, &parent->child_head, sibling_node) {
 		if (!strcmp(dev->name, name)) {
 			*devp = dev;
@@ -955,6 +1019,7 @@ const char *dev_get_uclass_name(const struct udevice *dev)
 
 bool device_has_children(const struct udevice *dev)
 {
+	dm_lazy_bind_children(dev);
 	return !list_empty(&dev->child_head);
 }
 
@@ -965,7 +1030,7 @@ bool device_has_active_children(const struct udevice *dev)
 	for (device_find_first_child(dev, &child);
 	     child;
 	     device_find_next_child(&child)) {
-		if (device_active(child))
+		if (child->flags & DM_FLAG_ACTIVATED)
 			return true;
 	}
 
@@ -993,10 +1058,17 @@ int device_set_name(struct udevice *dev, const char *name)
 		return -ENOMEM;
 	dev->name = name;
 	device_set_name_alloced(dev);
+	uclass_index_update(dev);
 
 	return 0;
 }
 
+void dev_set_ofnode(struct udevice *dev, ofnode node)
+{
+	dev->node = node;
+	uclass_index_update(dev);
+}
+
 #if CONFIG_IS_ENABLED(OF_CONTROL) && !CONFIG_IS_ENABLED(OF_PLATDATA)
 bool device_is_compatible(const struct udevice *dev, const char *compat)
 {
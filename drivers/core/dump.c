@@ -6,6 +6,7 @@
 #include <common.h>
 #include <dm.h>
 #include <mapmem.h>
+#include <dm/lists.h>
 #include <dm/root.h>
 #include <dm/util.h>
 #include <dm/uclass-internal.h>
@@ -47,6 +48,7 @@ void dm_dump_all(void)
 {
 	struct udevice *root;
 
+	dm_lazy_bind_all();
 	root = dm_root();
 	if (root) {
 		printf(" Class     Index  Probed  Driver                Name\n");
@@ -97,6 +99,38 @@ void dm_dump_uclass(void)
 	}
 }
 
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX)
+void dm_dump_stats(void)
+{
+	ulong lookups[UCLASS_INDEX_COUNT] = { 0 };
+	ulong compares[UCLASS_INDEX_COUNT] = { 0 };
+	struct uclass_index *idx;
+	struct uclass *uc;
+	int id, key;
+
+	puts("Uclass           Devs  Buckets   seq lookups/compares  name lookups/compares  node lookups/compares\n");
+	for (id = 0; id < UCLASS_COUNT; id++) {
+		uc = uclass_find(id);
+		if (!uc)
+			continue;
+		idx = &uc->index;
+		printf("%-15.15s %5d %8d", uc->uc_drv->name, idx->dev_count,
+		       idx->bits ? 1 << idx->bits : 0);
+		for (key = 0; key < UCLASS_INDEX_COUNT; key++) {
+			printf("  %10lu/%-10lu", idx->lookups[key],
+			       idx->compares[key]);
+			lookups[key] += idx->lookups[key];
+			compares[key] += idx->compares[key];
+		}
+		puts("\n");
+	}
+	printf("%-15s %5s %8s", "Total", "", "");
+	for (key = 0; key < UCLASS_INDEX_COUNT; key++)
+		printf("  %10lu/%-10lu", lookups[key], compares[key]);
+	puts("\n");
+}
+#endif
+
 void dm_dump_driver_compat(void)
 {
 	struct driver *d = ll_entry_start(struct driver, driver);
@@ -11,6 +11,7 @@
 #include <common.h>
 #include <errno.h>
 #include <log.h>
+#include <malloc.h>
 #include <dm/device.h>
 #include <dm/device-internal.h>
 #include <dm/lists.h>
@@ -19,6 +20,10 @@
 #include <dm/util.h>
 #include <fdtdec.h>
 #include <linux/compiler.h>
+#include <sort.h>
+#include <linux/kernel.h>
+
+DECLARE_GLOBAL_DATA_PTR;
 
 struct driver *lists_driver_lookup_name(const char *name)
 {
@@ -51,79 +56,86 @@ struct uclass_driver *lists_uclass_lookup(enum uclass_id id)
 	return NULL;
 }
 
-static int bind_drivers_pass(struct udevice *parent, bool pre_reloc_only)
+/**
+ * bind_driver_info() - bind the device for a driver_info record
+ *
+ * For of-platdata, the parent is bound first if needed, so that devices can
+ * be bound in a single pass whatever their order in the linker list.
+ *
+ * @parent: parent device to use if the record does not give one
+ * @idx: index of the record in the driver_info linker list
+ * @pre_reloc_only: If true, bind only drivers with the DM_FLAG_PRE_RELOC flag.
+ * @return 0 if OK, -EPERM if the device (or its parent) should not be bound
+ *	at this stage, other -ve value on error
+ */
+static int bind_driver_info(struct udevice *parent, uint idx,
+			    bool pre_reloc_only)
 {
 	struct driver_info *info =
 		ll_entry_start(struct driver_info, driver_info);
-	const int n_ents = ll_entry_count(struct driver_info, driver_info);
-	bool missing_parent = false;
-	int result = 0;
-	uint idx;
-
-	/*
-	 * Do one iteration through the driver_info records. For of-platdata,
-	 * bind only devices whose parent is already bound. If we find any
-	 * device we can't bind, set missing_parent to true, which will cause
-	 * this function to be called again.
-	 */
-	for (idx = 0; idx < n_ents; idx++) {
-		struct udevice *par = parent;
-		const struct driver_info *entry = info + idx;
-		struct driver_rt *drt = gd_dm_driver_rt() + idx;
-		struct udevice *dev;
-		int ret;
+	const struct driver_info *entry = info + idx;
+	struct driver_rt *drt = gd_dm_driver_rt() + idx;
+	struct udevice *par = parent;
+	struct udevice *dev;
+	int ret;
 
-		if (CONFIG_IS_ENABLED(OF_PLATDATA)) {
-			int parent_idx = driver_info_parent_id(entry);
+	if (CONFIG_IS_ENABLED(OF_PLATDATA)) {
+		int parent_idx = driver_info_parent_id(entry);
 
-			if (drt->dev)
-				continue;
+		if (drt->dev)
+			return 0;
 
-			if (CONFIG_IS_ENABLED(OF_PLATDATA_PARENT) &&
-			    parent_idx != -1) {
-				struct driver_rt *parent_drt;
+		if (CONFIG_IS_ENABLED(OF_PLATDATA_PARENT) &&
+		    parent_idx != -1) {
+			struct driver_rt *parent_drt;
 
-				parent_drt = gd_dm_driver_rt() + parent_idx;
-				if (!parent_drt->dev) {
-					missing_parent = true;
-					continue;
-				}
+			/* Any error is reported when the parent's turn comes */
+			bind_driver_info(parent, parent_idx, pre_reloc_only);
+			parent_drt = gd_dm_driver_rt() + parent_idx;
+			if (!parent_drt->dev)
+				return -EPERM;
 
-				par = parent_drt->dev;
-			}
-		}
-		ret = device_bind_by_name(par, pre_reloc_only, entry, &dev);
-		if (!ret) {
-			if (CONFIG_IS_ENABLED(OF_PLATDATA))
-				drt->dev = dev;
-		} else if (ret != -EPERM) {
-			dm_warn("No match for driver '%s'\n", entry->name);
-			if (!result || ret != -ENOENT)
-				result = ret;
+			par = parent_drt->dev;
 		}
 	}
+	ret = device_bind_by_name(par, pre_reloc_only, entry, &dev);
+	if (ret)
+		return ret;
+	if (CONFIG_IS_ENABLED(OF_PLATDATA))
+		drt->dev = dev;
 
-	return result ? result : missing_parent ? -EAGAIN : 0;
+	return 0;
 }
 
 int lists_bind_drivers(struct udevice *parent, bool pre_reloc_only)
 {
+	struct driver_info *info =
+		ll_entry_start(struct driver_info, driver_info);
+	const int n_ents = ll_entry_count(struct driver_info, driver_info);
 	int result = 0;
-	int pass;
+	uint idx;
 
 	/*
-	 * 10 passes is 10 levels deep in the devicetree, which is plenty. If
-	 * OF_PLATDATA_PARENT is not enabled, then bind_drivers_pass() will
-	 * always succeed on the first pass.
+	 * Bind devices which have an alias first, so that devices without one
+	 * are numbered after them and do not take their sequence numbers.
 	 */
-	for (pass = 0; pass < 10; pass++) {
+	if (CONFIG_IS_ENABLED(OF_PLATDATA)) {
+		for (idx = 0; idx < n_ents; idx++) {
+			/* Any error is reported in the loop below */
+			if (driver_info_req_seq(&info[idx]) != -1)
+				bind_driver_info(parent, idx, pre_reloc_only);
+		}
+	}
+
+	for (idx = 0; idx < n_ents; idx++) {
 		int ret;
 
-		ret = bind_drivers_pass(parent, pre_reloc_only);
-		if (!ret)
-			break;
-		if (ret != -EAGAIN && !result)
-			result = ret;
+		ret = bind_driver_info(parent, idx, pre_reloc_only);
+		if (ret && ret != -EPERM) {
+			dm_warn("No match for driver '%s'\n", info[idx].name);
+			if (!result || ret != -ENOENT)
+				result = ret;
+		}
 	}
 
 	return result;
@@ -181,11 +193,138 @@ static int driver_check_compatible(const struct udevice_id *of_match,
 	return -ENOENT;
 }
 
-int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp,
-		   bool pre_reloc_only)
+#if CONFIG_IS_ENABLED(DM_COMPAT_TABLE)
+/**
+ * struct lists_compat - an entry in the compatible-string table
+ *
+ * @compat: Compatible string
+ * @drv: Driver which has @compat in its of_match table
+ * @id: Entry in the of_match table of @drv
+ */
+struct lists_compat {
+	const char *compat;
+	struct driver *drv;
+	const struct udevice_id *id;
+};
+
+/* Table of all compatible strings, sorted by string, -ve count on error */
+static struct lists_compat *compat_table;
+static int compat_count;
+
+static int lists_compat_cmp(const void *a, const void *b)
+{
+	const struct lists_compat *ca = a, *cb = b;
+	int ret;
+
+	ret = strcmp(ca->compat, cb->compat);
+	if (ret)
+		return ret;
+
+	/* Keep linker-list order so that the first matching driver wins */
+	if (ca->drv != cb->drv)
+		return ca->drv < cb->drv ? -1 : 1;
+
+	return ca->id < cb->id ? -1 : ca->id > cb->id;
+}
+
+static int lists_compat_build(void)
 {
 	struct driver *driver = ll_entry_start(struct driver, driver);
 	const int n_ents = ll_entry_count(struct driver, driver);
+	const struct udevice_id *id;
+	struct lists_compat *ent;
+	struct driver *entry;
+	int count = 0;
+
+	for (entry = driver; entry != driver + n_ents; entry++) {
+		for (id = entry->of_match; id && id->compatible; id++)
+			count++;
+	}
+
+	compat_table = malloc(count * sizeof(*compat_table));
+	if (!compat_table) {
+		compat_count = -ENOMEM;
+		return -ENOMEM;
+	}
+
+	ent = compat_table;
+	for (entry = driver; entry != driver + n_ents; entry++) {
+		for (id = entry->of_match; id && id->compatible; id++) {
+			ent->compat = id->compatible;
+			ent->drv = entry;
+			ent->id = id;
+			ent++;
+		}
+	}
+	qsort(compat_table, count, sizeof(*compat_table), lists_compat_cmp);
+	compat_count = count;
+	log_debug("%d compatible strings\n", count);
+
+	return 0;
+}
+
+static struct driver *lists_compat_find(const char *compat,
+					const struct udevice_id **of_idp)
+{
+	int low = 0, high = compat_count;
+
+	/* Find the first entry which is not before @compat */
+	while (low < high) {
+		int mid = low + (high - low) / 2;
+
+		if (strcmp(compat_table[mid].compat, compat) < 0)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	if (low == compat_count || strcmp(compat_table[low].compat, compat))
+		return NULL;
+	*of_idp = compat_table[low].id;
+
+	return compat_table[low].drv;
+}
+
+/**
+ * lists_compat_ready() - check that the compatible-string table can be used
+ *
+ * The table is built on first use, once the full malloc() pool is available.
+ * Before that (and if it cannot be built) callers scan all drivers instead.
+ *
+ * @return true if the table can be used
+ */
+static bool lists_compat_ready(void)
+{
+	if (!(gd->flags & GD_FLG_FULL_MALLOC_INIT))
+		return false;
+	if (!compat_table && !compat_count)
+		lists_compat_build();
+
+	return compat_count > 0;
+}
+#endif /* DM_COMPAT_TABLE */
+
+struct driver *lists_driver_lookup_compatible(const char *compat,
+					      const struct udevice_id **of_idp)
+{
+	struct driver *driver = ll_entry_start(struct driver, driver);
+	const int n_ents = ll_entry_count(struct driver, driver);
+	struct driver *entry;
+
+#if CONFIG_IS_ENABLED(DM_COMPAT_TABLE)
+	if (lists_compat_ready())
+		return lists_compat_find(compat, of_idp);
+#endif
+	for (entry = driver; entry != driver + n_ents; entry++) {
+		if (!driver_check_compatible(entry->of_match, of_idp, compat))
+			return entry;
+	}
+
+	return NULL;
+}
+
+int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp,
+		   bool pre_reloc_only)
+{
 	const struct udevice_id *id;
 	struct driver *entry;
 	struct udevice *dev;
@@ -222,13 +361,8 @@ int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp,
 		log_debug("   - attempt to match compatible string '%s'\n",
 			  compat);
 
-		for (entry = driver; entry != driver + n_ents; entry++) {
-			ret = driver_check_compatible(entry->of_match, &id,
-						      compat);
-			if (!ret)
-				break;
-		}
-		if (entry == driver + n_ents)
+		entry = lists_driver_lookup_compatible(compat, &id);
+		if (!entry)
 			continue;
 
 		if (pre_reloc_only) {
@@ -265,4 +399,251 @@ int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp,
 
 	return result;
 }
+
+#if CONFIG_IS_ENABLED(DM_LAZY_BIND)
+/* Number of entries allocated at once in the lazy-bind list */
+#define DM_LAZY_BLOCK_ENTRIES	32
+
+/**
+ * struct dm_lazy_entry - a device tree node waiting to be bound
+ *
+ * @parent: Parent device for the new device
+ * @drv: Driver which matches the node, NULL once the entry is used
+ * @id: Entry in the driver's of_match table which matches the node
+ * @node: Device tree node
+ */
+struct dm_lazy_entry {
+	struct udevice *parent;
+	const struct driver *drv;
+	const struct udevice_id *id;
+	ofnode node;
+};
+
+/**
+ * struct dm_lazy_block - a block of entries in the lazy-bind list
+ *
+ * @next: Next block, or NULL if none
+ * @count: Number of entries used in this block
+ * @entry: Entries
+ */
+struct dm_lazy_block {
+	struct dm_lazy_block *next;
+	int count;
+	struct dm_lazy_entry entry[DM_LAZY_BLOCK_ENTRIES];
+};
+
+/**
+ * struct dm_lazy_bind - device tree nodes waiting to be bound
+ *
+ * Entries never move once added, since binding one device may add entries
+ * for its children while the list is being walked.
+ *
+ * @first: First block
+ * @last: Last block, which new entries are added to
+ * @pending: Bitmap of uclass IDs which may have entries waiting
+ */
+struct dm_lazy_bind {
+	struct dm_lazy_block *first;
+	struct dm_lazy_block *last;
+	ulong pending[DIV_ROUND_UP(UCLASS_COUNT, BITS_PER_LONG)];
+};
+
+static int dm_lazy_add(struct udevice *parent, const struct driver *drv,
+		       const struct udevice_id *id, ofnode node)
+{
+	struct dm_lazy_bind *lazy = gd->dm_lazy;
+	struct dm_lazy_block *blk;
+	struct dm_lazy_entry *ent;
+
+	if (!lazy) {
+		lazy = calloc(1, sizeof(*lazy));
+		if (!lazy)
+			return -ENOMEM;
+		gd->dm_lazy = lazy;
+	}
+	blk = lazy->last;
+	if (!blk || blk->count == DM_LAZY_BLOCK_ENTRIES) {
+		blk = malloc(sizeof(*blk));
+		if (!blk)
+			return -ENOMEM;
+		blk->next = NULL;
+		blk->count = 0;
+		if (lazy->last)
+			lazy->last->next = blk;
+		else
+			lazy->first = blk;
+		lazy->last = blk;
+	}
+	ent = &blk->entry[blk->count++];
+	ent->parent = parent;
+	ent->drv = drv;
+	ent->id = id;
+	ent->node = node;
+	lazy->pending[drv->id / BITS_PER_LONG] |=
+		1UL << (drv->id % BITS_PER_LONG);
+	parent->flags |= DM_FLAG_LAZY_CHILDREN;
+
+	return 0;
+}
+
+int lists_bind_fdt_lazy(struct udevice *parent, ofnode node,
+			bool pre_reloc_only)
+{
+	const char *compat_list, *compat;
+	const struct udevice_id *id;
+	struct driver *drv;
+	int compat_length, i;
+
+	/*
+	 * The driver may bind devices for subnodes, perhaps in other uclasses,
+	 * so there is no way to know which lookups need this node. Bind it now.
+	 */
+	if (ofnode_valid(ofnode_first_subnode(node)))
+		return lists_bind_fdt(parent, node, NULL, pre_reloc_only);
+
+	compat_list = ofnode_get_property(node, "compatible", &compat_length);
+	if (!compat_list)
+		return lists_bind_fdt(parent, node, NULL, pre_reloc_only);
+
+	for (i = 0; i < compat_length; i += strlen(compat) + 1) {
+		compat = compat_list + i;
+		drv = lists_driver_lookup_compatible(compat, &id);
+		if (!drv)
+			continue;
+
+		if (pre_reloc_only && !ofnode_pre_reloc(node) &&
+		    !(drv->flags & DM_FLAG_PRE_RELOC))
+			return 0;
+
+		log_debug("defer node %s: '%s'\n", ofnode_get_name(node),
+			  drv->name);
+		return dm_lazy_add(parent, drv, id, node);
+	}
+
+	return 0;
+}
+
+static int dm_lazy_bind_entry(struct dm_lazy_entry *ent)
+{
+	struct dm_lazy_entry copy = *ent;
+	int ret;
+
+	/* Mark it used first, since binding can look up the same uclass */
+	ent->drv = NULL;
+	ret = device_bind_with_driver_data(copy.parent, copy.drv,
+					   ofnode_get_name(copy.node),
+					   copy.id->data, copy.node, NULL);
+	if (ret == -ENODEV) {
+		/* Let the full search try the other compatible strings */
+		log_debug("Driver '%s' refuses to bind\n", copy.drv->name);
+		ret = lists_bind_fdt(copy.parent, copy.node, NULL,
+				     !(gd->flags & GD_FLG_RELOC));
+	}
+	if (ret)
+		dm_warn("Error binding driver '%s': %d\n", copy.drv->name,
+			ret);
+
+	return ret;
+}
+
+/**
+ * dm_lazy_bind_entries() - bind waiting devices
+ *
+ * @parent: bind only children of this device, or NULL for any
+ * @id: bind only devices in this uclass, or UCLASS_INVALID for any
+ */
+static void dm_lazy_bind_entries(const struct udevice *parent,
+				 enum uclass_id id)
+{
+	struct dm_lazy_block *blk;
+	struct dm_lazy_entry *ent;
+	int ret = 0, err, i;
+
+	if (!gd->dm_lazy)
+		return;
+
+	/* Entries added while binding are at the end, so are seen too */
+	for (blk = gd->dm_lazy->first; blk; blk = blk->next) {
+		for (i = 0; i < blk->count; i++) {
+			ent = &blk->entry[i];
+			if (!ent->drv)
+				continue;
+			if (parent && ent->parent != parent)
+				continue;
+			if (id != UCLASS_INVALID && ent->drv->id != id)
+				continue;
+			err = dm_lazy_bind_entry(ent);
+			if (err && !ret)
+				ret = err;
+		}
+	}
+
+	if (ret)
+		dm_warn("Some drivers failed to bind\n");
+}
+
+void dm_lazy_bind_uclass(enum uclass_id id)
+{
+	struct dm_lazy_bind *lazy = gd->dm_lazy;
+	ulong mask = 1UL << (id % BITS_PER_LONG);
+
+	if (!lazy || id < 0 || id >= UCLASS_COUNT ||
+	    !(lazy->pending[id / BITS_PER_LONG] & mask))
+		return;
+	lazy->pending[id / BITS_PER_LONG] &= ~mask;
+	dm_lazy_bind_entries(NULL, id);
+}
+
+void dm_lazy_bind_children(const struct udevice *parent)
+{
+	struct udevice *dev = (struct udevice *)parent;
+
+	if (!(dev->flags & DM_FLAG_LAZY_CHILDREN))
+		return;
+	dev->flags &= ~DM_FLAG_LAZY_CHILDREN;
+	dm_lazy_bind_entries(dev, UCLASS_INVALID);
+}
+
+void dm_lazy_bind_all(void)
+{
+	if (!gd->dm_lazy)
+		return;
+	memset(gd->dm_lazy->pending, '\0', sizeof(gd->dm_lazy->pending));
+	dm_lazy_bind_entries(NULL, UCLASS_INVALID);
+}
+
+void dm_lazy_forget(struct udevice *parent, const struct driver *drv)
+{
+	struct dm_lazy_block *blk;
+	int i;
+
+	if (!gd->dm_lazy || !(parent->flags & DM_FLAG_LAZY_CHILDREN))
+		return;
+	if (!drv)
+		parent->flags &= ~DM_FLAG_LAZY_CHILDREN;
+
+	for (blk = gd->dm_lazy->first; blk; blk = blk->next) {
+		for (i = 0; i < blk->count; i++) {
+			struct dm_lazy_entry *ent = &blk->entry[i];
+
+			if (ent->parent == parent && (!drv || ent->drv == drv))
+				ent->drv = NULL;
+		}
+	}
+}
+
+void dm_lazy_free(void)
+{
+	struct dm_lazy_block *blk, *next;
+
+	if (!gd->dm_lazy)
+		return;
+	for (blk = gd->dm_lazy->first; blk; blk = next) {
+		next = blk->next;
+		free(blk);
+	}
+	free(gd->dm_lazy);
+	gd->dm_lazy = NULL;
+}
+#endif /* DM_LAZY_BIND */
 #endif
@@ -28,6 +28,7 @@
 #include <linux/ctype.h>
 #include <linux/err.h>
 #include <linux/ioport.h>
+#include <linux/log2.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -438,6 +439,81 @@ struct device_node *of_find_node_by_prop_value(struct device_node *from,
 	return np;
 }
 
+#if CONFIG_IS_ENABLED(OF_PHANDLE_INDEX)
+/*
+ * Hash table of nodes with a phandle, indexed by the low bits of the phandle
+ * with linear probing. It is at most half full and only valid for the tree
+ * starting at of_phandle_root. If it could not be allocated, lookups walk the
+ * tree until of_phandle_index_build() is next called explicitly.
+ */
+static struct device_node **of_phandle_index;
+static struct device_node *of_phandle_root;
+static uint of_phandle_mask;
+static bool of_phandle_index_failed;
+
+int of_phandle_index_build(void)
+{
+	struct device_node **index;
+	struct device_node *np;
+	int count = 0;
+	uint size, i;
+
+	free(of_phandle_index);
+	of_phandle_index = NULL;
+	of_phandle_root = NULL;
+
+	for_each_of_allnodes(np)
+		if (np->phandle)
+			count++;
+
+	size = roundup_pow_of_two(max(count * 2, 16));
+	index = calloc(size, sizeof(*index));
+	of_phandle_index_failed = !index;
+	if (!index)
+		return -ENOMEM;
+
+	for_each_of_allnodes(np) {
+		if (!np->phandle)
+			continue;
+		for (i = np->phandle & (size - 1); index[i];
+		     i = (i + 1) & (size - 1))
+			;
+		index[i] = np;
+	}
+	of_phandle_index = index;
+	of_phandle_root = gd_of_root();
+	of_phandle_mask = size - 1;
+	debug("%s: %d phandles in %u slots\n", __func__, count, size);
+
+	return 0;
+}
+
+static struct device_node *of_phandle_index_find(phandle handle)
+{
+	struct device_node *np;
+	uint i;
+
+	if (of_phandle_index_failed)
+		return NULL;
+	if ((!of_phandle_index || of_phandle_root != gd_of_root()) &&
+	    of_phandle_index_build())
+		return NULL;
+
+	for (i = handle & of_phandle_mask; (np = of_phandle_index[i]);
+	     i = (i + 1) & of_phandle_mask) {
+		if (np->phandle == handle)
+			return np;
+	}
+
+	return NULL;
+}
+#else
+int of_phandle_index_build(void)
+{
+	return 0;
+}
+#endif
+
 struct device_node *of_find_node_by_phandle(phandle handle)
 {
 	struct device_node *np;
@@ -445,10 +521,23 @@ struct device_node *of_find_node_by_phandle(phandle handle)
 	if (!handle)
 		return NULL;
 
+#if CONFIG_IS_ENABLED(OF_PHANDLE_INDEX)
+	np = of_phandle_index_find(handle);
+	if (np)
+		return of_node_get(np);
+	/*
+	 * The phandle may have been set after the index was built, so walk
+	 * the tree. If it turns up there, rebuild the index next time.
+	 */
+#endif
 	for_each_of_allnodes(np)
 		if (np->phandle == handle)
 			break;
 	(void)of_node_get(np);
+#if CONFIG_IS_ENABLED(OF_PHANDLE_INDEX)
+	if (np)
+		of_phandle_root = NULL;
+#endif
 
 	return np;
 }
@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Finishing device probes in the background
+ *
+ * A driver with a slow probe (e.g. waiting for a link to come up) can start
+ * the slow part and call device_probe_defer(). The probe then finishes in a
+ * background task, so that other slow probes and the boot itself can carry on
+ * in the meantime.
+ */
+
+#define LOG_CATEGORY LOGC_DM
+
+#include <common.h>
+#include <bgtask.h>
+#include <bootstage.h>
+#include <log.h>
+#include <malloc.h>
+#include <dm/device.h>
+#include <dm/device-internal.h>
+#include <dm/root.h>
+#include <dm/uclass.h>
+#include <dm/uclass-internal.h>
+#include <linux/ctype.h>
+
+/**
+ * struct dm_probe_task - A device probe which is finishing in the background
+ *
+ * @task: Background task
+ * @dev: Device being probed
+ * @finish: Driver function to call for each step
+ * @start_us: Time when the probe started, for bootstage
+ */
+struct dm_probe_task {
+	struct bgtask task;
+	struct udevice *dev;
+	int (*finish)(struct udevice *dev);
+	ulong start_us;
+};
+
+static int device_probe_step(void *ctx)
+{
+	struct dm_probe_task *pt = ctx;
+	struct udevice *dev = pt->dev;
+	int ret;
+
+	ret = pt->finish(dev);
+	if (ret == -EAGAIN)
+		return ret;
+	if (!ret)
+		ret = uclass_post_probe_device(dev);
+	if (ret) {
+		/* device_probe() removes the device when it sees this */
+		log_debug("%s: probe failed (err=%d)\n", dev->name, ret);
+		return ret;
+	}
+	dev->flags &= ~DM_FLAG_PROBE_PENDING;
+	if (device_get_uclass_id(dev) != UCLASS_TIMER)
+		bootstage_span(pt->start_us, "probe %s", dev->name);
+
+	return 0;
+}
+
+int device_probe_defer(struct udevice *dev, int (*finish)(struct udevice *dev))
+{
+	struct dm_probe_task *pt;
+	int ret;
+
+	pt = calloc(1, sizeof(*pt));
+	if (!pt)
+		return log_msg_ret("alloc", -ENOMEM);
+	pt->dev = dev;
+	pt->finish = finish;
+	pt->start_us = bootstage_span_start();
+	ret = bgtask_start(&pt->task, dev->name, device_probe_step, pt);
+	if (ret) {
+		free(pt);
+		return log_msg_ret("start", ret);
+	}
+	dev->probe_task = pt;
+	dev->flags |= DM_FLAG_PROBE_PENDING;
+
+	return 0;
+}
+
+int device_probe_wait(struct udevice *dev)
+{
+	int ret;
+
+	ret = bgtask_wait(&dev->probe_task->task,
+			  CONFIG_DM_ASYNC_PROBE_TIMEOUT);
+	if (ret == -ETIMEDOUT || ret == -EDEADLK)
+		return log_msg_ret("wait", ret);
+	if (ret) {
+		device_remove(dev, DM_REMOVE_NORMAL);
+		return log_msg_ret("fail", ret);
+	}
+
+	return 0;
+}
+
+void device_probe_cancel(struct udevice *dev)
+{
+	if (!dev->probe_task)
+		return;
+	bgtask_cancel(&dev->probe_task->task);
+	free(dev->probe_task);
+	dev->probe_task = NULL;
+	dev->flags &= ~DM_FLAG_PROBE_PENDING;
+}
+
+int dm_probe_async(const char *uclasses)
+{
+	const char *p, *end;
+	char name[32];
+
+	for (p = uclasses; *p; p = end) {
+		struct udevice *dev;
+		enum uclass_id id;
+		struct uclass *uc;
+		int len;
+
+		while (isspace(*p))
+			p++;
+		for (end = p; *end && !isspace(*end); end++)
+			;
+		len = end - p;
+		if (!len)
+			continue;
+		if (len >= sizeof(name)) {
+			log_warning("Uclass name too long: %.*s\n", len, p);
+			continue;
+		}
+		strlcpy(name, p, len + 1);
+		id = uclass_get_by_name(name);
+		if (id == UCLASS_INVALID) {
+			log_warning("Unknown uclass '%s'\n", name);
+			continue;
+		}
+
+		/* Drivers which do not defer their probe just probe here */
+		uclass_id_foreach_dev(id, dev, uc) {
+			int ret = device_probe_nowait(dev);
+
+			if (ret)
+				log_debug("%s: probe failed (err=%d)\n",
+					  dev->name, ret);
+		}
+	}
+
+	return 0;
+}
@@ -125,6 +125,10 @@ void fix_devices(void)
 	for (entry = dev; entry != dev + n_ents; entry++) {
 		if (entry->platdata)
 			entry->platdata += gd->reloc_off;
+#if CONFIG_IS_ENABLED(OF_PLATDATA)
+		if (entry->drv)
+			entry->drv = (void *)entry->drv + gd->reloc_off;
+#endif
 	}
 }
 
@@ -137,6 +141,10 @@ int dm_init(bool of_live)
 		return -EINVAL;
 	}
 	INIT_LIST_HEAD(&DM_UCLASS_ROOT_NON_CONST);
+#if CONFIG_IS_ENABLED(DM_LAZY_BIND)
+	/* Anything left here belongs to the pre-relocation devices */
+	gd->dm_lazy = NULL;
+#endif
 
 	if (IS_ENABLED(CONFIG_NEEDS_MANUAL_RELOC)) {
 		fix_drivers();
@@ -149,9 +157,9 @@ int dm_init(bool of_live)
 		return ret;
 #if CONFIG_IS_ENABLED(OF_CONTROL)
 	if (CONFIG_IS_ENABLED(OF_LIVE) && of_live)
-		DM_ROOT_NON_CONST->node = np_to_ofnode(gd_of_root());
+		dev_set_ofnode(DM_ROOT_NON_CONST, np_to_ofnode(gd_of_root()));
 	else
-		DM_ROOT_NON_CONST->node = offset_to_ofnode(0);
+		dev_set_ofnode(DM_ROOT_NON_CONST, offset_to_ofnode(0));
 #endif
 	ret = device_probe(DM_ROOT_NON_CONST);
 	if (ret)
@@ -165,6 +173,7 @@ int dm_uninit(void)
 	device_remove(dm_root(), DM_REMOVE_NORMAL);
 	device_unbind(dm_root());
 	gd->dm_root = NULL;
+	dm_lazy_free();
 
 	return 0;
 }
@@ -216,8 +225,8 @@ static int dm_scan_fdt_live(struct udevice *parent,
 			pr_debug("   - ignoring disabled device\n");
 			continue;
 		}
-		err = lists_bind_fdt(parent, np_to_ofnode(np), NULL,
-				     pre_reloc_only);
+		err = lists_bind_fdt_lazy(parent, np_to_ofnode(np),
+					  pre_reloc_only);
 		if (err && !ret) {
 			ret = err;
 			debug("%s: ret=%d\n", np->name, ret);
@@ -257,8 +266,8 @@ static int dm_scan_fdt_node(struct udevice *parent, const void *blob,
 			pr_debug("   - ignoring disabled device\n");
 			continue;
 		}
-		err = lists_bind_fdt(parent, offset_to_ofnode(offset), NULL,
-				     pre_reloc_only);
+		err = lists_bind_fdt_lazy(parent, offset_to_ofnode(offset),
+					  pre_reloc_only);
 		if (err && !ret) {
 			ret = err;
 			debug("%s: ret=%d\n", node_name, ret);
@@ -19,9 +19,215 @@
 #include <dm/uclass.h>
 #include <dm/uclass-internal.h>
 #include <dm/util.h>
+#include <linux/log2.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
+/* Hash a device name for use as a uclass_index_find() value */
+static ulong uclass_index_name_value(const char *name)
+{
+	ulong val = 0;
+
+	while (*name)
+		val = val * 31 + *name++;
+
+	return val;
+}
+
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX)
+/* Number of devices a uclass must have before its devices are indexed */
+#define UCLASS_INDEX_MIN_DEVS	8
+
+/**
+ * uclass_index_value() - get the value a device is indexed by
+ *
+ * @dev: Device to check
+ * @key: Key to get the value for
+ * @valp: Returns the value to hash
+ * @return true if the device should be indexed by this key, false if not
+ */
+static bool uclass_index_value(struct udevice *dev, enum uclass_index_key key,
+			       ulong *valp)
+{
+	switch (key) {
+	case UCLASS_INDEX_SEQ:
+		*valp = dev->seq;
+		return dev->seq != -1;
+	case UCLASS_INDEX_NAME:
+		if (!dev->name)
+			return false;
+		*valp = uclass_index_name_value(dev->name);
+		return true;
+	case UCLASS_INDEX_NODE:
+		*valp = dev->node.of_offset;
+		return ofnode_valid(dev->node);
+	default:
+		return false;
+	}
+}
+
+static struct hlist_head *uclass_index_head(struct uclass *uc,
+					    enum uclass_index_key key,
+					    ulong val)
+{
+	struct uclass_index *idx = &uc->index;
+
+	/* Multiplicative hashing, keeping the top bits of the product */
+	return &idx->heads[(key << idx->bits) +
+			   ((u32)val * 0x61c88647 >> (32 - idx->bits))];
+}
+
+static void uclass_index_add(struct udevice *dev)
+{
+	struct uclass *uc = dev->uclass;
+	ulong val;
+	int key;
+
+	if (!uc->index.bits)
+		return;
+	for (key = 0; key < UCLASS_INDEX_COUNT; key++) {
+		if (uclass_index_value(dev, key, &val))
+			hlist_add_head(&dev->index_node[key],
+				       uclass_index_head(uc, key, val));
+	}
+}
+
+static void uclass_index_del(struct udevice *dev)
+{
+	int key;
+
+	for (key = 0; key < UCLASS_INDEX_COUNT; key++)
+		hlist_del_init(&dev->index_node[key]);
+}
+
+/**
+ * uclass_index_resize() - create or grow the hash tables for a uclass
+ *
+ * All devices in the uclass are added to the new tables.
+ *
+ * @uc: Uclass to update
+ * @bits: log2 of the number of buckets to use for each table
+ * @return 0 if OK, -ENOMEM if out of memory, in which case the old tables
+ * are kept
+ */
+static int uclass_index_resize(struct uclass *uc, uint bits)
+{
+	struct hlist_head *heads;
+	struct udevice *dev;
+	int key;
+
+	heads = calloc(UCLASS_INDEX_COUNT << bits, sizeof(*heads));
+	if (!heads)
+		return -ENOMEM;
+	free(uc->index.heads);
+	uc->index.heads = heads;
+	uc->index.bits = bits;
+
+	/* This runs while binding a device, so must not bind any others */
+	list_for_each_entry(dev, &uc->dev_head, uclass_node) {
+		for (key = 0; key < UCLASS_INDEX_COUNT; key++)
+			INIT_HLIST_NODE(&dev->index_node[key]);
+		uclass_index_add(dev);
+	}
+
+	return 0;
+}
+
+/* Add a device which has just been added to its uclass's device list */
+static void uclass_index_bind(struct udevice *dev)
+{
+	struct uclass *uc = dev->uclass;
+	struct uclass_index *idx = &uc->index;
+	uint bits = idx->bits;
+
+	idx->dev_count++;
+	if (!bits ? idx->dev_count >= UCLASS_INDEX_MIN_DEVS :
+	    idx->dev_count > 1 << bits) {
+		if (!uclass_index_resize(uc, bits ? bits + 1 :
+					 ilog2(UCLASS_INDEX_MIN_DEVS)))
+			return;
+	}
+	uclass_index_add(dev);
+}
+
+static void uclass_index_unbind(struct udevice *dev)
+{
+	uclass_index_del(dev);
+	dev->uclass->index.dev_count--;
+}
+
+void uclass_index_update(struct udevice *dev)
+{
+	if (list_empty(&dev->uclass_node))
+		return;
+	uclass_index_del(dev);
+	uclass_index_add(dev);
+}
+
+/**
+ * uclass_index_find() - find a device using a uclass's hash table
+ *
+ * @uc: Uclass to search
+ * @key: Key to search by
+ * @val: Value to hash, as returned by uclass_index_value()
+ * @match: Function to check whether a device matches
+ * @arg: Argument to pass to @match
+ * @devp: Returns the device found, or NULL if there is none
+ * @return 0 if the search is complete, -EAGAIN if the caller must search
+ * the device list instead. This happens if the uclass is not indexed, or if
+ * several devices match, since the first in the list must be returned.
+ */
+static int uclass_index_find(struct uclass *uc, enum uclass_index_key key,
+			     ulong val,
+			     bool (*match)(struct udevice *dev, const void *arg),
+			     const void *arg, struct udevice **devp)
+{
+	struct uclass_index *idx = &uc->index;
+	struct hlist_node *node;
+	struct udevice *dev;
+
+	idx->lookups[key]++;
+	if (!idx->bits)
+		return -EAGAIN;
+
+	*devp = NULL;
+	hlist_for_each(node, uclass_index_head(uc, key, val)) {
+		dev = container_of(node - key, struct udevice, index_node[0]);
+		idx->compares[key]++;
+		if (!match(dev, arg))
+			continue;
+		if (*devp) {
+			*devp = NULL;
+			return -EAGAIN;
+		}
+		*devp = dev;
+	}
+
+	return 0;
+}
+
+/* Count a device compared during a search of the device list */
+static void uclass_index_compare(struct uclass *uc, enum uclass_index_key key)
+{
+	uc->index.compares[key]++;
+}
+#else
+static void uclass_index_bind(struct udevice *dev) {}
+static void uclass_index_unbind(struct udevice *dev) {}
+
+static int uclass_index_find(struct uclass *uc, enum uclass_index_key key,
+			     ulong val,
+			     bool (*match)(struct udevice *dev, const void *arg),
+			     const void *arg, struct udevice **devp)
+{
+	return -EAGAIN;
+}
+
+static void uclass_index_compare(struct uclass *uc, enum uclass_index_key key)
+{
+}
+#endif
+
 struct uclass *uclass_find(enum uclass_id key)
 {
 	struct uclass *uc;
@@ -133,12 +339,15 @@ int uclass_destroy(struct uclass *uc)
 	list_del(&uc->sibling_node);
 	if (uc_drv->priv_auto_alloc_size)
 		free(uc->priv);
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX)
+	free(uc->index.heads);
+#endif
 	free(uc);
 
 	return 0;
 }
 
-int uclass_get(enum uclass_id id, struct uclass **ucp)
+int uclass_find_or_add(enum uclass_id id, struct uclass **ucp)
 {
 	struct uclass *uc;
 
@@ -151,6 +360,13 @@ int uclass_get(enum uclass_id id, struct uclass **ucp)
 	return 0;
 }
 
+int uclass_get(enum uclass_id id, struct uclass **ucp)
+{
+	dm_lazy_bind_uclass(id);
+
+	return uclass_find_or_add(id, ucp);
+}
+
 const char *uclass_get_name(enum uclass_id id)
 {
 	struct uclass *uc;
@@ -248,6 +464,11 @@ int uclass_find_next_device(struct udevice **devp)
 	return 0;
 }
 
+static bool match_name(struct udevice *dev, const void *name)
+{
+	return !strcmp(dev->name, name);
+}
+
 int uclass_find_device_by_name(enum uclass_id id, const char *name,
 			       struct udevice **devp)
 {
@@ -262,7 +483,14 @@ int uclass_find_device_by_name(enum uclass_id id, const char *name,
 	if (ret)
 		return ret;
 
+	ret = uclass_index_find(uc, UCLASS_INDEX_NAME,
+				uclass_index_name_value(name), match_name, name,
+				devp);
+	if (ret != -EAGAIN)
+		return *devp ? 0 : -ENODEV;
+
 	uclass_foreach_dev(dev, uc) {
+		uclass_index_compare(uc, UCLASS_INDEX_NAME);
 		if (!strcmp(dev->name, name)) {
 			*devp = dev;
 			return 0;
@@ -294,6 +522,11 @@ int uclass_find_next_free_req_seq(enum uclass_id id)
 	return max + 1;
 }
 
+static bool match_seq(struct udevice *dev, const void *seqp)
+{
+	return dev->seq == *(int *)seqp;
+}
+
 int uclass_find_device_by_seq(enum uclass_id id, int seq_or_req_seq,
 			      bool find_req_seq, struct udevice **devp)
 {
@@ -309,7 +542,18 @@ int uclass_find_device_by_seq(enum uclass_id id, int seq_or_req_seq,
 	if (ret)
 		return ret;
 
+	/* Requested sequence numbers may be changed by drivers directly */
+	if (!find_req_seq) {
+		ret = uclass_index_find(uc, UCLASS_INDEX_SEQ, seq_or_req_seq,
+					match_seq, &seq_or_req_seq, devp);
+		if (ret != -EAGAIN) {
+			log_debug("   - %s\n", *devp ? "found" : "not found");
+			return *devp ? 0 : -ENODEV;
+		}
+	}
+
 	uclass_foreach_dev(dev, uc) {
+		uclass_index_compare(uc, UCLASS_INDEX_SEQ);
 		log_debug("   - %d %d '%s'\n",
 			  dev->req_seq, dev->seq, dev->name);
 		if ((find_req_seq ? dev->req_seq : dev->seq) ==
@@ -348,6 +592,11 @@ int uclass_find_device_by_of_offset(enum uclass_id id, int node,
 	return -ENODEV;
 }
 
+static bool match_ofnode(struct udevice *dev, const void *nodep)
+{
+	return ofnode_equal(dev_ofnode(dev), *(ofnode *)nodep);
+}
+
 int uclass_find_device_by_ofnode(enum uclass_id id, ofnode node,
 				 struct udevice **devp)
 {
@@ -363,7 +612,15 @@ int uclass_find_device_by_ofnode(enum uclass_id id, ofnode node,
 	if (ret)
 		return ret;
 
+	ret = uclass_index_find(uc, UCLASS_INDEX_NODE, node.of_offset,
+				match_ofnode, &node, devp);
+	if (ret != -EAGAIN) {
+		ret = *devp ? 0 : -ENODEV;
+		goto done;
+	}
+
 	uclass_foreach_dev(dev, uc) {
+		uclass_index_compare(uc, UCLASS_INDEX_NODE);
 		log(LOGC_DM, LOGL_DEBUG_CONTENT, "      - checking %s\n",
 		    dev->name);
 		if (ofnode_equal(dev_ofnode(dev), node)) {
@@ -392,6 +649,18 @@ int uclass_find_device_by_phandle(enum uclass_id id, struct udevice *parent,
 	find_phandle = dev_read_u32_default(parent, name, -1);
 	if (find_phandle <= 0)
 		return -ENOENT;
+
+	/*
+	 * Devices with this phandle are those bound to the node which has it,
+	 * which the index can find without reading every device's phandle
+	 */
+	if (CONFIG_IS_ENABLED(DM_UCLASS_INDEX)) {
+		ofnode node = ofnode_get_by_phandle(find_phandle);
+
+		if (ofnode_valid(node))
+			return uclass_find_device_by_ofnode(id, node, devp);
+	}
+
 	ret = uclass_get(id, &uc);
 	if (ret)
 		return ret;
@@ -650,6 +919,7 @@ int uclass_bind_device(struct udevice *dev)
 
 	uc = dev->uclass;
 	list_add_tail(&dev->uclass_node, &uc->dev_head);
+	uclass_index_bind(dev);
 
 	if (dev->parent) {
 		struct uclass_driver *uc_drv = dev->parent->uclass->uc_drv;
@@ -664,6 +934,7 @@ int uclass_bind_device(struct udevice *dev)
 	return 0;
 err:
 	/* There is no need to undo the parent's post_bind call */
+	uclass_index_unbind(dev);
 	list_del(&dev->uclass_node);
 
 	return ret;
@@ -682,6 +953,7 @@ int uclass_unbind_device(struct udevice *dev)
 			return ret;
 	}
 
+	uclass_index_unbind(dev);
 	list_del(&dev->uclass_node);
 	return 0;
 }
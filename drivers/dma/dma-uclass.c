@@ -14,13 +14,19 @@
 #include <dm.h>
 #include <log.h>
 #include <malloc.h>
+#include <time.h>
+#include <watchdog.h>
 #include <asm/cache.h>
+#include <dm/device_compat.h>
 #include <dm/read.h>
 #include <dma-uclass.h>
 #include <linux/dma-mapping.h>
 #include <dt-structs.h>
 #include <errno.h>
 
+/* Generous enough for the largest copy a board is likely to offload */
+#define DMA_MEMCPY_TIMEOUT_MS	10000
+
 #ifdef CONFIG_DMA_CHANNELS
 static inline struct dma_ops *dma_dev_ops(struct udevice *dev)
 {
@@ -230,35 +236,121 @@ int dma_get_device(u32 transfer_type, struct udevice **devp)
 	return ret;
 }
 
-int dma_memcpy(void *dst, void *src, size_t len)
+int dma_memcpy_submit(struct dma_copy *copy, void *dst, void *src,
+		      size_t len)
 {
-	struct udevice *dev;
 	const struct dma_ops *ops;
-	dma_addr_t destination;
-	dma_addr_t source;
 	int ret;
 
-	ret = dma_get_device(DMA_SUPPORTS_MEM_TO_MEM, &dev);
+	ret = dma_get_device(DMA_SUPPORTS_MEM_TO_MEM, &copy->dev);
 	if (ret < 0)
 		return ret;
 
-	ops = device_get_ops(dev);
-	if (!ops->transfer)
+	ops = device_get_ops(copy->dev);
+	if (!ops->transfer_submit && !ops->transfer)
 		return -ENOSYS;
 
 	/* Clean the areas, so no writeback into the RAM races with DMA */
-	destination = dma_map_single(dst, len, DMA_FROM_DEVICE);
-	source = dma_map_single(src, len, DMA_TO_DEVICE);
+	copy->dst = dma_map_single(dst, len, DMA_FROM_DEVICE);
+	copy->src = dma_map_single(src, len, DMA_TO_DEVICE);
+	copy->len = len;
+	copy->cookie = 0;
+	copy->done = false;
+
+	if (ops->transfer_submit)
+		ret = ops->transfer_submit(copy->dev, DMA_MEM_TO_MEM, copy->dst,
+					   copy->src, len, &copy->cookie);
+	else
+		ret = ops->transfer(copy->dev, DMA_MEM_TO_MEM, copy->dst,
+				    copy->src, len);
+	if (ret || !ops->transfer_submit) {
+		/* Either failed or already complete */
+		dma_unmap_single(copy->dst, len, DMA_FROM_DEVICE);
+		dma_unmap_single(copy->src, len, DMA_TO_DEVICE);
+		copy->done = !ret;
+	}
+
+	return ret;
+}
+
+int dma_memcpy_poll(struct dma_copy *copy)
+{
+	const struct dma_ops *ops;
+	int ret;
+
+	if (copy->done)
+		return 0;
 
-	ret = ops->transfer(dev, DMA_MEM_TO_MEM, destination, source, len);
+	ops = device_get_ops(copy->dev);
+	ret = ops->transfer_poll ? ops->transfer_poll(copy->dev, copy->cookie) :
+		0;
+	if (ret == -EBUSY)
+		return ret;
 
 	/* Clean+Invalidate the areas after, so we can see DMA'd data */
-	dma_unmap_single(destination, len, DMA_FROM_DEVICE);
-	dma_unmap_single(source, len, DMA_TO_DEVICE);
+	dma_unmap_single(copy->dst, copy->len, DMA_FROM_DEVICE);
+	dma_unmap_single(copy->src, copy->len, DMA_TO_DEVICE);
+	copy->done = !ret;
 
 	return ret;
 }
 
+/* Stop a copy which is not complete, so the buffers can be reused */
+static void dma_memcpy_stop(struct dma_copy *copy)
+{
+	const struct dma_ops *ops = device_get_ops(copy->dev);
+
+	if (ops->transfer_stop)
+		ops->transfer_stop(copy->dev, copy->cookie);
+	dma_unmap_single(copy->dst, copy->len, DMA_FROM_DEVICE);
+	dma_unmap_single(copy->src, copy->len, DMA_TO_DEVICE);
+}
+
+int dma_memcpy_wait(struct dma_copy *copy)
+{
+	ulong start = get_timer(0);
+	int ret;
+
+	while (ret = dma_memcpy_poll(copy), ret == -EBUSY) {
+		if (get_timer(start) > DMA_MEMCPY_TIMEOUT_MS) {
+			dev_err(copy->dev, "memcpy of %zx bytes timed out\n",
+				copy->len);
+			dma_memcpy_stop(copy);
+			return -ETIMEDOUT;
+		}
+		WATCHDOG_RESET();
+	}
+
+	return ret;
+}
+
+int dma_memcpy(void *dst, void *src, size_t len)
+{
+	struct dma_copy copy;
+	int ret;
+
+	ret = dma_memcpy_submit(&copy, dst, src, len);
+	if (ret)
+		return ret;
+
+	return dma_memcpy_wait(&copy);
+}
+
+int dma_memcpy_try(void *dst, void *src, size_t len)
+{
+	ulong d = (ulong)dst, s = (ulong)src;
+
+	if (!CONFIG_DMA_MEMCPY_THRESHOLD || len < CONFIG_DMA_MEMCPY_THRESHOLD)
+		return -ENOSYS;
+	if (d < s + len && s < d + len)
+		return -EINVAL;
+	/* Cache maintenance would clobber data next to unaligned buffers */
+	if (!IS_ALIGNED(d | s | len, ARCH_DMA_MINALIGN))
+		return -EINVAL;
+
+	return dma_memcpy(dst, src, len);
+}
+
 UCLASS_DRIVER(dma) = {
 	.id		= UCLASS_DMA,
 	.name		= "dma",
@@ -18,6 +18,7 @@
 
 #define SANDBOX_DMA_CH_CNT 3
 #define SANDBOX_DMA_BUF_SIZE 1024
+#define SANDBOX_DMA_QUEUE_LEN 4
 
 struct sandbox_dma_chan {
 	struct sandbox_dma_dev *ud;
@@ -28,6 +29,12 @@ struct sandbox_dma_chan {
 	bool enabled;
 };
 
+struct sandbox_dma_copy {
+	dma_addr_t dst;
+	dma_addr_t src;
+	size_t len;
+};
+
 struct sandbox_dma_dev {
 	struct device *dev;
 	u32 ch_count;
@@ -36,6 +43,9 @@ struct sandbox_dma_dev {
 	uchar	*buf_rx;
 	size_t	data_len;
 	u32	meta;
+	struct sandbox_dma_copy queue[SANDBOX_DMA_QUEUE_LEN];
+	u32	submitted;
+	u32	completed;
 };
 
 static int sandbox_dma_transfer(struct udevice *dev, int direction,
@@ -46,6 +56,52 @@ static int sandbox_dma_transfer(struct udevice *dev, int direction,
 	return 0;
 }
 
+/*
+ * Queue the copy without doing it; each call to sandbox_dma_transfer_poll()
+ * then completes one queued copy, so that callers see copies in progress.
+ */
+static int sandbox_dma_transfer_submit(struct udevice *dev, int direction,
+				       dma_addr_t dst, dma_addr_t src,
+				       size_t len, ulong *cookiep)
+{
+	struct sandbox_dma_dev *ud = dev_get_priv(dev);
+	struct sandbox_dma_copy *copy;
+
+	if (ud->submitted - ud->completed >= SANDBOX_DMA_QUEUE_LEN)
+		return -ENOSPC;
+
+	copy = &ud->queue[ud->submitted % SANDBOX_DMA_QUEUE_LEN];
+	copy->dst = dst;
+	copy->src = src;
+	copy->len = len;
+	*cookiep = ++ud->submitted;
+
+	return 0;
+}
+
+static int sandbox_dma_transfer_poll(struct udevice *dev, ulong cookie)
+{
+	struct sandbox_dma_dev *ud = dev_get_priv(dev);
+	struct sandbox_dma_copy *copy;
+
+	if ((s32)((u32)cookie - ud->completed) <= 0)
+		return 0;
+
+	copy = &ud->queue[ud->completed % SANDBOX_DMA_QUEUE_LEN];
+	memcpy((void *)copy->dst, (void *)copy->src, copy->len);
+	ud->completed++;
+
+	return (s32)((u32)cookie - ud->completed) > 0 ? -EBUSY : 0;
+}
+
+/* Drop every queued copy without doing it */
+static void sandbox_dma_transfer_stop(struct udevice *dev, ulong cookie)
+{
+	struct sandbox_dma_dev *ud = dev_get_priv(dev);
+
+	ud->completed = ud->submitted;
+}
+
 static int sandbox_dma_of_xlate(struct dma *dma,
 				struct ofnode_phandle_args *args)
 {
@@ -229,6 +285,9 @@ static int sandbox_dma_prepare_rcv_buf(struct dma *dma, void *dst, size_t size)
 
 static const struct dma_ops sandbox_dma_ops = {
 	.transfer	= sandbox_dma_transfer,
+	.transfer_submit = sandbox_dma_transfer_submit,
+	.transfer_poll	= sandbox_dma_transfer_poll,
+	.transfer_stop	= sandbox_dma_transfer_stop,
 	.of_xlate	= sandbox_dma_of_xlate,
 	.request	= sandbox_dma_request,
 	.rfree		= sandbox_dma_rfree,
@@ -179,6 +179,11 @@ struct udma_dev {
 	u32 psil_base;
 
 	u32 ch_count;
+
+	/* memcpy channel state, see udma_transfer_submit() */
+	bool memcpy_active;
+	u32 memcpy_submitted;
+	u32 memcpy_completed;
 };
 
 struct udma_chan_config {
@@ -1835,8 +1840,8 @@ static int udma_push_to_ring(struct k3_nav_ring *ring, void *elem)
 	return k3_nav_ringacc_ring_push(ring, &addr);
 }
 
-static int *udma_prep_dma_memcpy(struct udma_chan *uc, dma_addr_t dest,
-				 dma_addr_t src, size_t len)
+static int udma_prep_dma_memcpy(struct udma_chan *uc, dma_addr_t dest,
+				dma_addr_t src, size_t len)
 {
 	u32 tc_ring_id = k3_nav_ringacc_get_ring_id(uc->tchan->tc_ring);
 	struct cppi5_tr_type15_t *tr_req;
@@ -1846,6 +1851,7 @@ static int *udma_prep_dma_memcpy(struct udma_chan *uc, dma_addr_t dest,
 	unsigned long dummy;
 	void *tr_desc;
 	size_t desc_size;
+	int ret;
 
 	if (len < SZ_64K) {
 		num_tr = 1;
@@ -1865,7 +1871,7 @@ static int *udma_prep_dma_memcpy(struct udma_chan *uc, dma_addr_t dest,
 		if (len / tr0_cnt0 >= SZ_64K) {
 			dev_err(uc->ud->dev, "size %zu is not supported\n",
 				len);
-			return NULL;
+			return -EINVAL;
 		}
 
 		tr0_cnt1 = len / tr0_cnt0;
@@ -1875,7 +1881,7 @@ static int *udma_prep_dma_memcpy(struct udma_chan *uc, dma_addr_t dest,
 	desc_size = cppi5_trdesc_calc_size(num_tr, tr_size);
 	tr_desc = dma_alloc_coherent(desc_size, &dummy);
 	if (!tr_desc)
-		return NULL;
+		return -ENOMEM;
 	memset(tr_desc, 0, desc_size);
 
 	cppi5_trdesc_init(tr_desc, num_tr, tr_size, 0, 0);
@@ -1926,7 +1932,11 @@ static int *udma_prep_dma_memcpy(struct udma_chan *uc, dma_addr_t dest,
 			   ALIGN((unsigned long)tr_desc + desc_size,
 				 ARCH_DMA_MINALIGN));
 
-	udma_push_to_ring(uc->tchan->t_ring, tr_desc);
+	ret = udma_push_to_ring(uc->tchan->t_ring, tr_desc);
+	if (ret) {
+		dma_free_coherent(tr_desc);
+		return ret;
+	}
 
 	return 0;
 }
@@ -2310,15 +2320,15 @@ err_res_free:
 	return ret;
 }
 
-static int udma_transfer(struct udevice *dev, int direction,
-			 dma_addr_t dst, dma_addr_t src, size_t len)
+static int udma_memcpy_get(struct udma_dev *ud)
 {
-	struct udma_dev *ud = dev_get_priv(dev);
 	/* Channel0 is reserved for memcpy */
 	struct udma_chan *uc = &ud->channels[0];
-	dma_addr_t paddr = 0;
 	int ret;
 
+	if (ud->memcpy_active)
+		return 0;
+
 	switch (ud->match_data->type) {
 	case DMA_TYPE_UDMA:
 		ret = udma_alloc_chan_resources(uc);
@@ -2332,9 +2342,15 @@ static int udma_transfer(struct udevice *dev, int direction,
 	if (ret)
 		return ret;
 
-	udma_prep_dma_memcpy(uc, dst, src, len);
-	udma_start(uc);
-	udma_poll_completion(uc, &paddr);
+	ud->memcpy_active = true;
+
+	return 0;
+}
+
+static void udma_memcpy_put(struct udma_dev *ud)
+{
+	struct udma_chan *uc = &ud->channels[0];
+
 	udma_stop(uc);
 
 	switch (ud->match_data->type) {
@@ -2345,9 +2361,99 @@ static int udma_transfer(struct udevice *dev, int direction,
 		bcdma_free_bchan_resources(uc);
 		break;
 	default:
-		return -EINVAL;
+		break;
 	};
 
+	ud->memcpy_active = false;
+}
+
+/*
+ * Copies are queued on the memcpy channel's ring and complete in order, so a
+ * transfer is identified by its sequence number. The channel is set up by
+ * the first submission and released once every queued copy has completed.
+ */
+static int udma_transfer_submit(struct udevice *dev, int direction,
+				dma_addr_t dst, dma_addr_t src, size_t len,
+				ulong *cookiep)
+{
+	struct udma_dev *ud = dev_get_priv(dev);
+	struct udma_chan *uc = &ud->channels[0];
+	bool idle = !ud->memcpy_active;
+	int ret;
+
+	ret = udma_memcpy_get(ud);
+	if (ret)
+		return ret;
+
+	ret = udma_prep_dma_memcpy(uc, dst, src, len);
+	if (ret) {
+		if (idle)
+			udma_memcpy_put(ud);
+		return ret;
+	}
+	udma_start(uc);
+	*cookiep = ++ud->memcpy_submitted;
+
+	return 0;
+}
+
+static int udma_transfer_poll(struct udevice *dev, ulong cookie)
+{
+	struct udma_dev *ud = dev_get_priv(dev);
+	struct udma_chan *uc = &ud->channels[0];
+	dma_addr_t paddr;
+
+	if (!ud->memcpy_active)
+		return 0;
+
+	while (!udma_pop_from_ring(uc, &paddr)) {
+		dma_free_coherent((void *)(uintptr_t)paddr);
+		ud->memcpy_completed++;
+	}
+
+	if ((s32)((u32)cookie - ud->memcpy_completed) > 0)
+		return -EBUSY;
+
+	if (ud->memcpy_completed == ud->memcpy_submitted)
+		udma_memcpy_put(ud);
+
+	return 0;
+}
+
+/* The memcpy channel is shared, so this abandons every queued copy */
+static void udma_transfer_stop(struct udevice *dev, ulong cookie)
+{
+	struct udma_dev *ud = dev_get_priv(dev);
+	struct udma_chan *uc = &ud->channels[0];
+	dma_addr_t paddr;
+
+	if (!ud->memcpy_active)
+		return;
+
+	while (!udma_pop_from_ring(uc, &paddr))
+		dma_free_coherent((void *)(uintptr_t)paddr);
+	udma_memcpy_put(ud);
+	ud->memcpy_completed = ud->memcpy_submitted;
+}
+
+static int udma_transfer(struct udevice *dev, int direction,
+			 dma_addr_t dst, dma_addr_t src, size_t len)
+{
+	ulong cookie;
+	int i = 1;
+	int ret;
+
+	ret = udma_transfer_submit(dev, direction, dst, src, len, &cookie);
+	if (ret)
+		return ret;
+
+	while (udma_transfer_poll(dev, cookie) == -EBUSY) {
+		udelay(1);
+		if (!(i % 1000000))
+			printf(".");
+		i++;
+	}
+
 	return 0;
 }
 
@@ -2708,6 +2814,9 @@ static int udma_get_cfg(struct dma *dma, u32 id, void **data)
 
 static const struct dma_ops udma_ops = {
 	.transfer	= udma_transfer,
+	.transfer_submit = udma_transfer_submit,
+	.transfer_poll	= udma_transfer_poll,
+	.transfer_stop	= udma_transfer_stop,
 	.of_xlate	= udma_of_xlate,
 	.request	= udma_request,
 	.rfree		= udma_rfree,
@@ -87,7 +87,7 @@ static int stm32_populate_gpio_dev_list(struct udevice *dev)
 	 * current pin-controller. This list is used to find pin_name and
 	 * pin muxing
 	 */
-	list_for_each_entry(child, &dev->child_head, sibling_node) {
+	device_foreach_child(child, dev) {
 		ret = uclass_get_device_by_name(UCLASS_GPIO, child->name,
 						&gpio_dev);
 		if (ret < 0)
@@ -5,6 +5,7 @@
 #include <common.h>
 #include <cpu_func.h>
 #include <dm.h>
+#include <dma.h>
 #include <elf.h>
 #include <log.h>
 #include <remoteproc.h>
@@ -190,7 +191,7 @@ int rproc_elf32_load_image(struct udevice *dev, unsigned long addr, ulong size)
 
 		dev_dbg(dev, "Loading phdr %i to 0x%p (%i bytes)\n",
 			i, dst, phdr->p_filesz);
-		if (phdr->p_filesz)
+		if (phdr->p_filesz && dma_memcpy_try(dst, src, phdr->p_filesz))
 			memcpy(dst, src, phdr->p_filesz);
 		if (phdr->p_filesz != phdr->p_memsz)
 			memset(dst + phdr->p_filesz, 0x00,
@@ -245,7 +246,8 @@ int rproc_elf64_load_image(struct udevice *dev, ulong addr, ulong size)
 			}
 		}
 
-		if (filesz)
+		if (filesz &&
+		    dma_memcpy_try(ptr, (void *)addr + offset, filesz))
 			memcpy(ptr, (void *)addr + offset, filesz);
 		if (filesz != memsz)
 			memset(ptr + filesz, 0x00, memsz - filesz);
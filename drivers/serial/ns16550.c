@@ -23,6 +23,7 @@ DECLARE_GLOBAL_DATA_PTR;
 #define UART_LCRVAL UART_LCR_8N1		/* 8 data, 1 stop, no parity */
 #define UART_MCRVAL (UART_MCR_DTR | \
 		     UART_MCR_RTS)		/* RTS/DTR */
+#define NS16550_TX_FIFO_SIZE	16	/* smallest FIFO, on the 16550A */
 
 #if !CONFIG_IS_ENABLED(DM_SERIAL)
 #ifdef CONFIG_SYS_NS16550_PORT_MAPPED
@@ -395,6 +396,31 @@ static int ns16550_serial_putc(struct udevice *dev, const char ch)
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(SERIAL_PUTS)
+static ssize_t ns16550_serial_puts(struct udevice *dev, const char *str,
+				   size_t len)
+{
+	struct NS16550 *const com_port = dev_get_priv(dev);
+	size_t i;
+
+	if (!(serial_in(&com_port->lsr) & UART_LSR_THRE))
+		return -EAGAIN;
+
+	/* The transmit FIFO is empty, so fill it without checking again */
+	if (ns16550_getfcr(com_port) & UART_FCR_FIFO_EN)
+		len = min_t(size_t, len, NS16550_TX_FIFO_SIZE);
+	else
+		len = 1;
+	for (i = 0; i < len; i++) {
+		serial_out(str[i], &com_port->thr);
+		if (str[i] == '\n')
+			WATCHDOG_RESET();
+	}
+
+	return len;
+}
+#endif
+
 static int ns16550_serial_pending(struct udevice *dev, bool input)
 {
 	struct NS16550 *const com_port = dev_get_priv(dev);
@@ -578,6 +604,9 @@ int ns16550_serial_ofdata_to_platdata(struct udevice *dev)
 
 const struct dm_serial_ops ns16550_serial_ops = {
 	.putc = ns16550_serial_putc,
+#if CONFIG_IS_ENABLED(SERIAL_PUTS)
+	.puts = ns16550_serial_puts,
+#endif
 	.pending = ns16550_serial_pending,
 	.getc = ns16550_serial_getc,
 	.setbrg = ns16550_serial_setbrg,
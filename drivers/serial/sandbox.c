@@ -36,6 +36,7 @@ DECLARE_GLOBAL_DATA_PTR;
 static unsigned char serial_buf[16];
 static unsigned int serial_buf_write;
 static unsigned int serial_buf_read;
+static size_t serial_written;	/* number of bytes written */
 
 struct sandbox_serial_platdata {
 	int colour;	/* Text colour to use for output, -1 for none */
@@ -101,12 +102,46 @@ static int sandbox_serial_putc(struct udevice *dev, const char ch)
 	}
 
 	os_write(1, &ch, 1);
+	serial_written++;
 	if (ch == '\n')
 		priv->start_of_line = true;
 
 	return 0;
 }
 
+static ssize_t sandbox_serial_puts(struct udevice *dev, const char *str,
+				   size_t len)
+{
+	struct sandbox_serial_priv *priv = dev_get_priv(dev);
+	struct sandbox_serial_platdata *plat = dev->platdata;
+	const char *newline;
+	ssize_t ret;
+
+	/* Stop after a newline so that the next line gets its colour */
+	newline = memchr(str, '\n', len);
+	if (newline)
+		len = newline - str + 1;
+	if (!CONFIG_IS_ENABLED(OF_PLATDATA) && priv->start_of_line &&
+	    plat->colour != -1) {
+		priv->start_of_line = false;
+		output_ansi_colour(plat->colour);
+	}
+
+	ret = os_write(1, str, len);
+	if (ret < 0)
+		return ret;
+	serial_written += ret;
+	if (newline && ret == len)
+		priv->start_of_line = true;
+
+	return ret;
+}
+
+size_t sandbox_serial_written(void)
+{
+	return serial_written;
+}
+
 static unsigned int increment_buffer_index(unsigned int index)
 {
 	return (index + 1) % ARRAY_SIZE(serial_buf);
@@ -242,6 +277,7 @@ static int sandbox_serial_ofdata_to_platdata(struct udevice *dev)
 
 static const struct dm_serial_ops sandbox_serial_ops = {
 	.putc = sandbox_serial_putc,
+	.puts = sandbox_serial_puts,
 	.pending = sandbox_serial_pending,
 	.getc = sandbox_serial_getc,
 	.getconfig = sandbox_serial_getconfig,
@@ -188,10 +188,48 @@ static void _serial_putc(struct udevice *dev, char ch)
 	} while (err == -EAGAIN);
 }
 
+static int __serial_puts(struct udevice *dev, const char *str, size_t len)
+{
+	struct dm_serial_ops *ops = serial_get_ops(dev);
+	ssize_t written;
+
+	while (len) {
+		written = ops->puts(dev, str, len);
+		if (written == -EAGAIN)
+			continue;
+		if (written < 0)
+			return written;
+		str += written;
+		len -= written;
+	}
+
+	return 0;
+}
+
 static void _serial_puts(struct udevice *dev, const char *str)
 {
-	while (*str)
-		_serial_putc(dev, *str++);
+	struct dm_serial_ops *ops = serial_get_ops(dev);
+	const char *newline;
+	size_t len;
+
+	if (!CONFIG_IS_ENABLED(SERIAL_PUTS) || !ops->puts) {
+		while (*str)
+			_serial_putc(dev, *str++);
+		return;
+	}
+
+	/* Send everything up to each newline at once, then \r\n */
+	while (*str) {
+		newline = strchrnul(str, '\n');
+		len = newline - str;
+		if (len && __serial_puts(dev, str, len))
+			return;
+		if (!*newline)
+			break;
+		if (__serial_puts(dev, "\r\n", 2))
+			return;
+		str = newline + 1;
+	}
 }
 
 static int __serial_getc(struct udevice *dev)
@@ -9,6 +9,7 @@
 #include <malloc.h>
 #include <video.h>
 #include <video_console.h>
+#include <linux/err.h>
 
 /* Functions needed by stb_truetype.h */
 static int tt_floor(double val)
@@ -93,6 +94,44 @@ struct pos_info {
  */
 #define POS_HISTORY_SIZE	(CONFIG_SYS_CBSIZE * 11 / 10)
 
+/**
+ * struct tt_glyph - A character rendered into display pixels
+ *
+ * @ch:		Character
+ * @step:	Sub-pixel position the character was rendered at, in units of
+ *		1 / GLYPH_SUBPIXEL_STEPS of a pixel
+ * @invert:	true if rendered for a non-black background (see putc_xy())
+ * @last_used:	Sequence number when last used, 0 if this entry is unused
+ * @width:	Width of image in pixels
+ * @height:	Height of image in pixels
+ * @xoff:	X offset of image from the cursor position
+ * @yoff:	Y offset of image from the baseline
+ * @pixels:	Image in the display's pixel format, or NULL if the character
+ *		has no image (e.g. ' ')
+ */
+struct tt_glyph {
+	char ch;
+	u8 step;
+	bool invert;
+	uint last_used;
+	int width;
+	int height;
+	int xoff;
+	int yoff;
+	void *pixels;
+};
+
+/*
+ * Number of sub-pixel positions a character is rendered at. The difference
+ * between them is not visible, but using only a few of them means that a
+ * character needs few entries in the glyph cache.
+ */
+#define GLYPH_SUBPIXEL_STEPS	4
+
+#ifdef CONFIG_CONSOLE_TRUETYPE_CACHE
+#define GLYPH_CACHE_SIZE	CONFIG_CONSOLE_TRUETYPE_CACHE_SIZE
+#endif
+
 /**
  * struct console_tt_priv - Private data for this driver
  *
@@ -112,6 +151,12 @@ struct pos_info {
  * @scale:	Scale of the font. This is calculated from the pixel height
  *		of the font. It is used by the STB library to generate images
  *		of the correct size.
+ * @glyphs:	Cache of rendered characters, so that they need not be
+ *		rendered each time they are written. Since the font and size
+ *		are fixed for a device, entries are found by character and
+ *		sub-pixel position.
+ * @glyph_seq:	Sequence number of the last glyph used, for finding the least
+ *		recently used cache entry
  */
 struct console_tt_priv {
 	int font_size;
@@ -121,6 +166,10 @@ struct console_tt_priv {
 	int pos_ptr;
 	int baseline;
 	double scale;
+#ifdef CONFIG_CONSOLE_TRUETYPE_CACHE
+	struct tt_glyph glyphs[GLYPH_CACHE_SIZE];
+	uint glyph_seq;
+#endif
 };
 
 static int console_truetype_set_row(struct udevice *dev, uint row, int clr)
@@ -197,6 +246,138 @@ static int console_truetype_move_rows(struct udevice *dev, uint rowdst,
 	return 0;
 }
 
+/**
+ * console_truetype_render() - Render a character into display pixels
+ *
+ * This asks the STB library for an 8-bit-per-pixel image of the character,
+ * which is converted into the colour depth of the display.
+ *
+ * @dev:	Device to render for
+ * @glyph:	Glyph to render, with @ch, @step and @invert filled in.
+ *		The rest is filled in by this function.
+ * @return 0 if OK, -ENOMEM if out of memory, -ENOSYS if the display depth is
+ *	not supported
+ */
+static int console_truetype_render(struct udevice *dev, struct tt_glyph *glyph)
+{
+	struct video_priv *vid_priv = dev_get_uclass_priv(dev->parent);
+	struct console_tt_priv *priv = dev_get_priv(dev);
+	int i, count;
+	u8 *data;
+
+	/*
+	 * Pass in how far past the start of a pixel we are, so the image is
+	 * anti-aliased correctly. For empty characters, like ' ', data will
+	 * return NULL;
+	 */
+	glyph->pixels = NULL;
+	data = stbtt_GetCodepointBitmapSubpixel(&priv->font, priv->scale,
+						priv->scale, (double)glyph->step /
+						GLYPH_SUBPIXEL_STEPS, 0,
+						glyph->ch, &glyph->width,
+						&glyph->height, &glyph->xoff,
+						&glyph->yoff);
+	if (!data)
+		return 0;
+
+	count = glyph->width * glyph->height;
+	switch (vid_priv->bpix) {
+#ifdef CONFIG_VIDEO_BPP16
+	case VIDEO_BPP16: {
+		u16 *out = malloc(count * sizeof(u16));
+
+		glyph->pixels = out;
+		for (i = 0; out && i < count; i++) {
+			int val = glyph->invert ? 255 - data[i] : data[i];
+
+			*out++ = val >> 3 | (val >> 2) << 5 | (val >> 3) << 11;
+		}
+		break;
+	}
+#endif
+#ifdef CONFIG_VIDEO_BPP32
+	case VIDEO_BPP32: {
+		u32 *out = malloc(count * sizeof(u32));
+
+		glyph->pixels = out;
+		for (i = 0; out && i < count; i++) {
+			int val = glyph->invert ? 255 - data[i] : data[i];
+
+			*out++ = val | val << 8 | val << 16;
+		}
+		break;
+	}
+#endif
+	default:
+		free(data);
+		return -ENOSYS;
+	}
+	free(data);
+	if (!glyph->pixels)
+		return -ENOMEM;
+
+	return 0;
+}
+
+/**
+ * console_truetype_get_glyph() - Get the image of a character
+ *
+ * This looks up the character in the glyph cache, rendering it if needed.
+ *
+ * @dev:	Device to render for
+ * @ch:		Character to get
+ * @step:	Sub-pixel position to render at (0 to GLYPH_SUBPIXEL_STEPS - 1)
+ * @tmp:	Glyph to use if there is no cache. If this is returned, the
+ *		caller must free its @pixels
+ * @return glyph, or ERR_PTR(-ve) on error
+ */
+static struct tt_glyph *console_truetype_get_glyph(struct udevice *dev,
+						   char ch, uint step,
+						   struct tt_glyph *tmp)
+{
+	struct video_priv *vid_priv = dev_get_uclass_priv(dev->parent);
+	struct tt_glyph *glyph = tmp;
+	bool invert = vid_priv->colour_bg != 0;
+	int ret;
+#ifdef CONFIG_CONSOLE_TRUETYPE_CACHE
+	struct console_tt_priv *priv = dev_get_priv(dev);
+	struct tt_glyph *entry;
+	uint hash;
+	int i;
+
+	/*
+	 * Each character can be in one of two places. Mix all the bits of the
+	 * key into the hash, so that similar keys spread across the cache.
+	 */
+	hash = ((u8)ch * GLYPH_SUBPIXEL_STEPS + step) * 2 + invert;
+	hash *= 0x9e3779b1;
+	hash ^= hash >> 16;
+	for (i = 0; i < 2; i++) {
+		entry = &priv->glyphs[(hash + i) % GLYPH_CACHE_SIZE];
+		if (entry->last_used && entry->ch == ch &&
+		    entry->step == step && entry->invert == invert) {
+			entry->last_used = ++priv->glyph_seq;
+			return entry;
+		}
+		if (glyph == tmp || entry->last_used < glyph->last_used)
+			glyph = entry;
+	}
+	free(glyph->pixels);
+	glyph->last_used = 0;
+#endif
+	glyph->ch = ch;
+	glyph->step = step;
+	glyph->invert = invert;
+	ret = console_truetype_render(dev, glyph);
+	if (ret)
+		return ERR_PTR(ret);
+#ifdef CONFIG_CONSOLE_TRUETYPE_CACHE
+	glyph->last_used = ++priv->glyph_seq;
+#endif
+
+	return glyph;
+}
+
 static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 				    char ch)
 {
@@ -205,14 +386,14 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 	struct video_priv *vid_priv = dev_get_uclass_priv(vid);
 	struct console_tt_priv *priv = dev_get_priv(dev);
 	stbtt_fontinfo *font = &priv->font;
-	int width, height, xoff, yoff;
-	double xpos, x_shift;
+	struct tt_glyph *glyph, tmp;
+	double xpos;
+	uint step;
 	int lsb;
 	int width_frac, linenum;
 	struct pos_info *pos;
-	u8 *bits, *data;
 	int advance;
-	void *start, *end, *line;
+	void *start, *line;
 	int row, ret;
 
 	/* First get some basic metrics about this character */
@@ -234,7 +415,7 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 	 * effective width of this character, which will be our return value:
 	 * it dictates how much the cursor will move forward on the line.
 	 */
-	x_shift = xpos - (double)tt_floor(xpos);
+	step = (xpos - (double)tt_floor(xpos)) * GLYPH_SUBPIXEL_STEPS;
 	xpos += advance * priv->scale;
 	width_frac = (int)VID_TO_POS(xpos);
 	if (x + width_frac >= vc_priv->xsize_frac)
@@ -248,91 +429,73 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 		priv->pos_ptr++;
 	}
 
-	/*
-	 * Figure out how much past the start of a pixel we are, and pass this
-	 * information into the render, which will return a 8-bit-per-pixel
-	 * image of the character. For empty characters, like ' ', data will
-	 * return NULL;
-	 */
-	data = stbtt_GetCodepointBitmapSubpixel(font, priv->scale, priv->scale,
-						x_shift, 0, ch, &width, &height,
-						&xoff, &yoff);
-	if (!data)
-		return width_frac;
+	glyph = console_truetype_get_glyph(dev, ch, step, &tmp);
+	if (IS_ERR(glyph))
+		return PTR_ERR(glyph);
+	if (!glyph->pixels)
+		goto done;
 
 	/* Figure out where to write the character in the frame buffer */
-	bits = data;
 	start = vid_priv->fb + y * vid_priv->line_length +
 		VID_TO_PIXEL(x) * VNBYTES(vid_priv->bpix);
-	linenum = priv->baseline + yoff;
+	linenum = priv->baseline + glyph->yoff;
 	if (linenum > 0)
 		start += linenum * vid_priv->line_length;
 	line = start;
 
 	/*
-	 * Write a row at a time, converting the 8bpp image into the colour
-	 * depth of the display. We only expect white-on-black or the reverse
-	 * so the code only handles this simple case.
+	 * Write a row at a time. The image is already in the colour depth of
+	 * the display. We only expect white-on-black or the reverse so the
+	 * code only handles this simple case.
 	 */
-	for (row = 0; row < height; row++) {
+	for (row = 0; row < glyph->height; row++) {
 		switch (vid_priv->bpix) {
 #ifdef CONFIG_VIDEO_BPP16
 		case VIDEO_BPP16: {
-			uint16_t *dst = (uint16_t *)line + xoff;
+			const u16 *src = glyph->pixels;
+			u16 *dst = (u16 *)line + glyph->xoff;
 			int i;
 
-			for (i = 0; i < width; i++) {
-				int val = *bits;
-				int out;
-
-				if (vid_priv->colour_bg)
-					val = 255 - val;
-				out = val >> 3 |
-					(val >> 2) << 5 |
-					(val >> 3) << 11;
-				if (vid_priv->colour_fg)
-					*dst++ |= out;
-				else
-					*dst++ &= out;
-				bits++;
+			src += row * glyph->width;
+			if (vid_priv->colour_fg) {
+				for (i = 0; i < glyph->width; i++)
+					*dst++ |= *src++;
+			} else {
+				for (i = 0; i < glyph->width; i++)
+					*dst++ &= *src++;
 			}
-			end = dst;
 			break;
 		}
 #endif
 #ifdef CONFIG_VIDEO_BPP32
 		case VIDEO_BPP32: {
-			u32 *dst = (u32 *)line + xoff;
+			const u32 *src = glyph->pixels;
+			u32 *dst = (u32 *)line + glyph->xoff;
 			int i;
 
-			for (i = 0; i < width; i++) {
-				int val = *bits;
-				int out;
-
-				if (vid_priv->colour_bg)
-					val = 255 - val;
-				out = val | val << 8 | val << 16;
-				if (vid_priv->colour_fg)
-					*dst++ |= out;
-				else
-					*dst++ &= out;
-				bits++;
+			src += row * glyph->width;
+			if (vid_priv->colour_fg) {
+				for (i = 0; i < glyph->width; i++)
+					*dst++ |= *src++;
+			} else {
+				for (i = 0; i < glyph->width; i++)
+					*dst++ &= *src++;
 			}
-			end = dst;
 			break;
 		}
 #endif
 		default:
-			free(data);
-			return -ENOSYS;
+			break;
 		}
 
 		line += vid_priv->line_length;
 	}
 	ret = vidconsole_sync_copy(dev, start, line);
 	if (ret)
-		return ret;
-	free(data);
+		width_frac = ret;
+done:
+	if (glyph == &tmp)
+		free(tmp.pixels);
 
 	return width_frac;
 }
@@ -575,6 +738,19 @@ static int console_truetype_probe(struct udevice *dev)
 	return 0;
 }
 
+static int console_truetype_remove(struct udevice *dev)
+{
+#ifdef CONFIG_CONSOLE_TRUETYPE_CACHE
+	struct console_tt_priv *priv = dev_get_priv(dev);
+	int i;
+
+	for (i = 0; i < GLYPH_CACHE_SIZE; i++)
+		free(priv->glyphs[i].pixels);
+#endif
+
+	return 0;
+}
+
 struct vidconsole_ops console_truetype_ops = {
 	.putc_xy	= console_truetype_putc_xy,
 	.move_rows	= console_truetype_move_rows,
@@ -588,5 +764,6 @@ U_BOOT_DRIVER(vidconsole_truetype) = {
 	.id	= UCLASS_VIDEO_CONSOLE,
 	.ops	= &console_truetype_ops,
 	.probe	= console_truetype_probe,
+	.remove	= console_truetype_remove,
 	.priv_auto_alloc_size	= sizeof(struct console_tt_priv),
 };
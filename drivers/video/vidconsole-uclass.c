@@ -629,7 +629,7 @@ UCLASS_DRIVER(vidconsole) = {
 	.per_device_auto_alloc_size	= sizeof(struct vidconsole_priv),
 };
 
-#ifdef CONFIG_VIDEO_COPY
+#if defined(CONFIG_VIDEO_COPY) || defined(CONFIG_VIDEO_DAMAGE)
 int vidconsole_sync_copy(struct udevice *dev, void *from, void *to)
 {
 	struct udevice *vid = dev_get_parent(dev);
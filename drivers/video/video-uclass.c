@@ -171,15 +171,85 @@ void video_set_default_colors(struct udevice *dev, bool invert)
 	priv->colour_bg = vid_console_color(priv, back);
 }
 
+#ifdef CONFIG_VIDEO_DAMAGE
+void video_damage(struct udevice *vid, int x, int y, int width, int height)
+{
+	struct video_priv *priv = dev_get_uclass_priv(vid);
+	int xend = min(x + width, (int)priv->xsize);
+	int yend = min(y + height, (int)priv->ysize);
+
+	x = max(x, 0);
+	y = max(y, 0);
+	if (x >= xend || y >= yend)
+		return;
+
+	if (priv->damage.xend <= priv->damage.xstart) {
+		priv->damage.xstart = x;
+		priv->damage.ystart = y;
+		priv->damage.xend = xend;
+		priv->damage.yend = yend;
+	} else {
+		priv->damage.xstart = min(priv->damage.xstart, x);
+		priv->damage.ystart = min(priv->damage.ystart, y);
+		priv->damage.xend = max(priv->damage.xend, xend);
+		priv->damage.yend = max(priv->damage.yend, yend);
+	}
+}
+
+/* Copy and flush the part of the frame buffer which has changed */
+static void video_sync_damage(struct udevice *vid)
+{
+	struct video_priv *priv = dev_get_uclass_priv(vid);
+	int pbytes = VNBYTES(priv->bpix);
+	ulong offset;
+	int width, y;
+
+	if (priv->damage.xend <= priv->damage.xstart)
+		return;
+
+	offset = priv->damage.ystart * priv->line_length +
+		priv->damage.xstart * pbytes;
+	width = (priv->damage.xend - priv->damage.xstart) * pbytes;
+	if (priv->copy_fb) {
+		ulong line = offset;
+
+		for (y = priv->damage.ystart; y < priv->damage.yend; y++) {
+			memcpy(priv->copy_fb + line, priv->fb + line, width);
+			line += priv->line_length;
+		}
+	}
+
+	/* See the comment in video_sync() about flush_dcache_range() */
+#if defined(CONFIG_ARM) && !CONFIG_IS_ENABLED(SYS_DCACHE_OFF)
+	if (priv->flush_dcache) {
+		ulong start = (ulong)priv->fb + offset;
+		ulong end = start + (priv->damage.yend - priv->damage.ystart -
+				     1) * priv->line_length + width;
+
+		flush_dcache_range(ALIGN_DOWN(start, CONFIG_SYS_CACHELINE_SIZE),
+				   ALIGN(end, CONFIG_SYS_CACHELINE_SIZE));
+	}
+#endif
+	priv->damage.xstart = 0;
+	priv->damage.ystart = 0;
+	priv->damage.xend = 0;
+	priv->damage.yend = 0;
+}
+#endif
+
 /* Flush video activity to the caches */
 void video_sync(struct udevice *vid, bool force)
 {
+#ifdef CONFIG_VIDEO_DAMAGE
+	video_sync_damage(vid);
+#endif
 	/*
 	 * flush_dcache_range() is declared in common.h but it seems that some
 	 * architectures do not actually implement it. Is there a way to find
 	 * out whether it exists? For now, ARM is safe.
 	 */
-#if defined(CONFIG_ARM) && !CONFIG_IS_ENABLED(SYS_DCACHE_OFF)
+#if defined(CONFIG_ARM) && !CONFIG_IS_ENABLED(SYS_DCACHE_OFF) && \
+	!defined(CONFIG_VIDEO_DAMAGE)
 	struct video_priv *priv = dev_get_uclass_priv(vid);
 
 	if (priv->flush_dcache) {
@@ -224,12 +294,12 @@ int video_get_ysize(struct udevice *dev)
 	return priv->ysize;
 }
 
-#ifdef CONFIG_VIDEO_COPY
+#if defined(CONFIG_VIDEO_COPY) || defined(CONFIG_VIDEO_DAMAGE)
 int video_sync_copy(struct udevice *dev, void *from, void *to)
 {
 	struct video_priv *priv = dev_get_uclass_priv(dev);
 
-	if (priv->copy_fb) {
+	if (priv->copy_fb || IS_ENABLED(CONFIG_VIDEO_DAMAGE)) {
 		long offset, size;
 
 		/* Find the offset of the first byte to copy */
@@ -270,7 +340,21 @@ int video_sync_copy(struct udevice *dev, void *from, void *to)
 			offset = 0;
 		}
 
-		memcpy(priv->copy_fb + offset, priv->fb + offset, size);
+		/*
+		 * Leave the copy to video_sync(), so that many small updates
+		 * between syncs only need one copy
+		 */
+		if (IS_ENABLED(CONFIG_VIDEO_DAMAGE)) {
+			int ystart = offset / priv->line_length;
+			int yend = DIV_ROUND_UP(offset + size,
+						priv->line_length);
+
+			video_damage(dev, 0, ystart, priv->xsize,
+				     yend - ystart);
+		} else {
+			memcpy(priv->copy_fb + offset, priv->fb + offset,
+			       size);
+		}
 	}
 
 	return 0;
@@ -321,8 +405,10 @@ static int video_post_probe(struct udevice *dev)
 	/* Set up colors  */
 	video_set_default_colors(dev, false);
 
-	if (!CONFIG_IS_ENABLED(NO_FB_CLEAR))
+	if (!CONFIG_IS_ENABLED(NO_FB_CLEAR)) {
 		video_clear(dev);
+		video_sync(dev, false);
+	}
 
 	/*
 	 * Create a text console device. For now we always do this, although
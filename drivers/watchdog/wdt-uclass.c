@@ -10,6 +10,7 @@
 #include <log.h>
 #include <time.h>
 #include <wdt.h>
+#include <worker.h>
 #include <dm/device-internal.h>
 #include <dm/lists.h>
 
@@ -125,6 +126,10 @@ void watchdog_reset(void)
 	if (!gd || !(gd->flags & GD_FLG_WDT_READY))
 		return;
 
+	/* Only the boot CPU looks after the watchdog, not worker cores */
+	if (worker_self())
+		return;
+
 	/* Do not reset the watchdog too often */
 	now = get_timer(0);
 	if (time_after(now, next_reset)) {
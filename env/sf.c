@@ -21,13 +21,14 @@
 #include <uuid.h>
 #include <asm/cache.h>
 #include <dm/device-internal.h>
+#include <linux/build_bug.h>
 #include <u-boot/crc.h>
 
 #ifndef CONFIG_SPL_BUILD
 #define INITENV
 #endif
 
-#ifdef CONFIG_ENV_OFFSET_REDUND
+#if defined(CONFIG_ENV_OFFSET_REDUND) && !defined(CONFIG_ENV_SF_JOURNAL)
 static ulong env_offset		= CONFIG_ENV_OFFSET;
 static ulong env_new_offset	= CONFIG_ENV_OFFSET_REDUND;
 #endif /* CONFIG_ENV_OFFSET_REDUND */
@@ -66,7 +67,385 @@ static int setup_flash_device(void)
 	return 0;
 }
 
-#if defined(CONFIG_ENV_OFFSET_REDUND)
+#if defined(CONFIG_ENV_SF_JOURNAL)
+#if CONFIG_ENV_ADDR != 0x0
+#error "CONFIG_ENV_SF_JOURNAL cannot be used with CONFIG_ENV_ADDR"
+#endif
+
+#define ENV_SF_JOURNAL_ALIGN	4
+
+static const ulong env_sf_offsets[] = {
+	CONFIG_ENV_OFFSET,
+#ifdef CONFIG_ENV_OFFSET_REDUND
+	CONFIG_ENV_OFFSET_REDUND,
+#endif
+};
+
+#define ENV_SF_AREAS	ARRAY_SIZE(env_sf_offsets)
+
+/**
+ * struct env_sf_journal - Environment read from a journal area
+ *
+ * @env: Environment after replaying the journal, with a zero CRC
+ * @used: Number of bytes of @env->data used by variables
+ * @seq: Sequence number of the area
+ * @end: Offset within the area of the first byte after the last record
+ * @clean: true if the area after @end is erased, so records can be added
+ */
+struct env_sf_journal {
+	env_t *env;
+	size_t used;
+	u32 seq;
+	u32 end;
+	bool clean;
+};
+
+/* Get the number of bytes used by the variables in an environment */
+static size_t env_sf_used(const char *data)
+{
+	size_t pos;
+
+	for (pos = 0; pos < ENV_SIZE && data[pos]; )
+		pos += strlen(data + pos) + 1;
+
+	return pos;
+}
+
+/* Find a variable by name, returning its offset or -ENOENT */
+static int env_sf_find(const char *data, size_t used, const char *name,
+		       size_t len)
+{
+	size_t pos;
+
+	for (pos = 0; pos < used; pos += strlen(data + pos) + 1) {
+		if (!strncmp(data + pos, name, len) && data[pos + len] == '=')
+			return pos;
+	}
+
+	return -ENOENT;
+}
+
+/* Apply the changes in a journal record to an environment */
+static int env_sf_apply(char *data, size_t *usedp, const char *rec,
+			size_t size)
+{
+	size_t used = *usedp;
+	size_t pos, len, nlen, elen;
+	int ofs;
+
+	for (pos = 0; pos < size; pos += len + 1) {
+		len = strnlen(rec + pos, size - pos);
+		nlen = strcspn(rec + pos, "=");
+		if (pos + len == size || !nlen)
+			return -EINVAL;
+
+		ofs = env_sf_find(data, used, rec + pos, nlen);
+		if (ofs >= 0) {
+			elen = strlen(data + ofs) + 1;
+			memmove(data + ofs, data + ofs + elen,
+				used - ofs - elen);
+			used -= elen;
+			memset(data + used, '\0', elen);
+		}
+		if (nlen < len) {
+			if (used + len + 1 >= ENV_SIZE)
+				return -E2BIG;
+			memcpy(data + used, rec + pos, len + 1);
+			used += len + 1;
+		}
+	}
+	*usedp = used;
+
+	return 0;
+}
+
+/*
+ * Work out the changes needed to turn environment @old into @new, returning
+ * the size of the record, or -E2BIG if it is larger than @max
+ */
+static int env_sf_diff(const char *old, size_t old_used, const char *new,
+		       size_t new_used, char *rec, size_t max)
+{
+	size_t pos, len, nlen, size = 0;
+	int ofs;
+
+	/* Variables which were set */
+	for (pos = 0; pos < new_used; pos += len + 1) {
+		len = strlen(new + pos);
+		nlen = strcspn(new + pos, "=");
+		ofs = env_sf_find(old, old_used, new + pos, nlen);
+		if (ofs >= 0 && !strcmp(old + ofs, new + pos))
+			continue;
+		if (size + len + 1 > max)
+			return -E2BIG;
+		memcpy(rec + size, new + pos, len + 1);
+		size += len + 1;
+	}
+
+	/* Variables which were deleted */
+	for (pos = 0; pos < old_used; pos += len + 1) {
+		len = strlen(old + pos);
+		nlen = strcspn(old + pos, "=");
+		if (env_sf_find(new, new_used, old + pos, nlen) >= 0)
+			continue;
+		if (size + nlen + 1 > max)
+			return -E2BIG;
+		memcpy(rec + size, old + pos, nlen);
+		rec[size + nlen] = '\0';
+		size += nlen + 1;
+	}
+
+	return size;
+}
+
+static u32 env_sf_rec_crc(const struct env_sf_journal_rec *hdr,
+			  const void *data)
+{
+	u32 crc;
+
+	crc = crc32(0, (const void *)hdr,
+		    offsetof(struct env_sf_journal_rec, crc));
+
+	return crc32(crc, data, hdr->size);
+}
+
+static bool env_sf_erased(const char *buf, size_t size)
+{
+	while (size--) {
+		if ((u8)*buf++ != 0xff)
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * Read a journal area and replay its records. Replay stops at the first
+ * record which is not valid, e.g. because power failed while writing it.
+ */
+static int env_sf_journal_scan(ulong offset, char *buf,
+			       struct env_sf_journal *jnl)
+{
+	struct env_sf_journal_rec hdr;
+	char *data = (char *)jnl->env->data;
+	const char *rec;
+	u32 pos;
+	int ret;
+
+	ret = spi_flash_read(env_flash, offset, CONFIG_ENV_SF_JOURNAL_SIZE,
+			     buf);
+	if (ret)
+		return ret;
+
+	memset(jnl->env, '\0', CONFIG_ENV_SIZE);
+	jnl->used = 0;
+	for (pos = 0; pos + sizeof(hdr) <= CONFIG_ENV_SF_JOURNAL_SIZE;
+	     pos = ALIGN(pos + sizeof(hdr) + hdr.size, ENV_SF_JOURNAL_ALIGN)) {
+		memcpy(&hdr, buf + pos, sizeof(hdr));
+		rec = buf + pos + sizeof(hdr);
+		if (hdr.magic != (pos ? ENV_SF_JOURNAL_DELTA :
+				  ENV_SF_JOURNAL_FULL) ||
+		    (pos && hdr.seq != jnl->seq) ||
+		    hdr.size > CONFIG_ENV_SF_JOURNAL_SIZE - pos - sizeof(hdr) ||
+		    env_sf_rec_crc(&hdr, rec) != hdr.crc)
+			break;
+
+		if (!pos) {
+			if (hdr.size >= ENV_SIZE ||
+			    (hdr.size && rec[hdr.size - 1]))
+				break;
+			memcpy(data, rec, hdr.size);
+			jnl->used = hdr.size;
+			jnl->seq = hdr.seq;
+		} else if (env_sf_apply(data, &jnl->used, rec, hdr.size)) {
+			break;
+		}
+	}
+	if (!pos)
+		return -ENOMSG;
+
+	/* Nothing must have been written after the last valid record */
+	jnl->end = min_t(u32, pos, CONFIG_ENV_SF_JOURNAL_SIZE);
+	jnl->clean = env_sf_erased(buf + jnl->end,
+				   CONFIG_ENV_SF_JOURNAL_SIZE - jnl->end);
+	if (jnl->end == CONFIG_ENV_SF_JOURNAL_SIZE)
+		jnl->clean = false;
+
+	return 0;
+}
+
+/* Read each journal area, returning the index of the newest valid one */
+static int env_sf_journal_read(struct env_sf_journal *jnls, char *buf)
+{
+	int i, cur = -ENOMSG;
+
+	for (i = 0; i < ENV_SF_AREAS; i++) {
+		if (env_sf_journal_scan(env_sf_offsets[i], buf, &jnls[i]))
+			continue;
+		if (cur < 0 || (s32)(jnls[i].seq - jnls[cur].seq) > 0)
+			cur = i;
+	}
+
+	return cur;
+}
+
+static int env_sf_journal_alloc(struct env_sf_journal *jnls, char **bufp)
+{
+	int i;
+
+	*bufp = memalign(ARCH_DMA_MINALIGN, CONFIG_ENV_SF_JOURNAL_SIZE);
+	if (!*bufp)
+		return -ENOMEM;
+	for (i = 0; i < ENV_SF_AREAS; i++) {
+		jnls[i].env = memalign(ARCH_DMA_MINALIGN, CONFIG_ENV_SIZE);
+		if (!jnls[i].env)
+			return -ENOMEM;
+	}
+
+	return 0;
+}
+
+static void env_sf_journal_free(struct env_sf_journal *jnls, char *buf)
+{
+	int i;
+
+	for (i = 0; i < ENV_SF_AREAS; i++)
+		free(jnls[i].env);
+	free(buf);
+}
+
+static int env_sf_save(void)
+{
+	struct env_sf_journal jnls[ENV_SF_AREAS] = {};
+	struct env_sf_journal_rec *hdr;
+	struct env_sf_journal *jnl;
+	int	cur, area, size;
+	size_t	used, max;
+	env_t	env_new;
+	char	*buf;
+	int	ret;
+
+	BUILD_BUG_ON(CONFIG_ENV_SF_JOURNAL_SIZE <
+		     sizeof(*hdr) + CONFIG_ENV_SIZE);
+
+	ret = setup_flash_device();
+	if (ret)
+		return ret;
+
+	ret = env_export(&env_new);
+	if (ret)
+		return -EIO;
+	used = env_sf_used((char *)env_new.data);
+
+	ret = env_sf_journal_alloc(jnls, &buf);
+	if (ret)
+		goto done;
+	hdr = (struct env_sf_journal_rec *)buf;
+
+	/* Add a record with the changes, if there is room */
+	cur = env_sf_journal_read(jnls, buf);
+	if (cur >= 0 && jnls[cur].clean) {
+		jnl = &jnls[cur];
+		max = CONFIG_ENV_SF_JOURNAL_SIZE - jnl->end;
+		size = -E2BIG;
+		if (max > sizeof(*hdr))
+			size = env_sf_diff((char *)jnl->env->data, jnl->used,
+					   (char *)env_new.data, used,
+					   buf + sizeof(*hdr),
+					   max - sizeof(*hdr));
+		if (!size) {
+			puts("No changes to save\n");
+			goto done;
+		}
+		if (size > 0) {
+			hdr->magic = ENV_SF_JOURNAL_DELTA;
+			hdr->seq = jnl->seq;
+			hdr->size = size;
+			hdr->crc = env_sf_rec_crc(hdr, buf + sizeof(*hdr));
+
+			puts("Writing to SPI flash...");
+			ret = spi_flash_write(env_flash,
+					      env_sf_offsets[cur] + jnl->end,
+					      sizeof(*hdr) + size, buf);
+			if (ret)
+				goto done;
+			area = cur;
+			goto written;
+		}
+	}
+
+	/*
+	 * Start a new journal with the whole environment. If there are two
+	 * areas, use the other one so the current one is kept until this is
+	 * written.
+	 */
+	area = cur >= 0 ? (cur + 1) % ENV_SF_AREAS : 0;
+	hdr->magic = ENV_SF_JOURNAL_FULL;
+	hdr->seq = cur >= 0 ? jnls[cur].seq + 1 : 0;
+	hdr->size = used;
+	memcpy(buf + sizeof(*hdr), env_new.data, used);
+	hdr->crc = env_sf_rec_crc(hdr, buf + sizeof(*hdr));
+
+	puts("Erasing SPI flash...");
+	ret = spi_flash_erase(env_flash, env_sf_offsets[area],
+			      CONFIG_ENV_SF_JOURNAL_SIZE);
+	if (ret)
+		goto done;
+
+	puts("Writing to SPI flash...");
+	ret = spi_flash_write(env_flash, env_sf_offsets[area],
+			      sizeof(*hdr) + used, buf);
+	if (ret)
+		goto done;
+
+written:
+	puts("done\n");
+	gd->env_valid = area ? ENV_REDUND : ENV_VALID;
+
+done:
+	env_sf_journal_free(jnls, buf);
+
+	return ret;
+}
+
+static int env_sf_load(void)
+{
+	struct env_sf_journal jnls[ENV_SF_AREAS] = {};
+	char *buf;
+	int cur;
+	int ret;
+
+	ret = env_sf_journal_alloc(jnls, &buf);
+	if (ret) {
+		env_set_default("malloc() failed", 0);
+		ret = -EIO;
+		goto out;
+	}
+
+	ret = setup_flash_device();
+	if (ret)
+		goto out;
+
+	cur = env_sf_journal_read(jnls, buf);
+	if (cur < 0) {
+		env_set_default("bad CRC", 0);
+		ret = cur;
+		goto err_read;
+	}
+
+	ret = env_import((char *)jnls[cur].env, 0, H_EXTERNAL);
+	if (!ret)
+		gd->env_valid = cur ? ENV_REDUND : ENV_VALID;
+
+err_read:
+	spi_flash_free(env_flash);
+	env_flash = NULL;
+out:
+	env_sf_journal_free(jnls, buf);
+
+	return ret;
+}
+#elif defined(CONFIG_ENV_OFFSET_REDUND)
 static int env_sf_save(void)
 {
 	env_t	env_new;
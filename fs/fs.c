@@ -9,6 +9,7 @@
 #include <config.h>
 #include <errno.h>
 #include <common.h>
+#include <bootstage.h>
 #include <env.h>
 #include <lmb.h>
 #include <log.h>
@@ -514,11 +515,13 @@ static int fs_read_lmb_check(const char *filename, ulong addr, loff_t offset,
 	lmb_init_and_reserve(&lmb, gd->bd, (void *)gd->fdt_blob);
 	lmb_dump_all(&lmb);
 
-	if (lmb_alloc_addr(&lmb, addr, read_len) == addr)
-		return 0;
+	lmb.owner = LMB_OWNER_FS;
+	ret = lmb_alloc_addr(&lmb, addr, read_len) == addr ? 0 : -ENOSPC;
+	lmb_release(&lmb);
+	if (ret)
+		log_err("** Reading file would overwrite reserved memory **\n");
 
-	log_err("** Reading file would overwrite reserved memory **\n");
-	return -ENOSPC;
+	return ret;
 }
 #endif
 
@@ -526,6 +529,7 @@ static int _fs_read(const char *filename, ulong addr, loff_t offset, loff_t len,
 		    int do_lmb_check, loff_t *actread)
 {
 	struct fstype_info *info = fs_get_info(fs_type);
+	ulong start_us;
 	void *buf;
 	int ret;
 
@@ -541,9 +545,11 @@ static int _fs_read(const char *filename, ulong addr, loff_t offset, loff_t len,
 	 * We don't actually know how many bytes are being read, since len==0
 	 * means read the whole file.
 	 */
+	start_us = bootstage_span_start();
 	buf = map_sysmem(addr, len);
 	ret = info->read(filename, buf, offset, len, actread);
 	unmap_sysmem(buf);
+	bootstage_span(start_us, "load %s", filename);
 
 	/* If we requested a specific number of bytes, check we got it */
 	if (ret == 0 && len && *actread != len)
@@ -25,7 +25,10 @@
 #include <linux/list.h>
 
 struct acpi_ctx;
+struct dm_lazy_bind;
 struct driver_rt;
+struct fdt_phandle_index;
+struct malloc_usage;
 
 typedef struct global_data gd_t;
 
@@ -195,6 +198,12 @@ struct global_data {
 	 * @uclass_root: head of core tree
 	 */
 	struct list_head uclass_root;
+# if CONFIG_IS_ENABLED(DM_LAZY_BIND)
+	/**
+	 * @dm_lazy: device tree nodes found by the scan but not bound yet
+	 */
+	struct dm_lazy_bind *dm_lazy;
+# endif
 # if CONFIG_IS_ENABLED(OF_PLATDATA)
 	/** @dm_driver_rt: Dynamic info about the driver */
 	struct driver_rt *dm_driver_rt;
@@ -224,6 +233,13 @@ struct global_data {
 	 */
 	struct device_node *of_root;
 #endif
+#if CONFIG_IS_ENABLED(OF_PHANDLE_INDEX)
+	/**
+	 * @fdt_phandle_index: phandle index for @fdt_blob, see
+	 * fdtdec_node_offset_by_phandle()
+	 */
+	struct fdt_phandle_index *fdt_phandle_index;
+#endif
 
 #if CONFIG_IS_ENABLED(MULTI_DTB_FIT)
 	/**
@@ -278,6 +294,12 @@ struct global_data {
 	 * @malloc_ptr: current address of early malloc()
 	 */
 	unsigned long malloc_ptr;
+# if CONFIG_IS_ENABLED(MALLOC_STATS)
+	/**
+	 * @malloc_usage: heap usage for each caller of early malloc()
+	 */
+	struct malloc_usage *malloc_usage;
+# endif
 #endif
 #ifdef CONFIG_PCI
 	/**
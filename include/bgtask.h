@@ -0,0 +1,118 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Cooperative background tasks
+ *
+ * A background task is a function which does a small step of some slow
+ * operation (e.g. waiting for a link to come up) each time it is called. The
+ * pending tasks are called whenever U-Boot is waiting anyway: for console
+ * input, in udelay() and in the network loop. This allows slow operations to
+ * overlap with each other and with whatever else U-Boot is doing.
+ *
+ * There is no preemption: each step should return quickly.
+ */
+
+#ifndef __BGTASK_H
+#define __BGTASK_H
+
+#include <linux/list.h>
+
+/* udelay() polls background tasks at this interval, for delays this long */
+#define BGTASK_UDELAY_US	1000
+
+/**
+ * typedef bgtask_func - Do the next step of a background task
+ *
+ * @ctx: Context pointer passed to bgtask_start()
+ * @return -EAGAIN if there is more to do, 0 if the task has finished, other
+ *	-ve error code if it failed
+ */
+typedef int (*bgtask_func)(void *ctx);
+
+/**
+ * struct bgtask - A background task
+ *
+ * This is provided by the caller of bgtask_start() and must remain valid until
+ * the task has finished or been cancelled.
+ *
+ * @name: Name of the task, for debugging
+ * @func: Function to call for each step
+ * @ctx: Context pointer for @func
+ * @ret: -EAGAIN while the task is running, else the value returned by the
+ *	final step
+ * @sibling: Node in the list of pending tasks
+ */
+struct bgtask {
+	const char *name;
+	bgtask_func func;
+	void *ctx;
+	int ret;
+	struct list_head sibling;
+};
+
+#if CONFIG_IS_ENABLED(BGTASK)
+/**
+ * bgtask_start() - Start a background task
+ *
+ * The first step is not run until the tasks are next polled.
+ *
+ * @task: Task to start
+ * @name: Name of the task
+ * @func: Function to call for each step
+ * @ctx: Context pointer for @func
+ * @return 0 if OK, -EPERM if called before relocation
+ */
+int bgtask_start(struct bgtask *task, const char *name, bgtask_func func,
+		 void *ctx);
+
+/**
+ * bgtask_poll() - Run one step of each pending task
+ *
+ * This does nothing if called from within a task.
+ */
+void bgtask_poll(void);
+
+/**
+ * bgtask_wait() - Wait for a task to finish
+ *
+ * Other tasks are polled too while waiting. If called from within a task, only
+ * @task is run.
+ *
+ * @task: Task to wait for
+ * @timeout_ms: Maximum time to wait in milliseconds
+ * @return value returned by the final step of the task, or -ETIMEDOUT if it
+ *	did not finish in time (in which case it is still running)
+ */
+int bgtask_wait(struct bgtask *task, ulong timeout_ms);
+
+/**
+ * bgtask_cancel() - Stop a task without waiting for it to finish
+ *
+ * This must not be called from within the task itself.
+ *
+ * @task: Task to stop (this does nothing if it has already finished)
+ */
+void bgtask_cancel(struct bgtask *task);
+
+/**
+ * bgtask_pending() - Check if there are any tasks running
+ *
+ * @return true if any task has not yet finished
+ */
+bool bgtask_pending(void);
+
+/**
+ * bgtask_show() - Show the pending tasks
+ */
+void bgtask_show(void);
+#else
+static inline void bgtask_poll(void)
+{
+}
+
+static inline bool bgtask_pending(void)
+{
+	return false;
+}
+#endif
+
+#endif
@@ -54,6 +54,8 @@ enum sig_type {
 	SIG_TYPE_COUNT			/* Number of signature types */
 };
 
+struct part_cache;
+
 /*
  * With driver model (CONFIG_BLK) this is uclass platform data, accessible
  * with dev_get_uclass_platdata(dev)
@@ -86,6 +88,9 @@ struct blk_desc {
 		uint32_t mbr_sig;	/* MBR integer signature */
 		efi_guid_t guid_sig;	/* GPT GUID Signature */
 	};
+#if CONFIG_IS_ENABLED(PARTITION_CACHE)
+	struct part_cache *part_cache;	/* Parsed partition table, or NULL */
+#endif
 #if CONFIG_IS_ENABLED(BLK)
 	/*
 	 * For now we have a few functions which take struct blk_desc as a
@@ -204,6 +209,24 @@ static inline void blkcache_invalidate(int iftype, int dev) {}
 
 #endif
 
+#if CONFIG_IS_ENABLED(PARTITION_CACHE)
+/**
+ * part_cache_write() - Drop the cached partition table if it is overwritten
+ *
+ * This is called before blocks are written or erased. The partition table
+ * cached for the device is dropped if any of the blocks are outside the area
+ * covered by its partitions, since they may hold the partition table itself.
+ *
+ * @desc:	Block device being written
+ * @start:	First block to be written
+ * @blkcnt:	Number of blocks to be written
+ */
+void part_cache_write(struct blk_desc *desc, lbaint_t start, lbaint_t blkcnt);
+#else
+static inline void part_cache_write(struct blk_desc *desc, lbaint_t start,
+				    lbaint_t blkcnt) {}
+#endif
+
 #if CONFIG_IS_ENABLED(BLK)
 struct udevice;
 
@@ -457,6 +480,7 @@ static inline ulong blk_dwrite(struct blk_desc *block_dev, lbaint_t start,
 			       lbaint_t blkcnt, const void *buffer)
 {
 	blkcache_invalidate(block_dev->if_type, block_dev->devnum);
+	part_cache_write(block_dev, start, blkcnt);
 	return block_dev->block_write(block_dev, start, blkcnt, buffer);
 }
 
@@ -464,6 +488,7 @@ static inline ulong blk_derase(struct blk_desc *block_dev, lbaint_t start,
 			       lbaint_t blkcnt)
 {
 	blkcache_invalidate(block_dev->if_type, block_dev->devnum);
+	part_cache_write(block_dev, start, blkcnt);
 	return block_dev->block_erase(block_dev, start, blkcnt);
 }
 
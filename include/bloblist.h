@@ -38,6 +38,7 @@ enum bloblist_tag_t {
 	BLOBLISTT_TCPA_LOG,		/* TPM log space */
 	BLOBLISTT_ACPI_TABLES,		/* ACPI tables for x86 */
 	BLOBLISTT_SMBIOS_TABLES,	/* SMBIOS tables for x86 */
+	BLOBLISTT_MALLOC_STATS,		/* Heap usage from SPL */
 
 	BLOBLISTT_COUNT
 };
@@ -179,6 +180,35 @@ void *bloblist_ensure(uint tag, int size);
  */
 int bloblist_ensure_size_ret(uint tag, int *sizep, void **blobp);
 
+/**
+ * bloblist_load() - Copy out a blob with a known size and magic number
+ *
+ * This is for data saved by an earlier phase with bloblist_save(), which
+ * starts with a 32-bit magic number identifying its layout
+ *
+ * @tag:	Tag to search for (enum bloblist_tag_t)
+ * @buf:	Buffer to copy the blob into
+ * @size:	Size of @buf, which the blob must match
+ * @magic:	Value which the first 32-bit word of the blob must have
+ * @return 0 if OK, -ENOENT if there is no such blob, or it has the wrong size
+ *	or magic number
+ */
+int bloblist_load(uint tag, void *buf, int size, u32 magic);
+
+/**
+ * bloblist_save() - Save a copy of some data for later phases
+ *
+ * This can be called before the bloblist is set up, in which case nothing is
+ * saved.
+ *
+ * @tag:	Tag to add (enum bloblist_tag_t)
+ * @buf:	Data to save
+ * @size:	Size of @buf
+ * @return 0 if OK, -ENOENT if there is no bloblist yet, -ENOSPC if there is not
+ *	enough space, or -ESPIPE if the blob exists but has the wrong size
+ */
+int bloblist_save(uint tag, const void *buf, int size);
+
 /**
  * bloblist_new() - Create a new, empty bloblist of a given size
  *
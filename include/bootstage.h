@@ -15,6 +15,7 @@
 enum bootstage_flags {
 	BOOTSTAGEF_ERROR	= 1 << 0,	/* Error record */
 	BOOTSTAGEF_ALLOC	= 1 << 1,	/* Allocate an id */
+	BOOTSTAGEF_SPAN		= 1 << 2,	/* Span with a start and duration */
 };
 
 /* bootstate sub-IDs used for kernel and ramdisk ranges */
@@ -205,6 +206,7 @@ enum bootstage_id {
 	BOOTSTAGE_ID_ACCUM_FSP_M,
 	BOOTSTAGE_ID_ACCUM_FSP_S,
 	BOOTSTAGE_ID_ACCUM_MMAP_SPI,
+	BOOTSTAGE_ID_ACCUM_BOOTM_COPY,
 
 	/* a few spare for the user, from here */
 	BOOTSTAGE_ID_USER,
@@ -234,6 +236,9 @@ void show_boot_progress(int val);
 #if CONFIG_IS_ENABLED(BOOTSTAGE)
 #define ENABLE_BOOTSTAGE
 #endif
+#if CONFIG_IS_ENABLED(BOOTSTAGE_SPANS)
+#define ENABLE_BOOTSTAGE_SPANS
+#endif
 #endif
 
 #ifdef ENABLE_BOOTSTAGE
@@ -358,6 +363,20 @@ int bootstage_get_size(void);
  */
 int bootstage_init(bool first);
 
+/**
+ * bootstage_export_json() - Write bootstage records in Chrome trace format
+ *
+ * This writes a JSON object suitable for chrome://tracing or Perfetto. Marks
+ * become instant events, spans become complete events and accumulated times
+ * are placed in the 'otherData' section. The output is nul-terminated.
+ *
+ * @buf: Buffer to write to (may be NULL if @size is 0)
+ * @size: Size of buffer in bytes
+ * @return number of bytes needed for the output, including the terminator.
+ *	If this is larger than @size, the output was truncated.
+ */
+int bootstage_export_json(char *buf, int size);
+
 #else
 static inline ulong bootstage_add_record(enum bootstage_id id,
 		const char *name, int flags, ulong mark)
@@ -429,8 +448,50 @@ static inline int bootstage_init(bool first)
 	return 0;
 }
 
+static inline int bootstage_export_json(char *buf, int size)
+{
+	return 0;
+}
+
 #endif /* ENABLE_BOOTSTAGE */
 
+#ifdef ENABLE_BOOTSTAGE_SPANS
+/**
+ * bootstage_span_start() - Get the start time for a span
+ *
+ * @return current time in microseconds, to pass to bootstage_span()
+ */
+static inline ulong bootstage_span_start(void)
+{
+	return timer_get_boot_us();
+}
+
+/**
+ * bootstage_span() - Record an activity with a start time and duration
+ *
+ * This adds a span record covering the time from @start_us until now. Spans
+ * shorter than CONFIG_BOOTSTAGE_SPAN_MIN_US are dropped, so this can be used
+ * around frequent operations such as probing a device without filling up the
+ * record table.
+ *
+ * @start_us: Start time, from bootstage_span_start()
+ * @fmt: printf() format string for the name of the span
+ * @return duration of the span in microseconds
+ */
+ulong bootstage_span(ulong start_us, const char *fmt, ...)
+		__attribute__ ((format (__printf__, 2, 3)));
+#else
+static inline ulong bootstage_span_start(void)
+{
+	return 0;
+}
+
+static inline ulong bootstage_span(ulong start_us, const char *fmt, ...)
+{
+	return 0;
+}
+#endif /* ENABLE_BOOTSTAGE_SPANS */
+
 /* Helper macro for adding a bootstage to a line of code */
 #define BOOTSTAGE_MARKER()	\
 		bootstage_mark_code(__FILE__, __func__, __LINE__)
@@ -16,6 +16,25 @@ extern int u_boot_hush_start(void);
 extern int parse_string_outer(const char *, int);
 extern int parse_file_outer(void);
 
+#ifdef CONFIG_HUSH_SCRIPT_CACHE
+/**
+ * parse_string_cached() - Run a script, keeping its parse tree for next time
+ *
+ * This behaves like parse_string_outer() but the parsed script is cached, so
+ * that running the same text again does not need it to be parsed again.
+ *
+ * @s: Script to run
+ * @flag: FLAG_... flags for the parser
+ * @return 0 if OK, 1 on error
+ */
+int parse_string_cached(const char *s, int flag);
+#else
+static inline int parse_string_cached(const char *s, int flag)
+{
+	return parse_string_outer(s, flag);
+}
+#endif
+
 int set_local_var(const char *s, int flg_export);
 void unset_local_var(const char *name);
 char *get_local_var(const char *s);
@@ -12,6 +12,8 @@
 #define CONFIG_TRACE_EARLY_SIZE		(16 << 20)
 #define CONFIG_TRACE_EARLY
 #define CONFIG_TRACE_EARLY_ADDR		0x00100000
+#define CONFIG_TRACE_FUNC_STATS		1
+#define CONFIG_TRACE_FUNC_STATS_SIZE	4096
 #endif
 
 #ifndef CONFIG_SPL_BUILD
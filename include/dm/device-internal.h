@@ -114,11 +114,59 @@ int device_ofdata_to_platdata(struct udevice *dev);
  * Activate a device so that it is ready for use. All its parents are probed
  * first.
  *
+ * If the device's probe is finishing in the background (see
+ * device_probe_defer()), this waits for it to finish.
+ *
  * @dev: Pointer to device to probe
  * @return 0 if OK, -ve on error
  */
 int device_probe(struct udevice *dev);
 
+#if CONFIG_IS_ENABLED(DM_ASYNC_PROBE)
+/**
+ * device_probe_nowait() - Probe a device without waiting for it to be ready
+ *
+ * This is the same as device_probe() except that if the driver finishes its
+ * probe in the background (see device_probe_defer()), this returns as soon as
+ * the driver's probe() method has returned. It is used by dm_probe_async().
+ * The device has DM_FLAG_PROBE_PENDING set until it is ready.
+ *
+ * @dev: Pointer to device to probe
+ * @return 0 if OK, -ve on error
+ */
+int device_probe_nowait(struct udevice *dev);
+
+/**
+ * device_probe_wait() - Wait for a device's probe to finish in the background
+ *
+ * If the probe fails, the device is removed.
+ *
+ * @dev: Device with DM_FLAG_PROBE_PENDING set
+ * @return 0 if OK, -ETIMEDOUT if it took longer than DM_ASYNC_PROBE_TIMEOUT,
+ *	other -ve error if the probe failed
+ */
+int device_probe_wait(struct udevice *dev);
+
+/**
+ * device_probe_cancel() - Stop a device's probe finishing in the background
+ *
+ * This is used when the device is removed. It does nothing if the device's
+ * probe was not deferred.
+ *
+ * @dev: Device to update
+ */
+void device_probe_cancel(struct udevice *dev);
+#else
+static inline int device_probe_wait(struct udevice *dev)
+{
+	return 0;
+}
+
+static inline void device_probe_cancel(struct udevice *dev)
+{
+}
+#endif
+
 /**
  * device_remove() - Remove a device, de-activating it
  *
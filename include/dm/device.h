@@ -10,6 +10,7 @@
 #ifndef _DM_DEVICE_H
 #define _DM_DEVICE_H
 
+#include <dm/lists.h>
 #include <dm/ofnode.h>
 #include <dm/uclass-id.h>
 #include <fdtdec.h>
@@ -18,6 +19,7 @@
 #include <linux/list.h>
 #include <linux/printk.h>
 
+struct dm_probe_task;
 struct driver_info;
 
 /* Driver is active (probed). Cleared when it is removed */
@@ -73,6 +75,12 @@ struct driver_info;
  */
 #define DM_FLAG_REMOVE_WITH_PD_ON	(1 << 13)
 
+/* Device has children which are waiting to be bound, see DM_LAZY_BIND */
+#define DM_FLAG_LAZY_CHILDREN		(1 << 14)
+
+/* Device probe is finishing in the background, see device_probe_defer() */
+#define DM_FLAG_PROBE_PENDING		(1 << 15)
+
 /*
  * One or multiple of these flags are passed to device_remove() so that
  * a selective device removal as specified by the remove-stage and the
@@ -138,6 +146,12 @@ enum {
  *		When CONFIG_DEVRES is enabled, devm_kmalloc() and friends will
  *		add to this list. Memory so-allocated will be freed
  *		automatically when the device is removed / unbound
+ * @index_node: Used by uclass to find the device by each enum
+ *		uclass_index_key (CONFIG_DM_UCLASS_INDEX only). Since the
+ *		device is indexed by its name and node, these must only be
+ *		changed through device_set_name() and dev_set_ofnode().
+ * @probe_task: Background task finishing the probe, if the driver called
+ *		device_probe_defer() (CONFIG_DM_ASYNC_PROBE only)
  */
 struct udevice {
 	const struct driver *driver;
@@ -161,6 +175,12 @@ struct udevice {
 #ifdef CONFIG_DEVRES
 	struct list_head devres_head;
 #endif
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX)
+	struct hlist_node index_node[UCLASS_INDEX_COUNT];
+#endif
+#if CONFIG_IS_ENABLED(DM_ASYNC_PROBE)
+	struct dm_probe_task *probe_task;
+#endif
 };
 
 /* Maximum sequence number supported */
@@ -169,17 +189,30 @@ struct udevice {
 /* Returns the operations for a device */
 #define device_get_ops(dev)	(dev->driver->ops)
 
-/* Returns non-zero if the device is active (probed and not removed) */
-#define device_active(dev)	((dev)->flags & DM_FLAG_ACTIVATED)
+/*
+ * Returns non-zero if the device is active (probed and not removed). A device
+ * whose probe is still finishing in the background is not active yet.
+ */
+#define device_active(dev)	(((dev)->flags & (DM_FLAG_ACTIVATED | \
+						  DM_FLAG_PROBE_PENDING)) == \
+				 DM_FLAG_ACTIVATED)
 
 static inline int dev_of_offset(const struct udevice *dev)
 {
 	return ofnode_to_offset(dev->node);
 }
 
+/**
+ * dev_set_ofnode() - set the device tree node of a device
+ *
+ * @dev: Device to update
+ * @node: New node for the device
+ */
+void dev_set_ofnode(struct udevice *dev, ofnode node);
+
 static inline void dev_set_of_offset(struct udevice *dev, int of_offset)
 {
-	dev->node = offset_to_ofnode(of_offset);
+	dev_set_ofnode(dev, offset_to_ofnode(of_offset));
 }
 
 static inline bool dev_has_of_node(struct udevice *dev)
@@ -282,6 +315,16 @@ struct driver {
 #define DM_GET_DRIVER(__name)						\
 	ll_entry_get(struct driver, __name, driver)
 
+/*
+ * Refer to a driver in a static initialiser, e.g. in code generated by dtoc.
+ * DM_DRIVER_WEAK_DECL(name) must come first. If the driver is not built into
+ * the image, DM_DRIVER_REF(name) is NULL.
+ */
+#define DM_DRIVER_WEAK_DECL(__name)					\
+	ll_entry_weak_decl(struct driver, __name, driver)
+#define DM_DRIVER_REF(__name)						\
+	ll_entry_ref(struct driver, __name, driver)
+
 /**
  * Declare a macro to state a alias for a driver name. This macro will
  * produce no code but its information will be parsed by tools like
@@ -721,6 +764,44 @@ bool device_is_last_sibling(const struct udevice *dev);
  */
 int device_set_name(struct udevice *dev, const char *name);
 
+/**
+ * device_probe_defer() - Finish probing a device in the background
+ *
+ * This can be called from a driver's probe() method after starting something
+ * slow, such as link training, which does not need the CPU. The probe() method
+ * then returns 0 straight away and @finish is called from bgtask_poll() until
+ * it returns something other than -EAGAIN. After that the uclass'
+ * post_probe() method is called, as it would be at the end of device_probe().
+ *
+ * Until then the device has DM_FLAG_PROBE_PENDING set and device_active() is
+ * false. Only dm_probe_async() leaves the probe running in the background;
+ * device_probe() waits for it to finish, so uclass_get_device() and the like
+ * only return the device once it is ready. If the probe fails, the device is
+ * removed.
+ *
+ * @dev:	Device being probed
+ * @finish:	Function to call for each step of the probe. It must return
+ *		-EAGAIN if there is more to do, 0 when the device is ready, or
+ *		other -ve error on failure
+ * @return 0 if OK, -ENOMEM if out of memory
+ */
+#if CONFIG_IS_ENABLED(DM_ASYNC_PROBE)
+int device_probe_defer(struct udevice *dev, int (*finish)(struct udevice *dev));
+#else
+static inline int device_probe_defer(struct udevice *dev,
+				     int (*finish)(struct udevice *dev))
+{
+	int ret;
+
+	/* Finish the probe now */
+	do {
+		ret = finish(dev);
+	} while (ret == -EAGAIN);
+
+	return ret;
+}
+#endif
+
 /**
  * device_set_name_alloced() - note that a device name is allocated
  *
@@ -781,26 +862,58 @@ static inline bool device_is_on_pci_bus(const struct udevice *dev)
 	return dev->parent && device_get_uclass_id(dev->parent) == UCLASS_PCI;
 }
 
+/**
+ * device_child_head() - get the list of a device's children
+ *
+ * With DM_LAZY_BIND, any children waiting to be bound are bound first, so
+ * that the list is complete.
+ *
+ * @parent: parent device
+ * @return list of child devices, linked by their sibling_node
+ */
+static inline const struct list_head *
+device_child_head(const struct udevice *parent)
+{
+	if (CONFIG_IS_ENABLED(DM_LAZY_BIND) &&
+	    (parent->flags & DM_FLAG_LAZY_CHILDREN))
+		dm_lazy_bind_children(parent);
+
+	return &parent->child_head;
+}
+
 /**
  * device_foreach_child_safe() - iterate through child devices safely
  *
- * This allows the @pos child to be removed in the loop if required.
+ * This allows the @pos child to be removed in the loop if required. Children
+ * waiting to be bound are bound first, see device_child_head().
  *
  * @pos: struct udevice * for the current device
  * @next: struct udevice * for the next device
  * @parent: parent device to scan
  */
-#define device_foreach_child_safe(pos, next, parent)	\
-	list_for_each_entry_safe(pos, next, &parent->child_head, sibling_node)
+#define device_foreach_child_safe(pos, next, parent)			\
+	for (pos = list_entry(device_child_head(parent)->next,		\
+			      typeof(*pos), sibling_node),		\
+		next = list_entry(pos->sibling_node.next, typeof(*pos),	\
+				  sibling_node);			\
+	     &pos->sibling_node != &(parent)->child_head;		\
+	     pos = next, next = list_entry(next->sibling_node.next,	\
+					   typeof(*next), sibling_node))
 
 /**
  * device_foreach_child() - iterate through child devices
  *
+ * Children waiting to be bound are bound first, see device_child_head().
+ *
  * @pos: struct udevice * for the current device
  * @parent: parent device to scan
  */
-#define device_foreach_child(pos, parent)	\
-	list_for_each_entry(pos, &parent->child_head, sibling_node)
+#define device_foreach_child(pos, parent)				\
+	for (pos = list_entry(device_child_head(parent)->next,		\
+			      typeof(*pos), sibling_node);		\
+	     &pos->sibling_node != &(parent)->child_head;		\
+	     pos = list_entry(pos->sibling_node.next, typeof(*pos),	\
+			      sibling_node))
 
 /**
  * device_foreach_child_ofdata_to_platdata() - iterate through children
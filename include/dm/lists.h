@@ -12,6 +12,9 @@
 #include <dm/ofnode.h>
 #include <dm/uclass-id.h>
 
+struct udevice;
+struct udevice_id;
+
 /**
  * lists_driver_lookup_name() - Return u_boot_driver corresponding to name
  *
@@ -61,6 +64,87 @@ int lists_bind_drivers(struct udevice *parent, bool pre_reloc_only);
 int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp,
 		   bool pre_reloc_only);
 
+/**
+ * lists_driver_lookup_compatible() - find the driver for a compatible string
+ *
+ * This returns the first driver in the linker list whose of_match table has
+ * @compat. Once the full malloc() pool is available, a sorted table of all
+ * compatible strings is used for this (see DM_COMPAT_TABLE).
+ *
+ * @compat: compatible string to look up
+ * @of_idp: returns the entry in the driver's of_match table which matches
+ * @return pointer to driver, or NULL if not found
+ */
+struct driver *lists_driver_lookup_compatible(const char *compat,
+					      const struct udevice_id **of_idp);
+
+#if CONFIG_IS_ENABLED(DM_LAZY_BIND)
+/**
+ * lists_bind_fdt_lazy() - bind a device tree node when it is first needed
+ *
+ * This works out which driver to use for @node and records it, so that the
+ * device can be bound later by dm_lazy_bind_uclass() or
+ * dm_lazy_bind_children(). Nodes which have subnodes are bound straight
+ * away with lists_bind_fdt().
+ *
+ * @parent: parent device
+ * @node: device tree node to bind
+ * @pre_reloc_only: If true, bind only nodes with special devicetree properties,
+ * or drivers with the DM_FLAG_PRE_RELOC flag. If false bind all drivers.
+ * @return 0 if OK, -ENOMEM if out of memory, other -ve value on error
+ */
+int lists_bind_fdt_lazy(struct udevice *parent, ofnode node,
+			bool pre_reloc_only);
+
+/**
+ * dm_lazy_bind_uclass() - bind all waiting devices in a uclass
+ *
+ * @id: uclass ID to bind devices for
+ */
+void dm_lazy_bind_uclass(enum uclass_id id);
+
+/**
+ * dm_lazy_bind_children() - bind all waiting children of a device
+ *
+ * @parent: device whose children should be bound
+ */
+void dm_lazy_bind_children(const struct udevice *parent);
+
+/**
+ * dm_lazy_bind_all() - bind all waiting devices
+ */
+void dm_lazy_bind_all(void);
+
+/**
+ * dm_lazy_forget() - drop waiting children of a device
+ *
+ * This is used when a device's children are unbound, so that none of them
+ * are bound later.
+ *
+ * @parent: device whose children should be dropped
+ * @drv: drop only children which use this driver, or NULL for all
+ */
+void dm_lazy_forget(struct udevice *parent, const struct driver *drv);
+
+/**
+ * dm_lazy_free() - free the list of waiting devices
+ */
+void dm_lazy_free(void);
+#else
+static inline int lists_bind_fdt_lazy(struct udevice *parent, ofnode node,
+				      bool pre_reloc_only)
+{
+	return lists_bind_fdt(parent, node, NULL, pre_reloc_only);
+}
+
+static inline void dm_lazy_bind_uclass(enum uclass_id id) {}
+static inline void dm_lazy_bind_children(const struct udevice *parent) {}
+static inline void dm_lazy_bind_all(void) {}
+static inline void dm_lazy_forget(struct udevice *parent,
+				  const struct driver *drv) {}
+static inline void dm_lazy_free(void) {}
+#endif
+
 /**
  * device_bind_driver() - bind a device to a driver
  *
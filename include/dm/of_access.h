@@ -258,6 +258,24 @@ struct device_node *of_find_node_by_prop_value(struct device_node *from,
  */
 struct device_node *of_find_node_by_phandle(phandle handle);
 
+/**
+ * of_phandle_index_build() - build the phandle index for the live tree
+ *
+ * With CONFIG_OF_PHANDLE_INDEX this builds a hash table of all nodes in the
+ * live tree which have a phandle, so that of_find_node_by_phandle() does not
+ * need to walk the whole tree. Any previous index is discarded. A phandle
+ * which is missing from the index is looked up by walking the tree, and the
+ * index is rebuilt if it turns up there, so phandles added later are found.
+ *
+ * The index is only an accelerator. If there is not enough memory for it,
+ * lookups walk the tree instead, and do not try to build it again until this
+ * function is next called.
+ *
+ * @return 0 if OK (or if the index is not enabled), -ENOMEM if not enough
+ * memory
+ */
+int of_phandle_index_build(void);
+
 /**
  * of_read_u32() - Find and read a 32-bit integer from a property
  *
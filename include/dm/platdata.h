@@ -21,22 +21,29 @@
  *
  * @name:	Driver name
  * @platdata:	Driver-specific platform data
+ * @drv:	Driver to use, or NULL to look it up by @name. This is set by
+ *		dtoc, so that binding does not need to search the driver list
  * @platdata_size: Size of platform data structure
  * @parent_idx:	Index of the parent driver_info structure
+ * @req_seq:	Requested sequence number, from the devicetree aliases, or -1
  */
 struct driver_info {
 	const char *name;
 	const void *platdata;
 #if CONFIG_IS_ENABLED(OF_PLATDATA)
+	const struct driver *drv;
 	unsigned short platdata_size;
 	short parent_idx;
+	short req_seq;
 #endif
 };
 
 #if CONFIG_IS_ENABLED(OF_PLATDATA)
-#define driver_info_parent_id(driver_info)	driver_info->parent_idx
+#define driver_info_parent_id(driver_info)	((driver_info)->parent_idx)
+#define driver_info_req_seq(driver_info)	((driver_info)->req_seq)
 #else
 #define driver_info_parent_id(driver_info)	(-1)
+#define driver_info_req_seq(driver_info)	(-1)
 #endif
 
 /**
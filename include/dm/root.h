@@ -114,6 +114,18 @@ int dm_init(bool of_live);
  */
 int dm_uninit(void);
 
+/**
+ * dm_probe_async() - Start probing the devices in some uclasses
+ *
+ * This probes every device in each uclass. Drivers which use
+ * device_probe_defer() finish their probe in the background, so that the
+ * devices can become ready while U-Boot carries on.
+ *
+ * @uclasses: Space-separated list of uclass names, e.g. "ethernet usb"
+ * @return 0 (unknown uclasses and failed probes are skipped)
+ */
+int dm_probe_async(const char *uclasses);
+
 #if CONFIG_IS_ENABLED(DM_DEVICE_REMOVE)
 /**
  * dm_remove_devices_flags - Call remove function of all drivers with
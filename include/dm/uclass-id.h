@@ -131,4 +131,20 @@ enum uclass_id {
 	UCLASS_INVALID = -1,
 };
 
+/**
+ * enum uclass_index_key - keys by which devices in a uclass are indexed
+ *
+ * @UCLASS_INDEX_SEQ: Sequence number (seq) of a probed device
+ * @UCLASS_INDEX_NAME: Device name
+ * @UCLASS_INDEX_NODE: Device tree node
+ * @UCLASS_INDEX_COUNT: Number of keys
+ */
+enum uclass_index_key {
+	UCLASS_INDEX_SEQ,
+	UCLASS_INDEX_NAME,
+	UCLASS_INDEX_NODE,
+
+	UCLASS_INDEX_COUNT,
+};
+
 #endif
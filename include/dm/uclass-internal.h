@@ -196,6 +196,21 @@ int uclass_unbind_device(struct udevice *dev);
 static inline int uclass_unbind_device(struct udevice *dev) { return 0; }
 #endif
 
+/**
+ * uclass_index_update() - Update the uclass index after a device changes
+ *
+ * This must be called after changing the sequence number, name or device
+ * tree node of a device which is bound to a uclass, so that it can still be
+ * found by uclass_find_device_by_seq(), etc.
+ *
+ * @dev:	Pointer to the device
+ */
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX)
+void uclass_index_update(struct udevice *dev);
+#else
+static inline void uclass_index_update(struct udevice *dev) {}
+#endif
+
 /**
  * uclass_pre_probe_device() - Deal with a device that is about to be probed
  *
@@ -241,6 +256,18 @@ static inline int uclass_pre_remove_device(struct udevice *dev) { return 0; }
  */
 struct uclass *uclass_find(enum uclass_id key);
 
+/**
+ * uclass_find_or_add() - Find a uclass by its id, creating it if needed
+ *
+ * This is like uclass_get() but does not bind any devices which are waiting
+ * to be bound (see DM_LAZY_BIND). It is used when binding a device.
+ *
+ * @id:		Id to search for
+ * @ucp:	Returns pointer to uclass (there is only one per ID)
+ * @return 0 if OK, -EINVAL if there is no uclass driver for @id
+ */
+int uclass_find_or_add(enum uclass_id id, struct uclass **ucp);
+
 /**
  * uclass_destroy() - Destroy a uclass
  *
@@ -9,11 +9,36 @@
 #ifndef _DM_UCLASS_H
 #define _DM_UCLASS_H
 
+#include <dm/lists.h>
 #include <dm/ofnode.h>
 #include <dm/uclass-id.h>
 #include <linker_lists.h>
 #include <linux/list.h>
 
+/**
+ * struct uclass_index - hash tables for finding devices in a uclass
+ *
+ * Small uclasses are searched linearly. The tables are only created once a
+ * uclass has a few devices and are then grown to keep at most one device
+ * per bucket on average. Each device is linked into the tables through its
+ * index_node[] members.
+ *
+ * @bits: log2 of the number of buckets in each table, 0 if there are no
+ *	tables
+ * @dev_count: Number of devices in the uclass
+ * @heads: Bucket heads, with the table for each enum uclass_index_key one
+ *	after the other
+ * @lookups: Number of lookups made for each key
+ * @compares: Number of devices compared during lookups for each key
+ */
+struct uclass_index {
+	uint bits;
+	int dev_count;
+	struct hlist_head *heads;
+	ulong lookups[UCLASS_INDEX_COUNT];
+	ulong compares[UCLASS_INDEX_COUNT];
+};
+
 /**
  * struct uclass - a U-Boot drive class, collecting together similar drivers
  *
@@ -30,12 +55,16 @@
  * @dev_head: List of devices in this uclass (devices are attached to their
  * uclass when their bind method is called)
  * @sibling_node: Next uclass in the linked list of uclasses
+ * @index: Hash tables for finding devices (CONFIG_DM_UCLASS_INDEX only)
  */
 struct uclass {
 	void *priv;
 	struct uclass_driver *uc_drv;
 	struct list_head dev_head;
 	struct list_head sibling_node;
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX)
+	struct uclass_index index;
+#endif
 };
 
 struct driver;
@@ -397,33 +426,63 @@ int uclass_resolve_seq(struct udevice *dev);
 	if (!uclass_get(id, &uc)) \
 		list_for_each_entry(pos, &uc->dev_head, uclass_node)
 
+/**
+ * uclass_dev_head() - get the list of devices in a uclass
+ *
+ * With DM_LAZY_BIND, any devices waiting to be bound in the uclass are bound
+ * first, so that the list is complete.
+ *
+ * @uc: uclass to check
+ * @return list of devices, linked by their uclass_node
+ */
+static inline const struct list_head *
+uclass_dev_head(const struct uclass *uc)
+{
+	if (CONFIG_IS_ENABLED(DM_LAZY_BIND))
+		dm_lazy_bind_uclass(uc->uc_drv->id);
+
+	return &uc->dev_head;
+}
+
 /**
  * uclass_foreach_dev() - Helper function to iteration through devices
  *
  * This creates a for() loop which works through the available devices in
- * a uclass in order from start to end.
+ * a uclass in order from start to end. Devices waiting to be bound are bound
+ * first, see uclass_dev_head().
  *
  * @pos: struct udevice * to hold the current device. Set to NULL when there
  * are no more devices.
  * @uc: uclass to scan
  */
-#define uclass_foreach_dev(pos, uc)	\
-	list_for_each_entry(pos, &uc->dev_head, uclass_node)
+#define uclass_foreach_dev(pos, uc)					\
+	for (pos = list_entry(uclass_dev_head(uc)->next, typeof(*pos),	\
+			      uclass_node);				\
+	     &pos->uclass_node != &(uc)->dev_head;			\
+	     pos = list_entry(pos->uclass_node.next, typeof(*pos),	\
+			      uclass_node))
 
 /**
  * uclass_foreach_dev_safe() - Helper function to safely iteration through devs
  *
  * This creates a for() loop which works through the available devices in
  * a uclass in order from start to end. Inside the loop, it is safe to remove
- * @pos if required.
+ * @pos if required. Devices waiting to be bound are bound first, see
+ * uclass_dev_head().
  *
  * @pos: struct udevice * to hold the current device. Set to NULL when there
  * are no more devices.
  * @next: struct udevice * to hold the next next
  * @uc: uclass to scan
  */
-#define uclass_foreach_dev_safe(pos, next, uc)	\
-	list_for_each_entry_safe(pos, next, &uc->dev_head, uclass_node)
+#define uclass_foreach_dev_safe(pos, next, uc)				\
+	for (pos = list_entry(uclass_dev_head(uc)->next, typeof(*pos),	\
+			      uclass_node),				\
+		next = list_entry(pos->uclass_node.next, typeof(*pos),	\
+				  uclass_node);				\
+	     &pos->uclass_node != &(uc)->dev_head;			\
+	     pos = next, next = list_entry(next->uclass_node.next,	\
+					   typeof(*next), uclass_node))
 
 /**
  * uclass_foreach_dev_probe() - Helper function to iteration through devices
@@ -42,6 +42,15 @@ static inline void dm_dump_devres(void)
 /* Dump out a list of drivers */
 void dm_dump_drivers(void);
 
+/* Dump out uclass index sizes and lookup counts */
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX)
+void dm_dump_stats(void);
+#else
+static inline void dm_dump_stats(void)
+{
+}
+#endif
+
 /* Dump out a list with each driver's compatibility strings */
 void dm_dump_driver_compat(void);
 
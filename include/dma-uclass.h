@@ -134,6 +134,43 @@ struct dma_ops {
 	 */
 	int (*transfer)(struct udevice *dev, int direction, dma_addr_t dst,
 			dma_addr_t src, size_t len);
+	/**
+	 * transfer_submit() - Start a DMA transfer without waiting for it.
+	 *   Further transfers may be submitted before earlier ones are
+	 *   complete; the implementation queues them in order.
+	 *
+	 * @dev: The DMA device
+	 * @direction: direction of data transfer (should be one from
+	 *   enum dma_direction)
+	 * @dst: The destination pointer.
+	 * @src: The source pointer.
+	 * @len: Length of the data to be copied (number of bytes).
+	 * @cookiep: Returns a driver-specific value identifying the transfer,
+	 *   to be passed to transfer_poll()
+	 * @return zero on success, or -ve error code.
+	 */
+	int (*transfer_submit)(struct udevice *dev, int direction,
+			       dma_addr_t dst, dma_addr_t src, size_t len,
+			       ulong *cookiep);
+	/**
+	 * transfer_poll() - Check whether a submitted transfer is complete.
+	 *   This must not block.
+	 *
+	 * @dev: The DMA device
+	 * @cookie: Value returned by transfer_submit()
+	 * @return zero if the transfer is complete, -EBUSY if it is still in
+	 *   progress, or other -ve error code.
+	 */
+	int (*transfer_poll)(struct udevice *dev, ulong cookie);
+	/**
+	 * transfer_stop() - Stop a submitted transfer which has not completed,
+	 *   e.g. because it timed out. Transfers queued after it may be
+	 *   stopped too.
+	 *
+	 * @dev: The DMA device
+	 * @cookie: Value returned by transfer_submit()
+	 */
+	void (*transfer_stop)(struct udevice *dev, ulong cookie);
 };
 
 #endif /* _DMA_UCLASS_H */
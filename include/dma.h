@@ -305,6 +305,28 @@ int dma_send(struct dma *dma, void *src, size_t len, void *metadata);
 int dma_get_cfg(struct dma *dma, u32 cfg_id, void **cfg_data);
 #endif /* CONFIG_DMA_CHANNELS */
 
+/**
+ * struct dma_copy - An asynchronous memory-to-memory DMA copy
+ *
+ * This is filled in by dma_memcpy_submit() and must stay valid until
+ * dma_memcpy_poll() or dma_memcpy_wait() reports that the copy is done.
+ *
+ * @dev: DMA device doing the copy
+ * @dst: Destination address, as mapped for the device
+ * @src: Source address, as mapped for the device
+ * @len: Number of bytes being copied
+ * @cookie: Driver-specific value identifying the transfer
+ * @done: true once the copy is complete and the buffers are unmapped
+ */
+struct dma_copy {
+	struct udevice *dev;
+	dma_addr_t dst;
+	dma_addr_t src;
+	size_t len;
+	ulong cookie;
+	bool done;
+};
+
 #if CONFIG_IS_ENABLED(DMA)
 /*
  * dma_get_device - get a DMA device which supports transfer
@@ -329,6 +351,63 @@ int dma_get_device(u32 transfer_type, struct udevice **devp);
 	     transferred and on failure return error code.
  */
 int dma_memcpy(void *dst, void *src, size_t len);
+
+/**
+ * dma_memcpy_submit() - Start a memory copy using DMA, without waiting
+ *
+ * The CPU is free to do other work while the copy runs, but must not touch
+ * either buffer until the copy is complete. Several copies may be submitted
+ * before waiting for any of them; they are carried out in order.
+ *
+ * If the DMA device has no asynchronous support, the copy is done
+ * synchronously and is already complete when this returns.
+ *
+ * @copy: Returns information about the copy in progress
+ * @dst: Destination pointer
+ * @src: Source pointer, which must not overlap @dst
+ * @len: Number of bytes to copy
+ * @return 0 if OK, -ve on error (in which case nothing was copied)
+ */
+int dma_memcpy_submit(struct dma_copy *copy, void *dst, void *src,
+		      size_t len);
+
+/**
+ * dma_memcpy_poll() - Check whether a submitted copy is complete
+ *
+ * Once this returns 0 the destination buffer can be read by the CPU.
+ *
+ * @copy: Copy started by dma_memcpy_submit()
+ * @return 0 if complete, -EBUSY if still in progress, other -ve on error
+ */
+int dma_memcpy_poll(struct dma_copy *copy);
+
+/**
+ * dma_memcpy_wait() - Wait for a submitted copy to complete
+ *
+ * If the copy does not finish in time it is stopped and the buffers are
+ * unmapped, so the caller can copy them with the CPU instead.
+ *
+ * @copy: Copy started by dma_memcpy_submit()
+ * @return 0 if complete, -ETIMEDOUT if it did not finish in time, other -ve
+ *	on error
+ */
+int dma_memcpy_wait(struct dma_copy *copy);
+
+/**
+ * dma_memcpy_try() - Copy memory with DMA if the copy is large enough
+ *
+ * Copies of at least CONFIG_DMA_MEMCPY_THRESHOLD bytes between
+ * non-overlapping buffers are done with dma_memcpy(). Both buffers and the
+ * length must be aligned to ARCH_DMA_MINALIGN, since the cache maintenance
+ * for the copy works on whole cache lines. For anything else, or if DMA
+ * fails, nothing is copied and the caller should use the CPU.
+ *
+ * @dst: Destination pointer
+ * @src: Source pointer
+ * @len: Number of bytes to copy
+ * @return 0 if copied, -ve if the caller must do the copy itself
+ */
+int dma_memcpy_try(void *dst, void *src, size_t len);
 #else
 static inline int dma_get_device(u32 transfer_type, struct udevice **devp)
 {
@@ -339,5 +418,26 @@ static inline int dma_memcpy(void *dst, void *src, size_t len)
 {
 	return -ENOSYS;
 }
+
+static inline int dma_memcpy_submit(struct dma_copy *copy, void *dst,
+				    void *src, size_t len)
+{
+	return -ENOSYS;
+}
+
+static inline int dma_memcpy_poll(struct dma_copy *copy)
+{
+	return -ENOSYS;
+}
+
+static inline int dma_memcpy_wait(struct dma_copy *copy)
+{
+	return -ENOSYS;
+}
+
+static inline int dma_memcpy_try(void *dst, void *src, size_t len)
+{
+	return -ENOSYS;
+}
 #endif /* CONFIG_DMA */
 #endif	/* _DMA_H_ */
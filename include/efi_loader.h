@@ -566,6 +566,27 @@ efi_status_t efi_get_memory_map(efi_uintn_t *memory_map_size,
 				efi_uintn_t *map_key,
 				efi_uintn_t *descriptor_size,
 				uint32_t *descriptor_version);
+/**
+ * struct efi_mem_stats - memory map bookkeeping statistics
+ *
+ * @entries:	number of entries in the memory map
+ * @capacity:	number of entries the memory map has space for
+ * @updates:	number of changes made to the memory map
+ * @update_us:	time spent changing the memory map, in microseconds
+ */
+struct efi_mem_stats {
+	int entries;
+	int capacity;
+	ulong updates;
+	ulong update_us;
+};
+
+/**
+ * efi_get_memory_stats() - get memory map bookkeeping statistics
+ *
+ * @stats:	returns the statistics
+ */
+void efi_get_memory_stats(struct efi_mem_stats *stats);
 /* Adds a range into the EFI memory map */
 efi_status_t efi_add_memory_map(u64 start, u64 size, int memory_type);
 /* Adds a conventional range into the EFI memory map */
@@ -107,6 +107,26 @@ typedef struct environment_s {
 	unsigned char	data[ENV_SIZE]; /* Environment data		*/
 } env_t;
 
+/*
+ * With CONFIG_ENV_SF_JOURNAL the environment in SPI flash is stored as a
+ * list of records. The first record in the area holds the whole environment
+ * as "name=value" strings. Each following record holds the changes made by
+ * one save: "name=value" for a variable which was set and "name" for one
+ * which was deleted. Each string ends with a '\0'. Records start on a 4-byte
+ * boundary and the rest of the area is left erased, so that new records can
+ * be written without erasing it.
+ */
+#define ENV_SF_JOURNAL_FULL	0x46564e45	/* "ENVF" */
+#define ENV_SF_JOURNAL_DELTA	0x44564e45	/* "ENVD" */
+#define ENV_SF_JOURNAL_ERASED	0xffffffff
+
+struct env_sf_journal_rec {
+	uint32_t	magic;		/* ENV_SF_JOURNAL_FULL or _DELTA */
+	uint32_t	seq;		/* Sequence number of the area	*/
+	uint32_t	size;		/* Bytes of data after this header */
+	uint32_t	crc;		/* CRC32 over the fields above and data */
+};
+
 #ifdef ENV_IS_EMBEDDED
 extern env_t embedded_environment;
 #endif /* ENV_IS_EMBEDDED */
@@ -674,6 +674,31 @@ const char *fdtdec_get_compatible(enum fdt_compat_id id);
  */
 int fdtdec_lookup_phandle(const void *blob, int node, const char *prop_name);
 
+/**
+ * fdtdec_node_offset_by_phandle() - find the node with a given phandle
+ *
+ * This does the same as fdt_node_offset_by_phandle() but, with
+ * CONFIG_OF_PHANDLE_INDEX, uses a hash table for U-Boot's own device tree
+ * instead of scanning the whole tree each time. The table is built on first
+ * use and rebuilt if the tree is found to have changed.
+ *
+ * @blob:	FDT blob
+ * @phandle:	phandle to look up
+ * @return node offset if found, -ve error code on error
+ */
+int fdtdec_node_offset_by_phandle(const void *blob, uint32_t phandle);
+
+/**
+ * fdtdec_phandle_index_invalidate() - drop the phandle index for a tree
+ *
+ * This must be called after nodes are added to or removed from U-Boot's own
+ * device tree, for example when applying fixups or overlays, so that the
+ * index is rebuilt on the next lookup.
+ *
+ * @blob:	FDT blob which has been changed
+ */
+void fdtdec_phandle_index_invalidate(const void *blob);
+
 /**
  * Look up a property in a node and return its contents in an integer
  * array of given length. The property must have at least enough data for
@@ -407,6 +407,9 @@ typedef struct bootm_headers {
 
 	char		*ft_addr;	/* flat dev tree address */
 	ulong		ft_len;		/* length of flat device tree */
+	bool		ft_embedded;	/* FDT lies within another image */
+
+	ulong		copied;		/* bytes moved while placing images */
 
 	ulong		initrd_start;
 	ulong		initrd_end;
@@ -760,6 +763,7 @@ int boot_get_fdt(int flag, int argc, char *const argv[], uint8_t arch,
 		 char **of_flat_tree, ulong *of_size);
 void boot_fdt_add_mem_rsv_regions(struct lmb *lmb, void *fdt_blob);
 int boot_relocate_fdt(struct lmb *lmb, char **of_flat_tree, ulong *of_size);
+int boot_place_fdt(bootm_headers_t *images, ulong *of_size);
 
 int boot_ramdisk_high(struct lmb *lmb, ulong rd_data, ulong rd_len,
 		  ulong *initrd_start, ulong *initrd_end);
@@ -1186,6 +1190,49 @@ int fit_conf_get_prop_node(const void *fit, int noffset,
 
 int fit_check_ramdisk(const void *fit, int os_noffset,
 		uint8_t arch, int verify);
+
+/*
+ * Hashes are worked out in advance on the secondary cores, except when a
+ * hardware hash engine is used, since the drivers only expect to be called
+ * from the boot CPU, one hash at a time
+ */
+#ifdef USE_HOSTCC
+# define IMAGE_ENABLE_PREHASH	0
+#else
+# define IMAGE_ENABLE_PREHASH	(CONFIG_IS_ENABLED(WORKER) && \
+				 !IS_ENABLED(CONFIG_SHA_HW_ACCEL) && \
+				 !IS_ENABLED(CONFIG_SHA_PROG_HW_ACCEL))
+#endif
+
+#if IMAGE_ENABLE_PREHASH
+/**
+ * fit_conf_prehash() - Start hashing the images in a configuration
+ *
+ * The hashes of the images used by the configuration are worked out on the
+ * secondary cores, so they are ready when each image is verified. This does
+ * nothing if there are no secondary cores.
+ *
+ * @fit:	FIT to check
+ * @cfg_noffset: Offset of the configuration node
+ */
+void fit_conf_prehash(const void *fit, int cfg_noffset);
+
+/**
+ * fit_prehash_done() - Drop any hashes which have not been used
+ *
+ * This must be called once the images have been loaded, since the data that
+ * was hashed may be changed after that.
+ */
+void fit_prehash_done(void);
+#else
+static inline void fit_conf_prehash(const void *fit, int cfg_noffset)
+{
+}
+
+static inline void fit_prehash_done(void)
+{
+}
+#endif
 #endif /* IMAGE_ENABLE_FIT */
 
 int calculate_hash(const void *data, int data_len, const char *algo,
@@ -8,6 +8,7 @@
 
 typedef int (*init_fnc_t)(void);
 
+#include <bootstage.h>
 #include <log.h>
 #ifdef CONFIG_EFI_APP
 #include <efi.h>
@@ -24,6 +25,7 @@ static inline int initcall_run_list(const init_fnc_t init_sequence[])
 
 	for (init_fnc_ptr = init_sequence; *init_fnc_ptr; ++init_fnc_ptr) {
 		unsigned long reloc_ofs = 0;
+		ulong start_us;
 		int ret;
 
 		/*
@@ -42,7 +44,10 @@ static inline int initcall_run_list(const init_fnc_t init_sequence[])
 		else
 			debug("initcall: %p\n", (char *)*init_fnc_ptr - reloc_ofs);
 
+		start_us = bootstage_span_start();
 		ret = (*init_fnc_ptr)();
+		bootstage_span(start_us, "initcall %ps",
+			       (char *)*init_fnc_ptr - reloc_ofs);
 		if (ret) {
 			printf("initcall sequence %p failed at call %p (err=%d)\n",
 			       init_sequence,
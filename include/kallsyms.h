@@ -0,0 +1,18 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Builtin symbol table, see CONFIG_KALLSYMS
+ */
+
+#ifndef __KALLSYMS_H
+#define __KALLSYMS_H
+
+/**
+ * symbol_lookup() - Find the symbol containing an address
+ *
+ * @addr: Address to look up, as linked (i.e. before relocation)
+ * @caddr: Returns the address of the start of the symbol, or 0 if none
+ * @return name of the symbol, or NULL if not found
+ */
+const char *symbol_lookup(unsigned long addr, unsigned long *caddr);
+
+#endif
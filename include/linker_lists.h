@@ -210,6 +210,38 @@
 		_ll_result;						\
 	})
 
+/**
+ * ll_entry_weak_decl() - Declare a weak reference to an entry by name
+ * @_type:	Data type of the entry
+ * @_name:	Name of the entry
+ * @_list:	Name of the list in which this entry is placed
+ *
+ * This declares the entry so that ll_entry_ref() can be used in a static
+ * initialiser. If nothing in the image defines the entry, the reference is
+ * NULL instead of causing a link error.
+ *
+ * Example:
+ *
+ * ::
+ *
+ *   ll_entry_weak_decl(struct my_sub_cmd, my_sub_cmd, cmd_sub);
+ *   static struct my_sub_cmd *c = ll_entry_ref(struct my_sub_cmd, my_sub_cmd,
+ *                                              cmd_sub);
+ */
+#define ll_entry_weak_decl(_type, _name, _list)				\
+	extern _type _u_boot_list_2_##_list##_2_##_name __attribute__((weak))
+
+/**
+ * ll_entry_ref() - Refer to an entry declared with ll_entry_weak_decl()
+ * @_type:	Data type of the entry
+ * @_name:	Name of the entry
+ * @_list:	Name of the list in which this entry is placed
+ *
+ * Unlike ll_entry_get() this can be used in a static initialiser.
+ */
+#define ll_entry_ref(_type, _name, _list)				\
+	((_type *)&_u_boot_list_2_##_list##_2_##_name)
+
 /**
  * ll_start() - Point to first entry of first linker-generated array
  * @_type:	Data type of the entry
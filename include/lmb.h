@@ -12,25 +12,96 @@
  * Copyright (C) 2001 Peter Bergner, IBM Corp.
  */
 
+/* Number of regions held in struct lmb_region before moving to the heap */
 #define MAX_LMB_REGIONS 8
 
+/**
+ * enum lmb_owner - what a reserved region is used for
+ *
+ * This is only used for diagnostics. Adjacent regions are merged only if
+ * they have the same owner, so that each region can be attributed.
+ *
+ * @LMB_OWNER_NONE: Not recorded
+ * @LMB_OWNER_UBOOT: U-Boot itself, from arch/board_lmb_reserve()
+ * @LMB_OWNER_FDT: Reserved-memory and /memreserve/ entries in the FDT
+ * @LMB_OWNER_BOOTM: Images placed by bootm
+ * @LMB_OWNER_FS: Files loaded from a filesystem
+ */
+enum lmb_owner {
+	LMB_OWNER_NONE,
+	LMB_OWNER_UBOOT,
+	LMB_OWNER_FDT,
+	LMB_OWNER_BOOTM,
+	LMB_OWNER_FS,
+
+	LMB_OWNER_COUNT,
+};
+
 struct lmb_property {
 	phys_addr_t base;
 	phys_size_t size;
+	enum lmb_owner owner;
 };
 
+/**
+ * struct lmb_region - a table of regions, sorted by base address
+ *
+ * The table starts out in @initial and moves to @heap when it outgrows that,
+ * so lmb_release() must be called once a struct lmb is finished with. Use
+ * lmb_regions() to get at the table.
+ *
+ * @cnt: Number of regions in use
+ * @max: Number of regions that the table can hold
+ * @size: Not currently maintained
+ * @heap: Region table allocated on the heap, or NULL if @initial is used
+ * @initial: Storage for the first MAX_LMB_REGIONS regions
+ */
 struct lmb_region {
 	unsigned long cnt;
+	unsigned long max;
 	phys_size_t size;
-	struct lmb_property region[MAX_LMB_REGIONS+1];
+	struct lmb_property *heap;
+	struct lmb_property initial[MAX_LMB_REGIONS];
 };
 
+/**
+ * lmb_regions() - Get the table of regions
+ *
+ * @rgn: Region table
+ * @return pointer to the first of @rgn->cnt regions, sorted by base address
+ */
+static inline struct lmb_property *lmb_regions(struct lmb_region *rgn)
+{
+	return rgn->heap ? rgn->heap : rgn->initial;
+}
+
+/**
+ * struct lmb - logical memory blocks
+ *
+ * The region tables may point to heap storage, so a struct lmb must not be
+ * copied by assignment: the copy would share that storage and releasing
+ * both would free it twice.
+ *
+ * @memory: Memory regions available
+ * @reserved: Regions reserved or allocated from @memory
+ * @owner: Owner recorded for new reservations and allocations
+ */
 struct lmb {
 	struct lmb_region memory;
 	struct lmb_region reserved;
+	enum lmb_owner owner;
 };
 
 extern void lmb_init(struct lmb *lmb);
+/**
+ * lmb_release() - Free any heap storage used by an lmb
+ *
+ * This leaves @lmb empty, as after lmb_init(). It is also safe to call on a
+ * zeroed struct lmb.
+ *
+ * @lmb: lmb to release
+ */
+void lmb_release(struct lmb *lmb);
 extern void lmb_init_and_reserve(struct lmb *lmb, struct bd_info *bd,
 				 void *fdt_blob);
 extern void lmb_init_and_reserve_range(struct lmb *lmb, phys_addr_t base,
@@ -54,7 +125,7 @@ extern void lmb_dump_all_force(struct lmb *lmb);
 static inline phys_size_t
 lmb_size_bytes(struct lmb_region *type, unsigned long region_nr)
 {
-	return type->region[region_nr].size;
+	return lmb_regions(type)[region_nr].size;
 }
 
 void board_lmb_reserve(struct lmb *lmb);
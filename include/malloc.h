@@ -924,6 +924,23 @@ void malloc_simple_info(void);
 # define mALLOPt		mallopt
 # endif /* USE_DL_PREFIX */
 
+# if CONFIG_IS_ENABLED(MALLOC_STATS)
+/*
+ * The allocator provides its functions under these names. The public ones are
+ * in malloc_stats.c, which records the caller of each one before passing it on.
+ */
+# undef cALLOc
+# undef fREe
+# undef mALLOc
+# undef mEMALIGn
+# undef rEALLOc
+# define cALLOc		calloc_impl
+# define fREe		free_impl
+# define mALLOc		malloc_impl
+# define mEMALIGn	memalign_impl
+# define rEALLOc		realloc_impl
+# endif /* MALLOC_STATS */
+
 #endif
 
 /* Set up pre-relocation malloc() ready for use */
@@ -951,6 +968,13 @@ size_t  malloc_usable_size(Void_t*);
 void    malloc_stats(void);
 int     mALLOPt(int, int);
 struct mallinfo mALLINFo(void);
+#if CONFIG_IS_ENABLED(MALLOC_STATS) && !CONFIG_IS_ENABLED(SYS_MALLOC_SIMPLE)
+void *malloc(size_t bytes);
+void free(void *ptr);
+void *calloc(size_t nmemb, size_t size);
+void *realloc(void *ptr, size_t bytes);
+void *memalign(size_t alignment, size_t bytes);
+#endif
 # else
 Void_t* mALLOc();
 void    fREe();
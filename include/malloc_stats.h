@@ -0,0 +1,155 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Heap usage statistics for each caller of malloc()
+ */
+
+#ifndef __MALLOC_STATS_H
+#define __MALLOC_STATS_H
+
+#include <linux/types.h>
+
+/**
+ * struct malloc_site - Heap usage for a single caller
+ *
+ * @caller: Return address of the call to malloc(), or 0 if the entry is unused
+ * @count: Number of allocations made from this address
+ * @bytes: Number of bytes currently allocated from this address
+ * @peak: Largest value that @bytes has reached
+ */
+struct malloc_site {
+	ulong caller;
+	uint count;
+	ulong bytes;
+	ulong peak;
+};
+
+/**
+ * struct malloc_usage - Heap usage for one heap
+ *
+ * @cur: Number of bytes currently allocated
+ * @peak: Largest value that @cur has reached
+ * @count: Number of allocations made
+ * @dropped: Number of allocations from callers which did not fit in @sites
+ * @untracked: Number of allocations which could not be tracked until freed,
+ *	because the table of live allocations was full
+ * @num_sites: Number of entries in use in @sites
+ * @max_sites: Number of entries in @sites
+ * @f_used: Bytes used in the pre-relocation heap, set when it is replaced
+ * @f_size: Size of the pre-relocation heap, set when it is replaced
+ * @sites: Hash table of callers
+ */
+struct malloc_usage {
+	ulong cur;
+	ulong peak;
+	uint count;
+	uint dropped;
+	uint untracked;
+	uint num_sites;
+	uint max_sites;
+	ulong f_used;
+	ulong f_size;
+	struct malloc_site *sites;
+};
+
+/**
+ * struct malloc_handoff - Heap usage passed from SPL to U-Boot proper
+ *
+ * This is stored in the bloblist with tag BLOBLISTT_MALLOC_STATS.
+ *
+ * @f_used: Bytes used in the pre-relocation heap
+ * @f_size: Size of the pre-relocation heap
+ * @peak: Largest number of bytes allocated from the main heap
+ * @size: Size of the main heap, or 0 if there was none
+ */
+struct malloc_handoff {
+	u32 f_used;
+	u32 f_size;
+	u32 peak;
+	u32 size;
+};
+
+#if CONFIG_IS_ENABLED(MALLOC_STATS)
+/**
+ * malloc_stats_alloc() - Record an allocation
+ *
+ * @ptr: Pointer returned by the allocator (NULL is ignored)
+ * @size: Number of bytes requested
+ * @caller: Return address of the call to the allocator
+ */
+void malloc_stats_alloc(void *ptr, size_t size, ulong caller);
+
+/**
+ * malloc_stats_free() - Record that a block has been freed
+ *
+ * Blocks which were not allocated from the main heap are ignored.
+ *
+ * @ptr: Block being freed
+ */
+void malloc_stats_free(void *ptr);
+
+/**
+ * malloc_stats_init() - Start recording for the main heap
+ *
+ * This is called when the main heap is set up. It saves the statistics for the
+ * pre-relocation heap and clears those for the main heap.
+ */
+void malloc_stats_init(void);
+
+/**
+ * malloc_stats_new_f_pool() - Note that the pre-relocation heap is replaced
+ *
+ * This records how much of the pre-relocation heap was used, before SPL moves
+ * to a new simple heap in a larger region.
+ */
+void malloc_stats_new_f_pool(void);
+
+/**
+ * malloc_stats_get() - Get the statistics for a heap
+ *
+ * @early: true to get the pre-relocation heap, false for the main heap
+ * @return pointer to the statistics, or NULL if there are none
+ */
+struct malloc_usage *malloc_stats_get(bool early);
+
+/**
+ * malloc_stats_write_handoff() - Write heap usage to the bloblist
+ *
+ * This is used by SPL so that U-Boot proper can report it.
+ *
+ * @return 0 if OK, -ENOSPC if there is no space in the bloblist
+ */
+int malloc_stats_write_handoff(void);
+
+/**
+ * malloc_stats_show() - Show heap usage
+ *
+ * @max_sites: Maximum number of callers to show for each heap
+ */
+void malloc_stats_show(int max_sites);
+
+/* Allocate from the simple heap without recording it, for the stats table */
+void *malloc_simple_untracked(size_t bytes);
+#else
+static inline void malloc_stats_alloc(void *ptr, size_t size, ulong caller)
+{
+}
+
+static inline void malloc_stats_free(void *ptr)
+{
+}
+
+static inline void malloc_stats_init(void)
+{
+}
+
+static inline void malloc_stats_new_f_pool(void)
+{
+}
+
+static inline int malloc_stats_write_handoff(void)
+{
+	return 0;
+}
+#endif
+
+#endif
@@ -407,4 +407,73 @@ void *os_find_text_base(void);
  */
 void os_relaunch(char *argv[]);
 
+/**
+ * os_profile_start() - Start sampling the call stack
+ *
+ * This sets up a timer which fires each time the process has used
+ * @period_us of CPU time. Each time it fires, @func is called from the
+ * signal handler with the call stack at the point where the program was
+ * interrupted, innermost frame first.
+ *
+ * @period_us:	Sample period in microseconds
+ * @func:	Function to call for each sample. This must be safe to call
+ *		from a signal handler, so must not allocate memory or print
+ * Return:	0 if OK, -EBUSY if already started, -EIO if the timer could not
+ *		be set up
+ */
+int os_profile_start(unsigned int period_us,
+		     void (*func)(void *const *frames, int count));
+
+/**
+ * os_profile_stop() - Stop sampling the call stack
+ *
+ * This does nothing if sampling is not active.
+ */
+void os_profile_stop(void);
+
+/**
+ * os_find_symbol() - Find the function containing an address
+ *
+ * This looks up an address in the running program using the symbol table of
+ * the executable. The table is read on first use.
+ *
+ * @addr:	Address to look up, as used at run time
+ * @offsetp:	Returns the offset of @addr from the start of the function
+ * Return:	name of the function, or NULL if not found
+ */
+const char *os_find_symbol(unsigned long addr, unsigned long *offsetp);
+
+/**
+ * os_thread_create() - Start a host thread
+ *
+ * The thread runs with all signals blocked, so that they are handled by the
+ * main thread.
+ *
+ * @func:	Function for the thread to run
+ * @arg:	Argument to pass to @func
+ * Return:	0 if OK, -ve on error
+ */
+int os_thread_create(void (*func)(void *arg), void *arg);
+
+/**
+ * os_thread_exit() - Stop the calling thread
+ *
+ * This must only be called from a thread started by os_thread_create().
+ */
+void os_thread_exit(void);
+
+/**
+ * os_event_wait() - Wait for os_event_signal() to be called
+ *
+ * This works like the ARM WFE instruction: it returns immediately if
+ * os_event_signal() has been called since this thread last returned from
+ * os_event_wait(). It may also return early.
+ */
+void os_event_wait(void);
+
+/**
+ * os_event_signal() - Wake up all threads waiting in os_event_wait()
+ */
+void os_event_signal(void);
+
 #endif
@@ -326,6 +326,82 @@ struct part_driver {
 #define U_BOOT_PART_TYPE(__name)					\
 	ll_entry_declare(struct part_driver, __name, part_driver)
 
+/**
+ * struct part_cache - Partition table cached for a block device
+ *
+ * This holds a partition table which has been read from a block device and
+ * checked, so that it does not need to be read again for each partition.
+ * It is dropped when the device is scanned again with part_init() or when
+ * blocks outside @first_lba..@last_lba are written.
+ *
+ * @part_type:	Partition type which the table was read for (PART_TYPE_...)
+ * @hwpart:	Hardware partition which the table was read from
+ * @first_lba:	First block which may be used by partitions
+ * @last_lba:	Last block which may be used by partitions
+ * @size:	Number of bytes in @data
+ * @data:	Partition table, in a format chosen by the partition driver
+ */
+struct part_cache {
+	int part_type;
+	int hwpart;
+	lbaint_t first_lba;
+	lbaint_t last_lba;
+	size_t size;
+	u8 data[];
+};
+
+#if CONFIG_IS_ENABLED(PARTITION_CACHE)
+/**
+ * part_cache_get() - Get the partition table cached for a block device
+ *
+ * @desc:	Block device descriptor
+ * @part_type:	Partition type wanted (PART_TYPE_...)
+ * @return cached table, or NULL if there is none for @part_type and the
+ *	   hardware partition currently selected
+ */
+struct part_cache *part_cache_get(struct blk_desc *desc, int part_type);
+
+/**
+ * part_cache_new() - Add a partition table to the cache for a block device
+ *
+ * This replaces any table already cached for the device. The caller must
+ * fill in the data.
+ *
+ * @desc:	Block device descriptor
+ * @part_type:	Partition type of the table (PART_TYPE_...)
+ * @first_lba:	First block which may be used by partitions
+ * @last_lba:	Last block which may be used by partitions
+ * @size:	Number of bytes needed for the table
+ * @return new cache entry, or NULL if out of memory
+ */
+struct part_cache *part_cache_new(struct blk_desc *desc, int part_type,
+				  lbaint_t first_lba, lbaint_t last_lba,
+				  size_t size);
+
+/**
+ * part_cache_drop() - Drop the partition table cached for a block device
+ *
+ * @desc:	Block device descriptor
+ */
+void part_cache_drop(struct blk_desc *desc);
+#else
+static inline struct part_cache *part_cache_get(struct blk_desc *desc,
+						int part_type)
+{
+	return NULL;
+}
+
+static inline struct part_cache *part_cache_new(struct blk_desc *desc,
+						int part_type,
+						lbaint_t first_lba,
+						lbaint_t last_lba, size_t size)
+{
+	return NULL;
+}
+
+static inline void part_cache_drop(struct blk_desc *desc) {}
+#endif
+
 #include <part_efi.h>
 
 #if CONFIG_IS_ENABLED(EFI_PARTITION)
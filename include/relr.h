@@ -0,0 +1,30 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Packed relative relocations (RELR)
+ */
+
+#ifndef __RELR_H
+#define __RELR_H
+
+#include <linux/types.h>
+
+/**
+ * relr_apply() - Apply packed relative relocations
+ *
+ * Each entry in the table is either an address or a bitmap. An address (bit 0
+ * clear) is the link address of a word to relocate. A bitmap (bit 0 set)
+ * covers the words following the last one relocated: bit n (n >= 1) being set
+ * means that word n - 1 of them must be relocated. Each bitmap moves on by
+ * one bit fewer than the number of bits in a word.
+ *
+ * Relocating a word means adding @offset to it. The words are assumed to be
+ * at their link address plus @offset, i.e. the image has already been copied.
+ *
+ * @start: First entry in the table (e.g. __relr_dyn_start)
+ * @end: End of the table
+ * @offset: Difference between the address the image is at and its link
+ *	address
+ */
+void relr_apply(const ulong *start, const ulong *end, ulong offset);
+
+#endif
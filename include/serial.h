@@ -194,6 +194,25 @@ struct dm_serial_ops {
 	 * @return 0 if OK, -ve on error
 	 */
 	int (*putc)(struct udevice *dev, const char ch);
+	/**
+	 * puts() - Write a string
+	 *
+	 * This writes as many characters as the device can accept without
+	 * waiting, e.g. enough to fill its transmit FIFO. It is called
+	 * repeatedly until the whole string is written. Newlines are not
+	 * translated: the uclass sends "\r\n" itself.
+	 *
+	 * This method is optional. If it is not provided, putc() is used for
+	 * each character. It is only used with CONFIG_SERIAL_PUTS, or
+	 * CONFIG_SPL_SERIAL_PUTS in SPL.
+	 *
+	 * @dev: Device pointer
+	 * @str: Characters to write (not nul-terminated)
+	 * @len: Number of characters to write (at least 1)
+	 * @return number of characters written (which may be fewer than
+	 *	@len), -EAGAIN if none can be written yet, other -ve on error
+	 */
+	ssize_t (*puts)(struct udevice *dev, const char *str, size_t len);
 	/**
 	 * pending() - Check if input/output characters are waiting
 	 *
@@ -0,0 +1,128 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Two-Level Segregated Fit (TLSF) memory allocator
+ *
+ * Free blocks are kept in lists indexed by a two-level bitmap: the first level
+ * splits sizes by power of two and the second level subdivides each of those
+ * linearly. Finding a suitable block, splitting it and merging it with its
+ * neighbours when freed are all O(1), so the time taken by an allocation does
+ * not depend on how many blocks are in use or how fragmented the pool is.
+ */
+
+#ifndef __TLSF_H
+#define __TLSF_H
+
+#include <linux/types.h>
+
+struct tlsf;
+
+/**
+ * struct tlsf_info - Statistics for a TLSF pool
+ *
+ * @total: Number of bytes available for blocks (including their headers)
+ * @used: Number of bytes in allocated blocks (including their headers)
+ * @max_used: Largest value that @used has reached
+ * @free_blocks: Number of free blocks
+ * @largest_free: Size of the largest free block which can be allocated
+ */
+struct tlsf_info {
+	size_t total;
+	size_t used;
+	size_t max_used;
+	uint free_blocks;
+	size_t largest_free;
+};
+
+/**
+ * tlsf_create() - Create a new pool in a region of memory
+ *
+ * The control structure is placed at the start of the region and the rest is
+ * used for blocks. Regions too large for a single block are truncated.
+ *
+ * @mem: Start of region
+ * @size: Size of region in bytes
+ * @return pointer to the new pool, or NULL if the region is too small
+ */
+struct tlsf *tlsf_create(void *mem, size_t size);
+
+/**
+ * tlsf_malloc() - Allocate a block
+ *
+ * @tlsf: Pool to allocate from
+ * @size: Number of bytes required
+ * @return pointer to the block, or NULL if there is not enough space
+ */
+void *tlsf_malloc(struct tlsf *tlsf, size_t size);
+
+/**
+ * tlsf_memalign() - Allocate a block with a particular alignment
+ *
+ * @tlsf: Pool to allocate from
+ * @align: Required alignment in bytes (must be a power of two)
+ * @size: Number of bytes required
+ * @return pointer to the block, or NULL if there is not enough space
+ */
+void *tlsf_memalign(struct tlsf *tlsf, size_t align, size_t size);
+
+/**
+ * tlsf_realloc() - Change the size of a block
+ *
+ * The block is resized in place if possible, otherwise a new block is
+ * allocated and the contents are copied to it.
+ *
+ * @tlsf: Pool containing the block
+ * @ptr: Block to resize, or NULL to allocate a new one
+ * @size: New size in bytes, or 0 to free the block
+ * @return pointer to the resized block, or NULL if there is not enough space
+ *	(in which case @ptr is left unchanged) or @size is 0
+ */
+void *tlsf_realloc(struct tlsf *tlsf, void *ptr, size_t size);
+
+/**
+ * tlsf_free() - Free a block
+ *
+ * @tlsf: Pool containing the block
+ * @ptr: Block to free (NULL is ignored)
+ */
+void tlsf_free(struct tlsf *tlsf, void *ptr);
+
+/**
+ * tlsf_usable_size() - Get the number of usable bytes in a block
+ *
+ * @ptr: Allocated block
+ * @return size of the block, which may be larger than was requested
+ */
+size_t tlsf_usable_size(const void *ptr);
+
+/**
+ * tlsf_contains() - Check whether a pointer is inside a pool
+ *
+ * @tlsf: Pool to check
+ * @ptr: Pointer to check
+ * @return true if @ptr is within the part of the pool used for blocks
+ */
+bool tlsf_contains(struct tlsf *tlsf, const void *ptr);
+
+/**
+ * tlsf_get_info() - Get statistics for a pool
+ *
+ * This walks the list of free blocks in the largest size class, so takes a
+ * little longer than the other operations.
+ *
+ * @tlsf: Pool to check
+ * @info: Returns the statistics
+ */
+void tlsf_get_info(struct tlsf *tlsf, struct tlsf_info *info);
+
+/**
+ * tlsf_check() - Check the consistency of a pool
+ *
+ * This walks every block in the pool, checking that the headers, free lists
+ * and bitmaps agree with each other. It is intended for testing.
+ *
+ * @tlsf: Pool to check
+ * @return 0 if OK, -EINVAL if the pool is corrupted
+ */
+int tlsf_check(struct tlsf *tlsf);
+
+#endif
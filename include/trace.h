@@ -45,6 +45,28 @@ struct trace_output_hdr {
 /* Print statistics about traced function calls */
 void trace_print_stats(void);
 
+/* Order for the functions shown by trace_print_top() */
+enum trace_sort {
+	TRACE_SORT_SELF,	/* Time excluding called functions */
+	TRACE_SORT_TOTAL,	/* Time including called functions */
+	TRACE_SORT_CALLS,	/* Number of calls */
+	TRACE_SORT_MAX,		/* Longest single call */
+};
+
+/**
+ * trace_print_top() - Print the functions which take the most time
+ *
+ * This shows the number of calls to each function along with the total,
+ * self (excluding called functions), average, minimum and maximum time.
+ * It needs CONFIG_TRACE_FUNC_STATS.
+ *
+ * @count:	Maximum number of functions to show
+ * @sort:	Order in which to show them
+ * Return:	0 if OK, -ENOSYS if not supported, -ENOENT if trace has not
+ *		been set up, -ENOMEM if out of memory
+ */
+int trace_print_top(int count, enum trace_sort sort);
+
 /**
  * Dump a list of functions and call counts into a buffer
  *
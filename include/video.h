@@ -112,6 +112,15 @@ struct video_priv {
 	ushort *cmap;
 	u8 fg_col_idx;
 	u8 bg_col_idx;
+#ifdef CONFIG_VIDEO_DAMAGE
+	/* Area changed since the last sync, in pixels (empty if xend is 0) */
+	struct {
+		int xstart;
+		int ystart;
+		int xend;
+		int yend;
+	} damage;
+#endif
 };
 
 /* Placeholder - there are no video operations at present */
@@ -161,6 +170,28 @@ int video_clear(struct udevice *dev);
  */
 void video_sync(struct udevice *vid, bool force);
 
+#ifdef CONFIG_VIDEO_DAMAGE
+/**
+ * video_damage() - Record that part of the frame buffer has changed
+ *
+ * The area is added to the area which is copied to the copy frame buffer
+ * and flushed from the cache by the next video_sync(). It is cropped to
+ * the display.
+ *
+ * @vid:	Device which was updated
+ * @x:		X position of the changed area in pixels
+ * @y:		Y position of the changed area in pixels
+ * @width:	Width of the changed area in pixels
+ * @height:	Height of the changed area in pixels
+ */
+void video_damage(struct udevice *vid, int x, int y, int width, int height);
+#else
+static inline void video_damage(struct udevice *vid, int x, int y, int width,
+				int height)
+{
+}
+#endif
+
 /**
  * video_sync_all() - Sync all devices' frame buffers with there hardware
  *
@@ -220,15 +251,18 @@ void video_set_flush_dcache(struct udevice *dev, bool flush);
  */
 void video_set_default_colors(struct udevice *dev, bool invert);
 
-#ifdef CONFIG_VIDEO_COPY
+#if defined(CONFIG_VIDEO_COPY) || defined(CONFIG_VIDEO_DAMAGE)
 /**
- * vidconsole_sync_copy() - Sync back to the copy framebuffer
+ * video_sync_copy() - Sync back to the copy framebuffer
  *
  * This ensures that the copy framebuffer has the same data as the framebuffer
  * for a particular region. It should be called after the framebuffer is updated
  *
  * @from and @to can be in either order. The region between them is synced.
  *
+ * With CONFIG_VIDEO_DAMAGE the region is only recorded, and is copied by the
+ * next video_sync().
+ *
  * @dev: Vidconsole device being updated
  * @from: Start/end address within the framebuffer (->fb)
  * @to: Other address within the frame buffer
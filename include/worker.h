@@ -0,0 +1,189 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Running jobs on secondary CPU cores
+ *
+ * U-Boot normally runs only on the boot CPU. This allows some of the other
+ * cores to be used for CPU-bound jobs such as hashing and decompression. There
+ * is no scheduler: a job is submitted to a queue, any idle core (including
+ * the boot CPU while it waits) picks it up and runs it to completion.
+ *
+ * Jobs run in parallel with the rest of U-Boot, so they must only work on the
+ * memory they are given. They must not allocate memory, print, use drivers or
+ * access global state. The only exception is WATCHDOG_RESET(), which does
+ * nothing except on the boot CPU.
+ */
+
+#ifndef __WORKER_H
+#define __WORKER_H
+
+/**
+ * typedef worker_func - Function which does the work for a job
+ *
+ * @ctx: Context pointer passed to worker_submit()
+ * @return 0 if OK, -ve on error
+ */
+typedef int (*worker_func)(void *ctx);
+
+/**
+ * struct worker_job - A job to run on another core
+ *
+ * This is provided by the caller of worker_submit() and must remain valid
+ * until worker_wait() returns.
+ *
+ * @func: Function to run
+ * @ctx: Context pointer for @func
+ * @ret: Value returned by @func, valid once @done is set
+ * @cpu: Worker that ran the job (0 for the boot CPU), for debugging
+ * @done: Set when @func has returned
+ */
+struct worker_job {
+	worker_func func;
+	void *ctx;
+	int ret;
+	uint cpu;
+	bool done;
+};
+
+#if CONFIG_IS_ENABLED(WORKER)
+/**
+ * worker_init() - Start the secondary cores
+ *
+ * This is called automatically on the first worker_submit(). It does nothing
+ * if the cores are already running. Once worker_stop() has been called, the
+ * cores are only started again by calling this function.
+ *
+ * @return number of secondary cores running
+ */
+int worker_init(void);
+
+/**
+ * worker_stop() - Stop the secondary cores
+ *
+ * Each core finishes the job it is running and then turns itself off, so that
+ * the OS can start it again. This must be called before booting an OS. Any
+ * jobs which are still queued are run on the boot CPU before this returns.
+ *
+ * @return 0 if OK, -ETIMEDOUT if some cores are still running U-Boot code, in
+ *	which case the OS must not be started
+ */
+int worker_stop(void);
+
+/**
+ * worker_count() - Get the number of secondary cores running
+ *
+ * @return number of cores, 0 if none (jobs then run on the boot CPU)
+ */
+uint worker_count(void);
+
+/**
+ * worker_self() - Get the number of the core that is running
+ *
+ * @return 0 on the boot CPU, else the worker number, starting at 1
+ */
+uint worker_self(void);
+
+/**
+ * worker_submit() - Queue a job to run on another core
+ *
+ * If there are no secondary cores, or the queue is full, the job is run
+ * before this function returns.
+ *
+ * @job: Job to run
+ * @func: Function to run
+ * @ctx: Context pointer for @func
+ */
+void worker_submit(struct worker_job *job, worker_func func, void *ctx);
+
+/**
+ * worker_wait() - Wait for a job to finish
+ *
+ * While waiting, the boot CPU runs any jobs which no other core has picked up
+ * yet, including @job itself.
+ *
+ * @job: Job to wait for
+ * @return value returned by the job's function
+ */
+int worker_wait(struct worker_job *job);
+#else
+static inline int worker_init(void)
+{
+	return 0;
+}
+
+static inline int worker_stop(void)
+{
+	return 0;
+}
+
+static inline uint worker_count(void)
+{
+	return 0;
+}
+
+static inline uint worker_self(void)
+{
+	return 0;
+}
+
+static inline void worker_submit(struct worker_job *job, worker_func func,
+				 void *ctx)
+{
+	job->ret = func(ctx);
+	job->cpu = 0;
+	job->done = true;
+}
+
+static inline int worker_wait(struct worker_job *job)
+{
+	return job->ret;
+}
+#endif
+
+/**
+ * arch_worker_start() - Start secondary cores
+ *
+ * Each core that is started calls @entry with its worker number, which never
+ * returns.
+ *
+ * @max: Maximum number of cores to start
+ * @entry: Function for each core to run
+ * @return number of cores started, numbered from 1
+ */
+int arch_worker_start(uint max, void (*entry)(uint id));
+
+/**
+ * arch_worker_self() - Get the worker number of the running core
+ *
+ * @return 0 on the boot CPU, else the number passed to the entry function
+ */
+uint arch_worker_self(void);
+
+/**
+ * arch_worker_idle() - Wait until there may be more work
+ *
+ * This is called by an idle worker. It may return early, but should return
+ * soon after arch_worker_kick() is called, even if that happened between the
+ * worker last checking for work and calling this function.
+ */
+void arch_worker_idle(void);
+
+/**
+ * arch_worker_kick() - Wake up the idle workers
+ */
+void arch_worker_kick(void);
+
+/**
+ * arch_worker_exit() - Turn off the running core
+ *
+ * This is called by a worker when the cores are stopped. It does not return.
+ */
+void arch_worker_exit(void);
+
+/**
+ * arch_worker_stop() - Wait for the secondary cores to be off
+ *
+ * This is called on the boot CPU once all workers have stopped running jobs.
+ */
+void arch_worker_stop(void);
+
+#endif
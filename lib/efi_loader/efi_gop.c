@@ -26,6 +26,7 @@ static const efi_guid_t efi_gop_guid = EFI_GRAPHICS_OUTPUT_PROTOCOL_GUID;
  * @mode:	graphical output mode
  * @bpix:	bits per pixel
  * @fb:		frame buffer
+ * @vdev:	video device
  */
 struct efi_gop_obj {
 	struct efi_object header;
@@ -35,6 +36,9 @@ struct efi_gop_obj {
 	/* Fields we only have access to during init */
 	u32 bpix;
 	void *fb;
+#ifdef CONFIG_DM_VIDEO
+	struct udevice *vdev;
+#endif
 };
 
 static efi_status_t EFIAPI gop_query_mode(struct efi_gop *this, u32 mode_number,
@@ -414,6 +418,12 @@ efi_status_t EFIAPI gop_blt(struct efi_gop *this, struct efi_gop_pixel *buffer,
 		return EFI_EXIT(ret);
 
 #ifdef CONFIG_DM_VIDEO
+	if (operation != EFI_BLT_VIDEO_TO_BLT_BUFFER) {
+		struct efi_gop_obj *gopobj;
+
+		gopobj = container_of(this, struct efi_gop_obj, ops);
+		video_damage(gopobj->vdev, dx, dy, width, height);
+	}
 	video_sync_all();
 #else
 	lcd_sync();
@@ -526,6 +536,9 @@ efi_status_t efi_gop_register(void)
 	gopobj->info.pixels_per_scanline = col;
 	gopobj->bpix = bpix;
 	gopobj->fb = fb;
+#ifdef CONFIG_DM_VIDEO
+	gopobj->vdev = vdev;
+#endif
 
 	return EFI_SUCCESS;
 }
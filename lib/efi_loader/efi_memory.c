@@ -10,9 +10,9 @@
 #include <init.h>
 #include <malloc.h>
 #include <mapmem.h>
+#include <time.h>
 #include <watchdog.h>
 #include <asm/cache.h>
-#include <linux/list_sort.h>
 #include <linux/sizes.h>
 
 DECLARE_GLOBAL_DATA_PTR;
@@ -20,19 +20,22 @@ DECLARE_GLOBAL_DATA_PTR;
 /* Magic number identifying memory allocated from pool */
 #define EFI_ALLOC_POOL_MAGIC 0x1fe67ddf6491caa2
 
-efi_uintn_t efi_memory_map_key;
+/* Number of memory map entries to allocate space for initially */
+#define EFI_MEM_INITIAL_ENTRIES 32
 
-struct efi_mem_list {
-	struct list_head link;
-	struct efi_mem_desc desc;
-};
+efi_uintn_t efi_memory_map_key;
 
-#define EFI_CARVE_NO_OVERLAP		-1
-#define EFI_CARVE_LOOP_AGAIN		-2
-#define EFI_CARVE_OVERLAPS_NONRAM	-3
+/*
+ * The memory map, sorted by ascending address. Entries never overlap and
+ * adjacent entries with the same type and attributes are always merged, so
+ * an address is looked up by binary search.
+ */
+static struct efi_mem_desc *efi_mem;
+static int efi_mem_count;
+static int efi_mem_max;
 
-/* This list contains all memory map items */
-LIST_HEAD(efi_mem);
+/* Bookkeeping statistics, see efi_get_memory_stats() */
+static struct efi_mem_stats efi_mem_stats;
 
 #ifdef CONFIG_EFI_LOADER_BOUNCE_BUFFER
 void *efi_bounce_buffer;
@@ -77,161 +80,91 @@ static u64 checksum(struct efi_pool_allocation *alloc)
 	return ret;
 }
 
-/*
- * Sorts the memory list from highest address to lowest address
- *
- * When allocating memory we should always start from the highest
- * address chunk, so sort the memory list such that the first list
- * iterator gets the highest address and goes lower from there.
- */
-static int efi_mem_cmp(void *priv, struct list_head *a, struct list_head *b)
-{
-	struct efi_mem_list *mema = list_entry(a, struct efi_mem_list, link);
-	struct efi_mem_list *memb = list_entry(b, struct efi_mem_list, link);
-
-	if (mema->desc.physical_start == memb->desc.physical_start)
-		return 0;
-	else if (mema->desc.physical_start < memb->desc.physical_start)
-		return 1;
-	else
-		return -1;
-}
-
 static uint64_t desc_get_end(struct efi_mem_desc *desc)
 {
 	return desc->physical_start + (desc->num_pages << EFI_PAGE_SHIFT);
 }
 
-static void efi_mem_sort(void)
+/**
+ * efi_mem_find() - find the memory map entry for an address
+ *
+ * @addr:	address to look up
+ * Return:	index of the first entry ending above @addr, which is the
+ *		entry containing @addr if there is one, or efi_mem_count if
+ *		there is no such entry
+ */
+static int efi_mem_find(u64 addr)
 {
-	struct list_head *lhandle;
-	struct efi_mem_list *prevmem = NULL;
-	bool merge_again = true;
-
-	list_sort(NULL, &efi_mem, efi_mem_cmp);
-
-	/* Now merge entries that can be merged */
-	while (merge_again) {
-		merge_again = false;
-		list_for_each(lhandle, &efi_mem) {
-			struct efi_mem_list *lmem;
-			struct efi_mem_desc *prev = &prevmem->desc;
-			struct efi_mem_desc *cur;
-			uint64_t pages;
-
-			lmem = list_entry(lhandle, struct efi_mem_list, link);
-			if (!prevmem) {
-				prevmem = lmem;
-				continue;
-			}
-
-			cur = &lmem->desc;
-
-			if ((desc_get_end(cur) == prev->physical_start) &&
-			    (prev->type == cur->type) &&
-			    (prev->attribute == cur->attribute)) {
-				/* There is an existing map before, reuse it */
-				pages = cur->num_pages;
-				prev->num_pages += pages;
-				prev->physical_start -= pages << EFI_PAGE_SHIFT;
-				prev->virtual_start -= pages << EFI_PAGE_SHIFT;
-				list_del(&lmem->link);
-				free(lmem);
-
-				merge_again = true;
-				break;
-			}
-
-			prevmem = lmem;
-		}
+	int lo = 0, hi = efi_mem_count;
+
+	while (lo < hi) {
+		int mid = lo + (hi - lo) / 2;
+
+		if (desc_get_end(&efi_mem[mid]) <= addr)
+			lo = mid + 1;
+		else
+			hi = mid;
 	}
+
+	return lo;
 }
 
-/** efi_mem_carve_out - unmap memory region
+/**
+ * efi_mem_can_merge() - check if two memory map entries can be merged
  *
- * @map:		memory map
- * @carve_desc:		memory region to unmap
- * @overlap_only_ram:	the carved out region may only overlap RAM
- * Return Value:	the number of overlapping pages which have been
- *			removed from the map,
- *			EFI_CARVE_NO_OVERLAP, if the regions don't overlap,
- *			EFI_CARVE_OVERLAPS_NONRAM, if the carve and map overlap,
- *			and the map contains anything but free ram
- *			(only when overlap_only_ram is true),
- *			EFI_CARVE_LOOP_AGAIN, if the mapping list should be
- *			traversed again, as it has been altered.
+ * @lower:	entry at the lower address
+ * @upper:	entry at the higher address
+ * Return:	true if @upper directly follows @lower and they match
+ */
+static bool efi_mem_can_merge(struct efi_mem_desc *lower,
+			      struct efi_mem_desc *upper)
+{
+	return desc_get_end(lower) == upper->physical_start &&
+	       lower->type == upper->type &&
+	       lower->attribute == upper->attribute;
+}
+
+/**
+ * efi_mem_splice() - replace a range of memory map entries
  *
- * Unmaps all memory occupied by the carve_desc region from the list entry
- * pointed to by map.
+ * Entries @first to @last - 1 are replaced by @n entries from @descs, growing
+ * the map if needed.
  *
- * In case of EFI_CARVE_OVERLAPS_NONRAM it is the callers responsibility
- * to re-add the already carved out pages to the mapping.
+ * @first:	index of the first entry to replace
+ * @last:	index after the last entry to replace
+ * @descs:	new entries
+ * @n:		number of new entries
+ * Return:	status code
  */
-static s64 efi_mem_carve_out(struct efi_mem_list *map,
-			     struct efi_mem_desc *carve_desc,
-			     bool overlap_only_ram)
+static efi_status_t efi_mem_splice(int first, int last,
+				   struct efi_mem_desc *descs, int n)
 {
-	struct efi_mem_list *newmap;
-	struct efi_mem_desc *map_desc = &map->desc;
-	uint64_t map_start = map_desc->physical_start;
-	uint64_t map_end = map_start + (map_desc->num_pages << EFI_PAGE_SHIFT);
-	uint64_t carve_start = carve_desc->physical_start;
-	uint64_t carve_end = carve_start +
-			     (carve_desc->num_pages << EFI_PAGE_SHIFT);
-
-	/* check whether we're overlapping */
-	if ((carve_end <= map_start) || (carve_start >= map_end))
-		return EFI_CARVE_NO_OVERLAP;
-
-	/* We're overlapping with non-RAM, warn the caller if desired */
-	if (overlap_only_ram && (map_desc->type != EFI_CONVENTIONAL_MEMORY))
-		return EFI_CARVE_OVERLAPS_NONRAM;
-
-	/* Sanitize carve_start and carve_end to lie within our bounds */
-	carve_start = max(carve_start, map_start);
-	carve_end = min(carve_end, map_end);
-
-	/* Carving at the beginning of our map? Just move it! */
-	if (carve_start == map_start) {
-		if (map_end == carve_end) {
-			/* Full overlap, just remove map */
-			list_del(&map->link);
-			free(map);
-		} else {
-			map->desc.physical_start = carve_end;
-			map->desc.virtual_start = carve_end;
-			map->desc.num_pages = (map_end - carve_end)
-					      >> EFI_PAGE_SHIFT;
-		}
+	int count = efi_mem_count - (last - first) + n;
 
-		return (carve_end - carve_start) >> EFI_PAGE_SHIFT;
-	}
+	if (count > efi_mem_max) {
+		int max = max(efi_mem_max * 2, EFI_MEM_INITIAL_ENTRIES);
+		struct efi_mem_desc *mem;
 
-	/*
-	 * Overlapping maps, just split the list map at carve_start,
-	 * it will get moved or removed in the next iteration.
-	 *
-	 * [ map_desc |__carve_start__| newmap ]
-	 */
-
-	/* Create a new map from [ carve_start ... map_end ] */
-	newmap = calloc(1, sizeof(*newmap));
-	newmap->desc = map->desc;
-	newmap->desc.physical_start = carve_start;
-	newmap->desc.virtual_start = carve_start;
-	newmap->desc.num_pages = (map_end - carve_start) >> EFI_PAGE_SHIFT;
-	/* Insert before current entry (descending address order) */
-	list_add_tail(&newmap->link, &map->link);
-
-	/* Shrink the map to [ map_start ... carve_start ] */
-	map_desc->num_pages = (carve_start - map_start) >> EFI_PAGE_SHIFT;
+		mem = realloc(efi_mem, max * sizeof(*mem));
+		if (!mem)
+			return EFI_OUT_OF_RESOURCES;
+		efi_mem = mem;
+		efi_mem_max = max;
+	}
+	memmove(&efi_mem[first + n], &efi_mem[last],
+		(efi_mem_count - last) * sizeof(*efi_mem));
+	memcpy(&efi_mem[first], descs, n * sizeof(*descs));
+	efi_mem_count = count;
 
-	return EFI_CARVE_LOOP_AGAIN;
+	return EFI_SUCCESS;
 }
 
 /**
  * efi_add_memory_map_pg() - add pages to the memory map
  *
+ * The pages replace whatever the map held for that range, splitting any
+ * entries which only partly overlap it.
+ *
  * @start:		start address, must be a multiple of EFI_PAGE_SIZE
  * @pages:		number of pages to add
  * @memory_type:	type of memory added
@@ -242,11 +175,15 @@ static efi_status_t efi_add_memory_map_pg(u64 start, u64 pages,
 					  int memory_type,
 					  bool overlap_only_ram)
 {
-	struct list_head *lhandle;
-	struct efi_mem_list *newlist;
-	bool carve_again;
+	/* Up to two neighbours, two split-off parts and the new entry */
+	struct efi_mem_desc descs[5], *desc;
+	u64 end = start + (pages << EFI_PAGE_SHIFT);
 	uint64_t carved_pages = 0;
 	struct efi_event *evt;
+	int first, last, lo, hi;
+	efi_status_t ret;
+	ulong time;
+	int i, n;
 
 	EFI_PRINT("%s: 0x%llx 0x%llx %d %s\n", __func__,
 		  start, pages, memory_type, overlap_only_ram ? "yes" : "no");
@@ -257,80 +194,95 @@ static efi_status_t efi_add_memory_map_pg(u64 start, u64 pages,
 	if (!pages)
 		return EFI_SUCCESS;
 
-	++efi_memory_map_key;
-	newlist = calloc(1, sizeof(*newlist));
-	newlist->desc.type = memory_type;
-	newlist->desc.physical_start = start;
-	newlist->desc.virtual_start = start;
-	newlist->desc.num_pages = pages;
+	time = timer_get_us();
 
+	/* Find the entries overlapping the new range */
+	first = efi_mem_find(start);
+	for (last = first; last < efi_mem_count; last++) {
+		desc = &efi_mem[last];
+		if (desc->physical_start >= end)
+			break;
+		/*
+		 * The user requested to only have RAM overlaps, but we hit a
+		 * non-RAM region. Error out.
+		 */
+		if (overlap_only_ram && desc->type != EFI_CONVENTIONAL_MEMORY)
+			return EFI_NO_MAPPING;
+		carved_pages += (min(end, desc_get_end(desc)) -
+				 max(start, desc->physical_start)) >>
+				EFI_PAGE_SHIFT;
+	}
+
+	if (overlap_only_ram && (carved_pages != pages)) {
+		/*
+		 * The payload wanted to have RAM overlaps, but we overlapped
+		 * with an unallocated region. Error out.
+		 */
+		return EFI_NO_MAPPING;
+	}
+
+	/*
+	 * Build the replacement for the neighbouring and overlapping entries:
+	 * the neighbours, whatever of the overlapped entries lies outside the
+	 * new range, and the new entry itself.
+	 */
+	n = 0;
+	lo = first;
+	hi = last;
+	if (lo > 0 && (lo == last || efi_mem[lo].physical_start >= start))
+		descs[n++] = efi_mem[--lo];
+	if (first < last && efi_mem[first].physical_start < start) {
+		descs[n] = efi_mem[first];
+		descs[n].num_pages = (start - descs[n].physical_start) >>
+				     EFI_PAGE_SHIFT;
+		n++;
+	}
+
+	desc = &descs[n++];
+	desc->type = memory_type;
+	desc->physical_start = start;
+	desc->virtual_start = start;
+	desc->num_pages = pages;
 	switch (memory_type) {
 	case EFI_RUNTIME_SERVICES_CODE:
 	case EFI_RUNTIME_SERVICES_DATA:
-		newlist->desc.attribute = EFI_MEMORY_WB | EFI_MEMORY_RUNTIME;
+		desc->attribute = EFI_MEMORY_WB | EFI_MEMORY_RUNTIME;
 		break;
 	case EFI_MMAP_IO:
-		newlist->desc.attribute = EFI_MEMORY_RUNTIME;
+		desc->attribute = EFI_MEMORY_RUNTIME;
 		break;
 	default:
-		newlist->desc.attribute = EFI_MEMORY_WB;
+		desc->attribute = EFI_MEMORY_WB;
 		break;
 	}
 
-	/* Add our new map */
-	do {
-		carve_again = false;
-		list_for_each(lhandle, &efi_mem) {
-			struct efi_mem_list *lmem;
-			s64 r;
-
-			lmem = list_entry(lhandle, struct efi_mem_list, link);
-			r = efi_mem_carve_out(lmem, &newlist->desc,
-					      overlap_only_ram);
-			switch (r) {
-			case EFI_CARVE_OVERLAPS_NONRAM:
-				/*
-				 * The user requested to only have RAM overlaps,
-				 * but we hit a non-RAM region. Error out.
-				 */
-				return EFI_NO_MAPPING;
-			case EFI_CARVE_NO_OVERLAP:
-				/* Just ignore this list entry */
-				break;
-			case EFI_CARVE_LOOP_AGAIN:
-				/*
-				 * We split an entry, but need to loop through
-				 * the list again to actually carve it.
-				 */
-				carve_again = true;
-				break;
-			default:
-				/* We carved a number of pages */
-				carved_pages += r;
-				carve_again = true;
-				break;
-			}
-
-			if (carve_again) {
-				/* The list changed, we need to start over */
-				break;
-			}
-		}
-	} while (carve_again);
+	if (first < last && desc_get_end(&efi_mem[last - 1]) > end) {
+		descs[n] = efi_mem[last - 1];
+		descs[n].num_pages = (desc_get_end(&descs[n]) - end) >>
+				     EFI_PAGE_SHIFT;
+		descs[n].physical_start = end;
+		descs[n].virtual_start = end;
+		n++;
+	} else if (hi < efi_mem_count) {
+		descs[n++] = efi_mem[hi++];
+	}
 
-	if (overlap_only_ram && (carved_pages != pages)) {
-		/*
-		 * The payload wanted to have RAM overlaps, but we overlapped
-		 * with an unallocated region. Error out.
-		 */
-		return EFI_NO_MAPPING;
+	/* Merge entries that can be merged */
+	for (i = 1, desc = descs; i < n; i++) {
+		if (efi_mem_can_merge(desc, &descs[i]))
+			desc->num_pages += descs[i].num_pages;
+		else
+			*++desc = descs[i];
 	}
 
-	/* Add our new map */
-        list_add_tail(&newlist->link, &efi_mem);
+	ret = efi_mem_splice(lo, hi, descs, desc - descs + 1);
+	efi_mem_stats.updates++;
+	efi_mem_stats.update_us += timer_get_us() - time;
+	if (ret != EFI_SUCCESS)
+		return ret;
 
-	/* And make sure memory is listed in descending order */
-	efi_mem_sort();
+	/* Only tell callers the map changed once it actually has */
+	++efi_memory_map_key;
 
 	/* Notify that the memory map was changed */
 	list_for_each_entry(evt, &efi_events, link) {
@@ -384,19 +336,14 @@ efi_status_t efi_add_memory_map(u64 start, u64 size, int memory_type)
  */
 static efi_status_t efi_check_allocated(u64 addr, bool must_be_allocated)
 {
-	struct efi_mem_list *item;
-
-	list_for_each_entry(item, &efi_mem, link) {
-		u64 start = item->desc.physical_start;
-		u64 end = start + (item->desc.num_pages << EFI_PAGE_SHIFT);
-
-		if (addr >= start && addr < end) {
-			if (must_be_allocated ^
-			    (item->desc.type == EFI_CONVENTIONAL_MEMORY))
-				return EFI_SUCCESS;
-			else
-				return EFI_NOT_FOUND;
-		}
+	int i = efi_mem_find(addr);
+
+	if (i < efi_mem_count && efi_mem[i].physical_start <= addr) {
+		if (must_be_allocated ^
+		    (efi_mem[i].type == EFI_CONVENTIONAL_MEMORY))
+			return EFI_SUCCESS;
+		else
+			return EFI_NOT_FOUND;
 	}
 
 	return EFI_NOT_FOUND;
@@ -404,7 +351,7 @@ static efi_status_t efi_check_allocated(u64 addr, bool must_be_allocated)
 
 static uint64_t efi_find_free_memory(uint64_t len, uint64_t max_addr)
 {
-	struct list_head *lhandle;
+	int i;
 
 	/*
 	 * Prealign input max address, so we simplify our matching
@@ -412,12 +359,11 @@ static uint64_t efi_find_free_memory(uint64_t len, uint64_t max_addr)
 	 */
 	max_addr &= ~EFI_PAGE_MASK;
 
-	list_for_each(lhandle, &efi_mem) {
-		struct efi_mem_list *lmem = list_entry(lhandle,
-			struct efi_mem_list, link);
-		struct efi_mem_desc *desc = &lmem->desc;
-		uint64_t desc_len = desc->num_pages << EFI_PAGE_SHIFT;
-		uint64_t desc_end = desc->physical_start + desc_len;
+	/* Work down from the entry containing max_addr */
+	i = min(efi_mem_find(max_addr - 1), efi_mem_count - 1);
+	for (; i >= 0; i--) {
+		struct efi_mem_desc *desc = &efi_mem[i];
+		uint64_t desc_end = desc_get_end(desc);
 		uint64_t curmax = min(max_addr, desc_end);
 		uint64_t ret = curmax - len;
 
@@ -541,7 +487,6 @@ efi_status_t efi_free_pages(uint64_t memory, efi_uintn_t pages)
 
 	ret = efi_add_memory_map_pg(memory, pages, EFI_CONVENTIONAL_MEMORY,
 				    false);
-	/* Merging of adjacent free regions is missing */
 
 	if (ret != EFI_SUCCESS)
 		return EFI_NOT_FOUND;
@@ -637,8 +582,6 @@ efi_status_t efi_get_memory_map(efi_uintn_t *memory_map_size,
 				uint32_t *descriptor_version)
 {
 	efi_uintn_t map_size = 0;
-	int map_entries = 0;
-	struct list_head *lhandle;
 	efi_uintn_t provided_map_size;
 
 	if (!memory_map_size)
@@ -646,10 +589,7 @@ efi_status_t efi_get_memory_map(efi_uintn_t *memory_map_size,
 
 	provided_map_size = *memory_map_size;
 
-	list_for_each(lhandle, &efi_mem)
-		map_entries++;
-
-	map_size = map_entries * sizeof(struct efi_mem_desc);
+	map_size = efi_mem_count * sizeof(struct efi_mem_desc);
 
 	*memory_map_size = map_size;
 
@@ -665,16 +605,7 @@ efi_status_t efi_get_memory_map(efi_uintn_t *memory_map_size,
 	if (!memory_map)
 		return EFI_INVALID_PARAMETER;
 
-	/* Copy list into array */
-	/* Return the list in ascending order */
-	memory_map = &memory_map[map_entries - 1];
-	list_for_each(lhandle, &efi_mem) {
-		struct efi_mem_list *lmem;
-
-		lmem = list_entry(lhandle, struct efi_mem_list, link);
-		*memory_map = lmem->desc;
-		memory_map--;
-	}
+	memcpy(memory_map, efi_mem, map_size);
 
 	if (map_key)
 		*map_key = efi_memory_map_key;
@@ -682,6 +613,13 @@ efi_status_t efi_get_memory_map(efi_uintn_t *memory_map_size,
 	return EFI_SUCCESS;
 }
 
+void efi_get_memory_stats(struct efi_mem_stats *stats)
+{
+	*stats = efi_mem_stats;
+	stats->entries = efi_mem_count;
+	stats->capacity = efi_mem_max;
+}
+
 /**
  * efi_add_conventional_memory_map() - add a RAM memory area to the map
  *
@@ -0,0 +1,170 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * efi_selftest_memory_map
+ *
+ * This unit test checks that the memory map returned by GetMemoryMap stays
+ * consistent while many page ranges of alternating types are allocated and
+ * freed: entries must be sorted, must not overlap and adjacent entries of
+ * the same type and attributes must be merged.
+ */
+
+#include <efi_selftest.h>
+
+#define EFI_ST_NUM_ALLOCS 64
+
+static struct efi_boot_services *boottime;
+static u64 pages[EFI_ST_NUM_ALLOCS];
+
+/**
+ * setup() - setup unit test
+ *
+ * @handle:	handle of the loaded image
+ * @systable:	system table
+ * Return:	EFI_ST_SUCCESS for success
+ */
+static int setup(const efi_handle_t handle,
+		 const struct efi_system_table *systable)
+{
+	boottime = systable->boottime;
+
+	return EFI_ST_SUCCESS;
+}
+
+/**
+ * check_memory_map() - read and check the memory map
+ *
+ * @countp:	returns the number of memory map entries
+ * Return:	EFI_ST_SUCCESS for success
+ */
+static int check_memory_map(efi_uintn_t *countp)
+{
+	efi_uintn_t map_size = 0;
+	efi_uintn_t map_key;
+	efi_uintn_t desc_size;
+	u32 desc_version;
+	struct efi_mem_desc *memory_map, *prev, *entry;
+	efi_uintn_t i, count;
+	efi_status_t ret;
+
+	ret = boottime->get_memory_map(&map_size, NULL, &map_key, &desc_size,
+				       &desc_version);
+	if (ret != EFI_BUFFER_TOO_SMALL) {
+		efi_st_error
+			("GetMemoryMap did not return EFI_BUFFER_TOO_SMALL\n");
+		return EFI_ST_FAILURE;
+	}
+	/* Allocate extra space for the pool allocation itself */
+	map_size += 2 * desc_size;
+	ret = boottime->allocate_pool(EFI_BOOT_SERVICES_DATA, map_size,
+				      (void **)&memory_map);
+	if (ret != EFI_SUCCESS) {
+		efi_st_error("AllocatePool did not return EFI_SUCCESS\n");
+		return EFI_ST_FAILURE;
+	}
+	ret = boottime->get_memory_map(&map_size, memory_map, &map_key,
+				       &desc_size, &desc_version);
+	if (ret != EFI_SUCCESS) {
+		efi_st_error("GetMemoryMap did not return EFI_SUCCESS\n");
+		boottime->free_pool(memory_map);
+		return EFI_ST_FAILURE;
+	}
+
+	count = map_size / desc_size;
+	for (i = 1; i < count; ++i) {
+		prev = (void *)memory_map + (i - 1) * desc_size;
+		entry = (void *)memory_map + i * desc_size;
+
+		if (!entry->num_pages) {
+			efi_st_error("Empty memory map entry\n");
+			break;
+		}
+		if (prev->physical_start +
+		    (prev->num_pages << EFI_PAGE_SHIFT) > entry->physical_start) {
+			efi_st_error("Memory map not sorted or overlapping\n");
+			break;
+		}
+		if (prev->physical_start +
+		    (prev->num_pages << EFI_PAGE_SHIFT) ==
+		    entry->physical_start &&
+		    prev->type == entry->type &&
+		    prev->attribute == entry->attribute) {
+			efi_st_error("Adjacent entries not merged\n");
+			break;
+		}
+	}
+
+	ret = boottime->free_pool(memory_map);
+	if (ret != EFI_SUCCESS) {
+		efi_st_error("FreePool did not return EFI_SUCCESS\n");
+		return EFI_ST_FAILURE;
+	}
+	if (i < count)
+		return EFI_ST_FAILURE;
+	*countp = count;
+
+	return EFI_ST_SUCCESS;
+}
+
+/*
+ * execute() - execute unit test
+ *
+ * Return:	EFI_ST_SUCCESS for success
+ */
+static int execute(void)
+{
+	efi_uintn_t count_before, count;
+	efi_status_t ret;
+	int i;
+
+	if (check_memory_map(&count_before) != EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
+
+	/* Single pages of alternating types fragment the map */
+	for (i = 0; i < EFI_ST_NUM_ALLOCS; ++i) {
+		ret = boottime->allocate_pages(EFI_ALLOCATE_ANY_PAGES,
+					       i & 1 ? EFI_LOADER_DATA :
+					       EFI_BOOT_SERVICES_DATA,
+					       1, &pages[i]);
+		if (ret != EFI_SUCCESS) {
+			efi_st_error("AllocatePages did not return EFI_SUCCESS\n");
+			return EFI_ST_FAILURE;
+		}
+	}
+	if (check_memory_map(&count) != EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
+
+	/* Free every other page first, then the rest */
+	for (i = 0; i < EFI_ST_NUM_ALLOCS; i += 2) {
+		ret = boottime->free_pages(pages[i], 1);
+		if (ret != EFI_SUCCESS) {
+			efi_st_error("FreePages did not return EFI_SUCCESS\n");
+			return EFI_ST_FAILURE;
+		}
+	}
+	if (check_memory_map(&count) != EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
+	for (i = 1; i < EFI_ST_NUM_ALLOCS; i += 2) {
+		ret = boottime->free_pages(pages[i], 1);
+		if (ret != EFI_SUCCESS) {
+			efi_st_error("FreePages did not return EFI_SUCCESS\n");
+			return EFI_ST_FAILURE;
+		}
+	}
+	if (check_memory_map(&count) != EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
+
+	if (count != count_before) {
+		efi_st_error("Memory map has %u entries, expected %u\n",
+			     (unsigned int)count, (unsigned int)count_before);
+		return EFI_ST_FAILURE;
+	}
+
+	return EFI_ST_SUCCESS;
+}
+
+EFI_UNIT_TEST(memory_map) = {
+	.name = "memory map",
+	.phase = EFI_EXECUTE_BEFORE_BOOTTIME_EXIT,
+	.setup = setup,
+	.execute = execute,
+};
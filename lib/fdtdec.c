@@ -23,6 +23,7 @@
 #include <serial.h>
 #include <asm/sections.h>
 #include <linux/ctype.h>
+#include <linux/log2.h>
 #include <linux/lzo.h>
 #include <linux/ioport.h>
 
@@ -624,10 +625,139 @@ int fdtdec_lookup_phandle(const void *blob, int node, const char *prop_name)
 	if (!phandle)
 		return -FDT_ERR_NOTFOUND;
 
-	lookup = fdt_node_offset_by_phandle(blob, fdt32_to_cpu(*phandle));
+	lookup = fdtdec_node_offset_by_phandle(blob, fdt32_to_cpu(*phandle));
 	return lookup;
 }
 
+#if CONFIG_IS_ENABLED(OF_PHANDLE_INDEX)
+/**
+ * struct fdt_phandle_index - hash table mapping phandles to node offsets
+ *
+ * Phandles are normally allocated sequentially by dtc, so the low bits of the
+ * phandle are used directly as the hash. Collisions are resolved by linear
+ * probing; the table is kept at most half full.
+ *
+ * @blob:	device tree which this index is for
+ * @mask:	number of slots - 1 (the number of slots is a power of two)
+ * @slot:	slots, with a phandle of 0 marking an empty slot
+ */
+struct fdt_phandle_index {
+	const void *blob;
+	uint mask;
+	struct {
+		uint32_t phandle;
+		int offset;
+	} slot[];
+};
+
+static struct fdt_phandle_index *fdt_phandle_index_build(const void *blob)
+{
+	struct fdt_phandle_index *idx;
+	uint32_t phandle;
+	int count = 0;
+	int offset;
+	uint size;
+
+	for (offset = fdt_next_node(blob, -1, NULL); offset >= 0;
+	     offset = fdt_next_node(blob, offset, NULL)) {
+		if (fdt_get_phandle(blob, offset))
+			count++;
+	}
+	if (offset != -FDT_ERR_NOTFOUND)
+		return NULL;
+
+	size = roundup_pow_of_two(max(count * 2, 16));
+	idx = calloc(1, sizeof(*idx) + size * sizeof(idx->slot[0]));
+	if (!idx)
+		return NULL;
+	idx->blob = blob;
+	idx->mask = size - 1;
+
+	for (offset = fdt_next_node(blob, -1, NULL); offset >= 0;
+	     offset = fdt_next_node(blob, offset, NULL)) {
+		uint i;
+
+		phandle = fdt_get_phandle(blob, offset);
+		if (!phandle)
+			continue;
+		for (i = phandle & idx->mask; idx->slot[i].phandle;
+		     i = (i + 1) & idx->mask)
+			;
+		idx->slot[i].phandle = phandle;
+		idx->slot[i].offset = offset;
+	}
+	debug("%s: %d phandles in %u slots\n", __func__, count, size);
+
+	return idx;
+}
+
+int fdtdec_node_offset_by_phandle(const void *blob, uint32_t phandle)
+{
+	struct fdt_phandle_index *idx = gd->fdt_phandle_index;
+	int offset;
+	uint i;
+
+	if (blob != gd->fdt_blob || !phandle || phandle == (uint32_t)-1)
+		return fdt_node_offset_by_phandle(blob, phandle);
+
+	/* The device tree may have been relocated since the index was built */
+	if (idx && idx->blob != blob) {
+		free(idx);
+		idx = NULL;
+	}
+	/* Avoid using up the limited pre-relocation malloc() space */
+	if (!idx && (gd->flags & GD_FLG_FULL_MALLOC_INIT))
+		idx = fdt_phandle_index_build(blob);
+	gd->fdt_phandle_index = idx;
+	if (!idx)
+		return fdt_node_offset_by_phandle(blob, phandle);
+
+	for (i = phandle & idx->mask; idx->slot[i].phandle;
+	     i = (i + 1) & idx->mask) {
+		if (idx->slot[i].phandle != phandle)
+			continue;
+
+		/*
+		 * The tree may have been changed behind our back, so check
+		 * that the node is still there
+		 */
+		offset = idx->slot[i].offset;
+		if (fdt_get_phandle(blob, offset) == phandle)
+			return offset;
+		break;
+	}
+
+	/*
+	 * Either the phandle does not exist or the index is stale. In the
+	 * latter case drop the index so that it is rebuilt next time.
+	 */
+	offset = fdt_node_offset_by_phandle(blob, phandle);
+	if (offset >= 0)
+		fdtdec_phandle_index_invalidate(blob);
+
+	return offset;
+}
+
+void fdtdec_phandle_index_invalidate(const void *blob)
+{
+	struct fdt_phandle_index *idx = gd->fdt_phandle_index;
+
+	if (idx && idx->blob == blob) {
+		free(idx);
+		gd->fdt_phandle_index = NULL;
+	}
+}
+#else
+int fdtdec_node_offset_by_phandle(const void *blob, uint32_t phandle)
+{
+	return fdt_node_offset_by_phandle(blob, phandle);
+}
+
+void fdtdec_phandle_index_invalidate(const void *blob)
+{
+}
+#endif
+
 /**
  * Look up a property in a node and check that it has a minimum length.
  *
@@ -755,7 +885,7 @@ int fdtdec_parse_phandle_with_args(const void *blob, int src_node,
 			 * below.
 			 */
 			if (cells_name || cur_index == index) {
-				node = fdt_node_offset_by_phandle(blob,
+				node = fdtdec_node_offset_by_phandle(blob,
 								  phandle);
 				if (node < 0) {
 					debug("%s: could not find phandle\n",
@@ -1470,7 +1600,7 @@ int fdtdec_get_carveout(const void *blob, const char *node, const char *name,
 
 	phandle = fdt32_to_cpu(prop[index]);
 
-	offset = fdt_node_offset_by_phandle(blob, phandle);
+	offset = fdtdec_node_offset_by_phandle(blob, phandle);
 	if (offset < 0) {
 		debug("failed to find node for phandle %u\n", phandle);
 		return offset;
@@ -14,8 +14,18 @@
 
 #define LMB_ALLOC_ANYWHERE	0
 
+static const char *const lmb_owner_name[LMB_OWNER_COUNT] = {
+	[LMB_OWNER_NONE]	= "none",
+	[LMB_OWNER_UBOOT]	= "u-boot",
+	[LMB_OWNER_FDT]		= "fdt",
+	[LMB_OWNER_BOOTM]	= "bootm",
+	[LMB_OWNER_FS]		= "fs",
+};
+
 void lmb_dump_all_force(struct lmb *lmb)
 {
+	struct lmb_property *mem = lmb_regions(&lmb->memory);
+	struct lmb_property *res = lmb_regions(&lmb->reserved);
 	unsigned long i;
 
 	printf("lmb_dump_all:\n");
@@ -24,9 +34,9 @@ void lmb_dump_all_force(struct lmb *lmb)
 	       (unsigned long long)lmb->memory.size);
 	for (i = 0; i < lmb->memory.cnt; i++) {
 		printf("    memory.reg[0x%lx].base   = 0x%llx\n", i,
-		       (unsigned long long)lmb->memory.region[i].base);
+		       (unsigned long long)mem[i].base);
 		printf("		   .size   = 0x%llx\n",
-		       (unsigned long long)lmb->memory.region[i].size);
+		       (unsigned long long)mem[i].size);
 	}
 
 	printf("\n    reserved.cnt	   = 0x%lx\n", lmb->reserved.cnt);
@@ -34,9 +44,11 @@ void lmb_dump_all_force(struct lmb *lmb)
 	       (unsigned long long)lmb->reserved.size);
 	for (i = 0; i < lmb->reserved.cnt; i++) {
 		printf("    reserved.reg[0x%lx].base = 0x%llx\n", i,
-		       (unsigned long long)lmb->reserved.region[i].base);
+		       (unsigned long long)res[i].base);
 		printf("		     .size = 0x%llx\n",
-		       (unsigned long long)lmb->reserved.region[i].size);
+		       (unsigned long long)res[i].size);
+		printf("		     .owner = %s\n",
+		       lmb_owner_name[res[i].owner]);
 	}
 }
 
@@ -67,48 +79,95 @@ static long lmb_addrs_adjacent(phys_addr_t base1, phys_size_t size1,
 	return 0;
 }
 
-static long lmb_regions_adjacent(struct lmb_region *rgn, unsigned long r1,
-				 unsigned long r2)
+/*
+ * Regions are kept sorted by base address and never overlap, so the region
+ * which could contain an address is found by binary search. This returns
+ * the index of the last region starting at or below @addr, or -1 if there
+ * is none.
+ */
+static long lmb_find_region(struct lmb_region *rgn, phys_addr_t addr)
 {
-	phys_addr_t base1 = rgn->region[r1].base;
-	phys_size_t size1 = rgn->region[r1].size;
-	phys_addr_t base2 = rgn->region[r2].base;
-	phys_size_t size2 = rgn->region[r2].size;
+	struct lmb_property *region = lmb_regions(rgn);
+	unsigned long lo = 0, hi = rgn->cnt;
+
+	while (lo < hi) {
+		unsigned long mid = lo + (hi - lo) / 2;
+
+		if (region[mid].base <= addr)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
 
-	return lmb_addrs_adjacent(base1, size1, base2, size2);
+	return (long)lo - 1;
 }
 
-static void lmb_remove_region(struct lmb_region *rgn, unsigned long r)
+/* Double the size of the region table, moving it to the heap if needed */
+static int lmb_grow_region(struct lmb_region *rgn)
 {
-	unsigned long i;
+	struct lmb_property *region;
+	unsigned long max;
 
-	for (i = r; i < rgn->cnt - 1; i++) {
-		rgn->region[i].base = rgn->region[i + 1].base;
-		rgn->region[i].size = rgn->region[i + 1].size;
+	if (!rgn->max) {
+		/* The struct was zeroed rather than set up by lmb_init() */
+		rgn->max = MAX_LMB_REGIONS;
+		return 0;
 	}
+
+	max = rgn->max * 2;
+	region = malloc(max * sizeof(*region));
+	if (!region)
+		return -ENOMEM;
+	memcpy(region, lmb_regions(rgn), rgn->cnt * sizeof(*region));
+	free(rgn->heap);
+	rgn->heap = region;
+	rgn->max = max;
+
+	return 0;
+}
+
+static void lmb_remove_region(struct lmb_region *rgn, unsigned long r)
+{
+	struct lmb_property *region = lmb_regions(rgn);
+
+	memmove(&region[r], &region[r + 1],
+		(rgn->cnt - r - 1) * sizeof(*region));
 	rgn->cnt--;
 }
 
-/* Assumption: base addr of region 1 < base addr of region 2 */
-static void lmb_coalesce_regions(struct lmb_region *rgn, unsigned long r1,
-				 unsigned long r2)
+static void lmb_init_region(struct lmb_region *rgn)
 {
-	rgn->region[r1].size += rgn->region[r2].size;
-	lmb_remove_region(rgn, r2);
+	rgn->cnt = 0;
+	rgn->max = MAX_LMB_REGIONS;
+	rgn->size = 0;
+	rgn->heap = NULL;
+}
+
+static void lmb_release_region(struct lmb_region *rgn)
+{
+	free(rgn->heap);
+	lmb_init_region(rgn);
 }
 
 void lmb_init(struct lmb *lmb)
 {
-	lmb->memory.cnt = 0;
-	lmb->memory.size = 0;
-	lmb->reserved.cnt = 0;
-	lmb->reserved.size = 0;
+	lmb_init_region(&lmb->memory);
+	lmb_init_region(&lmb->reserved);
+	lmb->owner = LMB_OWNER_NONE;
+}
+
+void lmb_release(struct lmb *lmb)
+{
+	lmb_release_region(&lmb->memory);
+	lmb_release_region(&lmb->reserved);
 }
 
 static void lmb_reserve_common(struct lmb *lmb, void *fdt_blob)
 {
+	lmb->owner = LMB_OWNER_UBOOT;
 	arch_lmb_reserve(lmb);
 	board_lmb_reserve(lmb);
+	lmb->owner = LMB_OWNER_NONE;
 
 	if (IMAGE_ENABLE_OF_LIBFDT && fdt_blob)
 		boot_fdt_add_mem_rsv_regions(lmb, fdt_blob);
@@ -140,71 +199,64 @@ void lmb_init_and_reserve_range(struct lmb *lmb, phys_addr_t base,
 	lmb_reserve_common(lmb, fdt_blob);
 }
 
-/* This routine called with relocation disabled. */
-static long lmb_add_region(struct lmb_region *rgn, phys_addr_t base, phys_size_t size)
+/*
+ * Add a region, merging it with neighbours which have the same owner.
+ * Returns the number of merges done, or -1 if the region overlaps an
+ * existing one or the table cannot grow.
+ *
+ * This routine called with relocation disabled.
+ */
+static long lmb_add_region(struct lmb_region *rgn, phys_addr_t base,
+			   phys_size_t size, enum lmb_owner owner)
 {
+	struct lmb_property *region = lmb_regions(rgn);
+	struct lmb_property *prev = NULL, *next = NULL;
 	unsigned long coalesced = 0;
-	long adjacent, i;
-
-	if (rgn->cnt == 0) {
-		rgn->region[0].base = base;
-		rgn->region[0].size = size;
-		rgn->cnt = 1;
-		return 0;
-	}
+	long i;
 
-	/* First try and coalesce this LMB with another. */
-	for (i = 0; i < rgn->cnt; i++) {
-		phys_addr_t rgnbase = rgn->region[i].base;
-		phys_size_t rgnsize = rgn->region[i].size;
+	/* prev is the last region at or below base, next the one after it */
+	i = lmb_find_region(rgn, base);
+	if (i >= 0)
+		prev = &region[i];
+	if (i + 1 < rgn->cnt)
+		next = &region[i + 1];
 
-		if ((rgnbase == base) && (rgnsize == size))
-			/* Already have this region, so we're done */
-			return 0;
+	if (prev && prev->base == base && prev->size == size)
+		/* Already have this region, so we're done */
+		return 0;
+	if ((prev && lmb_addrs_overlap(base, size, prev->base, prev->size)) ||
+	    (next && lmb_addrs_overlap(base, size, next->base, next->size)))
+		/* regions overlap */
+		return -1;
 
-		adjacent = lmb_addrs_adjacent(base, size, rgnbase, rgnsize);
-		if (adjacent > 0) {
-			rgn->region[i].base -= size;
-			rgn->region[i].size += size;
-			coalesced++;
-			break;
-		} else if (adjacent < 0) {
-			rgn->region[i].size += size;
-			coalesced++;
-			break;
-		} else if (lmb_addrs_overlap(base, size, rgnbase, rgnsize)) {
-			/* regions overlap */
-			return -1;
-		}
+	if (prev && prev->owner == owner &&
+	    lmb_addrs_adjacent(prev->base, prev->size, base, size) > 0) {
+		prev->size += size;
+		coalesced++;
 	}
-
-	if ((i < rgn->cnt - 1) && lmb_regions_adjacent(rgn, i, i + 1)) {
-		lmb_coalesce_regions(rgn, i, i + 1);
+	if (next && next->owner == owner &&
+	    lmb_addrs_adjacent(base, size, next->base, next->size) > 0) {
+		if (coalesced) {
+			prev->size += next->size;
+			lmb_remove_region(rgn, i + 1);
+		} else {
+			next->base = base;
+			next->size += size;
+		}
 		coalesced++;
 	}
-
 	if (coalesced)
 		return coalesced;
-	if (rgn->cnt >= MAX_LMB_REGIONS)
-		return -1;
 
 	/* Couldn't coalesce the LMB, so add it to the sorted table. */
-	for (i = rgn->cnt-1; i >= 0; i--) {
-		if (base < rgn->region[i].base) {
-			rgn->region[i + 1].base = rgn->region[i].base;
-			rgn->region[i + 1].size = rgn->region[i].size;
-		} else {
-			rgn->region[i + 1].base = base;
-			rgn->region[i + 1].size = size;
-			break;
-		}
-	}
-
-	if (base < rgn->region[0].base) {
-		rgn->region[0].base = base;
-		rgn->region[0].size = size;
-	}
-
+	if (rgn->cnt >= rgn->max && lmb_grow_region(rgn))
+		return -1;
+	region = lmb_regions(rgn);
+	i++;
+	memmove(&region[i + 1], &region[i], (rgn->cnt - i) * sizeof(*region));
+	region[i].base = base;
+	region[i].size = size;
+	region[i].owner = owner;
 	rgn->cnt++;
 
 	return 0;
@@ -215,29 +267,27 @@ long lmb_add(struct lmb *lmb, phys_addr_t base, phys_size_t size)
 {
 	struct lmb_region *_rgn = &(lmb->memory);
 
-	return lmb_add_region(_rgn, base, size);
+	return lmb_add_region(_rgn, base, size, LMB_OWNER_NONE);
 }
 
 long lmb_free(struct lmb *lmb, phys_addr_t base, phys_size_t size)
 {
 	struct lmb_region *rgn = &(lmb->reserved);
+	struct lmb_property *region = lmb_regions(rgn);
 	phys_addr_t rgnbegin, rgnend;
 	phys_addr_t end = base + size - 1;
-	int i;
-
-	rgnbegin = rgnend = 0; /* supress gcc warnings */
+	long i;
 
 	/* Find the region where (base, size) belongs to */
-	for (i = 0; i < rgn->cnt; i++) {
-		rgnbegin = rgn->region[i].base;
-		rgnend = rgnbegin + rgn->region[i].size - 1;
+	i = lmb_find_region(rgn, base);
+	if (i < 0)
+		return -1;
 
-		if ((rgnbegin <= base) && (end <= rgnend))
-			break;
-	}
+	rgnbegin = region[i].base;
+	rgnend = rgnbegin + region[i].size - 1;
 
 	/* Didn't find the region */
-	if (i == rgn->cnt)
+	if (end > rgnend)
 		return -1;
 
 	/* Check to see if we are removing entire region */
@@ -248,14 +298,14 @@ long lmb_free(struct lmb *lmb, phys_addr_t base, phys_size_t size)
 
 	/* Check to see if region is matching at the front */
 	if (rgnbegin == base) {
-		rgn->region[i].base = end + 1;
-		rgn->region[i].size -= size;
+		region[i].base = end + 1;
+		region[i].size -= size;
 		return 0;
 	}
 
 	/* Check to see if the region is matching at the end */
 	if (rgnend == end) {
-		rgn->region[i].size -= size;
+		region[i].size -= size;
 		return 0;
 	}
 
@@ -263,30 +313,37 @@ long lmb_free(struct lmb *lmb, phys_addr_t base, phys_size_t size)
 	 * We need to split the entry -  adjust the current one to the
 	 * beginging of the hole and add the region after hole.
 	 */
-	rgn->region[i].size = base - rgn->region[i].base;
-	return lmb_add_region(rgn, end + 1, rgnend - end);
+	region[i].size = base - region[i].base;
+	return lmb_add_region(rgn, end + 1, rgnend - end,
+			      region[i].owner);
 }
 
 long lmb_reserve(struct lmb *lmb, phys_addr_t base, phys_size_t size)
 {
 	struct lmb_region *_rgn = &(lmb->reserved);
 
-	return lmb_add_region(_rgn, base, size);
+	return lmb_add_region(_rgn, base, size, lmb->owner);
 }
 
 static long lmb_overlaps_region(struct lmb_region *rgn, phys_addr_t base,
 				phys_size_t size)
 {
-	unsigned long i;
+	struct lmb_property *region = lmb_regions(rgn);
+	long i;
 
-	for (i = 0; i < rgn->cnt; i++) {
-		phys_addr_t rgnbase = rgn->region[i].base;
-		phys_size_t rgnsize = rgn->region[i].size;
-		if (lmb_addrs_overlap(base, size, rgnbase, rgnsize))
+	/*
+	 * The regions are sorted and do not overlap, so the first one to
+	 * overlap the range either contains @base or is the next one after it
+	 */
+	for (i = max(lmb_find_region(rgn, base), 0L); i < rgn->cnt; i++) {
+		if (region[i].base > base + size - 1)
 			break;
+		if (lmb_addrs_overlap(base, size, region[i].base,
+				      region[i].size))
+			return i;
 	}
 
-	return (i < rgn->cnt) ? i : -1;
+	return -1;
 }
 
 phys_addr_t lmb_alloc(struct lmb *lmb, phys_size_t size, ulong align)
@@ -317,10 +374,11 @@ phys_addr_t __lmb_alloc_base(struct lmb *lmb, phys_size_t size, ulong align, phy
 	long i, rgn;
 	phys_addr_t base = 0;
 	phys_addr_t res_base;
+	struct lmb_property *mem = lmb_regions(&lmb->memory);
 
 	for (i = lmb->memory.cnt - 1; i >= 0; i--) {
-		phys_addr_t lmbbase = lmb->memory.region[i].base;
-		phys_size_t lmbsize = lmb->memory.region[i].size;
+		phys_addr_t lmbbase = mem[i].base;
+		phys_size_t lmbsize = mem[i].size;
 
 		if (lmbsize < size)
 			continue;
@@ -340,11 +398,11 @@ phys_addr_t __lmb_alloc_base(struct lmb *lmb, phys_size_t size, ulong align, phy
 			if (rgn < 0) {
 				/* This area isn't reserved, take it */
 				if (lmb_add_region(&lmb->reserved, base,
-						   size) < 0)
+						   size, lmb->owner) < 0)
 					return 0;
 				return base;
 			}
-			res_base = lmb->reserved.region[rgn].base;
+			res_base = lmb_regions(&lmb->reserved)[rgn].base;
 			if (res_base < size)
 				break;
 			base = lmb_align_down(res_base - size, align);
@@ -359,17 +417,17 @@ phys_addr_t __lmb_alloc_base(struct lmb *lmb, phys_size_t size, ulong align, phy
  */
 phys_addr_t lmb_alloc_addr(struct lmb *lmb, phys_addr_t base, phys_size_t size)
 {
+	struct lmb_property *mem = lmb_regions(&lmb->memory);
 	long rgn;
 
 	/* Check if the requested address is in one of the memory regions */
-	rgn = lmb_overlaps_region(&lmb->memory, base, size);
+	rgn = lmb_overlaps_region(&lmb->memory, base, 1);
 	if (rgn >= 0) {
 		/*
 		 * Check if the requested end address is in the same memory
 		 * region we found.
 		 */
-		if (lmb_addrs_overlap(lmb->memory.region[rgn].base,
-				      lmb->memory.region[rgn].size,
+		if (lmb_addrs_overlap(mem[rgn].base, mem[rgn].size,
 				      base + size - 1, 1)) {
 			/* ok, reserve the memory */
 			if (lmb_reserve(lmb, base, size) >= 0)
@@ -382,41 +440,33 @@ phys_addr_t lmb_alloc_addr(struct lmb *lmb, phys_addr_t base, phys_size_t size)
 /* Return number of bytes from a given address that are free */
 phys_size_t lmb_get_free_size(struct lmb *lmb, phys_addr_t addr)
 {
-	int i;
-	long rgn;
+	struct lmb_region *rgn = &lmb->reserved;
+	struct lmb_property *res = lmb_regions(rgn);
+	struct lmb_property *mem = lmb_regions(&lmb->memory);
+	long i;
 
 	/* check if the requested address is in the memory regions */
-	rgn = lmb_overlaps_region(&lmb->memory, addr, 1);
-	if (rgn >= 0) {
-		for (i = 0; i < lmb->reserved.cnt; i++) {
-			if (addr < lmb->reserved.region[i].base) {
-				/* first reserved range > requested address */
-				return lmb->reserved.region[i].base - addr;
-			}
-			if (lmb->reserved.region[i].base +
-			    lmb->reserved.region[i].size > addr) {
-				/* requested addr is in this reserved range */
-				return 0;
-			}
-		}
-		/* if we come here: no reserved ranges above requested addr */
-		return lmb->memory.region[lmb->memory.cnt - 1].base +
-		       lmb->memory.region[lmb->memory.cnt - 1].size - addr;
+	if (lmb_overlaps_region(&lmb->memory, addr, 1) < 0)
+		return 0;
+
+	i = lmb_find_region(rgn, addr);
+	if (i >= 0 && res[i].base + res[i].size > addr) {
+		/* requested addr is in this reserved range */
+		return 0;
 	}
-	return 0;
+	if (i + 1 < rgn->cnt) {
+		/* first reserved range > requested address */
+		return res[i + 1].base - addr;
+	}
+
+	/* if we come here: no reserved ranges above requested addr */
+	return mem[lmb->memory.cnt - 1].base + mem[lmb->memory.cnt - 1].size -
+	       addr;
 }
 
 int lmb_is_reserved(struct lmb *lmb, phys_addr_t addr)
 {
-	int i;
-
-	for (i = 0; i < lmb->reserved.cnt; i++) {
-		phys_addr_t upper = lmb->reserved.region[i].base +
-			lmb->reserved.region[i].size - 1;
-		if ((addr >= lmb->reserved.region[i].base) && (addr <= upper))
-			return 1;
-	}
-	return 0;
+	return lmb_overlaps_region(&lmb->reserved, addr, 1) >= 0;
 }
 
 __weak void board_lmb_reserve(struct lmb *lmb)
@@ -7,6 +7,7 @@
 #include <compiler.h>
 #include <image.h>
 #include <lz4.h>
+#include <worker.h>
 #include <linux/kernel.h>
 #include <linux/types.h>
 #include <asm/unaligned.h>
@@ -28,12 +29,165 @@ typedef uint64_t U64;
 
 #define LZ4F_BLOCKUNCOMPRESSED_FLAG 0x80000000U
 
+/*
+ * Decompress blocks until the end mark, or until @count blocks are done.
+ * @inp and @outp are updated to point after the data processed.
+ */
+static int lz4_blocks(const void *src, size_t srcn, const void **inp,
+		      void **outp, const void *end, int has_block_checksum,
+		      uint count)
+{
+	const void *in = *inp;
+	void *out = *outp;
+	int ret = 0;
+
+	for (; count; count--) {
+		u32 block_header, block_size;
+
+		block_header = get_unaligned_le32(in);
+		in += sizeof(u32);
+		block_size = block_header & ~LZ4F_BLOCKUNCOMPRESSED_FLAG;
+
+		if (in - src + block_size > srcn) {
+			ret = -EINVAL;		/* input overrun */
+			break;
+		}
+
+		if (!block_size) {
+			ret = 0;	/* decompression successful */
+			break;
+		}
+
+		if (block_header & LZ4F_BLOCKUNCOMPRESSED_FLAG) {
+			size_t size = min((ptrdiff_t)block_size, end - out);
+			memcpy(out, in, size);
+			out += size;
+			if (size < block_size) {
+				ret = -ENOBUFS;	/* output overrun */
+				break;
+			}
+		} else {
+			/* constant folding essential, do not touch params! */
+			ret = LZ4_decompress_generic(in, out, block_size,
+					end - out, endOnInputSize,
+					full, 0, noDict, out, NULL, 0);
+			if (ret < 0) {
+				ret = -EPROTO;	/* decompression error */
+				break;
+			}
+			out += ret;
+			ret = 0;
+		}
+
+		in += block_size;
+		if (has_block_checksum)
+			in += sizeof(u32);
+	}
+
+	*inp = in;
+	*outp = out;
+	return ret;
+}
+
+#if CONFIG_IS_ENABLED(WORKER)
+/* A run of blocks to decompress on one core */
+struct lz4_job {
+	struct worker_job job;
+	const void *src;
+	size_t srcn;
+	const void *in;
+	void *out;
+	const void *end;
+	uint count;
+	int has_block_checksum;
+};
+
+static int lz4_job_run(void *ctx)
+{
+	struct lz4_job *lj = ctx;
+
+	return lz4_blocks(lj->src, lj->srcn, &lj->in, &lj->out, lj->end,
+			  lj->has_block_checksum, lj->count);
+}
+
+/* Get the size of the block header, data and checksum at @in */
+static size_t lz4_block_len(const void *in, int has_block_checksum)
+{
+	return sizeof(u32) + (has_block_checksum ? sizeof(u32) : 0) +
+		(get_unaligned_le32(in) & ~LZ4F_BLOCKUNCOMPRESSED_FLAG);
+}
+
+/*
+ * Decompress the blocks using several cores. All blocks except the last one
+ * are normally full-sized, so each core can be given a run of blocks and the
+ * part of the output buffer that they fill.
+ *
+ * This returns -EAGAIN if the data cannot be split up like this (including if
+ * it has an error), so that the caller can decompress it in the normal way.
+ */
+static int lz4_parallel(const void *src, size_t srcn, const void *in,
+			void *dst, const void *end, int has_block_checksum,
+			size_t block_max, size_t *dstn)
+{
+	struct lz4_job jobs[CONFIG_WORKER_MAX + 1];
+	uint nblocks, njobs, blk, last, i;
+	const void *p;
+	int ret;
+
+	if (!worker_init())
+		return -EAGAIN;
+
+	/* Count the blocks up to the end mark */
+	for (p = in, nblocks = 0;; nblocks++) {
+		if (p - src + sizeof(u32) > srcn)
+			return -EAGAIN;
+		if (!get_unaligned_le32(p))
+			break;
+		p += lz4_block_len(p, has_block_checksum);
+	}
+	njobs = min(nblocks, worker_count() + 1);
+	if (njobs < 2 || (nblocks - 1) * block_max > end - (void *)dst)
+		return -EAGAIN;
+
+	for (i = 0, blk = 0, p = in; i < njobs; i++) {
+		struct lz4_job *lj = &jobs[i];
+
+		last = (ulong)nblocks * (i + 1) / njobs;
+		lj->src = src;
+		lj->srcn = srcn;
+		lj->in = p;
+		lj->out = dst + blk * block_max;
+		lj->end = i == njobs - 1 ? end : dst + last * block_max;
+		lj->count = last - blk;
+		lj->has_block_checksum = has_block_checksum;
+		for (; blk < last; blk++)
+			p += lz4_block_len(p, has_block_checksum);
+	}
+
+	for (i = 0; i < njobs; i++)
+		worker_submit(&jobs[i].job, lz4_job_run, &jobs[i]);
+
+	/* Any run which does not fill its part of the output spoils it */
+	for (i = 0, ret = 0; i < njobs; i++) {
+		if (worker_wait(&jobs[i].job) ||
+		    (i < njobs - 1 && jobs[i].out != jobs[i].end))
+			ret = -EAGAIN;
+	}
+	if (ret)
+		return ret;
+	*dstn = jobs[njobs - 1].out - dst;
+
+	return 0;
+}
+#endif
+
 int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn)
 {
 	const void *end = dst + *dstn;
 	const void *in = src;
 	void *out = dst;
 	int has_block_checksum;
+	size_t __maybe_unused block_max;
 	int ret;
 	*dstn = 0;
 
@@ -56,6 +210,9 @@ int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn)
 		independent_blocks = (flags >> 5) & 0x1;
 		has_block_checksum = (flags >> 4) & 0x1;
 		has_content_size = (flags >> 3) & 0x1;
+		/* 64KB, 256KB, 1MB or 4MB, with 0 for reserved values */
+		block_max = block_desc & 0x40 ?
+			1UL << (8 + 2 * ((block_desc >> 4) & 0x7)) : 0;
 
 		/* We assume there's always only a single, standard frame. */
 		if (magic != LZ4F_MAGIC || version != 1)
@@ -74,47 +231,17 @@ int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn)
 		in += sizeof(u8);
 	}
 
-	while (1) {
-		u32 block_header, block_size;
-
-		block_header = get_unaligned_le32(in);
-		in += sizeof(u32);
-		block_size = block_header & ~LZ4F_BLOCKUNCOMPRESSED_FLAG;
-
-		if (in - src + block_size > srcn) {
-			ret = -EINVAL;		/* input overrun */
-			break;
-		}
-
-		if (!block_size) {
-			ret = 0;	/* decompression successful */
-			break;
-		}
-
-		if (block_header & LZ4F_BLOCKUNCOMPRESSED_FLAG) {
-			size_t size = min((ptrdiff_t)block_size, end - out);
-			memcpy(out, in, size);
-			out += size;
-			if (size < block_size) {
-				ret = -ENOBUFS;	/* output overrun */
-				break;
-			}
-		} else {
-			/* constant folding essential, do not touch params! */
-			ret = LZ4_decompress_generic(in, out, block_size,
-					end - out, endOnInputSize,
-					full, 0, noDict, out, NULL, 0);
-			if (ret < 0) {
-				ret = -EPROTO;	/* decompression error */
-				break;
-			}
-			out += ret;
-		}
-
-		in += block_size;
-		if (has_block_checksum)
-			in += sizeof(u32);
+#if CONFIG_IS_ENABLED(WORKER)
+	/* Blocks can only be done out of order if nothing is overwritten */
+	if (block_max && (src + srcn <= (void *)dst || end <= src)) {
+		ret = lz4_parallel(src, srcn, in, dst, end, has_block_checksum,
+				   block_max, dstn);
+		if (ret != -EAGAIN)
+			return ret;
 	}
+#endif
+	ret = lz4_blocks(src, srcn, &in, &out, end, has_block_checksum,
+			 UINT_MAX);
 
 	*dstn = out - dst;
 	return ret;
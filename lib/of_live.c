@@ -330,7 +330,11 @@ int of_live_build(const void *fdt_blob, struct device_node **rootp)
 		debug("Failed to scan live tree aliases: err=%d\n", ret);
 		return ret;
 	}
+	/* Lookups still work without the index, just more slowly */
+	ret = of_phandle_index_build();
+	if (ret)
+		log_warning("Cannot index live tree phandles: err=%d\n", ret);
 	debug("%s: stop\n", __func__);
 
-	return ret;
+	return 0;
 }
@@ -0,0 +1,32 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Packed relative relocations (RELR)
+ *
+ * This is called during relocation, so it must not use any global data or be
+ * traced.
+ */
+
+#include <common.h>
+#include <relr.h>
+
+void notrace relr_apply(const ulong *start, const ulong *end, ulong offset)
+{
+	const ulong *relr;
+	ulong *where = NULL;
+
+	for (relr = start; relr < end; relr++) {
+		ulong entry = *relr;
+		int i;
+
+		if (!(entry & 1)) {
+			where = (ulong *)(entry + offset);
+			*where++ += offset;
+			continue;
+		}
+		for (i = 0; entry >>= 1; i++) {
+			if (entry & 1)
+				where[i] += offset;
+		}
+		where += sizeof(ulong) * 8 - 1;
+	}
+}
@@ -5,6 +5,7 @@
  */
 
 #include <common.h>
+#include <bgtask.h>
 #include <bootstage.h>
 #include <dm.h>
 #include <errno.h>
@@ -184,11 +185,22 @@ void __weak __udelay(unsigned long usec)
 
 void udelay(unsigned long usec)
 {
-	ulong kv;
+	ulong kv, max = CONFIG_WD_PERIOD;
+	bool poll = false;
 
+	/*
+	 * Let background tasks run during longer delays. Short ones are often
+	 * used for bus timing, so leave those alone.
+	 */
+	if (usec >= BGTASK_UDELAY_US && bgtask_pending()) {
+		max = BGTASK_UDELAY_US;
+		poll = true;
+	}
 	do {
 		WATCHDOG_RESET();
-		kv = usec > CONFIG_WD_PERIOD ? CONFIG_WD_PERIOD : usec;
+		if (poll)
+			bgtask_poll();
+		kv = usec > max ? max : usec;
 		__udelay(kv);
 		usec -= kv;
 	} while(usec);
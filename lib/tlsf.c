@@ -0,0 +1,614 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Two-Level Segregated Fit (TLSF) memory allocator
+ *
+ * This follows the design in "TLSF: a New Dynamic Memory Allocator for
+ * Real-Time Systems" by M. Masmano, I. Ripoll, A. Crespo and J. Real.
+ *
+ * Each block starts with a header holding its size and a pointer to the block
+ * physically before it, so that neighbouring free blocks can be merged without
+ * searching. Free blocks also hold the links for their free list in the space
+ * which would otherwise be used for data.
+ */
+
+#define LOG_CATEGORY LOGC_ALLOC
+
+#include <common.h>
+#include <log.h>
+#include <tlsf.h>
+#include <linux/bitops.h>
+#include <linux/errno.h>
+#include <linux/kernel.h>
+
+/*
+ * Blocks are aligned to twice the word size, the same as dlmalloc. The largest
+ * block is limited to 1GB on 32-bit machines and 4GB on 64-bit ones.
+ */
+#if __SIZEOF_POINTER__ == 8
+#define ALIGN_SIZE_LOG2		4
+#define FL_INDEX_MAX		32
+#else
+#define ALIGN_SIZE_LOG2		3
+#define FL_INDEX_MAX		30
+#endif
+#define ALIGN_SIZE		(1 << ALIGN_SIZE_LOG2)
+
+/* Each power-of-two size range is divided into this many lists */
+#define SL_INDEX_COUNT_LOG2	5
+#define SL_INDEX_COUNT		(1 << SL_INDEX_COUNT_LOG2)
+
+/* Blocks smaller than SMALL_BLOCK_SIZE are all in first-level list 0 */
+#define FL_INDEX_SHIFT		(SL_INDEX_COUNT_LOG2 + ALIGN_SIZE_LOG2)
+#define FL_INDEX_COUNT		(FL_INDEX_MAX - FL_INDEX_SHIFT + 1)
+#define SMALL_BLOCK_SIZE	(1 << FL_INDEX_SHIFT)
+
+/* Flags held in the bottom bits of the block size */
+#define BLOCK_FREE		BIT(0)
+#define BLOCK_PREV_FREE		BIT(1)
+#define BLOCK_FLAGS		(BLOCK_FREE | BLOCK_PREV_FREE)
+
+struct tlsf_block {
+	struct tlsf_block *prev_phys;
+	size_t size;
+	/* These are only valid if the block is free */
+	struct tlsf_block *next_free;
+	struct tlsf_block *prev_free;
+};
+
+#define BLOCK_HDR		offsetof(struct tlsf_block, next_free)
+#define BLOCK_SIZE_MIN		(sizeof(struct tlsf_block) - BLOCK_HDR)
+#define BLOCK_SIZE_MAX		((size_t)1 << FL_INDEX_MAX)
+
+/**
+ * struct tlsf - Control structure for a pool
+ *
+ * @fl_bitmap: Bit n is set if any list in @blocks[n] is non-empty
+ * @sl_bitmap: Bit m of element n is set if @blocks[n][m] is non-empty
+ * @blocks: Lists of free blocks
+ * @first: First block in the pool
+ * @last: Zero-sized block which marks the end of the pool
+ * @total: Number of bytes available for blocks, including headers
+ * @used: Number of bytes in allocated blocks, including headers
+ * @max_used: Largest value that @used has reached
+ * @free_blocks: Number of free blocks
+ */
+struct tlsf {
+	u32 fl_bitmap;
+	u32 sl_bitmap[FL_INDEX_COUNT];
+	struct tlsf_block *blocks[FL_INDEX_COUNT][SL_INDEX_COUNT];
+	struct tlsf_block *first;
+	struct tlsf_block *last;
+	size_t total;
+	size_t used;
+	size_t max_used;
+	uint free_blocks;
+};
+
+static inline size_t block_size(const struct tlsf_block *block)
+{
+	return block->size & ~BLOCK_FLAGS;
+}
+
+static inline void block_set_size(struct tlsf_block *block, size_t size)
+{
+	block->size = size | (block->size & BLOCK_FLAGS);
+}
+
+static inline bool block_is_free(const struct tlsf_block *block)
+{
+	return block->size & BLOCK_FREE;
+}
+
+static inline void *block_to_ptr(const struct tlsf_block *block)
+{
+	return (char *)block + BLOCK_HDR;
+}
+
+static inline struct tlsf_block *block_from_ptr(const void *ptr)
+{
+	return (struct tlsf_block *)((char *)ptr - BLOCK_HDR);
+}
+
+static inline struct tlsf_block *block_next(const struct tlsf_block *block)
+{
+	return (struct tlsf_block *)((char *)block_to_ptr(block) +
+				     block_size(block));
+}
+
+/* Point the next block back at this one, returning the next block */
+static struct tlsf_block *block_link_next(struct tlsf_block *block)
+{
+	struct tlsf_block *next = block_next(block);
+
+	next->prev_phys = block;
+
+	return next;
+}
+
+static void block_mark_free(struct tlsf_block *block)
+{
+	struct tlsf_block *next = block_link_next(block);
+
+	next->size |= BLOCK_PREV_FREE;
+	block->size |= BLOCK_FREE;
+}
+
+static void block_mark_used(struct tlsf_block *block)
+{
+	struct tlsf_block *next = block_next(block);
+
+	next->size &= ~BLOCK_PREV_FREE;
+	block->size &= ~BLOCK_FREE;
+}
+
+/* Get the list which a free block of the given size belongs in */
+static void mapping_insert(size_t size, int *flp, int *slp)
+{
+	int fl;
+
+	if (size < SMALL_BLOCK_SIZE) {
+		*flp = 0;
+		*slp = size / (SMALL_BLOCK_SIZE / SL_INDEX_COUNT);
+	} else {
+		fl = fls_long(size) - 1;
+		*slp = (size >> (fl - SL_INDEX_COUNT_LOG2)) ^ SL_INDEX_COUNT;
+		*flp = fl - (FL_INDEX_SHIFT - 1);
+	}
+}
+
+/*
+ * Get the first list in which every block is large enough for the given size.
+ * This may return a first-level index which is out of range.
+ */
+static void mapping_search(size_t size, int *flp, int *slp)
+{
+	if (size >= SMALL_BLOCK_SIZE)
+		size += (1UL << (fls_long(size) - 1 - SL_INDEX_COUNT_LOG2)) - 1;
+	mapping_insert(size, flp, slp);
+}
+
+/* Find a non-empty list at or above the given one */
+static struct tlsf_block *search_suitable(struct tlsf *tlsf, int *flp,
+					  int *slp)
+{
+	u32 sl_map, fl_map;
+	int fl = *flp;
+
+	sl_map = tlsf->sl_bitmap[fl] & (~0U << *slp);
+	if (!sl_map) {
+		fl_map = tlsf->fl_bitmap & (~0U << (fl + 1));
+		if (!fl_map)
+			return NULL;
+		fl = ffs(fl_map) - 1;
+		*flp = fl;
+		sl_map = tlsf->sl_bitmap[fl];
+	}
+	*slp = ffs(sl_map) - 1;
+
+	return tlsf->blocks[fl][*slp];
+}
+
+static void remove_free_block(struct tlsf *tlsf, struct tlsf_block *block,
+			      int fl, int sl)
+{
+	struct tlsf_block *prev = block->prev_free;
+	struct tlsf_block *next = block->next_free;
+
+	if (next)
+		next->prev_free = prev;
+	if (prev) {
+		prev->next_free = next;
+	} else {
+		tlsf->blocks[fl][sl] = next;
+		if (!next) {
+			tlsf->sl_bitmap[fl] &= ~BIT(sl);
+			if (!tlsf->sl_bitmap[fl])
+				tlsf->fl_bitmap &= ~BIT(fl);
+		}
+	}
+	tlsf->free_blocks--;
+}
+
+static void insert_free_block(struct tlsf *tlsf, struct tlsf_block *block,
+			      int fl, int sl)
+{
+	struct tlsf_block *head = tlsf->blocks[fl][sl];
+
+	block->next_free = head;
+	block->prev_free = NULL;
+	if (head)
+		head->prev_free = block;
+	tlsf->blocks[fl][sl] = block;
+	tlsf->fl_bitmap |= BIT(fl);
+	tlsf->sl_bitmap[fl] |= BIT(sl);
+	tlsf->free_blocks++;
+}
+
+static void block_remove(struct tlsf *tlsf, struct tlsf_block *block)
+{
+	int fl, sl;
+
+	mapping_insert(block_size(block), &fl, &sl);
+	remove_free_block(tlsf, block, fl, sl);
+}
+
+static void block_insert(struct tlsf *tlsf, struct tlsf_block *block)
+{
+	int fl, sl;
+
+	mapping_insert(block_size(block), &fl, &sl);
+	insert_free_block(tlsf, block, fl, sl);
+}
+
+static bool block_can_split(struct tlsf_block *block, size_t size)
+{
+	return block_size(block) >= size + BLOCK_HDR + BLOCK_SIZE_MIN;
+}
+
+/*
+ * Split a block so that it holds @size bytes, returning a new free block for
+ * the rest. The new block is not added to any list.
+ */
+static struct tlsf_block *block_split(struct tlsf_block *block, size_t size)
+{
+	struct tlsf_block *rest;
+
+	rest = (struct tlsf_block *)((char *)block_to_ptr(block) + size);
+	rest->size = block_size(block) - size - BLOCK_HDR;
+	if (block_is_free(block))
+		rest->size |= BLOCK_PREV_FREE;
+	block_set_size(block, size);
+	block_link_next(block);
+	block_mark_free(rest);
+
+	return rest;
+}
+
+/* Merge a free block with the previous one if that is also free */
+static struct tlsf_block *block_merge_prev(struct tlsf *tlsf,
+					   struct tlsf_block *block)
+{
+	struct tlsf_block *prev;
+
+	if (block->size & BLOCK_PREV_FREE) {
+		prev = block->prev_phys;
+		block_remove(tlsf, prev);
+		block_set_size(prev, block_size(prev) + BLOCK_HDR +
+			       block_size(block));
+		block_link_next(prev);
+		block = prev;
+	}
+
+	return block;
+}
+
+/* Merge a block with the next one if that is free */
+static struct tlsf_block *block_merge_next(struct tlsf *tlsf,
+					   struct tlsf_block *block)
+{
+	struct tlsf_block *next = block_next(block);
+
+	if (block_is_free(next)) {
+		block_remove(tlsf, next);
+		block_set_size(block, block_size(block) + BLOCK_HDR +
+			       block_size(next));
+		block_link_next(block);
+	}
+
+	return block;
+}
+
+/* Return any space beyond @size in a free block to the free lists */
+static void block_trim_free(struct tlsf *tlsf, struct tlsf_block *block,
+			    size_t size)
+{
+	if (block_can_split(block, size))
+		block_insert(tlsf, block_split(block, size));
+}
+
+/* Return any space beyond @size in an allocated block to the free lists */
+static void block_trim_used(struct tlsf *tlsf, struct tlsf_block *block,
+			    size_t size)
+{
+	struct tlsf_block *rest;
+
+	if (block_can_split(block, size)) {
+		tlsf->used -= block_size(block) - size;
+		rest = block_split(block, size);
+		rest = block_merge_next(tlsf, rest);
+		block_insert(tlsf, rest);
+	}
+}
+
+/*
+ * Return the first @gap bytes of a free block to the free lists, returning
+ * the block which follows them
+ */
+static struct tlsf_block *block_trim_free_leading(struct tlsf *tlsf,
+						  struct tlsf_block *block,
+						  size_t gap)
+{
+	struct tlsf_block *rest;
+
+	rest = block_split(block, gap - BLOCK_HDR);
+	block_insert(tlsf, block);
+
+	return rest;
+}
+
+/* Find a free block of at least @size bytes and remove it from its list */
+static struct tlsf_block *block_locate_free(struct tlsf *tlsf, size_t size)
+{
+	struct tlsf_block *block;
+	int fl, sl;
+
+	mapping_search(size, &fl, &sl);
+	if (fl >= FL_INDEX_COUNT)
+		return NULL;
+	block = search_suitable(tlsf, &fl, &sl);
+	if (block)
+		remove_free_block(tlsf, block, fl, sl);
+
+	return block;
+}
+
+static void *block_prepare_used(struct tlsf *tlsf, struct tlsf_block *block,
+				size_t size)
+{
+	block_trim_free(tlsf, block, size);
+	block_mark_used(block);
+	tlsf->used += block_size(block) + BLOCK_HDR;
+	if (tlsf->used > tlsf->max_used)
+		tlsf->max_used = tlsf->used;
+
+	return block_to_ptr(block);
+}
+
+/* Get the block size to use for a request, or 0 if it is too large */
+static size_t adjust_request_size(size_t size)
+{
+	if (size >= BLOCK_SIZE_MAX)
+		return 0;
+
+	return max_t(size_t, ALIGN(size, ALIGN_SIZE), BLOCK_SIZE_MIN);
+}
+
+struct tlsf *tlsf_create(void *mem, size_t size)
+{
+	ulong start = ALIGN((ulong)mem, ALIGN_SIZE);
+	ulong end = ((ulong)mem + size) & ~(ulong)(ALIGN_SIZE - 1);
+	struct tlsf_block *block;
+	struct tlsf *tlsf;
+	ulong pool;
+	size_t avail;
+
+	pool = ALIGN(start + sizeof(*tlsf), ALIGN_SIZE);
+	if (end < pool || end - pool < 2 * BLOCK_HDR + BLOCK_SIZE_MIN)
+		return NULL;
+	avail = min_t(size_t, end - pool - 2 * BLOCK_HDR,
+		      BLOCK_SIZE_MAX - ALIGN_SIZE);
+
+	tlsf = (struct tlsf *)start;
+	memset(tlsf, '\0', sizeof(*tlsf));
+	block = (struct tlsf_block *)pool;
+	block->prev_phys = NULL;
+	block->size = avail;
+	tlsf->first = block;
+	tlsf->total = avail + BLOCK_HDR;
+
+	/* The sentinel is never free, so nothing is ever merged with it */
+	tlsf->last = block_link_next(block);
+	tlsf->last->size = 0;
+	block_mark_free(block);
+	block_insert(tlsf, block);
+
+	return tlsf;
+}
+
+void *tlsf_malloc(struct tlsf *tlsf, size_t size)
+{
+	struct tlsf_block *block;
+	size_t adjust;
+
+	adjust = adjust_request_size(size);
+	if (!adjust)
+		return NULL;
+	block = block_locate_free(tlsf, adjust);
+	if (!block)
+		return NULL;
+
+	return block_prepare_used(tlsf, block, adjust);
+}
+
+void *tlsf_memalign(struct tlsf *tlsf, size_t align, size_t size)
+{
+	const size_t gap_min = BLOCK_HDR + BLOCK_SIZE_MIN;
+	struct tlsf_block *block;
+	ulong ptr, aligned;
+	size_t adjust, gap;
+
+	if (align <= ALIGN_SIZE)
+		return tlsf_malloc(tlsf, size);
+	if (align & (align - 1))
+		return NULL;
+	adjust = adjust_request_size(size);
+	if (!adjust || align >= BLOCK_SIZE_MAX ||
+	    adjust >= BLOCK_SIZE_MAX - align - gap_min)
+		return NULL;
+
+	/*
+	 * Find a block large enough to be aligned, allowing for the gap in
+	 * front to be large enough to become a free block itself
+	 */
+	block = block_locate_free(tlsf, adjust + align + gap_min);
+	if (!block)
+		return NULL;
+	ptr = (ulong)block_to_ptr(block);
+	aligned = ALIGN(ptr, align);
+	gap = aligned - ptr;
+	if (gap && gap < gap_min) {
+		aligned = ALIGN(ptr + gap_min, align);
+		gap = aligned - ptr;
+	}
+	if (gap)
+		block = block_trim_free_leading(tlsf, block, gap);
+
+	return block_prepare_used(tlsf, block, adjust);
+}
+
+void tlsf_free(struct tlsf *tlsf, void *ptr)
+{
+	struct tlsf_block *block;
+
+	if (!ptr)
+		return;
+	block = block_from_ptr(ptr);
+	if (block_is_free(block)) {
+		log_err("Block %p is already free\n", ptr);
+		return;
+	}
+	tlsf->used -= block_size(block) + BLOCK_HDR;
+	block_mark_free(block);
+	block = block_merge_prev(tlsf, block);
+	block = block_merge_next(tlsf, block);
+	block_insert(tlsf, block);
+}
+
+void *tlsf_realloc(struct tlsf *tlsf, void *ptr, size_t size)
+{
+	struct tlsf_block *block, *next;
+	size_t cur, adjust;
+	void *new;
+
+	if (!ptr)
+		return tlsf_malloc(tlsf, size);
+	if (!size) {
+		tlsf_free(tlsf, ptr);
+		return NULL;
+	}
+	adjust = adjust_request_size(size);
+	if (!adjust)
+		return NULL;
+	block = block_from_ptr(ptr);
+	cur = block_size(block);
+
+	if (adjust > cur) {
+		/* Grow into the next block if possible, else move */
+		next = block_next(block);
+		if (!block_is_free(next) ||
+		    cur + BLOCK_HDR + block_size(next) < adjust) {
+			new = tlsf_malloc(tlsf, size);
+			if (new) {
+				memcpy(new, ptr, cur);
+				tlsf_free(tlsf, ptr);
+			}
+			return new;
+		}
+		block_merge_next(tlsf, block);
+		block_mark_used(block);
+		tlsf->used += block_size(block) - cur;
+	}
+	block_trim_used(tlsf, block, adjust);
+	if (tlsf->used > tlsf->max_used)
+		tlsf->max_used = tlsf->used;
+
+	return ptr;
+}
+
+size_t tlsf_usable_size(const void *ptr)
+{
+	return block_size(block_from_ptr(ptr));
+}
+
+bool tlsf_contains(struct tlsf *tlsf, const void *ptr)
+{
+	return ptr >= block_to_ptr(tlsf->first) && ptr < (void *)tlsf->last;
+}
+
+void tlsf_get_info(struct tlsf *tlsf, struct tlsf_info *info)
+{
+	struct tlsf_block *block;
+	int fl, sl;
+
+	info->total = tlsf->total;
+	info->used = tlsf->used;
+	info->max_used = tlsf->max_used;
+	info->free_blocks = tlsf->free_blocks;
+	info->largest_free = 0;
+	if (tlsf->fl_bitmap) {
+		fl = fls(tlsf->fl_bitmap) - 1;
+		sl = fls(tlsf->sl_bitmap[fl]) - 1;
+		for (block = tlsf->blocks[fl][sl]; block;
+		     block = block->next_free)
+			info->largest_free = max(info->largest_free,
+						 block_size(block));
+	}
+}
+
+/* Check that a free block is on the list it should be on */
+static bool tlsf_check_listed(struct tlsf *tlsf, struct tlsf_block *block)
+{
+	struct tlsf_block *node;
+	int fl, sl;
+
+	mapping_insert(block_size(block), &fl, &sl);
+	for (node = tlsf->blocks[fl][sl]; node; node = node->next_free) {
+		if (node == block)
+			return true;
+	}
+
+	return false;
+}
+
+int tlsf_check(struct tlsf *tlsf)
+{
+	struct tlsf_block *block, *prev = NULL;
+	uint free_blocks = 0, listed = 0;
+	bool prev_free = false;
+	size_t used = 0, size;
+	int fl, sl;
+
+	for (block = tlsf->first; block != tlsf->last;
+	     block = block_next(block)) {
+		size = block_size(block);
+		if (block->prev_phys != prev ||
+		    !!(block->size & BLOCK_PREV_FREE) != prev_free ||
+		    size < BLOCK_SIZE_MIN || size & (ALIGN_SIZE - 1) ||
+		    (ulong)block_next(block) > (ulong)tlsf->last)
+			return log_msg_ret("blk", -EINVAL);
+		if (block_is_free(block)) {
+			/* Neighbouring free blocks should have been merged */
+			if (prev_free || !tlsf_check_listed(tlsf, block))
+				return log_msg_ret("free", -EINVAL);
+			free_blocks++;
+		} else {
+			used += size + BLOCK_HDR;
+		}
+		prev_free = block_is_free(block);
+		prev = block;
+	}
+	if (tlsf->last->prev_phys != prev ||
+	    !!(tlsf->last->size & BLOCK_PREV_FREE) != prev_free ||
+	    used != tlsf->used || free_blocks != tlsf->free_blocks)
+		return log_msg_ret("tot", -EINVAL);
+
+	for (fl = 0; fl < FL_INDEX_COUNT; fl++) {
+		if (!(tlsf->fl_bitmap & BIT(fl)) != !tlsf->sl_bitmap[fl])
+			return log_msg_ret("fl", -EINVAL);
+		for (sl = 0; sl < SL_INDEX_COUNT; sl++) {
+			struct tlsf_block *node = tlsf->blocks[fl][sl];
+
+			if (!(tlsf->sl_bitmap[fl] & BIT(sl)) != !node)
+				return log_msg_ret("sl", -EINVAL);
+			for (; node; node = node->next_free) {
+				if (!block_is_free(node))
+					return log_msg_ret("lst", -EINVAL);
+				listed++;
+			}
+		}
+	}
+	if (listed != free_blocks)
+		return log_msg_ret("cnt", -EINVAL);
+
+	return 0;
+}
@@ -4,17 +4,51 @@
  */
 
 #include <common.h>
+#include <malloc.h>
 #include <mapmem.h>
+#include <os.h>
+#include <sort.h>
 #include <time.h>
 #include <trace.h>
 #include <asm/io.h>
 #include <asm/sections.h>
+#include <linux/bug.h>
+#include <linux/log2.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
 static char trace_enabled __attribute__((section(".data")));
 static char trace_inited __attribute__((section(".data")));
 
+/* Number of nested calls for which timing statistics are collected */
+#define TRACE_STATS_DEPTH	64
+
+/* Maximum number of hash-table slots to check when looking up a function */
+#define TRACE_STATS_PROBES	32
+
+#ifdef CONFIG_TRACE_FUNC_STATS
+#define TRACE_STATS_SIZE	CONFIG_TRACE_FUNC_STATS_SIZE
+#else
+#define TRACE_STATS_SIZE	0
+#endif
+
+/* Timing statistics for a function */
+struct trace_func_stats {
+	u32 func;		/* Function number plus one, 0 if slot unused */
+	u32 count;		/* Number of completed calls */
+	u32 min_us;		/* Shortest call */
+	u32 max_us;		/* Longest call */
+	u64 total_us;		/* Total time including called functions */
+	u64 self_us;		/* Total time excluding called functions */
+};
+
+/* A function which has been entered but not yet exited */
+struct trace_frame {
+	u32 func;		/* Function number */
+	ulong start_us;		/* Time when the function was entered */
+	ulong child_us;		/* Time spent in functions it called */
+};
+
 /* The header block at the start of the trace memory area */
 struct trace_hdr {
 	int func_count;		/* Total number of function call sites */
@@ -32,11 +66,17 @@ struct trace_hdr {
 	struct trace_call *ftrace;	/* The function call records */
 	ulong ftrace_size;	/* Num. of ftrace records we have space for */
 	ulong ftrace_count;	/* Num. of ftrace records written */
+	ulong ftrace_pos;	/* Position of the next ftrace record */
 	ulong ftrace_too_deep_count;	/* Functions that were too deep */
 
 	int depth;
 	int depth_limit;
 	int max_depth;
+
+	/* Hash table of per-function statistics (CONFIG_TRACE_FUNC_STATS) */
+	struct trace_func_stats *stats;
+	ulong stats_dropped;	/* Calls not counted as the table was full */
+	struct trace_frame stack[TRACE_STATS_DEPTH];
 };
 
 static struct trace_hdr *hdr;	/* Pointer to start of trace buffer */
@@ -107,8 +147,13 @@ static void __attribute__((no_instrument_function)) add_ftrace(void *func_ptr,
 		hdr->ftrace_too_deep_count++;
 		return;
 	}
-	if (hdr->ftrace_count < hdr->ftrace_size) {
-		struct trace_call *rec = &hdr->ftrace[hdr->ftrace_count];
+	if (hdr->ftrace_pos == hdr->ftrace_size && IS_ENABLED(CONFIG_TRACE_RING) &&
+	    hdr->ftrace_size > 1) {
+		/* Overwrite the oldest record, but keep the text base */
+		hdr->ftrace_pos = 1;
+	}
+	if (hdr->ftrace_pos < hdr->ftrace_size) {
+		struct trace_call *rec = &hdr->ftrace[hdr->ftrace_pos++];
 
 		rec->func = func_ptr_to_num(func_ptr);
 		rec->caller = func_ptr_to_num(caller);
@@ -119,8 +164,8 @@ static void __attribute__((no_instrument_function)) add_ftrace(void *func_ptr,
 
 static void __attribute__((no_instrument_function)) add_textbase(void)
 {
-	if (hdr->ftrace_count < hdr->ftrace_size) {
-		struct trace_call *rec = &hdr->ftrace[hdr->ftrace_count];
+	if (hdr->ftrace_pos < hdr->ftrace_size) {
+		struct trace_call *rec = &hdr->ftrace[hdr->ftrace_pos++];
 
 		rec->func = CONFIG_SYS_TEXT_BASE;
 		rec->caller = 0;
@@ -129,6 +174,90 @@ static void __attribute__((no_instrument_function)) add_textbase(void)
 	hdr->ftrace_count++;
 }
 
+/**
+ * stats_find() - Find the statistics for a function
+ *
+ * @func:	Function number
+ * Return:	pointer to statistics, which are set up if this is the first
+ *		call to the function, or NULL if there is no space for it
+ */
+static struct trace_func_stats __attribute__((no_instrument_function))
+		*stats_find(uint func)
+{
+	uint mask = TRACE_STATS_SIZE - 1;
+	uint i, probe;
+
+	i = ((func * 0x9e3779b1U) >> 16) & mask;
+	for (probe = 0; probe < TRACE_STATS_PROBES; probe++) {
+		struct trace_func_stats *stats = &hdr->stats[i];
+
+		if (stats->func == func + 1)
+			return stats;
+		if (!stats->func) {
+			stats->func = func + 1;
+			stats->min_us = U32_MAX;
+			return stats;
+		}
+		i = (i + 1) & mask;
+	}
+
+	return NULL;
+}
+
+/**
+ * stats_enter() - Record the time when a function is entered
+ *
+ * @func:	Function number
+ */
+static void __attribute__((no_instrument_function)) stats_enter(uint func)
+{
+	struct trace_frame *frame;
+
+	if (hdr->depth < 0 || hdr->depth >= TRACE_STATS_DEPTH)
+		return;
+	frame = &hdr->stack[hdr->depth];
+	frame->func = func;
+	frame->start_us = timer_get_us();
+	frame->child_us = 0;
+}
+
+/**
+ * stats_exit() - Update the statistics when a function exits
+ *
+ * @func:	Function number
+ */
+static void __attribute__((no_instrument_function)) stats_exit(uint func)
+{
+	int depth = hdr->depth - 1;
+	struct trace_func_stats *stats;
+	struct trace_frame *frame;
+	ulong duration;
+
+	if (depth < 0 || depth >= TRACE_STATS_DEPTH)
+		return;
+	frame = &hdr->stack[depth];
+
+	/* Ignore functions entered before tracing started */
+	if (frame->func != func)
+		return;
+	duration = timer_get_us() - frame->start_us;
+	if (depth)
+		hdr->stack[depth - 1].child_us += duration;
+
+	stats = stats_find(func);
+	if (!stats) {
+		hdr->stats_dropped++;
+		return;
+	}
+	stats->count++;
+	stats->total_us += duration;
+	stats->self_us += duration - frame->child_us;
+	if (duration < stats->min_us)
+		stats->min_us = duration;
+	if (duration > stats->max_us)
+		stats->max_us = duration;
+}
+
 /**
  * __cyg_profile_func_enter() - record function entry
  *
@@ -147,6 +276,8 @@ void __attribute__((no_instrument_function)) __cyg_profile_func_enter(
 		trace_swap_gd();
 		add_ftrace(func_ptr, caller, FUNCF_ENTRY);
 		func = func_ptr_to_num(func_ptr);
+		if (IS_ENABLED(CONFIG_TRACE_FUNC_STATS))
+			stats_enter(func);
 		if (func < hdr->func_count) {
 			hdr->call_accum[func]++;
 			hdr->call_count++;
@@ -172,6 +303,8 @@ void __attribute__((no_instrument_function)) __cyg_profile_func_exit(
 	if (trace_enabled) {
 		trace_swap_gd();
 		add_ftrace(func_ptr, caller, FUNCF_EXIT);
+		if (IS_ENABLED(CONFIG_TRACE_FUNC_STATS))
+			stats_exit(func_ptr_to_num(func_ptr));
 		hdr->depth--;
 		trace_swap_gd();
 	}
@@ -250,8 +383,9 @@ int trace_list_calls(void *buff, size_t buff_size, size_t *needed)
 {
 	struct trace_output_hdr *output_hdr = NULL;
 	void *end, *ptr = buff;
-	size_t rec, upto;
+	size_t rec, upto, idx;
 	size_t count;
+	bool wrapped;
 
 	end = buff ? buff + buff_size : NULL;
 
@@ -264,11 +398,23 @@ int trace_list_calls(void *buff, size_t buff_size, size_t *needed)
 	count = hdr->ftrace_count;
 	if (count > hdr->ftrace_size)
 		count = hdr->ftrace_size;
+	wrapped = IS_ENABLED(CONFIG_TRACE_RING) &&
+		hdr->ftrace_count > hdr->ftrace_size;
 	for (rec = upto = 0; rec < count; rec++) {
 		if (ptr + sizeof(struct trace_call) < end) {
-			struct trace_call *call = &hdr->ftrace[rec];
+			struct trace_call *call;
 			struct trace_call *out = ptr;
 
+			/*
+			 * If the ring has wrapped, the oldest record is at the
+			 * write position. The text base is always first.
+			 */
+			idx = rec;
+			if (wrapped && rec)
+				idx = 1 + (hdr->ftrace_pos - 1 + rec - 1) %
+					(hdr->ftrace_size - 1);
+			call = &hdr->ftrace[idx];
+
 			out->func = call->func * FUNC_SITE_SIZE;
 			out->caller = call->caller * FUNC_SITE_SIZE;
 			out->flags = call->flags;
@@ -316,14 +462,120 @@ void trace_print_stats(void)
 	print_grouped_ull(count, 10);
 	puts(" traced function calls");
 	if (hdr->ftrace_count > hdr->ftrace_size) {
-		printf(" (%lu dropped due to overflow)",
-		       hdr->ftrace_count - hdr->ftrace_size);
+		printf(" (%lu %s due to overflow)",
+		       hdr->ftrace_count - hdr->ftrace_size,
+		       IS_ENABLED(CONFIG_TRACE_RING) ? "overwritten" :
+		       "dropped");
 	}
 	puts("\n");
 	printf("%15d maximum observed call depth\n", hdr->max_depth);
 	printf("%15d call depth limit\n", hdr->depth_limit);
 	print_grouped_ull(hdr->ftrace_too_deep_count, 10);
 	puts(" calls not traced due to depth\n");
+	if (IS_ENABLED(CONFIG_TRACE_FUNC_STATS)) {
+		print_grouped_ull(hdr->stats_dropped, 10);
+		puts(" calls not timed as the function table is full\n");
+	}
+}
+
+static enum trace_sort trace_sort_key;
+
+static u64 stats_sort_value(const struct trace_func_stats *stats)
+{
+	switch (trace_sort_key) {
+	case TRACE_SORT_TOTAL:
+		return stats->total_us;
+	case TRACE_SORT_CALLS:
+		return stats->count;
+	case TRACE_SORT_MAX:
+		return stats->max_us;
+	case TRACE_SORT_SELF:
+	default:
+		return stats->self_us;
+	}
+}
+
+static int h_cmp_stats(const void *v1, const void *v2)
+{
+	const struct trace_func_stats *const *s1 = v1, *const *s2 = v2;
+	u64 val1 = stats_sort_value(*s1), val2 = stats_sort_value(*s2);
+
+	if (val1 == val2)
+		return 0;
+
+	return val1 < val2 ? 1 : -1;
+}
+
+/**
+ * trace_func_name() - Get a printable name for a function
+ *
+ * On sandbox the name is looked up in the executable. Elsewhere this is the
+ * link-time address of the function, which can be found in System.map
+ *
+ * @func:	Function number
+ * @buf:	Buffer to use for the name if needed
+ * @size:	Size of buffer
+ * Return:	name of function
+ */
+static const char *trace_func_name(uint func, char *buf, int size)
+{
+#ifdef CONFIG_SANDBOX
+	const char *name;
+	ulong offset;
+
+	name = os_find_symbol((ulong)&_init + func * FUNC_SITE_SIZE, &offset);
+	if (name && !offset)
+		return name;
+#endif
+	snprintf(buf, size, "%08lx",
+		 (ulong)CONFIG_SYS_TEXT_BASE + func * FUNC_SITE_SIZE);
+
+	return buf;
+}
+
+int trace_print_top(int count, enum trace_sort sort)
+{
+	struct trace_func_stats **list;
+	int was_enabled = trace_enabled;
+	int i, used;
+	char buf[20];
+
+	if (!IS_ENABLED(CONFIG_TRACE_FUNC_STATS))
+		return -ENOSYS;
+	if (!trace_inited) {
+		printf("Trace is disabled\n");
+		return -ENOENT;
+	}
+
+	/* Don't time the functions used to show the results */
+	trace_enabled = 0;
+	list = malloc(TRACE_STATS_SIZE * sizeof(*list));
+	if (!list) {
+		trace_enabled = was_enabled;
+		return -ENOMEM;
+	}
+	for (i = 0, used = 0; i < TRACE_STATS_SIZE; i++) {
+		if (hdr->stats[i].func && hdr->stats[i].count)
+			list[used++] = &hdr->stats[i];
+	}
+	trace_sort_key = sort;
+	qsort(list, used, sizeof(*list), h_cmp_stats);
+
+	printf("%10s %12s %12s %9s %9s %9s  %s\n", "Calls", "Total us",
+	       "Self us", "Avg us", "Min us", "Max us", "Function");
+	for (i = 0; i < min(used, count); i++) {
+		const struct trace_func_stats *stats = list[i];
+
+		printf("%10u %12llu %12llu %9llu %9u %9u  %s\n", stats->count,
+		       stats->total_us, stats->self_us,
+		       stats->total_us / stats->count, stats->min_us,
+		       stats->max_us,
+		       trace_func_name(stats->func - 1, buf, sizeof(buf)));
+	}
+	free(list);
+	trace_enabled = was_enabled;
+
+	return 0;
 }
 
 void __attribute__((no_instrument_function)) trace_set_enabled(int enabled)
@@ -345,6 +597,8 @@ int __attribute__((no_instrument_function)) trace_init(void *buff,
 	size_t needed;
 	int was_disabled = !trace_enabled;
 
+	/* Lookups mask the hash with TRACE_STATS_SIZE - 1 */
+	BUILD_BUG_ON(TRACE_STATS_SIZE && !is_power_of_2(TRACE_STATS_SIZE));
 	trace_save_gd();
 
 	if (!was_disabled) {
@@ -372,7 +626,8 @@ int __attribute__((no_instrument_function)) trace_init(void *buff,
 #endif
 	}
 	hdr = (struct trace_hdr *)buff;
-	needed = sizeof(*hdr) + func_count * sizeof(uintptr_t);
+	needed = sizeof(*hdr) + func_count * sizeof(uintptr_t) +
+		TRACE_STATS_SIZE * sizeof(struct trace_func_stats);
 	if (needed > buff_size) {
 		printf("trace: buffer size %zd bytes: at least %zd needed\n",
 		       buff_size, needed);
@@ -383,6 +638,7 @@ int __attribute__((no_instrument_function)) trace_init(void *buff,
 		memset(hdr, '\0', needed);
 	hdr->func_count = func_count;
 	hdr->call_accum = (uintptr_t *)(hdr + 1);
+	hdr->stats = (struct trace_func_stats *)(hdr->call_accum + func_count);
 
 	/* Use any remaining space for the timed function trace */
 	hdr->ftrace = (struct trace_call *)(buff + needed);
@@ -414,7 +670,8 @@ int __attribute__((no_instrument_function)) trace_early_init(void)
 		return 0;
 
 	hdr = map_sysmem(CONFIG_TRACE_EARLY_ADDR, CONFIG_TRACE_EARLY_SIZE);
-	needed = sizeof(*hdr) + func_count * sizeof(uintptr_t);
+	needed = sizeof(*hdr) + func_count * sizeof(uintptr_t) +
+		TRACE_STATS_SIZE * sizeof(struct trace_func_stats);
 	if (needed > buff_size) {
 		printf("trace: buffer size is %zd bytes, at least %zd needed\n",
 		       buff_size, needed);
@@ -424,6 +681,7 @@ int __attribute__((no_instrument_function)) trace_early_init(void)
 	memset(hdr, '\0', needed);
 	hdr->call_accum = (uintptr_t *)(hdr + 1);
 	hdr->func_count = func_count;
+	hdr->stats = (struct trace_func_stats *)(hdr->call_accum + func_count);
 
 	/* Use any remaining space for the timed function trace */
 	hdr->ftrace = (struct trace_call *)((char *)hdr + needed);
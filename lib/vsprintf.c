@@ -18,6 +18,7 @@
 #include <efi_loader.h>
 #include <div64.h>
 #include <hexdump.h>
+#include <kallsyms.h>
 #include <stdarg.h>
 #include <uuid.h>
 #include <vsprintf.h>
@@ -420,6 +421,36 @@ static char *uuid_string(char *buf, char *end, u8 *addr, int field_width,
 }
 #endif
 
+#ifdef CONFIG_KALLSYMS
+/*
+ * Look up a code address in the builtin symbol table.
+ *
+ *   %ps:    function_name
+ *   %pS:    function_name+0x18
+ *
+ * The address is printed in hex if it is not found.
+ */
+static char *symbol_string(char *buf, char *end, void *ptr, int field_width,
+			   int precision, int flags, const char *fmt)
+{
+	ulong addr = (ulong)ptr;
+	const char *sym;
+	char str[80];
+	ulong base;
+
+	sym = symbol_lookup(addr, &base);
+	if (!sym)
+		return number(buf, end, addr, 16, field_width, precision,
+			      flags | SPECIAL | SMALL);
+	if (*fmt == 'S' && addr != base)
+		snprintf(str, sizeof(str), "%s+%#lx", sym, addr - base);
+	else
+		strlcpy(str, sym, sizeof(str));
+
+	return string(buf, end, str, field_width, precision, flags);
+}
+#endif
+
 /*
  * Show a '%p' thing.  A kernel extension is that the '%p' is followed
  * by an extra set of alphanumeric characters that are extended format
@@ -433,6 +464,8 @@ static char *uuid_string(char *buf, char *end, u8 *addr, int field_width,
  *       decimal for v4 and colon separated network-order 16 bit hex for v6)
  * - 'i' [46] for 'raw' IPv4/IPv6 addresses, IPv6 omits the colons, IPv4 is
  *       currently the same
+ * - 's' For a code address, the symbol name if CONFIG_KALLSYMS is enabled
+ * - 'S' As 's', with the offset from the start of the symbol
  *
  * Note: The difference between 'S' and 'F' is that on ia64 and ppc64
  * function pointers are really function descriptors, which contain a
@@ -493,6 +526,12 @@ static char *pointer(const char *fmt, char *buf, char *end, void *ptr,
 	case 'U':
 		return uuid_string(buf, end, ptr, field_width, precision,
 				   flags, fmt);
+#endif
+#ifdef CONFIG_KALLSYMS
+	case 's':
+	case 'S':
+		return symbol_string(buf, end, ptr, field_width, precision,
+				     flags, fmt);
 #endif
 	default:
 		break;
@@ -82,6 +82,7 @@
 
 
 #include <common.h>
+#include <bgtask.h>
 #include <bootstage.h>
 #include <command.h>
 #include <console.h>
@@ -400,6 +401,7 @@ int net_loop(enum proto_t protocol)
 {
 	int ret = -EINVAL;
 	enum net_loop_state prev_net_state = net_state;
+	ulong start_us = bootstage_span_start();
 
 #if defined(CONFIG_CMD_PING)
 	if (protocol != PING)
@@ -560,6 +562,7 @@ restart:
 	 */
 	for (;;) {
 		WATCHDOG_RESET();
+		bgtask_poll();
 		if (arp_timeout_check() > 0)
 			time_start = get_timer(0);
 
@@ -671,6 +674,7 @@ done:
 	net_set_icmp_handler(NULL);
 #endif
 	net_set_state(prev_net_state);
+	bootstage_span(start_us, "net %s", net_boot_file_name);
 
 #if defined(CONFIG_CMD_PCAP)
 	if (pcap_active())
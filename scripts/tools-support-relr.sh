@@ -0,0 +1,13 @@
+#!/bin/sh -eu
+# SPDX-License-Identifier: GPL-2.0
+#
+# Check that the toolchain can pack relative relocations into a .relr.dyn
+# section. Older linkers ignore -z pack-relative-relocs with just a warning, so
+# the section is checked for.
+
+tmp_file=$(mktemp)
+trap "rm -f $tmp_file.o $tmp_file" EXIT
+
+echo 'void *p = &p;' | $CC -fpie -c -x c - -o $tmp_file.o >/dev/null 2>&1
+$LD $tmp_file.o -pie -z pack-relative-relocs -e 0 -o $tmp_file >/dev/null 2>&1
+$OBJDUMP -h $tmp_file | grep -q '\.relr\.dyn'
@@ -352,6 +352,50 @@ static int bloblist_test_align(struct unit_test_state *uts)
 }
 BLOBLIST_TEST(bloblist_test_align, 0);
 
+/* Test handing data with a magic number on to the next phase */
+static int bloblist_test_load_save(struct unit_test_state *uts)
+{
+	struct {
+		u32 magic;
+		char name[12];
+	} data, copy;
+	const u32 magic = 0xee3355aa;
+
+	/* Nothing can be saved until the bloblist is set up */
+	clear_bloblist();
+	gd->bloblist = NULL;
+	data.magic = magic;
+	strcpy(data.name, "board");
+	ut_asserteq(-ENOENT, bloblist_save(TEST_TAG, &data, sizeof(data)));
+	ut_asserteq(-ENOENT, bloblist_load(TEST_TAG, &copy, sizeof(copy),
+					   magic));
+
+	/* The first phase saves what it found */
+	ut_assertok(bloblist_new(TEST_ADDR, TEST_BLOBLIST_SIZE, 0));
+	ut_assertok(bloblist_save(TEST_TAG, &data, sizeof(data)));
+	ut_asserteq(-ESPIPE, bloblist_save(TEST_TAG, &data,
+					   sizeof(data) - 4));
+	ut_assertok(bloblist_finish());
+
+	/* The next phase finds the same contents */
+	gd->bloblist = NULL;
+	ut_assertok(bloblist_check(TEST_ADDR, TEST_BLOBLIST_SIZE));
+	memset(&copy, '\0', sizeof(copy));
+	ut_assertok(bloblist_load(TEST_TAG, &copy, sizeof(copy), magic));
+	ut_assertok(memcmp(&data, &copy, sizeof(data)));
+
+	/* Contents with a different size or layout are not accepted */
+	memset(&copy, '\0', sizeof(copy));
+	ut_asserteq(-ENOENT, bloblist_load(TEST_TAG, &copy,
+					   sizeof(copy) - 4, magic));
+	ut_asserteq(-ENOENT, bloblist_load(TEST_TAG, &copy, sizeof(copy),
+					   magic + 1));
+	ut_asserteq(0, copy.magic);
+
+	return 0;
+}
+BLOBLIST_TEST(bloblist_test_load_save, 0);
+
 int do_ut_bloblist(struct cmd_tbl *cmdtp, int flag, int argc,
 		   char *const argv[])
 {
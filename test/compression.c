@@ -12,7 +12,10 @@
 #include <lz4.h>
 #include <malloc.h>
 #include <mapmem.h>
+#include <worker.h>
 #include <asm/io.h>
+#include <asm/unaligned.h>
+#include <linux/sizes.h>
 
 #include <u-boot/zlib.h>
 #include <bzlib.h>
@@ -440,6 +443,131 @@ static int compression_test_lz4(struct unit_test_state *uts)
 }
 COMPRESSION_TEST(compression_test_lz4, 0);
 
+/* Block size selected by the frame descriptor in lz4_make_frame() */
+#define LZ4_BLOCK_MAX		SZ_64K
+#define LZ4_FULL_BLOCKS		8
+#define LZ4_LAST_BLOCK_SIZE	1000
+
+/* Append the extra length bytes for a literal or match length */
+static u8 *lz4_put_len(u8 *p, uint len)
+{
+	for (; len >= 255; len -= 255)
+		*p++ = 255;
+	*p++ = len;
+
+	return p;
+}
+
+/*
+ * There is no LZ4 compressor in U-Boot, so build a frame of independent
+ * blocks by hand. Even-numbered blocks are compressed, as one literal followed
+ * by a match which repeats it and then five more literals. The others are
+ * stored uncompressed. All blocks are full-sized except the last one.
+ *
+ * @frame: Returns the frame
+ * @plain: Returns the data in the frame
+ * @plain_sizep: Returns the number of bytes in @plain
+ * @return size of the frame in bytes
+ */
+static size_t lz4_make_frame(u8 *frame, u8 *plain, size_t *plain_sizep)
+{
+	u8 *p = frame;
+	uint blk, size, i;
+	u8 *start;
+
+	put_unaligned_le32(LZ4F_MAGIC, p);
+	p += 4;
+	*p++ = 0x60;		/* version 1, independent blocks */
+	*p++ = 0x40;		/* 64KiB blocks */
+	*p++ = 0;		/* header checksum, not checked */
+
+	for (blk = 0; blk <= LZ4_FULL_BLOCKS; blk++) {
+		size = blk < LZ4_FULL_BLOCKS ? LZ4_BLOCK_MAX :
+			LZ4_LAST_BLOCK_SIZE;
+		start = p;
+		p += 4;
+		if (blk % 2 || blk == LZ4_FULL_BLOCKS) {
+			for (i = 0; i < size; i++)
+				plain[i] = i * 7 + blk;
+			memcpy(p, plain, size);
+			p += size;
+			put_unaligned_le32(size | 0x80000000, start);
+		} else {
+			memset(plain, 'a' + blk, size);
+			*p++ = 0x1f;	/* one literal, long match */
+			*p++ = 'a' + blk;
+			put_unaligned_le16(1, p);	/* match offset */
+			p += 2;
+			p = lz4_put_len(p, size - 1 - 5 - 4 - 15);
+			*p++ = 0x50;	/* five literals, no match */
+			memset(p, 'a' + blk, 5);
+			p += 5;
+			put_unaligned_le32(p - start - 4, start);
+		}
+		plain += size;
+	}
+	put_unaligned_le32(0, p);	/* end mark */
+	p += 4;
+	*plain_sizep = LZ4_FULL_BLOCKS * LZ4_BLOCK_MAX + LZ4_LAST_BLOCK_SIZE;
+
+	return p - frame;
+}
+
+/* Check decompressing a frame with enough blocks to share between cores */
+static int compression_test_lz4_blocks(struct unit_test_state *uts)
+{
+	const size_t max = (LZ4_FULL_BLOCKS + 1) * (LZ4_BLOCK_MAX + 4) + 16;
+	size_t frame_size, plain_size, out_size;
+	u8 *frame, *plain, *out;
+	u8 *offset;
+
+	frame = malloc(max);
+	plain = malloc(max);
+	out = malloc(max);
+	ut_assertnonnull(frame);
+	ut_assertnonnull(plain);
+	ut_assertnonnull(out);
+	frame_size = lz4_make_frame(frame, plain, &plain_size);
+
+	/* Make sure that the blocks are decompressed in parallel */
+	if (CONFIG_IS_ENABLED(WORKER))
+		ut_assert(worker_init() > 0);
+
+	memset(out, '\0', max);
+	out_size = max;
+	ut_assertok(ulz4fn(frame, frame_size, out, &out_size));
+	ut_asserteq(plain_size, out_size);
+	ut_asserteq_mem(plain, out, plain_size);
+
+	/* The output buffer can be exactly the right size */
+	memset(out, '\0', max);
+	out_size = plain_size;
+	ut_assertok(ulz4fn(frame, frame_size, out, &out_size));
+	ut_asserteq(plain_size, out_size);
+	ut_asserteq_mem(plain, out, plain_size);
+
+	/* But no smaller */
+	out_size = plain_size - 1;
+	ut_asserteq(-ENOBUFS, ulz4fn(frame, frame_size, out, &out_size));
+
+	/* A bad match offset in a block in the middle must be reported */
+	offset = frame + 7;
+	offset += 4 + (get_unaligned_le32(offset) & ~0x80000000);
+	offset += 4 + (get_unaligned_le32(offset) & ~0x80000000);
+	offset += 4 + 2;
+	ut_asserteq(1, get_unaligned_le16(offset));
+	put_unaligned_le16(2, offset);
+	out_size = max;
+	ut_asserteq(-EPROTO, ulz4fn(frame, frame_size, out, &out_size));
+
+	free(out);
+	free(plain);
+	free(frame);
+
+	return 0;
+}
+COMPRESSION_TEST(compression_test_lz4_blocks, 0);
+
 static int compress_using_none(struct unit_test_state *uts,
 			       void *in, unsigned long in_size,
 			       void *out, unsigned long out_max,
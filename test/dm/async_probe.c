@@ -0,0 +1,179 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for background tasks and probing devices in the background
+ */
+
+#include <common.h>
+#include <bgtask.h>
+#include <dm.h>
+#include <dm/device-internal.h>
+#include <dm/lists.h>
+#include <dm/root.h>
+#include <dm/test.h>
+#include <linux/delay.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+/* Number of steps that the test device takes to become ready */
+#define ASYNC_STEPS	5
+
+/* Error to return when the test device's probe finishes */
+static int async_test_err;
+
+struct async_test_priv {
+	int steps;
+};
+
+static int async_test_finish(struct udevice *dev)
+{
+	struct async_test_priv *priv = dev_get_priv(dev);
+
+	if (++priv->steps < ASYNC_STEPS)
+		return -EAGAIN;
+
+	return async_test_err;
+}
+
+static int async_test_probe(struct udevice *dev)
+{
+	return device_probe_defer(dev, async_test_finish);
+}
+
+U_BOOT_DRIVER(async_test_drv) = {
+	.name	= "async_test_drv",
+	.id	= UCLASS_NOP,
+	.probe	= async_test_probe,
+	.priv_auto_alloc_size	= sizeof(struct async_test_priv),
+};
+
+static int count_step(void *ctx)
+{
+	int *count = ctx;
+
+	return ++*count < 3 ? -EAGAIN : 0;
+}
+
+/* Test running background tasks */
+static int dm_test_bgtask(struct unit_test_state *uts)
+{
+	struct bgtask task1, task2;
+	int count1 = 0, count2 = 0;
+
+	ut_assert(!bgtask_pending());
+	ut_assertok(bgtask_start(&task1, "task1", count_step, &count1));
+	ut_assertok(bgtask_start(&task2, "task2", count_step, &count2));
+	ut_assert(bgtask_pending());
+	ut_asserteq(0, count1);
+
+	/* Each poll runs one step of each task */
+	bgtask_poll();
+	ut_asserteq(1, count1);
+	ut_asserteq(1, count2);
+	ut_asserteq(-EAGAIN, task1.ret);
+
+	/* Waiting for one task runs the other too */
+	ut_assertok(bgtask_wait(&task1, 1000));
+	ut_asserteq(3, count1);
+	ut_asserteq(3, count2);
+	ut_asserteq(0, task2.ret);
+	ut_assert(!bgtask_pending());
+
+	/* A cancelled task is not run again */
+	count1 = 0;
+	ut_assertok(bgtask_start(&task1, "task1", count_step, &count1));
+	bgtask_poll();
+	bgtask_cancel(&task1);
+	ut_asserteq(-ECANCELED, bgtask_wait(&task1, 1000));
+	bgtask_poll();
+	ut_asserteq(1, count1);
+	ut_assert(!bgtask_pending());
+
+	/* Longer delays poll the tasks */
+	count1 = 0;
+	ut_assertok(bgtask_start(&task1, "task1", count_step, &count1));
+	udelay(BGTASK_UDELAY_US * 5);
+	ut_asserteq(3, count1);
+	ut_assertok(task1.ret);
+
+	return 0;
+}
+DM_TEST(dm_test_bgtask, 0);
+
+/* Test a device whose probe finishes in the background */
+static int dm_test_async_probe(struct unit_test_state *uts)
+{
+	struct async_test_priv *priv;
+	struct udevice *dev;
+
+	async_test_err = 0;
+	ut_assertok(device_bind_driver(dm_root(), "async_test_drv", "async",
+				       &dev));
+	ut_assertok(device_probe_nowait(dev));
+	ut_assert(!device_active(dev));
+	ut_assert(dev->flags & DM_FLAG_PROBE_PENDING);
+	priv = dev_get_priv(dev);
+	ut_asserteq(0, priv->steps);
+
+	bgtask_poll();
+	ut_asserteq(1, priv->steps);
+	ut_assert(dev->flags & DM_FLAG_PROBE_PENDING);
+
+	/* Probing it again waits for it to be ready */
+	ut_assertok(device_probe(dev));
+	ut_assert(device_active(dev));
+	ut_asserteq(ASYNC_STEPS, priv->steps);
+	ut_assert(!(dev->flags & DM_FLAG_PROBE_PENDING));
+	ut_assert(!bgtask_pending());
+
+	ut_assertok(device_remove(dev, DM_REMOVE_NORMAL));
+
+	/* A normal probe does not return until the device is ready */
+	ut_assertok(device_probe(dev));
+	ut_assert(device_active(dev));
+	priv = dev_get_priv(dev);
+	ut_asserteq(ASYNC_STEPS, priv->steps);
+	ut_assert(!(dev->flags & DM_FLAG_PROBE_PENDING));
+	ut_assert(!bgtask_pending());
+
+	ut_assertok(device_remove(dev, DM_REMOVE_NORMAL));
+	ut_assertok(device_unbind(dev));
+
+	return 0;
+}
+DM_TEST(dm_test_async_probe, 0);
+
+/* Test a device whose probe fails or is stopped before it finishes */
+static int dm_test_async_probe_fail(struct unit_test_state *uts)
+{
+	struct udevice *dev;
+
+	async_test_err = -EIO;
+	ut_assertok(device_bind_driver(dm_root(), "async_test_drv", "async",
+				       &dev));
+	ut_assertok(device_probe_nowait(dev));
+	ut_assert(dev->flags & DM_FLAG_PROBE_PENDING);
+
+	/* The failure is reported when waiting and the device is removed */
+	ut_asserteq(-EIO, device_probe(dev));
+	ut_assert(!device_active(dev));
+	ut_assert(!(dev->flags & DM_FLAG_PROBE_PENDING));
+
+	/* Removing the device stops the probe */
+	async_test_err = 0;
+	ut_assertok(device_probe_nowait(dev));
+	ut_assert(dev->flags & DM_FLAG_PROBE_PENDING);
+	ut_assertok(device_remove(dev, DM_REMOVE_NORMAL));
+	ut_assert(!device_active(dev));
+	ut_assert(!(dev->flags & DM_FLAG_PROBE_PENDING));
+	ut_assert(!bgtask_pending());
+
+	/* A normal probe reports the failure straight away */
+	async_test_err = -EIO;
+	ut_asserteq(-EIO, device_probe(dev));
+	ut_assert(!device_active(dev));
+	ut_assert(!bgtask_pending());
+	ut_assertok(device_unbind(dev));
+
+	return 0;
+}
+DM_TEST(dm_test_async_probe_fail, 0);
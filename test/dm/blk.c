@@ -5,10 +5,13 @@
 
 #include <common.h>
 #include <dm.h>
+#include <os.h>
 #include <part.h>
+#include <sandboxblockdev.h>
 #include <usb.h>
 #include <asm/state.h>
 #include <dm/test.h>
+#include <linux/sizes.h>
 #include <test/test.h>
 #include <test/ut.h>
 
@@ -164,3 +167,85 @@ static int dm_test_blk_get_from_parent(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_blk_get_from_parent, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+#if CONFIG_IS_ENABLED(PARTITION_CACHE)
+/* Test that a GPT is cached and that writing to it drops the cache */
+static int dm_test_blk_part_cache(struct unit_test_state *uts)
+{
+	static const char fname[] = "part_cache.img";
+	struct disk_partition parts[2], info;
+	struct host_block_dev *host_dev;
+	struct part_cache *cache;
+	struct blk_desc *desc;
+	struct udevice *dev;
+	char guid[] = "375a56f7-d6c9-4e81-b5f0-09d41ca89efe";
+	char buf[512];
+	int fd;
+
+	/* Create an empty 2MB disk */
+	fd = os_open(fname, OS_O_RDWR | OS_O_CREAT | OS_O_TRUNC);
+	ut_assert(fd >= 0);
+	ut_asserteq(SZ_2M - 1, os_lseek(fd, SZ_2M - 1, OS_SEEK_SET));
+	ut_asserteq(1, os_write(fd, "", 1));
+	os_close(fd);
+
+	ut_assertok(host_dev_bind(0, (char *)fname));
+	ut_assertok(blk_get_device(IF_TYPE_HOST, 0, &dev));
+	desc = dev_get_uclass_platdata(dev);
+	host_dev = dev_get_platdata(dev);
+
+	memset(parts, '\0', sizeof(parts));
+	parts[0].start = 64;
+	parts[0].size = 1024;
+	strcpy((char *)parts[0].name, "first");
+	parts[1].start = 1088;
+	parts[1].size = 1024;
+	strcpy((char *)parts[1].name, "second");
+#if CONFIG_IS_ENABLED(PARTITION_UUIDS)
+	strcpy(parts[0].uuid, "b7d5a8c4-7a57-4a6b-9d8a-4f4d7c1f6a01");
+	strcpy(parts[1].uuid, "b7d5a8c4-7a57-4a6b-9d8a-4f4d7c1f6a02");
+#endif
+	ut_assertok(gpt_restore(desc, guid, parts, ARRAY_SIZE(parts)));
+	part_init(desc);
+	ut_asserteq(PART_TYPE_EFI, desc->part_type);
+	ut_assertnull(desc->part_cache);
+
+	/* The first lookup reads the table, which is then kept */
+	ut_assertok(part_get_info(desc, 2, &info));
+	ut_asserteq(1088, info.start);
+	ut_asserteq_str("second", (char *)info.name);
+	cache = desc->part_cache;
+	ut_assertnonnull(cache);
+
+	/* Corrupt the primary header behind the block layer's back */
+	memset(buf, '\0', sizeof(buf));
+	ut_asserteq(512, os_lseek(host_dev->fd, 512, OS_SEEK_SET));
+	ut_asserteq(512, os_write(host_dev->fd, buf, sizeof(buf)));
+	ut_assertok(part_get_info(desc, 1, &info));
+	ut_asserteq(64, info.start);
+	ut_asserteq_str("first", (char *)info.name);
+	ut_asserteq_ptr(cache, desc->part_cache);
+
+	/* Writing inside a partition keeps the cache */
+	ut_asserteq(1, blk_dwrite(desc, 100, 1, buf));
+	ut_asserteq_ptr(cache, desc->part_cache);
+
+	/* Writing the table area drops it, so the backup GPT is used */
+	ut_asserteq(1, blk_dread(desc, 0, 1, buf));
+	ut_asserteq(1, blk_dwrite(desc, 0, 1, buf));
+	ut_assertnull(desc->part_cache);
+	ut_assertok(part_get_info(desc, 2, &info));
+	ut_asserteq(1088, info.start);
+	ut_assertnonnull(desc->part_cache);
+
+	/* Scanning the device again drops it too */
+	part_init(desc);
+	ut_assertnull(desc->part_cache);
+
+	ut_assertok(host_dev_bind(0, NULL));
+	ut_assertok(os_unlink(fname));
+
+	return 0;
+}
+DM_TEST(dm_test_blk_part_cache, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+#endif
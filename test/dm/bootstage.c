@@ -0,0 +1,72 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for bootstage spans around driver model operations
+ */
+
+#include <common.h>
+#include <bootstage.h>
+#include <dm.h>
+#include <malloc.h>
+#include <asm/global_data.h>
+#include <dm/device-internal.h>
+#include <dm/lists.h>
+#include <dm/root.h>
+#include <dm/test.h>
+#include <linux/delay.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/* Space for the exported records, which only cover this test */
+#define SPAN_EXPORT_SIZE	0x1000
+
+static int span_test_probe(struct udevice *dev)
+{
+	/* Take long enough for the probe to be recorded */
+	udelay(CONFIG_BOOTSTAGE_SPAN_MIN_US + 100);
+
+	return 0;
+}
+
+U_BOOT_DRIVER(span_test_drv) = {
+	.name	= "span_test_drv",
+	.id	= UCLASS_NOP,
+	.probe	= span_test_probe,
+};
+
+/* Test that probing a device records a span */
+static int dm_test_bootstage_probe_span(struct unit_test_state *uts)
+{
+	struct bootstage_data *old_bootstage = gd->bootstage;
+	struct bootstage_data *old_new_bootstage = gd->new_bootstage;
+	struct udevice *dev;
+	char *buf, *name;
+	int ret, size;
+
+	buf = malloc(SPAN_EXPORT_SIZE);
+	ut_assertnonnull(buf);
+	ut_assertok(device_bind_driver(dm_root(), "span_test_drv", "span-test",
+				       &dev));
+
+	/*
+	 * Record into an empty table, since the real one may be full by now.
+	 * Point new_bootstage at it too, so it is treated as relocated.
+	 */
+	ut_assertok(bootstage_init(true));
+	gd->new_bootstage = gd->bootstage;
+	ret = device_probe(dev);
+	size = bootstage_export_json(buf, SPAN_EXPORT_SIZE);
+	free(gd->bootstage);
+	gd->bootstage = old_bootstage;
+	gd->new_bootstage = old_new_bootstage;
+
+	ut_assertok(ret);
+	ut_assert(size <= SPAN_EXPORT_SIZE);
+	name = strstr(buf, "{\"name\":\"probe span-test\",\"ph\":\"X\"");
+	ut_assertnonnull(name);
+	free(buf);
+
+	return 0;
+}
+DM_TEST(dm_test_bootstage_probe_span, UT_TESTF_SCAN_PDATA);
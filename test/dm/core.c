@@ -11,7 +11,9 @@
 #include <fdtdec.h>
 #include <log.h>
 #include <malloc.h>
+#include <time.h>
 #include <dm/device-internal.h>
+#include <dm/lists.h>
 #include <dm/root.h>
 #include <dm/util.h>
 #include <dm/test.h>
@@ -1080,3 +1082,180 @@ static int dm_test_inactive_child(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_inactive_child, UT_TESTF_SCAN_PDATA);
+
+/* Number of devices bound by the uclass index tests */
+#define INDEX_DEV_COUNT	256
+
+/* Number of lookups made by the uclass index benchmark */
+#define INDEX_LOOKUP_COUNT	10000
+
+/* Test finding devices by name and sequence number in a large uclass */
+static int dm_test_uclass_index(struct unit_test_state *uts)
+{
+	struct dm_test_state *dms = uts->priv;
+	struct udevice **devs, *dev;
+	ulong start, name_us, seq_us;
+	char name[20];
+	int i;
+
+	/* Skip the behaviour in test_post_probe() */
+	dms->skip_post_probe = 1;
+
+	devs = calloc(INDEX_DEV_COUNT, sizeof(*devs));
+	ut_assertnonnull(devs);
+	for (i = 0; i < INDEX_DEV_COUNT; i++) {
+		ut_assertok(device_bind_ofnode(dms->root,
+					       DM_GET_DRIVER(test_drv), "idx",
+					       NULL, ofnode_null(), &devs[i]));
+		snprintf(name, sizeof(name), "idx%d", i);
+		ut_assertok(device_set_name(devs[i], name));
+	}
+
+	/* Probe every other device, to give it a sequence number */
+	for (i = 0; i < INDEX_DEV_COUNT; i += 2)
+		ut_assertok(device_probe(devs[i]));
+
+	for (i = 0; i < INDEX_DEV_COUNT; i++) {
+		snprintf(name, sizeof(name), "idx%d", i);
+		ut_assertok(uclass_find_device_by_name(UCLASS_TEST, name,
+						       &dev));
+		ut_asserteq_ptr(devs[i], dev);
+		if (i & 1) {
+			ut_asserteq(-1, devs[i]->seq);
+			continue;
+		}
+		ut_assertok(uclass_find_device_by_seq(UCLASS_TEST,
+						      devs[i]->seq, false,
+						      &dev));
+		ut_asserteq_ptr(devs[i], dev);
+	}
+	ut_asserteq(-ENODEV, uclass_find_device_by_name(UCLASS_TEST, "idx",
+							&dev));
+	ut_asserteq(-ENODEV, uclass_find_device_by_seq(UCLASS_TEST,
+						       INDEX_DEV_COUNT, false,
+						       &dev));
+
+	/* Removed devices lose their sequence number */
+	ut_assertok(device_remove(devs[0], DM_REMOVE_NORMAL));
+	ut_asserteq(-ENODEV, uclass_find_device_by_seq(UCLASS_TEST, 0, false,
+						       &dev));
+
+	/* Unbound devices can no longer be found */
+	for (i = 0; i < INDEX_DEV_COUNT; i += 4) {
+		ut_assertok(device_remove(devs[i], DM_REMOVE_NORMAL));
+		ut_assertok(device_unbind(devs[i]));
+		snprintf(name, sizeof(name), "idx%d", i);
+		ut_asserteq(-ENODEV, uclass_find_device_by_name(UCLASS_TEST,
+								name, &dev));
+	}
+	for (i = 1; i < INDEX_DEV_COUNT; i += 4) {
+		snprintf(name, sizeof(name), "idx%d", i);
+		ut_assertok(uclass_find_device_by_name(UCLASS_TEST, name,
+						       &dev));
+		ut_asserteq_ptr(devs[i], dev);
+	}
+
+	/* Time some lookups of the remaining devices */
+	start = timer_get_us();
+	for (i = 0; i < INDEX_LOOKUP_COUNT; i++) {
+		snprintf(name, sizeof(name), "idx%d",
+			 (i * 7 % (INDEX_DEV_COUNT / 4)) * 4 + 1);
+		ut_assertok(uclass_find_device_by_name(UCLASS_TEST, name,
+						       &dev));
+	}
+	name_us = timer_get_us() - start;
+
+	start = timer_get_us();
+	for (i = 0; i < INDEX_LOOKUP_COUNT; i++) {
+		dev = devs[(i * 7 % (INDEX_DEV_COUNT / 4)) * 4 + 2];
+		ut_assertok(uclass_find_device_by_seq(UCLASS_TEST, dev->seq,
+						      false, &dev));
+	}
+	seq_us = timer_get_us() - start;
+	printf("%d lookups in %d devices: %lu us by name, %lu us by seq\n",
+	       INDEX_LOOKUP_COUNT, INDEX_DEV_COUNT * 3 / 4, name_us, seq_us);
+	free(devs);
+
+	return 0;
+}
+DM_TEST(dm_test_uclass_index, UT_TESTF_SCAN_PDATA);
+
+/* Test finding devices by device tree node */
+static int dm_test_uclass_index_ofnode(struct unit_test_state *uts)
+{
+	struct udevice *dev, *first, *found;
+	struct uclass *uc;
+	int id;
+
+	for (id = 0; id < UCLASS_COUNT; id++) {
+		uc = uclass_find(id);
+		if (!uc)
+			continue;
+		uclass_foreach_dev(dev, uc) {
+			if (!dev_has_of_node(dev))
+				continue;
+
+			/* Several devices may share a node; expect the first */
+			uclass_foreach_dev(first, uc) {
+				if (ofnode_equal(dev_ofnode(first),
+						 dev_ofnode(dev)))
+					break;
+			}
+			ut_assertok(uclass_find_device_by_ofnode(id,
+							dev_ofnode(dev),
+							&found));
+			ut_asserteq_ptr(first, found);
+		}
+	}
+
+	return 0;
+}
+DM_TEST(dm_test_uclass_index_ofnode, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+/* Test that each compatible string finds the first driver which has it */
+static int dm_test_lists_compatible(struct unit_test_state *uts)
+{
+	struct driver *drivers = ll_entry_start(struct driver, driver);
+	const int n_ents = ll_entry_count(struct driver, driver);
+	const struct udevice_id *id, *found_id, *expect_id;
+	struct driver *drv, *found, *expect;
+	ulong start, count = 0;
+
+	start = timer_get_us();
+	for (drv = drivers; drv != drivers + n_ents; drv++) {
+		for (id = drv->of_match; id && id->compatible; id++) {
+			/* Work out the answer the slow way */
+			expect = NULL;
+			expect_id = NULL;
+			for (found = drivers; found != drv + 1 && !expect;
+			     found++) {
+				for (found_id = found->of_match;
+				     found_id && found_id->compatible;
+				     found_id++) {
+					if (!strcmp(found_id->compatible,
+						    id->compatible)) {
+						expect = found;
+						expect_id = found_id;
+						break;
+					}
+				}
+			}
+
+			found = lists_driver_lookup_compatible(id->compatible,
+							       &found_id);
+			ut_asserteq_ptr(expect, found);
+			ut_asserteq_ptr(expect_id, found_id);
+			count++;
+		}
+	}
+	printf("%lu compatible strings checked in %lu us\n", count,
+	       timer_get_us() - start);
+	ut_assert(count > 0);
+
+	ut_assertnull(lists_driver_lookup_compatible("denx,no-such-driver",
+						     &found_id));
+	ut_assertnull(lists_driver_lookup_compatible("", &found_id));
+
+	return 0;
+}
+DM_TEST(dm_test_lists_compatible, 0);
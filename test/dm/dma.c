@@ -9,6 +9,7 @@
 #include <common.h>
 #include <dm.h>
 #include <malloc.h>
+#include <memalign.h>
 #include <dm/test.h>
 #include <dma.h>
 #include <test/test.h>
@@ -37,6 +38,75 @@ static int dm_test_dma_m2m(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_dma_m2m, UT_TESTF_SCAN_FDT);
 
+static int dm_test_dma_m2m_async(struct unit_test_state *uts)
+{
+	struct dma_copy copy[3];
+	u8 src_buf[3][512];
+	u8 dst_buf[3][512];
+	u8 zero_buf[512];
+	size_t len = 512;
+	int i, j;
+
+	memset(zero_buf, 0, len);
+	memset(dst_buf, 0, sizeof(dst_buf));
+	for (i = 0; i < 3; i++) {
+		for (j = 0; j < len; j++)
+			src_buf[i][j] = i + j;
+	}
+
+	/* Submit a batch; nothing is copied until the copies are polled */
+	for (i = 0; i < 3; i++)
+		ut_assertok(dma_memcpy_submit(&copy[i], dst_buf[i],
+					      src_buf[i], len));
+	ut_asserteq_mem(zero_buf, dst_buf[0], len);
+
+	/* Copies complete in order */
+	ut_asserteq(-EBUSY, dma_memcpy_poll(&copy[1]));
+	ut_asserteq_mem(src_buf[0], dst_buf[0], len);
+	ut_asserteq_mem(zero_buf, dst_buf[1], len);
+	ut_assertok(dma_memcpy_poll(&copy[0]));
+
+	ut_assertok(dma_memcpy_wait(&copy[2]));
+	for (i = 0; i < 3; i++) {
+		ut_assertok(dma_memcpy_poll(&copy[i]));
+		ut_asserteq_mem(src_buf[i], dst_buf[i], len);
+	}
+
+	return 0;
+}
+DM_TEST(dm_test_dma_m2m_async, UT_TESTF_SCAN_FDT);
+
+/* Test that dma_memcpy_try() leaves unsuitable copies to the CPU */
+static int dm_test_dma_m2m_try(struct unit_test_state *uts)
+{
+	size_t len = 512;
+	ALLOC_CACHE_ALIGN_BUFFER(u8, src_buf, len);
+	ALLOC_CACHE_ALIGN_BUFFER(u8, dst_buf, len);
+	ALLOC_CACHE_ALIGN_BUFFER(u8, zero_buf, len);
+	int i;
+
+	memset(zero_buf, 0, len);
+	memset(dst_buf, 0, len);
+	for (i = 0; i < len; i++)
+		src_buf[i] = i;
+
+	/* Small, overlapping and unaligned copies are rejected */
+	ut_asserteq(-ENOSYS, dma_memcpy_try(dst_buf, src_buf,
+					    CONFIG_DMA_MEMCPY_THRESHOLD - 1));
+	ut_asserteq(-EINVAL, dma_memcpy_try(src_buf + ARCH_DMA_MINALIGN,
+					    src_buf, len - ARCH_DMA_MINALIGN));
+	ut_asserteq(-EINVAL, dma_memcpy_try(dst_buf + 1, src_buf, len / 2));
+	ut_asserteq(-EINVAL, dma_memcpy_try(dst_buf, src_buf + 1, len / 2));
+	ut_asserteq(-EINVAL, dma_memcpy_try(dst_buf, src_buf, len - 1));
+	ut_asserteq_mem(zero_buf, dst_buf, len);
+
+	ut_assertok(dma_memcpy_try(dst_buf, src_buf, len));
+	ut_asserteq_mem(src_buf, dst_buf, len);
+
+	return 0;
+}
+DM_TEST(dm_test_dma_m2m_try, UT_TESTF_SCAN_FDT);
+
 static int dm_test_dma(struct unit_test_state *uts)
 {
 	struct udevice *dev;
@@ -2,12 +2,18 @@
 
 #include <common.h>
 #include <dm.h>
+#include <fdtdec.h>
 #include <log.h>
+#include <malloc.h>
+#include <time.h>
+#include <dm/of_access.h>
 #include <dm/of_extra.h>
 #include <dm/test.h>
 #include <test/test.h>
 #include <test/ut.h>
 
+DECLARE_GLOBAL_DATA_PTR;
+
 static int dm_test_ofnode_compatible(struct unit_test_state *uts)
 {
 	ofnode root_node = ofnode_path("/");
@@ -35,6 +41,139 @@ static int dm_test_ofnode_get_by_phandle(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_ofnode_get_by_phandle, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
 
+/* Look up a phandle by walking the whole tree, without using the index */
+static ofnode find_phandle_slow(uint phandle)
+{
+	struct device_node *np;
+
+	if (!of_live_active())
+		return offset_to_ofnode(fdt_node_offset_by_phandle(gd->fdt_blob,
+								   phandle));
+	for_each_of_allnodes(np) {
+		if (np->phandle == phandle)
+			break;
+	}
+
+	return np_to_ofnode(np);
+}
+
+static int dm_test_ofnode_phandle_index(struct unit_test_state *uts)
+{
+	uint max_phandle, phandle;
+	ulong start, indexed, scanned;
+	int i, count = 0;
+	ofnode node;
+
+	max_phandle = fdt_get_max_phandle(gd->fdt_blob);
+	ut_assert(max_phandle > 0);
+
+	/* Every phandle must resolve to the same node as a full walk */
+	for (phandle = 1; phandle <= max_phandle; phandle++) {
+		node = ofnode_get_by_phandle(phandle);
+		ut_assert(ofnode_equal(find_phandle_slow(phandle), node));
+		if (ofnode_valid(node))
+			count++;
+	}
+	ut_assert(count > 0);
+	ut_assert(!ofnode_valid(ofnode_get_by_phandle(max_phandle + 1)));
+
+	/* Time lookups with and without the index */
+	start = timer_get_us();
+	for (i = 0; i < 100; i++) {
+		for (phandle = 1; phandle <= max_phandle; phandle++)
+			ofnode_get_by_phandle(phandle);
+	}
+	indexed = timer_get_us() - start;
+
+	start = timer_get_us();
+	for (i = 0; i < 100; i++) {
+		for (phandle = 1; phandle <= max_phandle; phandle++)
+			find_phandle_slow(phandle);
+	}
+	scanned = timer_get_us() - start;
+	printf("%s tree: %d phandles, 100 rounds: %lu us indexed, %lu us scanned\n",
+	       of_live_active() ? "live" : "flat", count, indexed, scanned);
+
+	return 0;
+}
+DM_TEST(dm_test_ofnode_phandle_index, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+/* Check that the live-tree index copes with a phandle being set later */
+static int phandle_index_stale_live(struct unit_test_state *uts)
+{
+	struct device_node *np;
+	uint max_phandle;
+	ofnode node;
+
+	max_phandle = fdt_get_max_phandle(gd->fdt_blob);
+	node = ofnode_path("/aliases");
+	ut_assert(ofnode_valid(node));
+	np = (struct device_node *)ofnode_to_np(node);
+	ut_asserteq(0, np->phandle);
+
+	/* Build the index, then give a node a phandle behind its back */
+	ut_assert(ofnode_valid(ofnode_get_by_phandle(1)));
+	np->phandle = max_phandle + 1;
+	ut_assert(ofnode_equal(node, ofnode_get_by_phandle(max_phandle + 1)));
+
+	np->phandle = 0;
+	ut_assert(!ofnode_valid(ofnode_get_by_phandle(max_phandle + 1)));
+
+	return 0;
+}
+
+/* Check that the phandle index copes with the tree changing */
+static int dm_test_ofnode_phandle_index_stale(struct unit_test_state *uts)
+{
+	const void *old_blob = gd->fdt_blob;
+	int size = fdt_totalsize(old_blob) + 1024;
+	uint max_phandle, phandle;
+	void *blob;
+	int node;
+
+	/* The live tree does not use the flat-tree index */
+	if (of_live_active())
+		return phandle_index_stale_live(uts);
+
+	blob = malloc(size);
+	ut_assertnonnull(blob);
+	ut_assertok(fdt_open_into(old_blob, blob, size));
+	gd->fdt_blob = blob;
+	max_phandle = fdt_get_max_phandle(blob);
+
+	/* Build the index */
+	ut_assert(fdtdec_node_offset_by_phandle(blob, 1) >= 0);
+
+	/*
+	 * Add a node at the start of the tree, which moves all the others,
+	 * and give it a new phandle
+	 */
+	node = fdt_add_subnode(blob, 0, "aaa-phandle-test");
+	ut_assert(node >= 0);
+	ut_assertok(fdt_setprop_u32(blob, node, "phandle", max_phandle + 1));
+
+	for (phandle = 1; phandle <= max_phandle + 1; phandle++)
+		ut_asserteq(fdt_node_offset_by_phandle(blob, phandle),
+			    fdtdec_node_offset_by_phandle(blob, phandle));
+	ut_asserteq(node, fdtdec_node_offset_by_phandle(blob,
+							max_phandle + 1));
+
+	/* Remove it again, invalidating the index explicitly */
+	ut_assertok(fdt_del_node(blob, node));
+	fdtdec_phandle_index_invalidate(blob);
+	for (phandle = 1; phandle <= max_phandle + 1; phandle++)
+		ut_asserteq(fdt_node_offset_by_phandle(blob, phandle),
+			    fdtdec_node_offset_by_phandle(blob, phandle));
+
+	fdtdec_phandle_index_invalidate(blob);
+	gd->fdt_blob = old_blob;
+	free(blob);
+
+	return 0;
+}
+DM_TEST(dm_test_ofnode_phandle_index_stale,
+	UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
 static int dm_test_ofnode_by_prop_value(struct unit_test_state *uts)
 {
 	const char propname[] = "compatible";
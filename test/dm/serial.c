@@ -7,6 +7,7 @@
 #include <log.h>
 #include <serial.h>
 #include <dm.h>
+#include <asm/test.h>
 #include <dm/test.h>
 #include <test/test.h>
 #include <test/ut.h>
@@ -70,3 +71,20 @@ static int dm_test_serial(struct unit_test_state *uts)
 }
 
 DM_TEST(dm_test_serial, UT_TESTF_SCAN_FDT);
+
+/* Test that newlines are translated when writing strings */
+static int dm_test_serial_puts(struct unit_test_state *uts)
+{
+	size_t start;
+
+	start = sandbox_serial_written();
+	serial_puts("one\ntwo");
+	ut_asserteq(8, sandbox_serial_written() - start);
+
+	start = sandbox_serial_written();
+	serial_puts("\n\nthree\n");
+	ut_asserteq(11, sandbox_serial_written() - start);
+
+	return 0;
+}
+DM_TEST(dm_test_serial_puts, UT_TESTF_SCAN_FDT);
@@ -6,6 +6,8 @@
 #include <common.h>
 #include <command.h>
 #include <dm.h>
+#include <env.h>
+#include <env_internal.h>
 #include <fdtdec.h>
 #include <mapmem.h>
 #include <os.h>
@@ -94,3 +96,134 @@ static int dm_test_spi_flash_func(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_spi_flash_func, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+#ifdef CONFIG_ENV_SF_JOURNAL
+/* Read the header of a record in the environment journal */
+static int read_env_rec(struct unit_test_state *uts, uint pos,
+			struct env_sf_journal_rec *rec)
+{
+	struct udevice *dev;
+
+	/* Loading the environment removes the device, so probe it again */
+	ut_assertok(uclass_first_device_err(UCLASS_SPI_FLASH, &dev));
+	ut_assertok(spi_flash_read_dm(dev, CONFIG_ENV_OFFSET + pos,
+				      sizeof(*rec), rec));
+
+	return 0;
+}
+
+static struct env_driver *env_sf_driver(void)
+{
+	struct env_driver *drv = ll_entry_start(struct env_driver, env_driver);
+	const int n_ents = ll_entry_count(struct env_driver, env_driver);
+	struct env_driver *entry;
+
+	for (entry = drv; entry != drv + n_ents; entry++) {
+		if (entry->location == ENVL_SPI_FLASH)
+			return entry;
+	}
+
+	return NULL;
+}
+
+/* Test saving the environment in SPI flash as a journal */
+static int dm_test_spi_flash_env_journal(struct unit_test_state *uts)
+{
+	struct env_sf_journal_rec rec, full;
+	struct env_driver *drv;
+	struct udevice *dev;
+	int full_size = 0x200000;
+	char big[1000];
+	uint pos;
+	u8 *buf;
+	int i;
+
+	drv = env_sf_driver();
+	ut_assertnonnull(drv);
+
+	/* Start with the flash erased */
+	buf = map_sysmem(0x20000, full_size);
+	memset(buf, 0xff, full_size);
+	ut_assertok(os_write_file("spi.bin", buf, full_size));
+
+	/* The first save writes the whole environment */
+	ut_assertok(env_set("journal_a", "1"));
+	ut_assertok(drv->save());
+	ut_assertok(read_env_rec(uts, 0, &full));
+	ut_asserteq(ENV_SF_JOURNAL_FULL, full.magic);
+	pos = ALIGN(sizeof(full) + full.size, 4);
+
+	/* Later saves only add the variables which changed */
+	ut_assertok(env_set("journal_a", "2"));
+	ut_assertok(env_set("journal_b", "x"));
+	ut_assertok(drv->save());
+	ut_assertok(read_env_rec(uts, pos, &rec));
+	ut_asserteq(ENV_SF_JOURNAL_DELTA, rec.magic);
+	ut_asserteq(full.seq, rec.seq);
+	ut_asserteq(sizeof("journal_a=2") + sizeof("journal_b=x"), rec.size);
+	pos = ALIGN(pos + sizeof(rec) + rec.size, 4);
+
+	ut_assertok(env_set("journal_a", NULL));
+	ut_assertok(drv->save());
+	ut_assertok(read_env_rec(uts, pos, &rec));
+	ut_asserteq(sizeof("journal_a"), rec.size);
+	pos = ALIGN(pos + sizeof(rec) + rec.size, 4);
+
+	/* Loading replays the journal */
+	ut_assertok(env_set("journal_a", "3"));
+	ut_assertok(env_set("journal_b", "y"));
+	ut_assertok(drv->load());
+	ut_assertnull(env_get("journal_a"));
+	ut_asserteq_str("x", env_get("journal_b"));
+
+	/* A record which was not completely written is ignored... */
+	ut_assertok(uclass_first_device_err(UCLASS_SPI_FLASH, &dev));
+	ut_assertok(spi_flash_write_dm(dev, CONFIG_ENV_OFFSET + pos, 3, "bad"));
+	ut_assertok(drv->load());
+	ut_asserteq_str("x", env_get("journal_b"));
+
+	/* ...and the next save starts a new journal */
+	ut_assertok(env_set("journal_b", "z"));
+	ut_assertok(drv->save());
+	ut_assertok(read_env_rec(uts, 0, &rec));
+	ut_asserteq(ENV_SF_JOURNAL_FULL, rec.magic);
+	ut_asserteq(full.seq + 1, rec.seq);
+	full = rec;
+	pos = ALIGN(sizeof(full) + full.size, 4);
+	ut_assertok(read_env_rec(uts, pos, &rec));
+	ut_asserteq(ENV_SF_JOURNAL_ERASED, rec.magic);
+
+	/* A new journal is also started when the area is full */
+	memset(big, 'a', sizeof(big) - 1);
+	big[sizeof(big) - 1] = '\0';
+	for (i = 0; i < 100; i++) {
+		big[0] = 'a' + i % 26;
+		ut_assertok(env_set("journal_big", big));
+		ut_assertok(drv->save());
+		ut_assertok(read_env_rec(uts, 0, &rec));
+		if (rec.seq != full.seq)
+			break;
+	}
+	ut_assert(i > 10 && i < 100);
+	ut_asserteq(full.seq + 1, rec.seq);
+	ut_assertok(env_set("journal_big", NULL));
+	ut_assertok(drv->load());
+	ut_asserteq_str(big, env_get("journal_big"));
+	ut_asserteq_str("z", env_get("journal_b"));
+
+	ut_assertok(env_set("journal_b", NULL));
+	ut_assertok(env_set("journal_big", NULL));
+
+	/* Don't leave an environment in spi.bin for later runs to pick up */
+	ut_assertok(uclass_first_device_err(UCLASS_SPI_FLASH, &dev));
+	ut_assertok(spi_flash_erase_dm(dev, CONFIG_ENV_OFFSET,
+				       roundup(CONFIG_ENV_SIZE,
+					       CONFIG_ENV_SECT_SIZE)));
+	ut_assertok(read_env_rec(uts, 0, &rec));
+	ut_asserteq(ENV_SF_JOURNAL_ERASED, rec.magic);
+	sandbox_sf_unbind_emul(state_get_current(), 0, 0);
+
+	return 0;
+}
+DM_TEST(dm_test_spi_flash_env_journal, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+#endif
@@ -1116,3 +1116,94 @@ static int dm_test_ofdata_order(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_ofdata_order, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+#if CONFIG_IS_ENABLED(DM_LAZY_BIND)
+/* Check whether a node has a device, without binding waiting devices */
+static bool lazy_node_is_bound(enum uclass_id id, ofnode node)
+{
+	struct udevice *dev;
+	struct uclass *uc;
+
+	uc = uclass_find(id);
+	if (!uc)
+		return false;
+	list_for_each_entry(dev, &uc->dev_head, uclass_node) {
+		if (ofnode_equal(dev_ofnode(dev), node))
+			return true;
+	}
+
+	return false;
+}
+
+/* Test that devices are bound when their uclass or parent is looked at */
+static int dm_test_lazy_bind(struct unit_test_state *uts)
+{
+	struct udevice *root = dm_root();
+	struct udevice *dev, *found;
+	const struct driver *drv;
+	struct uclass *uc;
+	ofnode node;
+
+	node = ofnode_path("/b-test");
+	ut_assert(ofnode_valid(node));
+	ut_assertok(uclass_find_device_by_ofnode(UCLASS_TEST_FDT, node, &dev));
+	drv = dev->driver;
+
+	/* Looking in the uclass binds the device */
+	ut_assertok(device_unbind(dev));
+	ut_assertok(lists_bind_fdt_lazy(root, node, false));
+	ut_assert(root->flags & DM_FLAG_LAZY_CHILDREN);
+	ut_assert(!lazy_node_is_bound(UCLASS_TEST_FDT, node));
+	ut_assertok(uclass_find_device_by_ofnode(UCLASS_TEST_FDT, node, &dev));
+	ut_asserteq_ptr(root, dev->parent);
+	ut_asserteq_str("b-test", dev->name);
+
+	/* So does looking at the parent's children */
+	ut_assertok(device_unbind(dev));
+	ut_assertok(lists_bind_fdt_lazy(root, node, false));
+	ut_assert(!lazy_node_is_bound(UCLASS_TEST_FDT, node));
+	ut_assertok(device_find_child_by_name(root, "b-test", &dev));
+	ut_assert(!(root->flags & DM_FLAG_LAZY_CHILDREN));
+	ut_assert(ofnode_equal(node, dev_ofnode(dev)));
+
+	/* The iterators see waiting devices too */
+	ut_assertok(device_unbind(dev));
+	ut_assertok(lists_bind_fdt_lazy(root, node, false));
+	found = NULL;
+	device_foreach_child(dev, root) {
+		if (ofnode_equal(node, dev_ofnode(dev)))
+			found = dev;
+	}
+	ut_assertnonnull(found);
+
+	ut_assertok(device_unbind(found));
+	ut_assertok(lists_bind_fdt_lazy(root, node, false));
+	uc = uclass_find(UCLASS_TEST_FDT);
+	ut_assertnonnull(uc);
+	found = NULL;
+	uclass_foreach_dev(dev, uc) {
+		if (ofnode_equal(node, dev_ofnode(dev)))
+			found = dev;
+	}
+	ut_assertnonnull(found);
+	dev = found;
+
+	/* Unbinding the parent's children drops waiting devices too */
+	ut_assertok(device_unbind(dev));
+	ut_assertok(lists_bind_fdt_lazy(root, node, false));
+	ut_assertok(device_chld_unbind(root, (struct driver *)drv));
+	ut_asserteq(-ENODEV, uclass_find_device_by_ofnode(UCLASS_TEST_FDT,
+							  node, &dev));
+
+	/* Nodes with subnodes are bound straight away */
+	node = ofnode_path("/some-bus");
+	ut_assert(ofnode_valid(node));
+	ut_assertok(uclass_find_device_by_ofnode(UCLASS_TEST_BUS, node, &dev));
+	ut_assertok(device_unbind(dev));
+	ut_assertok(lists_bind_fdt_lazy(root, node, false));
+	ut_assert(lazy_node_is_bound(UCLASS_TEST_BUS, node));
+
+	return 0;
+}
+DM_TEST(dm_test_lazy_bind, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+#endif
@@ -11,6 +11,7 @@
 #include <malloc.h>
 #include <mapmem.h>
 #include <os.h>
+#include <time.h>
 #include <video.h>
 #include <video_console.h>
 #include <dm/test.h>
@@ -81,6 +82,8 @@ static int compress_frame_buffer(struct unit_test_state *uts,
 
 	/* Check here that the copy frame buffer is working correctly */
 	if (IS_ENABLED(CONFIG_VIDEO_COPY)) {
+		/* Changes may not be copied until the next sync */
+		video_sync(dev, false);
 		ut_assertf(!memcmp(uc_priv->fb, uc_priv->copy_fb,
 				   uc_priv->fb_size),
 				   "Copy framebuffer does not match fb");
@@ -148,6 +151,57 @@ static int dm_test_video_text(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_video_text, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
 
+#ifdef CONFIG_VIDEO_DAMAGE
+/* Test that only the changed area of the display is synced */
+static int dm_test_video_damage(struct unit_test_state *uts)
+{
+	struct vidconsole_priv *vc_priv;
+	struct udevice *dev, *con;
+	struct video_priv *priv;
+	ulong start;
+	int i;
+
+	ut_assertok(select_vidconsole(uts, "vidconsole0"));
+	ut_assertok(uclass_get_device(UCLASS_VIDEO, 0, &dev));
+	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
+	priv = dev_get_uclass_priv(dev);
+	vc_priv = dev_get_uclass_priv(con);
+
+	video_sync(dev, false);
+	ut_asserteq(0, priv->damage.xend);
+
+	/* A character damages the rows it is on */
+	vidconsole_putc_xy(con, VID_TO_POS(8), 32, 'a');
+	ut_asserteq(0, priv->damage.xstart);
+	ut_asserteq(32, priv->damage.ystart);
+	ut_asserteq(1366, priv->damage.xend);
+	ut_asserteq(32 + vc_priv->y_charsize, priv->damage.yend);
+	ut_assert(compress_frame_buffer(uts, dev) > 46);
+	ut_asserteq(0, priv->damage.xend);
+
+	/* Explicit damage is cropped to the display */
+	video_damage(dev, -10, 700, 20, 100);
+	ut_asserteq(0, priv->damage.xstart);
+	ut_asserteq(700, priv->damage.ystart);
+	ut_asserteq(10, priv->damage.xend);
+	ut_asserteq(768, priv->damage.yend);
+	video_sync(dev, false);
+
+	/* Measure console throughput, syncing after each line as puts does */
+	start = timer_get_us();
+	for (i = 0; i < 200; i++) {
+		vidconsole_put_string(con,
+			"The quick brown fox jumps over the lazy dog\n");
+		video_sync(dev, false);
+	}
+	printf("%s: 200 lines in %lu us\n", __func__, timer_get_us() - start);
+	ut_assert(compress_frame_buffer(uts, dev) > 46);
+
+	return 0;
+}
+DM_TEST(dm_test_video_damage, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+#endif
+
 /* Test handling of special characters in the console */
 static int dm_test_video_chars(struct unit_test_state *uts)
 {
@@ -344,7 +398,7 @@ static int dm_test_video_truetype(struct unit_test_state *uts)
 	ut_assertok(uclass_get_device(UCLASS_VIDEO, 0, &dev));
 	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
 	vidconsole_put_string(con, test_string);
-	ut_asserteq(12237, compress_frame_buffer(uts, dev));
+	ut_asserteq(8870, compress_frame_buffer(uts, dev));
 
 	return 0;
 }
@@ -365,7 +419,7 @@ static int dm_test_video_truetype_scroll(struct unit_test_state *uts)
 	ut_assertok(uclass_get_device(UCLASS_VIDEO, 0, &dev));
 	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
 	vidconsole_put_string(con, test_string);
-	ut_asserteq(35030, compress_frame_buffer(uts, dev));
+	ut_asserteq(29030, compress_frame_buffer(uts, dev));
 
 	return 0;
 }
@@ -386,8 +440,59 @@ static int dm_test_video_truetype_bs(struct unit_test_state *uts)
 	ut_assertok(uclass_get_device(UCLASS_VIDEO, 0, &dev));
 	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
 	vidconsole_put_string(con, test_string);
-	ut_asserteq(29018, compress_frame_buffer(uts, dev));
+	ut_asserteq(24075, compress_frame_buffer(uts, dev));
 
 	return 0;
 }
 DM_TEST(dm_test_video_truetype_bs, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+#if defined(CONFIG_CONSOLE_TRUETYPE_CACHE) && defined(CONFIG_VIDEO_ANSI)
+/* Test that the TrueType glyph cache is used, and evicts old characters */
+static int dm_test_video_truetype_cache(struct unit_test_state *uts)
+{
+	const char *test_string = "\x1b[2JCriticism may not be agreeable, but it is necessary.\n";
+	struct udevice *dev, *con;
+	int size, pass, line, i;
+	ulong start;
+	long used;
+
+	ut_assertok(uclass_get_device(UCLASS_VIDEO, 0, &dev));
+	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
+	vidconsole_put_string(con, test_string);
+	size = compress_frame_buffer(uts, dev);
+	ut_asserteq(2178, size);
+
+	/* Writing the same characters again just uses the cache */
+	start = ut_check_free();
+	vidconsole_put_string(con, test_string);
+	ut_asserteq(0, ut_check_delta(start));
+	ut_asserteq(size, compress_frame_buffer(uts, dev));
+
+	/*
+	 * Write every character at many sub-pixel positions, which is more
+	 * than the cache can hold. Doing this a second time must not use any
+	 * more memory, since evicted characters are freed.
+	 */
+	used = 0;
+	for (pass = 0; pass < 2; pass++) {
+		for (line = 0; line < 16; line++) {
+			for (i = 0; i < line; i++)
+				vidconsole_put_char(con, '.');
+			for (i = '!'; i <= '~'; i++)
+				vidconsole_put_char(con, i);
+			vidconsole_put_char(con, '\n');
+		}
+		if (!pass)
+			used = ut_check_delta(start);
+	}
+	ut_assert(used > 0);
+	ut_asserteq(used, ut_check_delta(start));
+
+	/* Characters which were evicted look the same when drawn again */
+	vidconsole_put_string(con, test_string);
+	ut_asserteq(size, compress_frame_buffer(uts, dev));
+
+	return 0;
+}
+DM_TEST(dm_test_video_truetype_cache, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+#endif
@@ -0,0 +1,72 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Test for the hush script cache
+ */
+
+#include <common.h>
+#include <command.h>
+#include <env.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+/* Run a script twice, so that the second run uses the cached parse tree */
+static int run_twice(struct unit_test_state *uts, const char *script,
+		     const char *var, const char *expect)
+{
+	int i;
+
+	ut_assertok(env_set("script", script));
+	for (i = 0; i < 2; i++) {
+		ut_assertok(env_set(var, "none"));
+		ut_assertok(run_command("run script", 0));
+		ut_asserteq_str(expect, env_get(var));
+	}
+
+	return 0;
+}
+
+static int lib_test_hush_cache(struct unit_test_state *uts)
+{
+	/* the loop variable is put back when the loop finishes */
+	ut_assertok(run_twice(uts,
+			      "for i in a b c; do setenv last ${i}; done",
+			      "last", "c"));
+
+	/* ...and also when it is left early */
+	ut_assertok(run_twice(uts,
+			      "for i in a b c; do setenv last ${i}; "
+			      "if test ${i} = b; then exit; fi; done",
+			      "last", "b"));
+
+	/* an assignment before a command must not change the tree */
+	ut_assertok(env_set("val", "hello"));
+	ut_assertok(run_twice(uts, "v=${val} setenv res ${v}", "res",
+			      "hello"));
+
+	/* variables are expanded each time */
+	ut_assertok(env_set("script", "setenv res ${val}"));
+	ut_assertok(run_command("run script", 0));
+	ut_asserteq_str("hello", env_get("res"));
+	ut_assertok(env_set("val", "there"));
+	ut_assertok(run_command("run script", 0));
+	ut_asserteq_str("there", env_get("res"));
+
+	/* a changed script is not taken from the cache */
+	ut_assertok(env_set("script", "setenv res changed"));
+	ut_assertok(run_command("run script", 0));
+	ut_asserteq_str("changed", env_get("res"));
+
+	/* errors are still reported */
+	ut_assertok(env_set("script", "false"));
+	ut_asserteq(1, run_command("run script", 0));
+	ut_asserteq(1, run_command("run script", 0));
+
+	env_set("script", NULL);
+	env_set("last", NULL);
+	env_set("val", NULL);
+	env_set("res", NULL);
+
+	return 0;
+}
+LIB_TEST(lib_test_hush_cache, 0);
@@ -21,22 +21,22 @@ static int check_lmb(struct unit_test_state *uts, struct lmb *lmb,
 {
 	if (ram_size) {
 		ut_asserteq(lmb->memory.cnt, 1);
-		ut_asserteq(lmb->memory.region[0].base, ram_base);
-		ut_asserteq(lmb->memory.region[0].size, ram_size);
+		ut_asserteq(lmb_regions(&lmb->memory)[0].base, ram_base);
+		ut_asserteq(lmb_regions(&lmb->memory)[0].size, ram_size);
 	}
 
 	ut_asserteq(lmb->reserved.cnt, num_reserved);
 	if (num_reserved > 0) {
-		ut_asserteq(lmb->reserved.region[0].base, base1);
-		ut_asserteq(lmb->reserved.region[0].size, size1);
+		ut_asserteq(lmb_regions(&lmb->reserved)[0].base, base1);
+		ut_asserteq(lmb_regions(&lmb->reserved)[0].size, size1);
 	}
 	if (num_reserved > 1) {
-		ut_asserteq(lmb->reserved.region[1].base, base2);
-		ut_asserteq(lmb->reserved.region[1].size, size2);
+		ut_asserteq(lmb_regions(&lmb->reserved)[1].base, base2);
+		ut_asserteq(lmb_regions(&lmb->reserved)[1].size, size2);
 	}
 	if (num_reserved > 2) {
-		ut_asserteq(lmb->reserved.region[2].base, base3);
-		ut_asserteq(lmb->reserved.region[2].size, size3);
+		ut_asserteq(lmb_regions(&lmb->reserved)[2].base, base3);
+		ut_asserteq(lmb_regions(&lmb->reserved)[2].size, size3);
 	}
 	return 0;
 }
@@ -82,14 +82,14 @@ static int test_multi_alloc(struct unit_test_state *uts, const phys_addr_t ram,
 
 	if (ram0_size) {
 		ut_asserteq(lmb.memory.cnt, 2);
-		ut_asserteq(lmb.memory.region[0].base, ram0);
-		ut_asserteq(lmb.memory.region[0].size, ram0_size);
-		ut_asserteq(lmb.memory.region[1].base, ram);
-		ut_asserteq(lmb.memory.region[1].size, ram_size);
+		ut_asserteq(lmb_regions(&lmb.memory)[0].base, ram0);
+		ut_asserteq(lmb_regions(&lmb.memory)[0].size, ram0_size);
+		ut_asserteq(lmb_regions(&lmb.memory)[1].base, ram);
+		ut_asserteq(lmb_regions(&lmb.memory)[1].size, ram_size);
 	} else {
 		ut_asserteq(lmb.memory.cnt, 1);
-		ut_asserteq(lmb.memory.region[0].base, ram);
-		ut_asserteq(lmb.memory.region[0].size, ram_size);
+		ut_asserteq(lmb_regions(&lmb.memory)[0].base, ram);
+		ut_asserteq(lmb_regions(&lmb.memory)[0].size, ram_size);
 	}
 
 	/* reserve 64KiB somewhere */
@@ -160,14 +160,14 @@ static int test_multi_alloc(struct unit_test_state *uts, const phys_addr_t ram,
 
 	if (ram0_size) {
 		ut_asserteq(lmb.memory.cnt, 2);
-		ut_asserteq(lmb.memory.region[0].base, ram0);
-		ut_asserteq(lmb.memory.region[0].size, ram0_size);
-		ut_asserteq(lmb.memory.region[1].base, ram);
-		ut_asserteq(lmb.memory.region[1].size, ram_size);
+		ut_asserteq(lmb_regions(&lmb.memory)[0].base, ram0);
+		ut_asserteq(lmb_regions(&lmb.memory)[0].size, ram0_size);
+		ut_asserteq(lmb_regions(&lmb.memory)[1].base, ram);
+		ut_asserteq(lmb_regions(&lmb.memory)[1].size, ram_size);
 	} else {
 		ut_asserteq(lmb.memory.cnt, 1);
-		ut_asserteq(lmb.memory.region[0].base, ram);
-		ut_asserteq(lmb.memory.region[0].size, ram_size);
+		ut_asserteq(lmb_regions(&lmb.memory)[0].base, ram);
+		ut_asserteq(lmb_regions(&lmb.memory)[0].size, ram_size);
 	}
 
 	return 0;
@@ -659,3 +659,108 @@ static int lib_test_lmb_get_free_size(struct unit_test_state *uts)
 
 DM_TEST(lib_test_lmb_get_free_size,
 	UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+/* Check that the reserved table is sorted and that no regions overlap */
+static int check_lmb_sorted(struct unit_test_state *uts, struct lmb *lmb)
+{
+	unsigned long i;
+
+	for (i = 1; i < lmb->reserved.cnt; i++)
+		ut_assert(lmb_regions(&lmb->reserved)[i - 1].base +
+			  lmb_regions(&lmb->reserved)[i - 1].size <=
+			  lmb_regions(&lmb->reserved)[i].base);
+
+	return 0;
+}
+
+/*
+ * Simulate 1 GiB RAM with thousands of reservations, enough to move the
+ * region table to the heap, and check lookups, allocation and merging.
+ */
+static int lib_test_lmb_many(struct unit_test_state *uts)
+{
+	const phys_addr_t ram = 0x40000000;
+	const phys_size_t ram_size = 0x40000000;
+	const int count = 4096;
+	const phys_size_t stride = 0x10000;
+	struct lmb lmb;
+	phys_addr_t base, a;
+	long ret;
+	int i, j;
+
+	lmb_init(&lmb);
+	ut_asserteq(0, lmb_add(&lmb, ram, ram_size));
+
+	/* Reserve 4 KiB every 64 KiB, in a scattered order */
+	for (i = 0; i < count; i++) {
+		j = (i * 1237) % count;
+		lmb.owner = j & 1 ? LMB_OWNER_FS : LMB_OWNER_BOOTM;
+		ret = lmb_reserve(&lmb, ram + j * stride, 0x1000);
+		ut_asserteq(0, ret);
+	}
+	ut_asserteq(count, lmb.reserved.cnt);
+	ut_assert(lmb.reserved.max >= count);
+	ut_assertok(check_lmb_sorted(uts, &lmb));
+
+	for (i = 0; i < count; i++) {
+		base = ram + i * stride;
+		ut_asserteq(base, lmb_regions(&lmb.reserved)[i].base);
+		ut_asserteq(i & 1 ? LMB_OWNER_FS : LMB_OWNER_BOOTM,
+			    lmb_regions(&lmb.reserved)[i].owner);
+		ut_asserteq(1, lmb_is_reserved(&lmb, base + 0xfff));
+		ut_asserteq(0, lmb_is_reserved(&lmb, base + 0x1000));
+		ut_asserteq(i < count - 1 ? stride - 0x1000 :
+			    ram + ram_size - base - 0x1000,
+			    lmb_get_free_size(&lmb, base + 0x1000));
+		ut_asserteq(-1, lmb_reserve(&lmb, base + 0x800, 0x1000));
+	}
+
+	/* Allocations fill the gaps, from the top down */
+	lmb.owner = LMB_OWNER_FS;
+	a = lmb_alloc_base(&lmb, stride - 0x1000, 0x1000,
+			   ram + count * stride);
+	ut_asserteq(ram + (count - 1) * stride + 0x1000, a);
+	ut_asserteq(count, lmb.reserved.cnt);
+	ut_assertok(lmb_free(&lmb, a, stride - 0x1000));
+
+	/* Nothing larger than a gap fits between the reservations */
+	ut_asserteq(0, lmb_alloc_base(&lmb, stride, 0x1000,
+				      ram + count * stride));
+
+	/* Filling a gap merges regions, but only if the owner matches */
+	ut_asserteq(1, lmb_reserve(&lmb, ram + 0x1000, stride - 0x1000));
+	ut_asserteq(count, lmb.reserved.cnt);
+	ut_asserteq(ram + 0x1000, lmb_regions(&lmb.reserved)[1].base);
+
+	ut_assertok(lmb_free(&lmb, ram + 3 * stride, 0x1000));
+	lmb.owner = LMB_OWNER_BOOTM;
+	ut_asserteq(2, lmb_reserve(&lmb, ram + 2 * stride + 0x1000,
+				   2 * stride - 0x1000));
+	ut_asserteq(count - 2, lmb.reserved.cnt);
+	ut_asserteq(2 * stride + 0x1000, lmb_regions(&lmb.reserved)[2].size);
+	ut_assertok(check_lmb_sorted(uts, &lmb));
+
+	/* Freeing the middle of a region splits it, keeping the owner */
+	ut_assertok(lmb_free(&lmb, ram + 3 * stride, 0x1000));
+	ut_asserteq(count - 1, lmb.reserved.cnt);
+	ut_asserteq(ram + 3 * stride + 0x1000,
+		    lmb_regions(&lmb.reserved)[3].base);
+	ut_asserteq(LMB_OWNER_BOOTM, lmb_regions(&lmb.reserved)[3].owner);
+
+	/* Free every other region, then the rest */
+	for (i = count - 1; i >= 5; i -= 2)
+		ut_assertok(lmb_free(&lmb, ram + i * stride, 0x1000));
+	ut_assertok(check_lmb_sorted(uts, &lmb));
+	while (lmb.reserved.cnt) {
+		ut_assertok(lmb_free(&lmb, lmb_regions(&lmb.reserved)[0].base,
+				     lmb_regions(&lmb.reserved)[0].size));
+	}
+
+	lmb_release(&lmb);
+	ut_asserteq(0, lmb.reserved.cnt);
+	ut_asserteq(MAX_LMB_REGIONS, lmb.reserved.max);
+
+	return 0;
+}
+
+DM_TEST(lib_test_lmb_many, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
@@ -0,0 +1,110 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for heap usage statistics
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <malloc_stats.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+#define NUM_PTRS	100
+
+static noinline void *test_alloc(size_t size)
+{
+	return malloc(size);
+}
+
+static noinline void *test_realloc(void *ptr, size_t size)
+{
+	return realloc(ptr, size);
+}
+
+/* Find the entry for a caller within a function */
+static struct malloc_site *find_site(struct malloc_usage *stats, void *func)
+{
+	ulong start = (ulong)func;
+	int i;
+
+	for (i = 0; i < stats->max_sites; i++) {
+		struct malloc_site *site = &stats->sites[i];
+
+		if (site->caller >= start && site->caller < start + 0x100)
+			return site;
+	}
+
+	return NULL;
+}
+
+static int lib_test_malloc_stats(struct unit_test_state *uts)
+{
+	struct malloc_site *site, *rsite;
+	struct malloc_usage *stats;
+	void *ptr[NUM_PTRS];
+	ulong cur, count;
+	int i;
+
+	stats = malloc_stats_get(false);
+	ut_assertnonnull(stats);
+	cur = stats->cur;
+	count = stats->count;
+
+	for (i = 0; i < NUM_PTRS; i++) {
+		ptr[i] = test_alloc(100);
+		ut_assertnonnull(ptr[i]);
+	}
+	ut_asserteq(count + NUM_PTRS, stats->count);
+	ut_asserteq(cur + NUM_PTRS * 100, stats->cur);
+	site = find_site(stats, test_alloc);
+	ut_assertnonnull(site);
+	ut_asserteq(NUM_PTRS * 100, site->bytes);
+	ut_asserteq(NUM_PTRS * 100, site->peak);
+
+	/* Freeing charges the blocks back to the caller */
+	for (i = 0; i < NUM_PTRS; i += 2)
+		free(ptr[i]);
+	ut_asserteq(NUM_PTRS * 50, site->bytes);
+	ut_asserteq(NUM_PTRS * 100, site->peak);
+	ut_asserteq(cur + NUM_PTRS * 50, stats->cur);
+
+	/* A reallocated block moves to the caller of realloc() */
+	ptr[1] = test_realloc(ptr[1], 1000);
+	ut_assertnonnull(ptr[1]);
+	rsite = find_site(stats, test_realloc);
+	ut_assertnonnull(rsite);
+	ut_asserteq(1000, rsite->bytes);
+	ut_asserteq(NUM_PTRS * 50 - 100, site->bytes);
+
+	for (i = 1; i < NUM_PTRS; i += 2)
+		free(ptr[i]);
+	ut_asserteq(0, site->bytes);
+	ut_asserteq(0, rsite->bytes);
+	ut_asserteq(cur, stats->cur);
+	ut_assert(stats->peak >= cur + NUM_PTRS * 100);
+
+	/* Blocks which were not recorded are ignored */
+	free(NULL);
+	ut_asserteq(cur, stats->cur);
+
+	return 0;
+}
+LIB_TEST(lib_test_malloc_stats, 0);
+
+/* The pre-relocation heap should have been recorded too */
+static int lib_test_malloc_stats_early(struct unit_test_state *uts)
+{
+	struct malloc_usage *stats;
+
+	stats = malloc_stats_get(true);
+	ut_assertnonnull(stats);
+	ut_assert(stats->count > 0);
+	ut_assert(stats->num_sites > 0);
+	ut_assert(stats->f_used > 0);
+	ut_assert(stats->f_used <= stats->f_size);
+	ut_asserteq(stats->cur, stats->peak);
+
+	return 0;
+}
+LIB_TEST(lib_test_malloc_stats_early, 0);
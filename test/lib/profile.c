@@ -0,0 +1,50 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Test for the sandbox sampling profiler
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <asm/profile.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+/* Use CPU time until the profiler has taken some samples, or give up */
+static noinline ulong profile_test_spin(void)
+{
+	ulong start = get_timer(0);
+	volatile ulong val = 0;
+
+	while (profile_get_total() < 20 && get_timer(start) < 5000)
+		val++;
+
+	return val;
+}
+
+static int lib_test_profile(struct unit_test_state *uts)
+{
+	char *buf;
+	int size;
+
+	ut_asserteq(-EINVAL, profile_start(0));
+	ut_assertok(profile_start(1000));
+	ut_asserteq(-EBUSY, profile_start(1000));
+	profile_test_spin();
+	ut_assertok(profile_stop());
+	ut_asserteq(-EALREADY, profile_stop());
+	ut_assert(profile_get_total() >= 20);
+
+	/* The spinning function should appear in the folded stacks */
+	size = profile_folded(NULL, 0);
+	ut_assert(size > 1);
+	buf = malloc(size);
+	ut_assertnonnull(buf);
+	ut_asserteq(size, profile_folded(buf, size));
+	ut_asserteq(size - 1, strlen(buf));
+	ut_assertnonnull(strstr(buf, "profile_test_spin"));
+	free(buf);
+
+	return 0;
+}
+LIB_TEST(lib_test_profile, 0);
@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for applying packed relative relocations (RELR)
+ */
+
+#include <common.h>
+#include <relr.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+#define LINK_ADDR	0x1000000
+#define IMAGE_WORDS	200
+#define WORD_BITS	(sizeof(ulong) * 8)
+
+/* Build a relocation table covering the words set in @reloc */
+static int relr_encode(const bool *reloc, int count, ulong *relr)
+{
+	int n = 0, next = -1;
+	int i, j;
+
+	for (i = 0; i < count; i++) {
+		ulong bitmap = 0;
+
+		if (!reloc[i])
+			continue;
+		if (i != next) {
+			/* Start a new run with an address entry */
+			relr[n++] = LINK_ADDR + i * sizeof(ulong);
+			next = i + 1;
+			continue;
+		}
+
+		/* Use a bitmap for the following words, if any need it */
+		for (j = 0; j < WORD_BITS - 1 && next + j < count; j++) {
+			if (reloc[next + j])
+				bitmap |= 1UL << (j + 1);
+		}
+		relr[n++] = bitmap | 1;
+		i = next + j - 1;
+		next += WORD_BITS - 1;
+	}
+
+	return n;
+}
+
+static int lib_test_relr(struct unit_test_state *uts)
+{
+	ulong image[IMAGE_WORDS], expect[IMAGE_WORDS];
+	ulong relr[IMAGE_WORDS + 1];
+	bool reloc[IMAGE_WORDS];
+	ulong offset;
+	uint seed = 1;
+	int pass, i, n;
+
+	offset = (ulong)image - LINK_ADDR;
+	for (pass = 0; pass < 4; pass++) {
+		for (i = 0; i < IMAGE_WORDS; i++) {
+			seed = seed * 1103515245 + 12345;
+			switch (pass) {
+			case 0:		/* nothing to relocate */
+				reloc[i] = false;
+				break;
+			case 1:		/* everything */
+				reloc[i] = true;
+				break;
+			case 2:		/* sparse, so mostly address entries */
+				reloc[i] = !(seed >> 8 & 0x1f);
+				break;
+			default:	/* dense, so mostly bitmaps */
+				reloc[i] = seed >> 8 & 3;
+				break;
+			}
+			image[i] = LINK_ADDR + (seed >> 4 & 0xfff);
+			expect[i] = reloc[i] ? image[i] + offset : image[i];
+		}
+		n = relr_encode(reloc, IMAGE_WORDS, relr);
+		ut_assert(n <= IMAGE_WORDS);
+		if (pass == 1)
+			ut_assert(n <= IMAGE_WORDS / (WORD_BITS - 1) + 2);
+
+		relr_apply(relr, relr + n, offset);
+		for (i = 0; i < IMAGE_WORDS; i++)
+			ut_asserteq(expect[i], image[i]);
+	}
+
+	/* An address entry which skips over a gap */
+	memset(image, '\0', sizeof(image));
+	relr[0] = LINK_ADDR;
+	relr[1] = 1 | 1UL << 3;
+	relr[2] = LINK_ADDR + 100 * sizeof(ulong);
+	relr_apply(relr, relr + 3, offset);
+	ut_asserteq(offset, image[0]);
+	ut_asserteq(0, image[1]);
+	ut_asserteq(offset, image[3]);
+	ut_asserteq(0, image[4]);
+	ut_asserteq(offset, image[100]);
+	ut_asserteq(0, image[101]);
+
+	return 0;
+}
+LIB_TEST(lib_test_relr, 0);
@@ -12,6 +12,9 @@
 #include <common.h>
 #include <command.h>
 #include <log.h>
+#include <malloc.h>
+#include <time.h>
+#include <linux/sizes.h>
 #include <test/lib.h>
 #include <test/test.h>
 #include <test/ut.h>
@@ -193,3 +196,239 @@ static int lib_memmove(struct unit_test_state *uts)
 }
 
 LIB_TEST(lib_memmove, 0);
+
+/* Lengths crossing the size thresholds of optimised implementations */
+static const int long_lens[] = {
+	33, 63, 64, 65, 96, 127, 128, 129, 143, 144, 145, 191, 192, 255, 256,
+	257, 300, 511, 512, 513, 1000, 4096 + 7,
+};
+
+/* Largest length in long_lens[] plus room for alignment and guard bytes */
+#define LONG_BUFLEN	(4096 + 7 + 2 * SWEEP)
+
+/**
+ * init_long_buffer() - initialize a long buffer
+ *
+ * The buffer is filled with a pattern which does not repeat every 256 bytes
+ * so that copies from the wrong offset are detected.
+ *
+ * @buf:	buffer
+ * @seed:	value mixed into the pattern
+ */
+static void init_long_buffer(u8 *buf, u8 seed)
+{
+	int i;
+
+	for (i = 0; i < LONG_BUFLEN; ++i)
+		buf[i] = (i + (i >> 8)) ^ seed;
+}
+
+/**
+ * lib_memset_long() - unit test for memset() on longer regions
+ *
+ * Test memset() with varied alignment, lengths up to several KiB and both
+ * zero and non-zero values, since zeroing may use a different code path.
+ *
+ * @uts:	unit test state
+ * Return:	0 = success, 1 = failure
+ */
+static int lib_memset_long(struct unit_test_state *uts)
+{
+	static const u8 vals[] = { 0, MASK };
+	int offset, i, v, j;
+	u8 *buf, *ref;
+
+	buf = malloc(LONG_BUFLEN);
+	ref = malloc(LONG_BUFLEN);
+	ut_assertnonnull(buf);
+	ut_assertnonnull(ref);
+
+	for (v = 0; v < ARRAY_SIZE(vals); v++) {
+		for (i = 0; i < ARRAY_SIZE(long_lens); i++) {
+			for (offset = 0; offset <= SWEEP; ++offset) {
+				int len = long_lens[i];
+
+				init_long_buffer(buf, 0);
+				init_long_buffer(ref, 0);
+				for (j = 0; j < len; j++)
+					ref[offset + j] = vals[v];
+				ut_asserteq_ptr(buf + offset,
+						memset(buf + offset, vals[v],
+						       len));
+				ut_asserteq_mem(ref, buf, LONG_BUFLEN);
+			}
+		}
+	}
+	free(ref);
+	free(buf);
+
+	return 0;
+}
+
+LIB_TEST(lib_memset_long, 0);
+
+/**
+ * lib_memcpy_long() - unit test for memcpy() on longer regions
+ *
+ * Test memcpy() with varied source and destination alignment and lengths
+ * up to several KiB.
+ *
+ * @uts:	unit test state
+ * Return:	0 = success, 1 = failure
+ */
+static int lib_memcpy_long(struct unit_test_state *uts)
+{
+	int offset1, offset2, i;
+	u8 *src, *dst, *ref;
+
+	src = malloc(LONG_BUFLEN);
+	dst = malloc(LONG_BUFLEN);
+	ref = malloc(LONG_BUFLEN);
+	ut_assertnonnull(src);
+	ut_assertnonnull(dst);
+	ut_assertnonnull(ref);
+
+	init_long_buffer(src, MASK);
+	for (i = 0; i < ARRAY_SIZE(long_lens); i++) {
+		for (offset1 = 0; offset1 <= SWEEP; ++offset1) {
+			for (offset2 = 0; offset2 <= SWEEP; ++offset2) {
+				int len = long_lens[i];
+				int j;
+
+				init_long_buffer(dst, 0);
+				init_long_buffer(ref, 0);
+				for (j = 0; j < len; j++)
+					ref[offset2 + j] = src[offset1 + j];
+				ut_asserteq_ptr(dst + offset2,
+						memcpy(dst + offset2,
+						       src + offset1, len));
+				ut_asserteq_mem(ref, dst, LONG_BUFLEN);
+			}
+		}
+	}
+	free(ref);
+	free(dst);
+	free(src);
+
+	return 0;
+}
+
+LIB_TEST(lib_memcpy_long, 0);
+
+/**
+ * lib_memmove_long() - unit test for memmove() on longer regions
+ *
+ * Test memmove() on overlapping regions in both directions with varied
+ * alignment and lengths up to several KiB.
+ *
+ * @uts:	unit test state
+ * Return:	0 = success, 1 = failure
+ */
+static int lib_memmove_long(struct unit_test_state *uts)
+{
+	int offset1, offset2, i;
+	u8 *buf, *ref;
+
+	buf = malloc(LONG_BUFLEN);
+	ref = malloc(LONG_BUFLEN);
+	ut_assertnonnull(buf);
+	ut_assertnonnull(ref);
+
+	for (i = 0; i < ARRAY_SIZE(long_lens); i++) {
+		for (offset1 = 0; offset1 <= 2 * SWEEP; ++offset1) {
+			for (offset2 = 0; offset2 <= 2 * SWEEP; ++offset2) {
+				int len = long_lens[i];
+				int j;
+
+				if (len + max(offset1, offset2) > LONG_BUFLEN)
+					continue;
+				init_long_buffer(buf, 0);
+				init_long_buffer(ref, 0);
+				for (j = 0; j < len; j++)
+					ref[offset2 + j] = buf[offset1 + j];
+				ut_asserteq_ptr(buf + offset2,
+						memmove(buf + offset2,
+							buf + offset1, len));
+				ut_asserteq_mem(ref, buf, LONG_BUFLEN);
+			}
+		}
+	}
+	free(ref);
+	free(buf);
+
+	return 0;
+}
+
+LIB_TEST(lib_memmove_long, 0);
+
+/* Size of the buffers used to measure throughput */
+#define SPEED_BUFLEN	SZ_1M
+/* Number of times each operation is repeated */
+#define SPEED_LOOPS	16
+
+/**
+ * show_speed() - print the throughput of a memory function
+ *
+ * @name:	function name
+ * @start:	timer_get_us() value when the measurement started
+ */
+static void show_speed(const char *name, ulong start)
+{
+	ulong us = max(timer_get_us() - start, 1UL);
+
+	printf("%-8s %6lu MiB/s\n", name,
+	       SPEED_BUFLEN / SZ_1M * SPEED_LOOPS * 1000000UL / us);
+}
+
+/**
+ * lib_string_speed() - measure memset(), memcpy() and memmove()
+ *
+ * Report the throughput of the memory functions on 1 MiB buffers, so that
+ * architecture-specific implementations can be compared with lib/string.c.
+ * The results are checked too, with unaligned buffers for the copies.
+ *
+ * @uts:	unit test state
+ * Return:	0 = success, 1 = failure
+ */
+static int lib_string_speed(struct unit_test_state *uts)
+{
+	u8 *src, *dst;
+	ulong start;
+	int i;
+
+	src = malloc(SPEED_BUFLEN + 16);
+	dst = malloc(SPEED_BUFLEN + 16);
+	ut_assertnonnull(src);
+	ut_assertnonnull(dst);
+
+	start = timer_get_us();
+	for (i = 0; i < SPEED_LOOPS; i++)
+		memset(src, i, SPEED_BUFLEN + 16);
+	show_speed("memset", start);
+	for (i = 0; i < SPEED_BUFLEN + 16; i += 4093)
+		ut_asserteq(SPEED_LOOPS - 1, src[i]);
+
+	for (i = 0; i < SPEED_BUFLEN + 16; i++)
+		src[i] = i ^ (i >> 8);
+
+	start = timer_get_us();
+	for (i = 0; i < SPEED_LOOPS; i++)
+		memcpy(dst + 3, src + 1, SPEED_BUFLEN);
+	show_speed("memcpy", start);
+	ut_asserteq_mem(src + 1, dst + 3, SPEED_BUFLEN);
+
+	memcpy(dst, src, SPEED_BUFLEN + 16);
+	start = timer_get_us();
+	for (i = 0; i < SPEED_LOOPS; i++)
+		memmove(dst + (i & 1) * 8, dst + !(i & 1) * 8, SPEED_BUFLEN);
+	show_speed("memmove", start);
+	/* each pair of moves leaves all but the first 8 bytes unchanged */
+	ut_asserteq_mem(src + 8, dst + 8, SPEED_BUFLEN);
+
+	free(dst);
+	free(src);
+
+	return 0;
+}
+
+LIB_TEST(lib_string_speed, 0);
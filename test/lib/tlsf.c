@@ -0,0 +1,288 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the TLSF memory allocator
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <time.h>
+#include <tlsf.h>
+#include <linux/sizes.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+#define POOL_SIZE	SZ_1M
+#define NUM_PTRS	256
+
+/* Simple LCG, so that the tests are repeatable */
+static uint tlsf_test_rand(uint *seed)
+{
+	*seed = *seed * 1103515245 + 12345;
+
+	return *seed >> 8;
+}
+
+static int lib_test_tlsf_basic(struct unit_test_state *uts)
+{
+	struct tlsf_info info, start;
+	void *buf, *ptr, *ptr2;
+	struct tlsf *tlsf;
+	size_t align;
+
+	buf = malloc(POOL_SIZE);
+	ut_assertnonnull(buf);
+	ut_assertnull(tlsf_create(buf, 16));
+	tlsf = tlsf_create(buf, POOL_SIZE);
+	ut_assertnonnull(tlsf);
+	ut_assertok(tlsf_check(tlsf));
+	tlsf_get_info(tlsf, &start);
+	ut_assert(start.total > POOL_SIZE - SZ_16K);
+	ut_asserteq(0, start.used);
+	ut_asserteq(1, start.free_blocks);
+
+	/* Blocks are at least as large as requested, and aligned */
+	ptr = tlsf_malloc(tlsf, 100);
+	ut_assertnonnull(ptr);
+	ut_assert(tlsf_usable_size(ptr) >= 100);
+	ut_asserteq(0, (ulong)ptr & (2 * sizeof(size_t) - 1));
+	ut_assert(tlsf_contains(tlsf, ptr));
+	ut_assert(!tlsf_contains(tlsf, buf));
+	tlsf_get_info(tlsf, &info);
+	ut_assert(info.used > 100);
+	ut_assertnull(tlsf_malloc(tlsf, POOL_SIZE));
+
+	/* Growing into free space following the block does not move it */
+	memset(ptr, 0xaa, 100);
+	ptr2 = tlsf_realloc(tlsf, ptr, 1000);
+	ut_asserteq_ptr(ptr, ptr2);
+	ut_asserteq(0xaa, ((u8 *)ptr2)[99]);
+	ptr2 = tlsf_realloc(tlsf, ptr, 50);
+	ut_asserteq_ptr(ptr, ptr2);
+	ut_assertok(tlsf_check(tlsf));
+
+	/* Growing past an allocated block moves it */
+	ptr2 = tlsf_malloc(tlsf, 10);
+	ut_assertnonnull(ptr2);
+	ptr = tlsf_realloc(tlsf, ptr, 5000);
+	ut_assertnonnull(ptr);
+	ut_asserteq(0xaa, ((u8 *)ptr)[49]);
+	ut_assertok(tlsf_check(tlsf));
+	tlsf_free(tlsf, ptr2);
+	ut_assertnull(tlsf_realloc(tlsf, ptr, 0));
+
+	for (align = 1; align <= SZ_64K; align <<= 1) {
+		ptr = tlsf_memalign(tlsf, align, 123);
+		ut_assertnonnull(ptr);
+		ut_asserteq(0, (ulong)ptr & (align - 1));
+		ut_assertok(tlsf_check(tlsf));
+		tlsf_free(tlsf, ptr);
+	}
+	ut_assertnull(tlsf_memalign(tlsf, 48, 10));
+
+	/* Everything should have been merged back into one block */
+	ut_assertok(tlsf_check(tlsf));
+	tlsf_get_info(tlsf, &info);
+	ut_asserteq(0, info.used);
+	ut_asserteq(1, info.free_blocks);
+	ut_asserteq(start.largest_free, info.largest_free);
+	ut_assert(info.max_used > 5000);
+	free(buf);
+
+	return 0;
+}
+LIB_TEST(lib_test_tlsf_basic, 0);
+
+#if CONFIG_IS_ENABLED(SYS_MALLOC_TLSF)
+/* Test the malloc() glue when TLSF manages the main malloc() pool */
+static int lib_test_malloc_tlsf(struct unit_test_state *uts)
+{
+	ulong start = ut_check_free();
+	struct mallinfo info;
+	u8 *ptr, *ptr2;
+	size_t align;
+	int i;
+
+	info = mallinfo();
+	ut_assert(info.arena > CONFIG_SYS_MALLOC_LEN / 2);
+	ut_assert(info.uordblks > 0);
+
+	ptr = malloc(100);
+	ut_assertnonnull(ptr);
+	ut_assert(malloc_usable_size(ptr) >= 100);
+	ut_assert(ut_check_delta(start) > 100);
+	memset(ptr, 0x55, 100);
+	ptr = realloc(ptr, 20000);
+	ut_assertnonnull(ptr);
+	ut_asserteq(0x55, ptr[99]);
+	free(ptr);
+	ut_asserteq(0, ut_check_delta(start));
+
+	ptr = calloc(50, 20);
+	ut_assertnonnull(ptr);
+	for (i = 0; i < 1000; i++)
+		ut_asserteq(0, ptr[i]);
+	ut_assertnull(calloc(SIZE_MAX / 2, 4));
+
+	for (align = 8; align <= SZ_4K; align <<= 1) {
+		ptr2 = memalign(align, 300);
+		ut_assertnonnull(ptr2);
+		ut_asserteq(0, (ulong)ptr2 & (align - 1));
+		free(ptr2);
+	}
+	free(ptr);
+	ut_asserteq(0, ut_check_delta(start));
+
+	/* Memory outside the pool is ignored */
+	free(&info);
+	ut_asserteq(0, malloc_usable_size(&info));
+	ut_asserteq(0, ut_check_delta(start));
+
+	return 0;
+}
+LIB_TEST(lib_test_malloc_tlsf, 0);
+#endif
+
+/* Check that a block still holds the byte it was filled with */
+static int tlsf_test_verify(struct unit_test_state *uts, u8 *ptr, size_t size,
+			    u8 fill)
+{
+	size_t i;
+
+	for (i = 0; i < size; i++)
+		ut_asserteq(fill, ptr[i]);
+
+	return 0;
+}
+
+static int lib_test_tlsf_stress(struct unit_test_state *uts)
+{
+	size_t size[NUM_PTRS] = {0};
+	void *ptr[NUM_PTRS] = {NULL};
+	u8 fill[NUM_PTRS];
+	struct tlsf_info info;
+	struct tlsf *tlsf;
+	uint seed = 1;
+	void *buf, *new;
+	int i, iter;
+
+	buf = malloc(POOL_SIZE);
+	ut_assertnonnull(buf);
+	tlsf = tlsf_create(buf, POOL_SIZE);
+	ut_assertnonnull(tlsf);
+
+	for (iter = 0; iter < 20000; iter++) {
+		size_t req = 1 + tlsf_test_rand(&seed) % 2000;
+
+		i = tlsf_test_rand(&seed) % NUM_PTRS;
+		if (ptr[i]) {
+			ut_assertok(tlsf_test_verify(uts, ptr[i], size[i],
+						     fill[i]));
+			if (tlsf_test_rand(&seed) & 1) {
+				tlsf_free(tlsf, ptr[i]);
+				ptr[i] = NULL;
+				continue;
+			}
+			new = tlsf_realloc(tlsf, ptr[i], req);
+			if (!new)
+				continue;
+			ut_assertok(tlsf_test_verify(uts, new,
+						     min(req, size[i]),
+						     fill[i]));
+			ptr[i] = new;
+		} else {
+			if (!(tlsf_test_rand(&seed) & 7))
+				req *= 20;
+			if (tlsf_test_rand(&seed) & 3) {
+				ptr[i] = tlsf_malloc(tlsf, req);
+			} else {
+				ulong align = 1 << tlsf_test_rand(&seed) % 12;
+
+				ptr[i] = tlsf_memalign(tlsf, align, req);
+				if (ptr[i])
+					ut_asserteq(0, (ulong)ptr[i] &
+						    (align - 1));
+			}
+			if (!ptr[i])
+				continue;
+			fill[i] = tlsf_test_rand(&seed);
+		}
+		ut_assert(tlsf_usable_size(ptr[i]) >= req);
+		size[i] = req;
+		memset(ptr[i], fill[i], req);
+		if (!(iter % 500))
+			ut_assertok(tlsf_check(tlsf));
+	}
+
+	for (i = 0; i < NUM_PTRS; i++)
+		tlsf_free(tlsf, ptr[i]);
+	ut_assertok(tlsf_check(tlsf));
+	tlsf_get_info(tlsf, &info);
+	ut_asserteq(0, info.used);
+	ut_asserteq(1, info.free_blocks);
+	free(buf);
+
+	return 0;
+}
+LIB_TEST(lib_test_tlsf_stress, 0);
+
+/*
+ * Time alloc/free cycles with a fragmented pool, using TLSF and malloc(). This
+ * only reports the results since the times depend on the host.
+ */
+static int lib_test_tlsf_bench(struct unit_test_state *uts)
+{
+	ulong tlsf_worst = 0, sys_worst = 0, tlsf_total = 0, sys_total = 0;
+	ulong start;
+	void *ptr[NUM_PTRS] = {NULL};
+	struct tlsf *tlsf;
+	int i, iter, pass;
+	uint seed;
+	void *buf;
+
+	buf = malloc(POOL_SIZE);
+	ut_assertnonnull(buf);
+	tlsf = tlsf_create(buf, POOL_SIZE);
+	ut_assertnonnull(tlsf);
+
+	for (pass = 0; pass < 2; pass++) {
+		ulong total_start = timer_get_us(), *worst;
+
+		worst = pass ? &sys_worst : &tlsf_worst;
+		seed = 1;
+		for (iter = 0; iter < 50000; iter++) {
+			size_t req = 16 + tlsf_test_rand(&seed) % 1024;
+
+			i = tlsf_test_rand(&seed) % NUM_PTRS;
+			start = timer_get_us();
+			if (pass) {
+				free(ptr[i]);
+				ptr[i] = malloc(req);
+			} else {
+				tlsf_free(tlsf, ptr[i]);
+				ptr[i] = tlsf_malloc(tlsf, req);
+			}
+			*worst = max(*worst, timer_get_us() - start);
+			ut_assertnonnull(ptr[i]);
+		}
+		for (i = 0; i < NUM_PTRS; i++) {
+			if (pass)
+				free(ptr[i]);
+			else
+				tlsf_free(tlsf, ptr[i]);
+			ptr[i] = NULL;
+		}
+		if (pass)
+			sys_total = timer_get_us() - total_start;
+		else
+			tlsf_total = timer_get_us() - total_start;
+	}
+	ut_assertok(tlsf_check(tlsf));
+	free(buf);
+
+	printf("50000 free/alloc cycles: tlsf %lu us (worst %lu us), malloc %lu us (worst %lu us)\n",
+	       tlsf_total, tlsf_worst, sys_total, sys_worst);
+
+	return 0;
+}
+LIB_TEST(lib_test_tlsf_bench, 0);
@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for running jobs on secondary CPU cores
+ */
+
+#include <common.h>
+#include <time.h>
+#include <worker.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+#define NUM_JOBS	50
+
+/* Time allowed for a worker to pick up a job */
+#define WORKER_TEST_TIMEOUT_MS	1000
+
+struct sum_ctx {
+	uint start;
+	uint count;
+	ulong sum;
+};
+
+static int sum_job(void *ctx)
+{
+	struct sum_ctx *sum = ctx;
+	uint i;
+
+	for (i = 0; i < sum->count; i++)
+		sum->sum += sum->start + i;
+
+	return sum->start & 1 ? -EINVAL : 0;
+}
+
+struct block_ctx {
+	bool started;
+	bool release;
+};
+
+/* Job which does not finish until it is released */
+static int block_job(void *ctx)
+{
+	struct block_ctx *block = ctx;
+
+	__atomic_store_n(&block->started, true, __ATOMIC_RELEASE);
+	while (!__atomic_load_n(&block->release, __ATOMIC_ACQUIRE))
+		;
+
+	return 0;
+}
+
+/* Wait for a flag to be set by another core */
+static bool wait_flag(bool *flag)
+{
+	ulong start = get_timer(0);
+
+	while (!__atomic_load_n(flag, __ATOMIC_ACQUIRE)) {
+		if (get_timer(start) > WORKER_TEST_TIMEOUT_MS)
+			return false;
+	}
+
+	return true;
+}
+
+/* Test that jobs run and return their results */
+static int lib_test_worker_jobs(struct unit_test_state *uts)
+{
+	struct worker_job jobs[NUM_JOBS];
+	struct sum_ctx sums[NUM_JOBS];
+	ulong expect;
+	int i;
+
+	for (i = 0; i < NUM_JOBS; i++) {
+		sums[i].start = i;
+		sums[i].count = 1000 + i;
+		sums[i].sum = 0;
+		worker_submit(&jobs[i], sum_job, &sums[i]);
+	}
+	for (i = 0; i < NUM_JOBS; i++) {
+		ut_asserteq(i & 1 ? -EINVAL : 0, worker_wait(&jobs[i]));
+		ut_assert(jobs[i].done);
+		expect = (ulong)sums[i].count * i +
+			(ulong)sums[i].count * (sums[i].count - 1) / 2;
+		ut_asserteq(expect, sums[i].sum);
+		ut_assert(jobs[i].cpu <= worker_count());
+	}
+
+	return 0;
+}
+LIB_TEST(lib_test_worker_jobs, 0);
+
+/* Test that jobs run in parallel and that stopping the workers works */
+static int lib_test_worker_stop(struct unit_test_state *uts)
+{
+	struct block_ctx block = {};
+	struct sum_ctx sum = {};
+	struct worker_job job;
+
+	ut_assert(worker_init() > 0);
+	ut_asserteq(0, worker_self());
+
+	/* A job can run on a worker while the boot CPU gets on with things */
+	worker_submit(&job, block_job, &block);
+	ut_assert(wait_flag(&block.started));
+	ut_assert(!job.done);
+	__atomic_store_n(&block.release, true, __ATOMIC_RELEASE);
+	ut_assertok(worker_wait(&job));
+	ut_assert(job.cpu > 0);
+
+	/* Once stopped, jobs run before worker_submit() returns */
+	ut_assertok(worker_stop());
+	ut_asserteq(0, worker_count());
+	sum.count = 10;
+	worker_submit(&job, sum_job, &sum);
+	ut_assert(job.done);
+	ut_asserteq(0, job.cpu);
+	ut_asserteq(45, sum.sum);
+	ut_assertok(worker_wait(&job));
+
+	/* The workers can be started again */
+	ut_assert(worker_init() > 0);
+	ut_assert(worker_count() > 0);
+
+	return 0;
+}
+LIB_TEST(lib_test_worker_stop, 0);
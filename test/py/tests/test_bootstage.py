@@ -0,0 +1,47 @@
+# SPDX-License-Identifier: GPL-2.0+
+# Copyright (c) 2020 Google LLC
+
+import json
+import pytest
+import u_boot_utils
+
+@pytest.mark.buildconfigspec('cmd_bootstage')
+def test_bootstage_export(u_boot_console):
+    """Test that 'bootstage export' produces a valid Chrome trace"""
+    cons = u_boot_console
+
+    output = cons.run_command('bootstage export')
+    trace = json.loads(output)
+    events = trace['traceEvents']
+    assert 'reset' in [event['name'] for event in events]
+    for event in events:
+        assert event['ph'] in ('i', 'X')
+        assert event['ts'] >= 0
+        if event['ph'] == 'X':
+            assert event['dur'] >= 0
+    assert 'otherData' in trace
+
+    # Write the trace to memory, which sets filesize
+    addr = u_boot_utils.find_ram_base(cons)
+    cons.run_command('setenv filesize')
+    output = cons.run_command('bootstage export %x' % addr)
+    assert output == ''
+    size = int(cons.run_command('echo $filesize'), 16)
+    assert size > 0
+
+    # A buffer which is too small is reported, with the size needed
+    output = cons.run_command('bootstage export %x 10' % addr)
+    assert 'Need %#x bytes for export' % (size + 1) in output
+
+@pytest.mark.buildconfigspec('cmd_bootstage')
+@pytest.mark.buildconfigspec('bootstage_spans')
+def test_bootstage_spans(u_boot_console):
+    """Test that spans are recorded while booting"""
+    cons = u_boot_console
+
+    output = cons.run_command('bootstage export')
+    events = json.loads(output)['traceEvents']
+    spans = [event['name'] for event in events if event['ph'] == 'X']
+
+    # Some initcalls always take longer than the minimum to be recorded
+    assert [name for name in spans if name.startswith('initcall ')]
@@ -0,0 +1,137 @@
+# SPDX-License-Identifier: GPL-2.0+
+#
+# Check FIT hash verification when the hashes are worked out in advance on
+# worker cores
+
+import hashlib
+import os
+import pytest
+import u_boot_utils as util
+
+# Number of loadables in the FIT, each with its own hashes
+NUM_LOADABLES = 3
+
+# Size of each image, large enough that hashing takes a little while
+IMAGE_SIZE = 0x40000
+
+FIT_ADDR = 0x100000
+KERNEL_ADDR = 0x800000
+LOADABLE_ADDR = 0xa00000
+
+image_its = '''
+                %(name)s {
+                        data = /incbin/("%(fname)s");
+                        type = "%(type)s";
+                        arch = "sandbox";
+                        os = "linux";
+                        compression = "none";
+                        load = <%(load)#x>;
+                        entry = <%(load)#x>;
+                        hash-1 {
+                                algo = "sha256";
+                        };
+                        hash-2 {
+                                algo = "crc32";
+                        };
+                };
+'''
+
+base_its = '''
+/dts-v1/;
+
+/ {
+        description = "FIT with several hashed images";
+        #address-cells = <1>;
+
+        images {
+%(images)s
+        };
+        configurations {
+                default = "conf-1";
+                conf-1 {
+                        kernel = "kernel";
+                        loadables = %(loadables)s;
+                };
+        };
+};
+'''
+
+def make_data(seed):
+    """Make some image data which does not repeat
+
+    Args:
+        seed: Number to make the data unique to this image
+    Returns:
+        Data as bytes
+    """
+    return b''.join(hashlib.sha256(b'%d-%d' % (seed, i)).digest()
+                    for i in range(IMAGE_SIZE // 32))
+
+@pytest.mark.boardspec('sandbox')
+@pytest.mark.buildconfigspec('fit')
+@pytest.mark.buildconfigspec('worker')
+@pytest.mark.requiredtool('dtc')
+def test_fit_prehash(u_boot_console):
+    """Test verifying images whose hashes are worked out in parallel"""
+    cons = u_boot_console
+    build_dir = cons.config.build_dir
+    mkimage = os.path.join(build_dir, 'tools', 'mkimage')
+
+    # Make the images: a kernel followed by the loadables
+    images = []
+    for i in range(NUM_LOADABLES + 1):
+        name = 'loadable-%d' % i if i else 'kernel'
+        fname = os.path.join(build_dir, 'prehash-%s.bin' % name)
+        data = make_data(i)
+        with open(fname, 'wb') as fd:
+            fd.write(data)
+        load = LOADABLE_ADDR + (i - 1) * IMAGE_SIZE if i else KERNEL_ADDR
+        images.append({'name': name, 'fname': fname, 'data': data,
+                       'type': 'kernel' if i else 'firmware', 'load': load})
+
+    its = os.path.join(build_dir, 'prehash.its')
+    fit = os.path.join(build_dir, 'prehash.fit')
+    with open(its, 'w') as fd:
+        fd.write(base_its % {
+            'images': ''.join(image_its % img for img in images),
+            'loadables': ', '.join('"%s"' % img['name']
+                                   for img in images[1:]),
+        })
+    util.run_and_log(cons, [mkimage, '-f', its, fit])
+    with open(fit, 'rb') as fd:
+        fit_data = fd.read()
+    for img in images:
+        img['offset'] = fit_data.find(img['data'])
+        assert img['offset'] > 0
+
+    cons.restart_uboot()
+    with cons.log.section('Good FIT'):
+        cons.run_command('host load hostfs 0 %x %s' % (FIT_ADDR, fit))
+        output = cons.run_command('iminfo %x' % FIT_ADDR)
+        assert 'error' not in output
+        assert output.count('sha256+ crc32+') == len(images)
+
+        # The loadables must be loaded intact
+        output = cons.run_command('bootm start %x' % FIT_ADDR)
+        assert 'Bad Data Hash' not in output
+        for img in images[1:]:
+            output = cons.run_command('cmp.b %x %x %x' %
+                                      (FIT_ADDR + img['offset'], img['load'],
+                                       IMAGE_SIZE))
+            assert 'Total of %d byte(s) were the same' % IMAGE_SIZE in output
+
+    # Corrupt the loadable in the middle, so the others are still hashed
+    bad = images[2]
+    pos = bad['offset'] + IMAGE_SIZE // 2
+    cons.restart_uboot()
+    with cons.log.section('Corrupted FIT'):
+        cons.run_command('host load hostfs 0 %x %s' % (FIT_ADDR, fit))
+        cons.run_command('mw.b %x %x' % (FIT_ADDR + pos, fit_data[pos] ^ 0xff))
+        output = cons.run_command('iminfo %x' % FIT_ADDR)
+        assert ("Bad hash value for 'hash-1' hash node in '%s' image node" %
+                bad['name']) in output
+
+        output = cons.run_command('bootm start %x' % FIT_ADDR)
+        assert 'Bad Data Hash' in output
+
+    cons.restart_uboot()
@@ -23,6 +23,7 @@ trace resume
 hash sha256 0 10000
 trace pause
 trace stats
+trace top 20 total
 reset
 END
 }
@@ -52,6 +53,11 @@ check_results() {
 	if [ "${counts}" != "1 1 0 1 " ]; then
 		fail "trace collection error: ${counts}"
 	fi
+
+	# The hash command should be among the functions taking most time
+	if ! grep -A20 "Total us" ${tmp} | grep -q do_hash; then
+		fail "trace top error"
+	fi
 }
 
 echo "Simple trace test / sanity check using sandbox"
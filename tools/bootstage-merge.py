@@ -0,0 +1,91 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: GPL-2.0+
+#
+# Merge bootstage timelines exported with 'bootstage export'
+#
+# Each input file becomes a separate process in the output, so that the SPL
+# and U-Boot proper timelines can be viewed together in chrome://tracing or
+# Perfetto. Records which appear in more than one input (for example SPL
+# records which U-Boot proper picked up with BOOTSTAGE_STASH) are only kept
+# in the first file which has them.
+#
+# Usage:
+#    bootstage-merge.py [-o out.json] spl.json[:name][@offset_us] ...
+
+import argparse
+import json
+import sys
+
+def parse_input(spec):
+    """Split an input specification into its component parts
+
+    Args:
+        spec: Input spec, in the form filename[:name][@offset_us]
+
+    Returns:
+        Tuple:
+            Filename to read
+            Name to use for the process
+            Offset in microseconds to add to each timestamp
+    """
+    offset = 0
+    if '@' in spec:
+        spec, offset_str = spec.rsplit('@', 1)
+        offset = int(offset_str, 0)
+    fname, _, name = spec.partition(':')
+    return fname, name or fname, offset
+
+def merge(inputs):
+    """Merge a list of bootstage exports into a single trace
+
+    Args:
+        inputs: List of (fname, name, offset) tuples
+
+    Returns:
+        dict containing the merged trace
+    """
+    events = []
+    other = {}
+    seen = set()
+    for pid, (fname, name, offset) in enumerate(inputs, 1):
+        with open(fname) as fd:
+            data = json.load(fd)
+        events.append({'name': 'process_name', 'ph': 'M', 'pid': pid,
+                       'tid': 1, 'args': {'name': name}})
+        events.append({'name': 'process_sort_index', 'ph': 'M', 'pid': pid,
+                       'tid': 1, 'args': {'sort_index': pid}})
+        for event in data.get('traceEvents', []):
+            key = (event.get('name'), event.get('ph'), event.get('ts'),
+                   event.get('dur'))
+            if key in seen:
+                continue
+            seen.add(key)
+            event = dict(event, pid=pid)
+            if 'ts' in event:
+                event['ts'] += offset
+            events.append(event)
+        for key, value in data.get('otherData', {}).items():
+            other['%s: %s' % (name, key)] = value
+    return {'traceEvents': events, 'displayTimeUnit': 'ms',
+            'otherData': other}
+
+def main(argv):
+    parser = argparse.ArgumentParser(
+        description='Merge bootstage Chrome-trace exports')
+    parser.add_argument('-o', '--output', default='-',
+                        help='Output file (default: stdout)')
+    parser.add_argument('inputs', nargs='+',
+                        help='Input files, as filename[:name][@offset_us]')
+    args = parser.parse_args(argv)
+
+    trace = merge([parse_input(spec) for spec in args.inputs])
+    if args.output == '-':
+        json.dump(trace, sys.stdout, indent=1)
+        print()
+    else:
+        with open(args.output, 'w') as fd:
+            json.dump(trace, fd, indent=1)
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
@@ -397,6 +397,25 @@ class DtbPlatdata(object):
                                    key=lambda x: conv_name_to_c(x.name))
         for idx, node in enumerate(self._valid_nodes):
             node.idx = idx
+            node.req_seq = -1
+
+    def scan_aliases(self):
+        """Scan the /aliases node to find sequence numbers for nodes
+
+        This sets node.req_seq for each valid node which has an alias ending
+        in a number, e.g. 'serial2'. If a node has more than one such alias,
+        the first one is used.
+        """
+        aliases = self._fdt.GetNode('/aliases')
+        if not aliases:
+            return
+        for name, prop in aliases.props.items():
+            match = re.match(r'.*\D(\d+)$', name)
+            if not match or prop.type != fdt.TYPE_STRING:
+                continue
+            node = self._fdt.GetNode(prop.value)
+            if node in self._valid_nodes and node.req_seq == -1:
+                node.req_seq = int(match.group(1))
 
     @staticmethod
     def get_num_cells(node):
@@ -648,15 +667,19 @@ class DtbPlatdata(object):
             self.buf(',\n')
         self.buf('};\n')
 
-        # Add a device declaration
+        # Add a device declaration. The driver is referenced weakly so that
+        # nodes whose driver is not built in fall back to a lookup by name.
+        self.buf('DM_DRIVER_WEAK_DECL(%s);\n' % struct_name)
         self.buf('U_BOOT_DEVICE(%s) = {\n' % var_name)
         self.buf('\t.name\t\t= "%s",\n' % struct_name)
+        self.buf('\t.drv\t\t= DM_DRIVER_REF(%s),\n' % struct_name)
         self.buf('\t.platdata\t= &%s%s,\n' % (VAL_PREFIX, var_name))
         self.buf('\t.platdata_size\t= sizeof(%s%s),\n' % (VAL_PREFIX, var_name))
         idx = -1
         if node.parent and node.parent in self._valid_nodes:
             idx = node.parent.idx
         self.buf('\t.parent_idx\t= %d,\n' % idx)
+        self.buf('\t.req_seq\t= %d,\n' % node.req_seq)
         self.buf('};\n')
         self.buf('\n')
 
@@ -718,6 +741,7 @@ def run_steps(args, dtb_file, include_disabled, output, warning_disabled=False,
     plat.scan_drivers()
     plat.scan_dtb()
     plat.scan_tree()
+    plat.scan_aliases()
     plat.scan_reg_sizes()
     plat.setup_output(output)
     structs = plat.scan_structs()
@@ -215,11 +215,14 @@ struct dtd_sandbox_spl_test_2 {
 /* Node /i2c@0 index 0 */
 static struct dtd_sandbox_i2c_test dtv_i2c_at_0 = {
 };
+DM_DRIVER_WEAK_DECL(sandbox_i2c_test);
 U_BOOT_DEVICE(i2c_at_0) = {
 \t.name\t\t= "sandbox_i2c_test",
+\t.drv\t\t= DM_DRIVER_REF(sandbox_i2c_test),
 \t.platdata\t= &dtv_i2c_at_0,
 \t.platdata_size\t= sizeof(dtv_i2c_at_0),
 \t.parent_idx\t= -1,
+\t.req_seq\t= -1,
 };
 
 /* Node /i2c@0/pmic@9 index 1 */
@@ -227,11 +230,14 @@ static struct dtd_sandbox_pmic_test dtv_pmic_at_9 = {
 \t.low_power\t\t= true,
 \t.reg\t\t\t= {0x9, 0x0},
 };
+DM_DRIVER_WEAK_DECL(sandbox_pmic_test);
 U_BOOT_DEVICE(pmic_at_9) = {
 \t.name\t\t= "sandbox_pmic_test",
+\t.drv\t\t= DM_DRIVER_REF(sandbox_pmic_test),
 \t.platdata\t= &dtv_pmic_at_9,
 \t.platdata_size\t= sizeof(dtv_pmic_at_9),
 \t.parent_idx\t= 0,
+\t.req_seq\t= -1,
 };
 
 /* Node /spl-test index 2 */
@@ -247,11 +253,14 @@ static struct dtd_sandbox_spl_test dtv_spl_test = {
 \t.stringarray\t\t= {"multi-word", "message", ""},
 \t.stringval\t\t= "message",
 };
+DM_DRIVER_WEAK_DECL(sandbox_spl_test);
 U_BOOT_DEVICE(spl_test) = {
 \t.name\t\t= "sandbox_spl_test",
+\t.drv\t\t= DM_DRIVER_REF(sandbox_spl_test),
 \t.platdata\t= &dtv_spl_test,
 \t.platdata_size\t= sizeof(dtv_spl_test),
 \t.parent_idx\t= -1,
+\t.req_seq\t= -1,
 };
 
 /* Node /spl-test2 index 3 */
@@ -266,11 +275,14 @@ static struct dtd_sandbox_spl_test dtv_spl_test2 = {
 \t.stringarray\t\t= {"another", "multi-word", "message"},
 \t.stringval\t\t= "message2",
 };
+DM_DRIVER_WEAK_DECL(sandbox_spl_test);
 U_BOOT_DEVICE(spl_test2) = {
 \t.name\t\t= "sandbox_spl_test",
+\t.drv\t\t= DM_DRIVER_REF(sandbox_spl_test),
 \t.platdata\t= &dtv_spl_test2,
 \t.platdata_size\t= sizeof(dtv_spl_test2),
 \t.parent_idx\t= -1,
+\t.req_seq\t= -1,
 };
 
 /* Node /spl-test3 index 4 */
@@ -279,21 +291,27 @@ static struct dtd_sandbox_spl_test dtv_spl_test3 = {
 \t\t0x0},
 \t.stringarray\t\t= {"one", "", ""},
 };
+DM_DRIVER_WEAK_DECL(sandbox_spl_test);
 U_BOOT_DEVICE(spl_test3) = {
 \t.name\t\t= "sandbox_spl_test",
+\t.drv\t\t= DM_DRIVER_REF(sandbox_spl_test),
 \t.platdata\t= &dtv_spl_test3,
 \t.platdata_size\t= sizeof(dtv_spl_test3),
 \t.parent_idx\t= -1,
+\t.req_seq\t= -1,
 };
 
 /* Node /spl-test4 index 5 */
 static struct dtd_sandbox_spl_test_2 dtv_spl_test4 = {
 };
+DM_DRIVER_WEAK_DECL(sandbox_spl_test_2);
 U_BOOT_DEVICE(spl_test4) = {
 \t.name\t\t= "sandbox_spl_test_2",
+\t.drv\t\t= DM_DRIVER_REF(sandbox_spl_test_2),
 \t.platdata\t= &dtv_spl_test4,
 \t.platdata_size\t= sizeof(dtv_spl_test4),
 \t.parent_idx\t= -1,
+\t.req_seq\t= -1,
 };
 
 ''' + C_EMPTY_POPULATE_PHANDLE_DATA, data)
@@ -323,11 +341,14 @@ static struct dtd_sandbox_gpio dtv_gpios_at_0 = {
 \t.gpio_controller\t= true,
 \t.sandbox_gpio_count\t= 0x14,
 };
+DM_DRIVER_WEAK_DECL(sandbox_gpio);
 U_BOOT_DEVICE(gpios_at_0) = {
 \t.name\t\t= "sandbox_gpio",
+\t.drv\t\t= DM_DRIVER_REF(sandbox_gpio),
 \t.platdata\t= &dtv_gpios_at_0,
 \t.platdata_size\t= sizeof(dtv_gpios_at_0),
 \t.parent_idx\t= -1,
+\t.req_seq\t= -1,
 };
 
 void dm_populate_phandle_data(void) {
@@ -355,17 +376,56 @@ struct dtd_invalid {
 /* Node /spl-test index 0 */
 static struct dtd_invalid dtv_spl_test = {
 };
+DM_DRIVER_WEAK_DECL(invalid);
 U_BOOT_DEVICE(spl_test) = {
 \t.name\t\t= "invalid",
+\t.drv\t\t= DM_DRIVER_REF(invalid),
 \t.platdata\t= &dtv_spl_test,
 \t.platdata_size\t= sizeof(dtv_spl_test),
 \t.parent_idx\t= -1,
+\t.req_seq\t= -1,
 };
 
 void dm_populate_phandle_data(void) {
 }
 ''', data)
 
+    def test_alias_seq(self):
+        """Test that sequence numbers are taken from aliases"""
+        dtb_file = get_dtb_file('dtoc_test_alias_seq.dts')
+        output = tools.GetOutputFilename('output')
+        self.run_test(['platdata'], dtb_file, output)
+        with open(output) as infile:
+            data = infile.read()
+        self._CheckStrings(C_HEADER + '''
+/* Node /serial@0 index 0 */
+static struct dtd_sandbox_serial dtv_serial_at_0 = {
+};
+DM_DRIVER_WEAK_DECL(sandbox_serial);
+U_BOOT_DEVICE(serial_at_0) = {
+\t.name\t\t= "sandbox_serial",
+\t.drv\t\t= DM_DRIVER_REF(sandbox_serial),
+\t.platdata\t= &dtv_serial_at_0,
+\t.platdata_size\t= sizeof(dtv_serial_at_0),
+\t.parent_idx\t= -1,
+\t.req_seq\t= -1,
+};
+
+/* Node /serial@1 index 1 */
+static struct dtd_sandbox_serial dtv_serial_at_1 = {
+};
+DM_DRIVER_WEAK_DECL(sandbox_serial);
+U_BOOT_DEVICE(serial_at_1) = {
+\t.name\t\t= "sandbox_serial",
+\t.drv\t\t= DM_DRIVER_REF(sandbox_serial),
+\t.platdata\t= &dtv_serial_at_1,
+\t.platdata_size\t= sizeof(dtv_serial_at_1),
+\t.parent_idx\t= -1,
+\t.req_seq\t= 1,
+};
+
+''' + C_EMPTY_POPULATE_PHANDLE_DATA, data)
+
     def test_phandle(self):
         """Test output from a node containing a phandle reference"""
         dtb_file = get_dtb_file('dtoc_test_phandle.dts')
@@ -390,33 +450,42 @@ struct dtd_target {
 static struct dtd_target dtv_phandle2_target = {
 \t.intval\t\t\t= 0x1,
 };
+DM_DRIVER_WEAK_DECL(target);
 U_BOOT_DEVICE(phandle2_target) = {
 \t.name\t\t= "target",
+\t.drv\t\t= DM_DRIVER_REF(target),
 \t.platdata\t= &dtv_phandle2_target,
 \t.platdata_size\t= sizeof(dtv_phandle2_target),
 \t.parent_idx\t= -1,
+\t.req_seq\t= -1,
 };
 
 /* Node /phandle3-target index 1 */
 static struct dtd_target dtv_phandle3_target = {
 \t.intval\t\t\t= 0x2,
 };
+DM_DRIVER_WEAK_DECL(target);
 U_BOOT_DEVICE(phandle3_target) = {
 \t.name\t\t= "target",
+\t.drv\t\t= DM_DRIVER_REF(target),
 \t.platdata\t= &dtv_phandle3_target,
 \t.platdata_size\t= sizeof(dtv_phandle3_target),
 \t.parent_idx\t= -1,
+\t.req_seq\t= -1,
 };
 
 /* Node /phandle-target index 4 */
 static struct dtd_target dtv_phandle_target = {
 \t.intval\t\t\t= 0x0,
 };
+DM_DRIVER_WEAK_DECL(target);
 U_BOOT_DEVICE(phandle_target) = {
 \t.name\t\t= "target",
+\t.drv\t\t= DM_DRIVER_REF(target),
 \t.platdata\t= &dtv_phandle_target,
 \t.platdata_size\t= sizeof(dtv_phandle_target),
 \t.parent_idx\t= -1,
+\t.req_seq\t= -1,
 };
 
 /* Node /phandle-source index 2 */
@@ -427,11 +496,14 @@ static struct dtd_source dtv_phandle_source = {
 \t\t\t{1, {12, 13}},
 \t\t\t{4, {}},},
 };
+DM_DRIVER_WEAK_DECL(source);
 U_BOOT_DEVICE(phandle_source) = {
 \t.name\t\t= "source",
+\t.drv\t\t= DM_DRIVER_REF(source),
 \t.platdata\t= &dtv_phandle_source,
 \t.platdata_size\t= sizeof(dtv_phandle_source),
 \t.parent_idx\t= -1,
+\t.req_seq\t= -1,
 };
 
 /* Node /phandle-source2 index 3 */
@@ -439,11 +511,14 @@ static struct dtd_source dtv_phandle_source2 = {
 \t.clocks\t\t\t= {
 \t\t\t{4, {}},},
 };
+DM_DRIVER_WEAK_DECL(source);
 U_BOOT_DEVICE(phandle_source2) = {
 \t.name\t\t= "source",
+\t.drv\t\t= DM_DRIVER_REF(source),
 \t.platdata\t= &dtv_phandle_source2,
 \t.platdata_size\t= sizeof(dtv_phandle_source2),
 \t.parent_idx\t= -1,
+\t.req_seq\t= -1,
 };
 
 void dm_populate_phandle_data(void) {
@@ -477,11 +552,14 @@ struct dtd_target {
 /* Node /phandle-target index 1 */
 static struct dtd_target dtv_phandle_target = {
 };
+DM_DRIVER_WEAK_DECL(target);
 U_BOOT_DEVICE(phandle_target) = {
 \t.name\t\t= "target",
+\t.drv\t\t= DM_DRIVER_REF(target),
 \t.platdata\t= &dtv_phandle_target,
 \t.platdata_size\t= sizeof(dtv_phandle_target),
 \t.parent_idx\t= -1,
+\t.req_seq\t= -1,
 };
 
 /* Node /phandle-source2 index 0 */
@@ -489,11 +567,14 @@ static struct dtd_source dtv_phandle_source2 = {
 \t.clocks\t\t\t= {
 \t\t\t{1, {}},},
 };
+DM_DRIVER_WEAK_DECL(source);
 U_BOOT_DEVICE(phandle_source2) = {
 \t.name\t\t= "source",
+\t.drv\t\t= DM_DRIVER_REF(source),
 \t.platdata\t= &dtv_phandle_source2,
 \t.platdata_size\t= sizeof(dtv_phandle_source2),
 \t.parent_idx\t= -1,
+\t.req_seq\t= -1,
 };
 
 void dm_populate_phandle_data(void) {
@@ -512,33 +593,42 @@ void dm_populate_phandle_data(void) {
 static struct dtd_target dtv_phandle2_target = {
 \t.intval\t\t\t= 0x1,
 };
+DM_DRIVER_WEAK_DECL(target);
 U_BOOT_DEVICE(phandle2_target) = {
 \t.name\t\t= "target",
+\t.drv\t\t= DM_DRIVER_REF(target),
 \t.platdata\t= &dtv_phandle2_target,
 \t.platdata_size\t= sizeof(dtv_phandle2_target),
 \t.parent_idx\t= -1,
+\t.req_seq\t= -1,
 };
 
 /* Node /phandle3-target index 1 */
 static struct dtd_target dtv_phandle3_target = {
 \t.intval\t\t\t= 0x2,
 };
+DM_DRIVER_WEAK_DECL(target);
 U_BOOT_DEVICE(phandle3_target) = {
 \t.name\t\t= "target",
+\t.drv\t\t= DM_DRIVER_REF(target),
 \t.platdata\t= &dtv_phandle3_target,
 \t.platdata_size\t= sizeof(dtv_phandle3_target),
 \t.parent_idx\t= -1,
+\t.req_seq\t= -1,
 };
 
 /* Node /phandle-target index 4 */
 static struct dtd_target dtv_phandle_target = {
 \t.intval\t\t\t= 0x0,
 };
+DM_DRIVER_WEAK_DECL(target);
 U_BOOT_DEVICE(phandle_target) = {
 \t.name\t\t= "target",
+\t.drv\t\t= DM_DRIVER_REF(target),
 \t.platdata\t= &dtv_phandle_target,
 \t.platdata_size\t= sizeof(dtv_phandle_target),
 \t.parent_idx\t= -1,
+\t.req_seq\t= -1,
 };
 
 /* Node /phandle-source index 2 */
@@ -549,11 +639,14 @@ static struct dtd_source dtv_phandle_source = {
 \t\t\t{1, {12, 13}},
 \t\t\t{4, {}},},
 };
+DM_DRIVER_WEAK_DECL(source);
 U_BOOT_DEVICE(phandle_source) = {
 \t.name\t\t= "source",
+\t.drv\t\t= DM_DRIVER_REF(source),
 \t.platdata\t= &dtv_phandle_source,
 \t.platdata_size\t= sizeof(dtv_phandle_source),
 \t.parent_idx\t= -1,
+\t.req_seq\t= -1,
 };
 
 /* Node /phandle-source2 index 3 */
@@ -561,11 +654,14 @@ static struct dtd_source dtv_phandle_source2 = {
 \t.cd_gpios\t\t= {
 \t\t\t{4, {}},},
 };
+DM_DRIVER_WEAK_DECL(source);
 U_BOOT_DEVICE(phandle_source2) = {
 \t.name\t\t= "source",
+\t.drv\t\t= DM_DRIVER_REF(source),
 \t.platdata\t= &dtv_phandle_source2,
 \t.platdata_size\t= sizeof(dtv_phandle_source2),
 \t.parent_idx\t= -1,
+\t.req_seq\t= -1,
 };
 
 void dm_populate_phandle_data(void) {
@@ -619,33 +715,42 @@ struct dtd_test3 {
 static struct dtd_test1 dtv_test1 = {
 \t.reg\t\t\t= {0x1234, 0x5678},
 };
+DM_DRIVER_WEAK_DECL(test1);
 U_BOOT_DEVICE(test1) = {
 \t.name\t\t= "test1",
+\t.drv\t\t= DM_DRIVER_REF(test1),
 \t.platdata\t= &dtv_test1,
 \t.platdata_size\t= sizeof(dtv_test1),
 \t.parent_idx\t= -1,
+\t.req_seq\t= -1,
 };
 
 /* Node /test2 index 1 */
 static struct dtd_test2 dtv_test2 = {
 \t.reg\t\t\t= {0x1234567890123456, 0x9876543210987654},
 };
+DM_DRIVER_WEAK_DECL(test2);
 U_BOOT_DEVICE(test2) = {
 \t.name\t\t= "test2",
+\t.drv\t\t= DM_DRIVER_REF(test2),
 \t.platdata\t= &dtv_test2,
 \t.platdata_size\t= sizeof(dtv_test2),
 \t.parent_idx\t= -1,
+\t.req_seq\t= -1,
 };
 
 /* Node /test3 index 2 */
 static struct dtd_test3 dtv_test3 = {
 \t.reg\t\t\t= {0x1234567890123456, 0x9876543210987654, 0x2, 0x3},
 };
+DM_DRIVER_WEAK_DECL(test3);
 U_BOOT_DEVICE(test3) = {
 \t.name\t\t= "test3",
+\t.drv\t\t= DM_DRIVER_REF(test3),
 \t.platdata\t= &dtv_test3,
 \t.platdata_size\t= sizeof(dtv_test3),
 \t.parent_idx\t= -1,
+\t.req_seq\t= -1,
 };
 
 ''' + C_EMPTY_POPULATE_PHANDLE_DATA, data)
@@ -674,22 +779,28 @@ struct dtd_test2 {
 static struct dtd_test1 dtv_test1 = {
 \t.reg\t\t\t= {0x1234, 0x5678},
 };
+DM_DRIVER_WEAK_DECL(test1);
 U_BOOT_DEVICE(test1) = {
 \t.name\t\t= "test1",
+\t.drv\t\t= DM_DRIVER_REF(test1),
 \t.platdata\t= &dtv_test1,
 \t.platdata_size\t= sizeof(dtv_test1),
 \t.parent_idx\t= -1,
+\t.req_seq\t= -1,
 };
 
 /* Node /test2 index 1 */
 static struct dtd_test2 dtv_test2 = {
 \t.reg\t\t\t= {0x12345678, 0x98765432, 0x2, 0x3},
 };
+DM_DRIVER_WEAK_DECL(test2);
 U_BOOT_DEVICE(test2) = {
 \t.name\t\t= "test2",
+\t.drv\t\t= DM_DRIVER_REF(test2),
 \t.platdata\t= &dtv_test2,
 \t.platdata_size\t= sizeof(dtv_test2),
 \t.parent_idx\t= -1,
+\t.req_seq\t= -1,
 };
 
 ''' + C_EMPTY_POPULATE_PHANDLE_DATA, data)
@@ -721,33 +832,42 @@ struct dtd_test3 {
 static struct dtd_test1 dtv_test1 = {
 \t.reg\t\t\t= {0x123400000000, 0x5678},
 };
+DM_DRIVER_WEAK_DECL(test1);
 U_BOOT_DEVICE(test1) = {
 \t.name\t\t= "test1",
+\t.drv\t\t= DM_DRIVER_REF(test1),
 \t.platdata\t= &dtv_test1,
 \t.platdata_size\t= sizeof(dtv_test1),
 \t.parent_idx\t= -1,
+\t.req_seq\t= -1,
 };
 
 /* Node /test2 index 1 */
 static struct dtd_test2 dtv_test2 = {
 \t.reg\t\t\t= {0x1234567890123456, 0x98765432},
 };
+DM_DRIVER_WEAK_DECL(test2);
 U_BOOT_DEVICE(test2) = {
 \t.name\t\t= "test2",
+\t.drv\t\t= DM_DRIVER_REF(test2),
 \t.platdata\t= &dtv_test2,
 \t.platdata_size\t= sizeof(dtv_test2),
 \t.parent_idx\t= -1,
+\t.req_seq\t= -1,
 };
 
 /* Node /test3 index 2 */
 static struct dtd_test3 dtv_test3 = {
 \t.reg\t\t\t= {0x1234567890123456, 0x98765432, 0x2, 0x3},
 };
+DM_DRIVER_WEAK_DECL(test3);
 U_BOOT_DEVICE(test3) = {
 \t.name\t\t= "test3",
+\t.drv\t\t= DM_DRIVER_REF(test3),
 \t.platdata\t= &dtv_test3,
 \t.platdata_size\t= sizeof(dtv_test3),
 \t.parent_idx\t= -1,
+\t.req_seq\t= -1,
 };
 
 ''' + C_EMPTY_POPULATE_PHANDLE_DATA, data)
@@ -779,33 +899,42 @@ struct dtd_test3 {
 static struct dtd_test1 dtv_test1 = {
 \t.reg\t\t\t= {0x1234, 0x567800000000},
 };
+DM_DRIVER_WEAK_DECL(test1);
 U_BOOT_DEVICE(test1) = {
 \t.name\t\t= "test1",
+\t.drv\t\t= DM_DRIVER_REF(test1),
 \t.platdata\t= &dtv_test1,
 \t.platdata_size\t= sizeof(dtv_test1),
 \t.parent_idx\t= -1,
+\t.req_seq\t= -1,
 };
 
 /* Node /test2 index 1 */
 static struct dtd_test2 dtv_test2 = {
 \t.reg\t\t\t= {0x12345678, 0x9876543210987654},
 };
+DM_DRIVER_WEAK_DECL(test2);
 U_BOOT_DEVICE(test2) = {
 \t.name\t\t= "test2",
+\t.drv\t\t= DM_DRIVER_REF(test2),
 \t.platdata\t= &dtv_test2,
 \t.platdata_size\t= sizeof(dtv_test2),
 \t.parent_idx\t= -1,
+\t.req_seq\t= -1,
 };
 
 /* Node /test3 index 2 */
 static struct dtd_test3 dtv_test3 = {
 \t.reg\t\t\t= {0x12345678, 0x9876543210987654, 0x2, 0x3},
 };
+DM_DRIVER_WEAK_DECL(test3);
 U_BOOT_DEVICE(test3) = {
 \t.name\t\t= "test3",
+\t.drv\t\t= DM_DRIVER_REF(test3),
 \t.platdata\t= &dtv_test3,
 \t.platdata_size\t= sizeof(dtv_test3),
 \t.parent_idx\t= -1,
+\t.req_seq\t= -1,
 };
 
 ''' + C_EMPTY_POPULATE_PHANDLE_DATA, data)
@@ -852,22 +981,28 @@ struct dtd_sandbox_spl_test {
 static struct dtd_sandbox_spl_test dtv_spl_test = {
 \t.intval\t\t\t= 0x1,
 };
+DM_DRIVER_WEAK_DECL(sandbox_spl_test);
 U_BOOT_DEVICE(spl_test) = {
 \t.name\t\t= "sandbox_spl_test",
+\t.drv\t\t= DM_DRIVER_REF(sandbox_spl_test),
 \t.platdata\t= &dtv_spl_test,
 \t.platdata_size\t= sizeof(dtv_spl_test),
 \t.parent_idx\t= -1,
+\t.req_seq\t= -1,
 };
 
 /* Node /spl-test2 index 1 */
 static struct dtd_sandbox_spl_test dtv_spl_test2 = {
 \t.intarray\t\t= 0x5,
 };
+DM_DRIVER_WEAK_DECL(sandbox_spl_test);
 U_BOOT_DEVICE(spl_test2) = {
 \t.name\t\t= "sandbox_spl_test",
+\t.drv\t\t= DM_DRIVER_REF(sandbox_spl_test),
 \t.platdata\t= &dtv_spl_test2,
 \t.platdata_size\t= sizeof(dtv_spl_test2),
 \t.parent_idx\t= -1,
+\t.req_seq\t= -1,
 };
 
 ''' + C_EMPTY_POPULATE_PHANDLE_DATA, data)